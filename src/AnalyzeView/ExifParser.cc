@@ -2,6 +2,7 @@
 #include <math.h>
 #include <QtEndian>
 #include <QDateTime>
+#include <QFile>
 
 ExifParser::ExifParser()
 {
@@ -56,7 +57,81 @@ double ExifParser::readTime(QByteArray& buf)
     return tagTime.toMSecsSinceEpoch()/1000.0;
 }
 
-bool ExifParser::write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag)
+bool ExifParser::readHeader(QIODevice& image, QByteArray& header)
+{
+    header = image.read(2);
+    if (header != QByteArray("\xff\xd8", 2)) {
+        // No start of image marker
+        return false;
+    }
+
+    while (true) {
+        // Each segment is a two byte marker followed by the big endian segment length, which includes the length itself
+        QByteArray marker = image.read(4);
+        if (marker.size() != 4 || static_cast<uint8_t>(marker[0]) != 0xff) {
+            return false;
+        }
+        uint8_t markerType = static_cast<uint8_t>(marker[1]);
+        if (markerType == 0xda || markerType == 0xd9) {
+            // Start of scan or end of image reached without an Exif segment
+            return false;
+        }
+        uint16_t segmentSize = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(marker.constData() + 2));
+        if (segmentSize < 2) {
+            return false;
+        }
+        QByteArray segment = image.read(segmentSize - 2);
+        if (segment.size() != segmentSize - 2) {
+            return false;
+        }
+        header.append(marker);
+        header.append(segment);
+
+        if (markerType == 0xe1 && segment.startsWith(QByteArray("Exif\0\0", 6))) {
+            return true;
+        }
+    }
+}
+
+bool ExifParser::writeTagged(const QString& sourceFile, const QString& destFile, const GeoTagWorker::cameraFeedbackPacket& geotag, QString& errorString)
+{
+    errorString.clear();
+
+    QFile source(sourceFile);
+    if (!source.open(QIODevice::ReadOnly)) {
+        errorString = tr("Couldn't open an image.");
+        return false;
+    }
+
+    QByteArray header;
+    if (!readHeader(source, header) || !write(header, geotag)) {
+        errorString = tr("Couldn't write to image.");
+        return false;
+    }
+
+    // The tagged header only differs in size from the original one, the image data following it is copied unchanged
+    QFile dest(destFile);
+    if (!dest.open(QFile::WriteOnly) || dest.write(header) != header.size()) {
+        errorString = tr("Couldn't write to an image.");
+        return false;
+    }
+    QByteArray chunk(_copyChunkSize, Qt::Uninitialized);
+    qint64 bytesRead;
+    while ((bytesRead = source.read(chunk.data(), chunk.size())) > 0) {
+        if (dest.write(chunk.constData(), bytesRead) != bytesRead) {
+            errorString = tr("Couldn't write to an image.");
+            return false;
+        }
+    }
+    if (bytesRead < 0) {
+        errorString = tr("Couldn't read an image.");
+        return false;
+    }
+
+    return true;
+}
+
+bool ExifParser::write(QByteArray& buf, const GeoTagWorker::cameraFeedbackPacket& geotag)
 {
     QByteArray app1Header("\xff\xe1", 2);
     uint32_t app1HeaderInd = buf.indexOf(app1Header);
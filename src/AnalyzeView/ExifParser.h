@@ -3,16 +3,33 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QCoreApplication>
+#include <QIODevice>
 
 #include "GeoTagController.h"
 
 class ExifParser
 {
+    Q_DECLARE_TR_FUNCTIONS(ExifParser)
+
 public:
     ExifParser();
     ~ExifParser();
     double readTime(QByteArray& buf);
-    bool write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag);
+    bool write(QByteArray& buf, const GeoTagWorker::cameraFeedbackPacket& geotag);
+
+    /// Reads the JPEG segments from the start of the image up to and including the Exif APP1 segment. This is all
+    /// readTime and write need, so the image data itself is never read.
+    ///     @return false: image could not be read or has no Exif segment
+    bool readHeader(QIODevice& image, QByteArray& header);
+
+    /// Writes a geotagged copy of an image. Only the Exif header is patched in memory, the remainder of the image is
+    /// copied through in chunks.
+    ///     @return false: failed, errorString set
+    bool writeTagged(const QString& sourceFile, const QString& destFile, const GeoTagWorker::cameraFeedbackPacket& geotag, QString& errorString);
+
+private:
+    static const int _copyChunkSize = 1024 * 1024;
 };
 
 #endif // EXIFPARSER_H
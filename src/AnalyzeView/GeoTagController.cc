@@ -15,6 +15,12 @@
 #include <cfloat>
 #include <QDir>
 #include <QUrl>
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <functional>
+#include <limits>
 
 #include "ExifParser.h"
 #include "ULogParser.h"
@@ -163,54 +169,100 @@ void GeoTagWorker::run()
     }
     emit progressChanged((100/nSteps));
 
-    // Parse EXIF
-    ExifParser exifParser;
-    _imageTime.clear();
-    for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
+    // Images are read and written by a bounded set of pool threads which pull the next image index from a shared
+    // counter. The first failure stops all of them. The pool threads work on locals of run, so every way out of run
+    // waits for the pool first.
+    std::atomic_bool    poolStop(false);
+    QMutex              poolErrorMutex;
+    QString             poolError;
+    QAtomicInt          nextIndex(0);
+    QAtomicInt          doneCount(0);
+    QThreadPool         pool;
+    pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), _maxPoolThreads));
+
+    auto poolFailed = [&](const QString& errorMsg) {
+        QMutexLocker lock(&poolErrorMutex);
+        if (poolError.isEmpty()) {
+            poolError = errorMsg;
         }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(exifParser.readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
+        poolStop = true;
+    };
+    auto startPool = [&](const std::function<void()>& poolWorker) {
+        poolStop = false;
+        nextIndex = 0;
+        doneCount = 0;
+        for (int i = 0; i < pool.maxThreadCount(); i++) {
+            QtConcurrent::run(&pool, poolWorker);
         }
-    }
+    };
+    auto stopPool = [&]() {
+        poolStop = true;
+        pool.waitForDone();
+    };
+
+    // Parse EXIF. Only the headers are read and this happens on the pool while the log is parsed below.
+    int imageCount = _imageList.count();
+    QVector<double> imageTimes(imageCount, -1.0);
+    startPool([&]() {
+        ExifParser exifParser;
+        int index;
+        while (!_cancel && !poolStop && (index = nextIndex.fetchAndAddOrdered(1)) < imageCount) {
+            QFile file(_imageList.at(index).absoluteFilePath());
+            if (!file.open(QIODevice::ReadOnly)) {
+                poolFailed(tr("Geotagging failed. Couldn't open an image."));
+                return;
+            }
+            QByteArray header;
+            if (exifParser.readHeader(file, header)) {
+                imageTimes[index] = exifParser.readTime(header);
+            } else {
+                qCWarning(GeotaggingLog) << "No EXIF header found" << file.fileName();
+            }
+            emit progressChanged((100/nSteps) + ((100/nSteps) / imageCount) * doneCount.fetchAndAddOrdered(1));
+        }
+    });
 
-    // Load log
+    // Load log. The log file is mapped rather than read so that only the pages the parser walks through are loaded,
+    // and they can be dropped again once it has moved on.
     bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
     QFile file(_logFile);
     if (!file.open(QIODevice::ReadOnly)) {
+        stopPool();
         emit error(tr("Geotagging failed. Couldn't open log file."));
         return;
     }
-    QByteArray log = file.readAll();
-    file.close();
 
     // Instantiate appropriate parser
     _triggerList.clear();
     bool parseComplete = false;
     QString errorString;
     if (isULog) {
+        // Only the camera_capture messages need to be indexed
+        ULogReader reader;
         ULogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList, errorString);
+        parseComplete = reader.open(_logFile, errorString, QStringList(ULogParser::cameraCaptureTopic)) &&
+                parser.getTagsFromLog(reader, _triggerList, errorString);
 
     } else {
+        QByteArray log;
+        uchar* logData = nullptr;
+        if (file.size() > 0 && file.size() <= std::numeric_limits<int>::max()) {
+            logData = file.map(0, file.size());
+        }
+        if (logData) {
+            log = QByteArray::fromRawData(reinterpret_cast<const char*>(logData), static_cast<int>(file.size()));
+        } else {
+            log = file.readAll();
+        }
+
         PX4LogParser parser;
         parseComplete = parser.getTagsFromLog(log, _triggerList);
 
     }
+    file.close();
 
     if (!parseComplete) {
+        stopPool();
         if (_cancel) {
             qCDebug(GeotaggingLog) << "Tagging cancelled";
             emit error(tr("Tagging cancelled"));
@@ -222,6 +274,13 @@ void GeoTagWorker::run()
             return;
         }
     }
+
+    pool.waitForDone();
+    if (!poolError.isEmpty()) {
+        emit error(poolError);
+        return;
+    }
+    _imageTime = imageTimes.toList();
     emit progressChanged(3*(100/nSteps));
 
     qCDebug(GeotaggingLog) << "Found " << _triggerList.count() << " trigger logs.";
@@ -249,44 +308,30 @@ void GeoTagWorker::run()
     // Tag images
     int maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
     maxIndex = std::min(maxIndex, _imageList.count());
-    for(int i = 0; i < maxIndex; i++) {
-        int imageIndex = _imageIndices[i];
-        if (imageIndex >= _imageList.count()) {
-            emit error(tr("Geotagging failed. Image requested not present."));
-            return;
-        }
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
-        }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
-
-        if (!exifParser.write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
-            return;
-        } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
+    startPool([&]() {
+        ExifParser exifParser;
+        QString tagError;
+        int i;
+        while (!_cancel && !poolStop && (i = nextIndex.fetchAndAddOrdered(1)) < maxIndex) {
+            int imageIndex = _imageIndices.at(i);
+            if (imageIndex >= _imageList.count()) {
+                poolFailed(tr("Geotagging failed. Image requested not present."));
+                return;
             }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
+            QString fileName = _imageList.at(imageIndex).fileName();
+            QString destFile = _saveDirectory == "" ? _imageDirectory + "/TAGGED/" + fileName : _saveDirectory + "/" + fileName;
+            if (!exifParser.writeTagged(_imageList.at(imageIndex).absoluteFilePath(), destFile, _triggerList.at(_triggerIndices.at(i)), tagError)) {
+                poolFailed(tr("Geotagging failed. %1").arg(tagError));
                 return;
             }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
+            emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex) * doneCount.fetchAndAddOrdered(1));
         }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
+    });
+    pool.waitForDone();
 
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
-        }
+    if (!poolError.isEmpty()) {
+        emit error(poolError);
+        return;
     }
 
     if (_cancel) {
@@ -21,6 +21,8 @@
 #include <QDebug>
 #include <QGeoCoordinate>
 
+#include <atomic>
+
 class GeoTagWorker : public QThread
 {
     Q_OBJECT
@@ -61,7 +63,7 @@ signals:
 private:
     bool triggerFiltering();
 
-    bool                    _cancel;
+    std::atomic_bool        _cancel;
     QString                 _logFile;
     QString                 _imageDirectory;
     QString                 _saveDirectory;
@@ -71,6 +73,7 @@ private:
     QList<int>              _imageIndices;
     QList<int>              _triggerIndices;
 
+    static const int _maxPoolThreads = 8;   ///< Images are read and written on at most this many threads, more only contend for the disk
 };
 
 /// Controller for GeoTagPage.qml. Supports geotagging images based on logfile camera tags.
@@ -23,20 +23,46 @@
 #include <QSettings>
 #include <QUrl>
 #include <QBitArray>
+#include <QDataStream>
+#include <QSaveFile>
 #include <QtCore/qmath.h>
 
-#define kTimeOutMilliseconds 500
-#define kGUIRateMilliseconds 17
-#define kTableBins           512
-#define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kTimeOutMilliseconds        500
+#define kMinTimeOutMilliseconds     50
+#define kTimeOutPacketIntervals     8
+#define kGUIRateMilliseconds        17
+#define kBinSize                    MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN
+#define kMinWindowBins              32
+#define kInitialWindowBins          512
+#define kMaxWindowBins              65536
+#define kWindowTargetMilliseconds   1000
+#define kMaxResendBins              16
+#define kMaxWindowLossPercent       25
+#define kResumeRateMilliseconds     1000
+#define kResumeExtension            ".resume"
+#define kResumeMagic                0x514C4F47
+#define kResumeVersion              1
 
 QGC_LOGGING_CATEGORY(LogDownloadLog, "LogDownloadLog")
 
 //-----------------------------------------------------------------------------
+// The log is tracked as kBinSize bins, one per LOG_DATA packet. Data is requested a window of bins at a time and
+// each packet is written to the file as it arrives. The window grows while windows arrive intact and faster than
+// kWindowTargetMilliseconds, and shrinks when packets go missing.
 struct LogDownloadData {
     LogDownloadData(QGCLogEntry* entry);
-    QBitArray     chunk_table;
-    uint32_t      current_chunk;
+    QBitArray     bin_table;        // Received bins of the whole log
+    uint32_t      bins_received;
+    uint32_t      first_missing;    // All bins before this one have been received
+    uint32_t      window_bins;      // Current window size
+    uint32_t      request_start;    // First bin of the outstanding request
+    uint32_t      request_end;      // One past the last bin of the outstanding request
+    uint32_t      next_bin;         // Bin expected next from the outstanding request
+    uint32_t      request_lost;     // Bins of the outstanding request which were skipped
+    QElapsedTimer request_elapsed;
+    QElapsedTimer resume_elapsed;
+    QElapsedTimer packet_elapsed;
+    qreal         packet_interval;  // Average msecs between packets
     QFile         file;
     QString       filename;
     uint          ID;
@@ -46,36 +72,34 @@ struct LogDownloadData {
     qreal         rate_avg;
     QElapsedTimer elapsed;
 
-    void advanceChunk()
+    // The number of kBinSize bins in the file
+    uint32_t numBins() const
     {
-           current_chunk++;
-           chunk_table = QBitArray(chunkBins(), false);
+        return qCeil(entry->size() / static_cast<qreal>(kBinSize));
     }
 
-    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-    uint32_t chunkBins() const
+    bool complete() const
     {
-        return qMin(qCeil((entry->size() - current_chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
-                    kTableBins);
+        return bins_received == static_cast<uint32_t>(bin_table.size());
     }
 
-    // The number of kChunkSize chunks in the file
-    uint32_t numChunks() const
+    QString resumeFilename() const
     {
-        return qCeil(entry->size() / static_cast<qreal>(kChunkSize));
+        return file.fileName() + kResumeExtension;
     }
-
-    // True if all bins in the chunk have been set to val
-    bool chunkEquals(const bool val) const
-    {
-        return chunk_table == QBitArray(chunk_table.size(), val);
-    }
-
 };
 
 //----------------------------------------------------------------------------------------
 LogDownloadData::LogDownloadData(QGCLogEntry* entry_)
-    : ID(entry_->id())
+    : bins_received(0)
+    , first_missing(0)
+    , window_bins(kInitialWindowBins)
+    , request_start(0)
+    , request_end(0)
+    , next_bin(0)
+    , request_lost(0)
+    , packet_interval(0)
+    , ID(entry_->id())
     , entry(entry_)
     , written(0)
     , rate_bytes(0)
@@ -134,6 +158,12 @@ void
 LogDownloadController::_setActiveVehicle(Vehicle* vehicle)
 {
     if(_uas) {
+        //-- Keep what we have so far so the download can be resumed
+        if(_downloadData) {
+            _interruptDownload(tr("Interrupted"));
+            _resetSelection();
+            _setDownloading(false);
+        }
         _logEntriesModel.clear();
         disconnect(_uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
         disconnect(_uas, &UASInterface::logData,  this, &LogDownloadController::_logData);
@@ -162,10 +192,12 @@ LogDownloadController::_logEntry(UASInterface* uas, uint32_t time_utc, uint32_t
         if(_vehicle->firmwareType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
             _apmOneBased = 1;
         }
+        QList<QGCLogEntry*> entries;
+        entries.reserve(num_logs);
         for(int i = 0; i < num_logs; i++) {
-            QGCLogEntry *entry = new QGCLogEntry(i);
-            _logEntriesModel.append(entry);
+            entries.append(new QGCLogEntry(i));
         }
+        _logEntriesModel.append(entries);
     }
     //-- Update this log record
     if(num_logs > 0) {
@@ -307,92 +339,90 @@ LogDownloadController::_logData(UASInterface* uas, uint32_t ofs, uint16_t id, ui
         return;
     }
 
-    if ((ofs % MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) != 0) {
+    if ((ofs % kBinSize) != 0) {
         qWarning() << "Ignored misaligned incoming packet @" << ofs;
         return;
     }
 
-    bool result = false;
-    uint32_t timeout_time = kTimeOutMilliseconds;
-    if(ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / kChunkSize;
-        if (chunk != _downloadData->current_chunk) {
-            qWarning() << "Ignored packet for out of order chunk actual:expected" << chunk << _downloadData->current_chunk;
-            return;
+    const uint32_t bin = ofs / kBinSize;
+    if (bin >= static_cast<uint32_t>(_downloadData->bin_table.size())) {
+        qWarning() << "Received log offset greater than expected";
+        _downloadData->entry->setStatus(QString(tr("Error")));
+        return;
+    }
+
+    //-- Late packets from an earlier request are still stored, but only data for the outstanding request counts as progress
+    const bool inRequest = bin >= _downloadData->request_start && bin < _downloadData->request_end;
+    if (inRequest) {
+        //-- Reset retries and timer, data is flowing. A lost packet at the end of a request is only noticed through the
+        //   timer, so wait no longer than a few packet intervals once data is coming in.
+        _retries = 0;
+        _downloadData->packet_interval = _downloadData->packet_interval*0.9 + _downloadData->packet_elapsed.restart()*0.1;
+        _timer.start(qBound(kMinTimeOutMilliseconds, qCeil(_downloadData->packet_interval * kTimeOutPacketIntervals), kTimeOutMilliseconds));
+
+        if (bin > _downloadData->next_bin) {
+            _downloadData->request_lost += bin - _downloadData->next_bin;
         }
-        const uint16_t bin = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qWarning() << "Out of range bin received";
-        } else
-            _downloadData->chunk_table.setBit(bin);
+        _downloadData->next_bin = bin + 1;
+    }
+
+    if (!_downloadData->bin_table.testBit(bin)) {
+        //-- Write straight to the file
         if (_downloadData->file.pos() != ofs) {
             // Seek to correct position
             if (!_downloadData->file.seek(ofs)) {
                 qWarning() << "Error while seeking log file offset";
+                _downloadData->entry->setStatus(QString(tr("Error")));
                 return;
             }
         }
-
-        //-- Write chunk to file
-        if(_downloadData->file.write((const char*)data, count)) {
-            _downloadData->written += count;
-            _downloadData->rate_bytes += count;
-            if (_downloadData->elapsed.elapsed() >= kGUIRateMilliseconds) {
-                //-- Update download rate
-                qreal rrate = _downloadData->rate_bytes/(_downloadData->elapsed.elapsed()/1000.0);
-                _downloadData->rate_avg = _downloadData->rate_avg*0.95 + rrate*0.05;
-                _downloadData->rate_bytes = 0;
-
-                //-- Update status
-                const QString status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
-                                                                QGCMapEngine::bigSizeToString(_downloadData->rate_avg));
-
-                _downloadData->entry->setStatus(status);
-                _downloadData->elapsed.start();
-            }
-            result = true;
-            //-- reset retries
-            _retries = 0;
-            //-- Reset timer
-            _timer.start(timeout_time);
-            //-- Do we have it all?
-            if(_logComplete()) {
-                _downloadData->entry->setStatus(QString(tr("Downloaded")));
-                //-- Check for more
-                _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk*kChunkSize,
-                                _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if (bin < _downloadData->chunk_table.size() - 1 && _downloadData->chunk_table.at(bin+1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
-            }
-        } else {
+        if (_downloadData->file.write((const char*)data, count) != count) {
             qWarning() << "Error while writing log file chunk";
+            _downloadData->entry->setStatus(QString(tr("Error")));
+            return;
+        }
+        _downloadData->bin_table.setBit(bin);
+        _downloadData->bins_received++;
+        _downloadData->written += count;
+        _downloadData->rate_bytes += count;
+        if (_downloadData->elapsed.elapsed() >= kGUIRateMilliseconds) {
+            //-- Update download rate
+            qreal rrate = _downloadData->rate_bytes/(_downloadData->elapsed.elapsed()/1000.0);
+            _downloadData->rate_avg = _downloadData->rate_avg*0.95 + rrate*0.05;
+            _downloadData->rate_bytes = 0;
+
+            //-- Update status
+            const QString status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
+                                                            QGCMapEngine::bigSizeToString(_downloadData->rate_avg));
+
+            _downloadData->entry->setStatus(status);
+            _downloadData->elapsed.start();
+        }
+        if (_downloadData->resume_elapsed.elapsed() >= kResumeRateMilliseconds) {
+            _saveResumeFile();
         }
-    } else {
-        qWarning() << "Received log offset greater than expected";
-    }
-    if(!result) {
-        _downloadData->entry->setStatus(QString(tr("Error")));
     }
-}
-
 
-//----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_chunkComplete() const
-{
-    return _downloadData->chunkEquals(true);
+    //-- Do we have it all?
+    if(_logComplete()) {
+        _downloadData->entry->setStatus(QString(tr("Downloaded")));
+        //-- Check for more
+        _receivedAllData();
+    } else if (inRequest && bin == _downloadData->request_end - 1) {
+        //-- End of the requested window, carry on with whatever is missing
+        const uint32_t requested = _downloadData->request_end - _downloadData->request_start;
+        _adjustWindow(_downloadData->request_lost * 100 <= requested * kMaxWindowLossPercent);
+        _requestNextWindow();
+        //-- The packet timeout set above is too short to cover the round trip of a new request
+        _timer.start(kTimeOutMilliseconds);
+    }
 }
 
 //----------------------------------------------------------------------------------------
 bool
 LogDownloadController::_logComplete() const
 {
-    return _chunkComplete() && (_downloadData->current_chunk+1) == _downloadData->numChunks();
+    return _downloadData->complete();
 }
 
 //----------------------------------------------------------------------------------------
@@ -400,10 +430,20 @@ void
 LogDownloadController::_receivedAllData()
 {
     _timer.stop();
+    if(_downloadData && _logComplete()) {
+        _downloadData->file.close();
+        QFile::remove(_downloadData->resumeFilename());
+    }
     //-- Anything queued up for download?
     if(_prepareLogDownload()) {
+        if(_logComplete()) {
+            //-- Resumed a download which was already complete
+            _downloadData->entry->setStatus(QString(tr("Downloaded")));
+            _receivedAllData();
+            return;
+        }
         //-- Request Log
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+        _requestNextWindow();
         _timer.start(kTimeOutMilliseconds);
     } else {
         _resetSelection();
@@ -418,37 +458,148 @@ LogDownloadController::_findMissingData()
     if (_logComplete()) {
          _receivedAllData();
          return;
-    } else if (_chunkComplete()) {
-        _downloadData->advanceChunk();
     }
 
     if(_retries++ > 2) {
-        _downloadData->entry->setStatus(QString(tr("Timed Out")));
-        //-- Give up
+        //-- Give up, but keep what we have so it can be resumed
         qWarning() << "Too many errors retreiving log data. Giving up.";
+        _interruptDownload(tr("Timed Out"));
         _receivedAllData();
         return;
     }
 
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
-        }
+    //-- Timed out waiting for data, the link can not keep up with the window
+    _adjustWindow(false);
+    _requestNextWindow();
+    _timer.start(kTimeOutMilliseconds);
+}
+
+//----------------------------------------------------------------------------------------
+/// Requests the missing bins from the first missing one, limited to the window size. Gaps separated by a few received
+/// bins are requested together, re-sending those bins costs less than a round trip per gap. Only the bins within the
+/// window are looked at, never the whole table.
+void
+LogDownloadController::_requestNextWindow()
+{
+    const uint32_t numBins = _downloadData->bin_table.size();
+    uint32_t start = _downloadData->first_missing;
+    while (start < numBins && _downloadData->bin_table.testBit(start)) {
+        start++;
+    }
+    _downloadData->first_missing = start;
+    if (start >= numBins) {
+        return;
     }
 
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
+    const uint32_t limit = qMin(numBins, start + _downloadData->window_bins);
+    uint32_t end = start + 1;
+    uint32_t received = 0;
+    for (uint32_t bin = end; bin < limit; bin++) {
+        if (!_downloadData->bin_table.testBit(bin)) {
+            received = 0;
+            end = bin + 1;
+        } else if (++received > kMaxResendBins) {
             break;
         }
     }
 
-    const uint32_t pos = _downloadData->current_chunk*kChunkSize + start*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-                   len = (end - start)*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    _downloadData->request_start = start;
+    _downloadData->request_end = end;
+    _downloadData->next_bin = start;
+    _downloadData->request_lost = 0;
+    _downloadData->request_elapsed.start();
+    _downloadData->packet_elapsed.start();
+
+    const uint32_t pos = start * kBinSize;
+    const uint32_t len = qMin((end - start) * kBinSize, _downloadData->entry->size() - pos);
     _requestLogData(_downloadData->ID, pos, len);
 }
 
+//----------------------------------------------------------------------------------------
+/// Grows the window while full windows arrive intact in less than kWindowTargetMilliseconds, so that the request round
+/// trip between windows costs less and less of the link time. Shrinks the window when more than kMaxWindowLossPercent
+/// of it goes missing, which is the link not keeping up rather than random loss.
+void
+LogDownloadController::_adjustWindow(bool intact)
+{
+    const uint32_t oldWindow = _downloadData->window_bins;
+    if (!intact) {
+        _downloadData->window_bins = qMax<uint32_t>(kMinWindowBins, _downloadData->window_bins / 2);
+    } else if (_downloadData->request_end - _downloadData->request_start == _downloadData->window_bins &&
+               _downloadData->request_elapsed.elapsed() < kWindowTargetMilliseconds) {
+        // Requests which only fill in a gap are smaller than the window and say nothing about the link
+        _downloadData->window_bins = qMin<uint32_t>(kMaxWindowBins, _downloadData->window_bins * 2);
+    }
+    if (_downloadData->window_bins != oldWindow) {
+        qCDebug(LogDownloadLog) << "Window bins" << oldWindow << "->" << _downloadData->window_bins << "request msecs" << _downloadData->request_elapsed.elapsed();
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/// Saves the table of received bins next to the log file so the download can be resumed later. The file is flushed
+/// first so the table never claims data which is not on disk.
+void
+LogDownloadController::_saveResumeFile()
+{
+    _downloadData->resume_elapsed.start();
+    if (!_downloadData->file.isOpen() || !_downloadData->file.flush()) {
+        return;
+    }
+
+    QSaveFile resumeFile(_downloadData->resumeFilename());
+    if (!resumeFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to save log resume file:" << resumeFile.errorString();
+        return;
+    }
+    QDataStream stream(&resumeFile);
+    stream << static_cast<quint32>(kResumeMagic)
+           << static_cast<quint32>(kResumeVersion)
+           << static_cast<quint32>(_downloadData->entry->size())
+           << static_cast<quint32>(_downloadData->entry->time().toTime_t())
+           << _downloadData->bin_table;
+    if (stream.status() != QDataStream::Ok || !resumeFile.commit()) {
+        qWarning() << "Failed to save log resume file:" << resumeFile.errorString();
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/// Loads the table of received bins saved by a previous download of the same log
+bool
+LogDownloadController::_loadResumeFile()
+{
+    QFile resumeFile(_downloadData->resumeFilename());
+    if (!resumeFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&resumeFile);
+    quint32     magic, version, size, timeUTC;
+    QBitArray   binTable;
+    stream >> magic >> version >> size >> timeUTC >> binTable;
+    if (stream.status() != QDataStream::Ok || magic != kResumeMagic || version != kResumeVersion ||
+            size != _downloadData->entry->size() || timeUTC != _downloadData->entry->time().toTime_t() ||
+            static_cast<uint32_t>(binTable.size()) != _downloadData->numBins()) {
+        qCDebug(LogDownloadLog) << "Ignoring resume file which does not match the log" << resumeFile.fileName();
+        return false;
+    }
+    _downloadData->bin_table = binTable;
+    _downloadData->bins_received = binTable.count(true);
+    _downloadData->written = qMin(_downloadData->bins_received * kBinSize, _downloadData->entry->size());
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+/// Stops the current download, keeping the partial log and its resume file
+void
+LogDownloadController::_interruptDownload(const QString& status)
+{
+    _timer.stop();
+    _saveResumeFile();
+    _downloadData->file.close();
+    _downloadData->entry->setStatus(status);
+    delete _downloadData;
+    _downloadData = NULL;
+}
+
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::_requestLogData(uint16_t id, uint32_t offset, uint32_t count)
@@ -605,33 +756,51 @@ LogDownloadController::_prepareLogDownload()
         _downloadData->filename += ".bin";
     }
     _downloadData->file.setFileName(_downloadPath + _downloadData->filename);
-    //-- Append a number to the end if the filename already exists
-    if (_downloadData->file.exists()){
-        uint num_dups = 0;
-        QStringList filename_spl = _downloadData->filename.split('.');
-        do {
-            num_dups +=1;
-            _downloadData->file.setFileName(filename_spl[0] + '_' + QString::number(num_dups) + '.' + filename_spl[1]);
-        } while( _downloadData->file.exists());
-    }
-    //-- Create file
-    if (!_downloadData->file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Failed to create log file:" <<  _downloadData->filename;
-    } else {
-        //-- Preallocate file
-        if(!_downloadData->file.resize(entry->size())) {
+    _downloadData->bin_table = QBitArray(_downloadData->numBins(), false);
+    if (_downloadData->file.exists() && _loadResumeFile()) {
+        //-- Pick up where a previous download of this log left off
+        if (!_downloadData->file.open(QIODevice::ReadWrite)) {
+            qWarning() << "Failed to open log file for resume:" <<  _downloadData->filename;
+        } else if (_downloadData->file.size() != entry->size() && !_downloadData->file.resize(entry->size())) {
             qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
         } else {
-            _downloadData->current_chunk = 0;
-            _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
-            _downloadData->elapsed.start();
+            qCDebug(LogDownloadLog) << "Resuming" << _downloadData->filename << "bins" << _downloadData->bins_received << "of" << _downloadData->bin_table.size();
+            _downloadData->entry->setStatus(QString(tr("Resuming")));
             result = true;
         }
+    } else {
+        //-- Append a number to the end if the filename already exists
+        if (_downloadData->file.exists()){
+            uint num_dups = 0;
+            QStringList filename_spl = _downloadData->filename.split('.');
+            do {
+                num_dups +=1;
+                _downloadData->file.setFileName(_downloadPath + filename_spl[0] + '_' + QString::number(num_dups) + '.' + filename_spl[1]);
+            } while( _downloadData->file.exists());
+        }
+        //-- Create file
+        if (!_downloadData->file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Failed to create log file:" <<  _downloadData->filename;
+        } else {
+            //-- Preallocate file
+            if(!_downloadData->file.resize(entry->size())) {
+                qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
+            } else {
+                result = true;
+            }
+        }
+    }
+    if(result) {
+        _retries = 0;
+        _downloadData->elapsed.start();
+        _downloadData->resume_elapsed.start();
     }
     if(!result) {
+        //-- Remove the partial log and its resume data together, one is useless without the other
         if (_downloadData->file.exists()) {
             _downloadData->file.remove();
         }
+        QFile::remove(_downloadData->resumeFilename());
         _downloadData->entry->setStatus(QString(tr("Error")));
         delete _downloadData;
         _downloadData = NULL;
@@ -645,7 +814,9 @@ LogDownloadController::_setDownloading(bool active)
 {
     if (_downloadingLogs != active) {
         _downloadingLogs = active;
-        _vehicle->setConnectionLostEnabled(!active);
+        if (_vehicle) {
+            _vehicle->setConnectionLostEnabled(!active);
+        }
         emit downloadingLogsChanged();
     }
 }
@@ -656,7 +827,9 @@ LogDownloadController::_setListing(bool active)
 {
     if (_requestingLogEntries != active) {
         _requestingLogEntries = active;
-        _vehicle->setConnectionLostEnabled(!active);
+        if (_vehicle) {
+            _vehicle->setConnectionLostEnabled(!active);
+        }
         emit requestingListChanged();
     }
 }
@@ -690,6 +863,7 @@ LogDownloadController::cancel(void)
         if (_downloadData->file.exists()) {
             _downloadData->file.remove();
         }
+        QFile::remove(_downloadData->resumeFilename());
         delete _downloadData;
         _downloadData = 0;
     }
@@ -732,18 +906,33 @@ QGCLogModel::append(QGCLogEntry* object)
     emit countChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCLogModel::append(const QList<QGCLogEntry*>& entries)
+{
+    if(entries.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + entries.count() - 1);
+    for(QGCLogEntry* entry: entries) {
+        QQmlEngine::setObjectOwnership(entry, QQmlEngine::CppOwnership);
+    }
+    _logEntries.append(entries);
+    endInsertRows();
+    emit countChanged();
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCLogModel::clear(void)
 {
     if(!_logEntries.isEmpty()) {
-        beginRemoveRows(QModelIndex(), 0, _logEntries.count());
-        while (_logEntries.count()) {
-            QGCLogEntry* entry = _logEntries.last();
+        beginResetModel();
+        for(QGCLogEntry* entry: _logEntries) {
             if(entry) entry->deleteLater();
-            _logEntries.removeLast();
         }
-        endRemoveRows();
+        _logEntries.clear();
+        endResetModel();
         emit countChanged();
     }
 }
@@ -47,6 +47,7 @@ public:
 
     int         count           (void) const;
     void        append          (QGCLogEntry* entry);
+    void        append          (const QList<QGCLogEntry*>& entries);
     void        clear           (void);
     QGCLogEntry*operator[]      (int i);
 
@@ -146,7 +147,6 @@ private slots:
 private:
 
     bool _entriesComplete   ();
-    bool _chunkComplete     () const;
     bool _logComplete       () const;
     void _findMissingEntries();
     void _receivedAllEntries();
@@ -158,6 +158,11 @@ private:
     bool _prepareLogDownload();
     void _setDownloading    (bool active);
     void _setListing        (bool active);
+    void _requestNextWindow ();
+    void _adjustWindow      (bool intact);
+    void _saveResumeFile    ();
+    bool _loadResumeFile    ();
+    void _interruptDownload (const QString& status);
 
     QGCLogEntry* _getNextSelected();
 
@@ -12,6 +12,7 @@
 #include "MockLink.h"
 
 #include <QDir>
+#include <QElapsedTimer>
 
 LogDownloadTest::LogDownloadTest(void)
 {
@@ -64,3 +65,127 @@ void LogDownloadTest::downloadTest(void)
 
     delete controller;
 }
+
+QString LogDownloadTest::_downloadFile(void)
+{
+    return QDir(QDir::currentPath()).filePath("log_0_UnknownDate.ulg");
+}
+
+void LogDownloadTest::_removeDownload(void)
+{
+    QFile::remove(_downloadFile());
+    QFile::remove(_downloadFile() + ".resume");
+}
+
+/// Lists the logs on the vehicle and selects the first one for download
+bool LogDownloadTest::_refreshAndSelect(LogDownloadController* controller)
+{
+    controller->refresh();
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while (controller->requestingList() || controller->model()->count() == 0) {
+        if (elapsed.elapsed() > 10000) {
+            return false;
+        }
+        QTest::qWait(50);
+    }
+    (*controller->model())[0]->setSelected(true);
+    return true;
+}
+
+void LogDownloadTest::lossyDownloadTest(void)
+{
+    const uint32_t fileSize = 100 * 1024;
+
+    _removeDownload();
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(fileSize);
+    _mockLink->setLogDownloadLinkConditions(20, 10);
+
+    LogDownloadController* controller = new LogDownloadController();
+    QVERIFY(_refreshAndSelect(controller));
+
+    controller->downloadToDirectory(QDir::currentPath());
+    QVERIFY(controller->downloadingLogs());
+    QTRY_VERIFY_WITH_TIMEOUT(!controller->downloadingLogs(), 30000);
+
+    // Lost packets are only requested again, not the whole log
+    QVERIFY(_mockLink->logDownloadBytesServed() < fileSize * 2);
+    QVERIFY(UnitTest::fileCompare(_downloadFile(), _mockLink->logDownloadFile()));
+    QVERIFY(!QFile::exists(_downloadFile() + ".resume"));
+
+    _removeDownload();
+    delete controller;
+}
+
+void LogDownloadTest::resumeTest(void)
+{
+    const uint32_t fileSize = 1024 * 1024;
+
+    _removeDownload();
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(fileSize);
+    _mockLink->setLogDownloadLinkConditions(0, 2);
+
+    LogDownloadController* controller = new LogDownloadController();
+    QVERIFY(_refreshAndSelect(controller));
+
+    // Lose the vehicle part way through the download
+    controller->downloadToDirectory(QDir::currentPath());
+    QTRY_VERIFY_WITH_TIMEOUT(QFile::exists(_downloadFile() + ".resume"), 10000);
+    _disconnectMockLink();
+    QTRY_VERIFY_WITH_TIMEOUT(!controller->downloadingLogs(), 10000);
+    QVERIFY(QFile::exists(_downloadFile()));
+
+    // Download again from a new vehicle serving the same log
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(fileSize);
+    _mockLink->setLogDownloadLinkConditions(0, 10);
+    QVERIFY(_refreshAndSelect(controller));
+    controller->downloadToDirectory(QDir::currentPath());
+    QTRY_VERIFY_WITH_TIMEOUT(!controller->downloadingLogs(), 30000);
+
+    QVERIFY(_mockLink->logDownloadBytesServed() < fileSize);
+    QVERIFY(UnitTest::fileCompare(_downloadFile(), _mockLink->logDownloadFile()));
+    QVERIFY(!QFile::exists(_downloadFile() + ".resume"));
+
+    _removeDownload();
+    delete controller;
+}
+
+void LogDownloadTest::_benchmarkDownload_data(void)
+{
+    QTest::addColumn<int>("lossPercent");
+
+    QTest::newRow("no loss") <<     0;
+    QTest::newRow("5% loss") <<     5;
+    QTest::newRow("20% loss") <<    20;
+}
+
+void LogDownloadTest::_benchmarkDownload(void)
+{
+    QFETCH(int, lossPercent);
+
+    const uint32_t fileSize = 4 * 1024 * 1024;
+
+    _removeDownload();
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(fileSize);
+    _mockLink->setLogDownloadLinkConditions(lossPercent, 50);
+
+    LogDownloadController* controller = new LogDownloadController();
+    QVERIFY(_refreshAndSelect(controller));
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    controller->downloadToDirectory(QDir::currentPath());
+    QTRY_VERIFY_WITH_TIMEOUT(!controller->downloadingLogs(), 120000);
+    qint64 msecs = qMax<qint64>(elapsed.elapsed(), 1);
+
+    QVERIFY(UnitTest::fileCompare(_downloadFile(), _mockLink->logDownloadFile()));
+    QTest::setBenchmarkResult(fileSize * 1000.0 / msecs, QTest::BytesPerSecond);
+
+    _removeDownload();
+    delete controller;
+}
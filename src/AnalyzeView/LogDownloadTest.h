@@ -13,6 +13,8 @@
 #include "UnitTest.h"
 #include "MultiSignalSpy.h"
 
+class LogDownloadController;
+
 class LogDownloadTest : public UnitTest
 {
     Q_OBJECT
@@ -25,8 +27,16 @@ private slots:
     //void cleanup(void) { _cleanup(); }
 
     void downloadTest(void);
+    void lossyDownloadTest(void);
+    void resumeTest(void);
+    void _benchmarkDownload_data(void);
+    void _benchmarkDownload(void);
 
 private:
+    bool    _refreshAndSelect   (LogDownloadController* controller);
+    QString _downloadFile       (void);
+    void    _removeDownload     (void);
+
     // LogDownloadController signals
 
     enum {
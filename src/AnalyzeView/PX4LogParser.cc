@@ -13,7 +13,7 @@ PX4LogParser::~PX4LogParser()
 
 }
 
-bool PX4LogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+bool PX4LogParser::getTagsFromLog(const QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
 {
 
      // general message header
@@ -11,7 +11,7 @@ class PX4LogParser
 public:
     PX4LogParser();
     ~PX4LogParser();
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
+    bool getTagsFromLog(const QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
 
 private:
 
@@ -0,0 +1,373 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReader.h"
+
+#include <QtEndian>
+#include <QtNumeric>
+
+QGC_LOGGING_CATEGORY(ULogReaderLog, "ULogReaderLog")
+
+const char ULogReader::_fileMagic[] = { 'U', 'L', 'o', 'g', 0x01, 0x12, 0x35 };
+
+ULogReader::Message::Message(const uchar* data, int size, int timestampOffset)
+    : _data             (data)
+    , _size             (size)
+    , _timestampOffset  (timestampOffset)
+{
+
+}
+
+quint64 ULogReader::Message::timestamp(void) const
+{
+    if (_timestampOffset < 0 || _timestampOffset + static_cast<int>(sizeof(quint64)) > _size) {
+        return 0;
+    }
+    return qFromLittleEndian<quint64>(_data + _timestampOffset);
+}
+
+double ULogReader::Message::toDouble(const Field_t& field, int arrayIndex) const
+{
+    switch (field.type) {
+    case TypeInt8:
+        return value<qint8>(field, arrayIndex);
+    case TypeUInt8:
+    case TypeBool:
+    case TypeChar:
+        return value<quint8>(field, arrayIndex);
+    case TypeInt16:
+        return value<qint16>(field, arrayIndex);
+    case TypeUInt16:
+        return value<quint16>(field, arrayIndex);
+    case TypeInt32:
+        return value<qint32>(field, arrayIndex);
+    case TypeUInt32:
+        return value<quint32>(field, arrayIndex);
+    case TypeInt64:
+        return value<qint64>(field, arrayIndex);
+    case TypeUInt64:
+        return value<quint64>(field, arrayIndex);
+    case TypeFloat:
+        return value<float>(field, arrayIndex);
+    case TypeDouble:
+        return value<double>(field, arrayIndex);
+    case TypeUnknown:
+        break;
+    }
+    return qQNaN();
+}
+
+ULogReader::ULogReader()
+    : _data             (nullptr)
+    , _size             (0)
+    , _startTimestamp   (0)
+    , _dropoutCount     (0)
+{
+
+}
+
+ULogReader::~ULogReader()
+{
+    close();
+}
+
+void ULogReader::close(void)
+{
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    _file.close();
+    _size = 0;
+    _startTimestamp = 0;
+    _dropoutCount = 0;
+    _formats.clear();
+    _topics.clear();
+    _msgIdTopics.clear();
+}
+
+bool ULogReader::open(const QString& fileName, QString& errorString, const QStringList& topics)
+{
+    close();
+    errorString.clear();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        errorString = tr("Couldn't open log file: %1").arg(_file.errorString());
+        return false;
+    }
+    _size = _file.size();
+    if (_size < _fileHeaderSize) {
+        errorString = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+    _data = _file.map(0, _size);
+    if (!_data) {
+        errorString = tr("Couldn't map log file: %1").arg(_file.errorString());
+        close();
+        return false;
+    }
+    if (memcmp(_data, _fileMagic, sizeof(_fileMagic)) != 0) {
+        errorString = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+    _startTimestamp = qFromLittleEndian<quint64>(_data + 8);
+
+    _indexMessages(topics);
+
+    for (Topic_t& topic: _topics) {
+        const QString formatName = topic.name;
+        if (!_resolveFormat(formatName, 0)) {
+            qCWarning(ULogReaderLog) << "Could not resolve format" << formatName;
+            topic.timestampOffset = -1;
+            continue;
+        }
+        Field_t timestamp = _formats.constFind(formatName)->fields.value(QStringLiteral("timestamp"), { TypeUnknown, -1, 1 });
+        topic.timestampOffset = timestamp.type == TypeUInt64 ? timestamp.offset : -1;
+    }
+
+    qCDebug(ULogReaderLog) << "Indexed" << fileName << "topics:dropouts" << _topics.count() << _dropoutCount;
+    return true;
+}
+
+/// Single pass over all messages of the file. Only the message headers are touched apart from the definition
+/// messages, so this is bound by how fast the file can be paged in.
+void ULogReader::_indexMessages(const QStringList& topics)
+{
+    _msgIdTopics.fill(-1, std::numeric_limits<quint16>::max() + 1);
+
+    qint64 index = _fileHeaderSize;
+    while (index + _messageHeaderSize <= _size) {
+        quint16 msgSize =   qFromLittleEndian<quint16>(_data + index);
+        uchar   msgType =   _data[index + 2];
+        qint64  payload =   index + _messageHeaderSize;
+        qint64  nextIndex = payload + msgSize;
+        if (nextIndex > _size) {
+            qCWarning(ULogReaderLog) << "Log truncated at" << index;
+            break;
+        }
+        const char* payloadChars = reinterpret_cast<const char*>(_data + payload);
+
+        switch (msgType) {
+        case 'D':
+            if (msgSize >= sizeof(quint16)) {
+                int topic = _msgIdTopics[qFromLittleEndian<quint16>(_data + payload)];
+                if (topic != -1) {
+                    _topics[topic].offsets.append(payload + sizeof(quint16));
+                }
+            }
+            break;
+
+        case 'F':
+        {
+            // "name:type name;type name;..."
+            QString format = QString::fromLatin1(payloadChars, qstrnlen(payloadChars, msgSize));
+            int separator = format.indexOf(':');
+            if (separator > 0) {
+                Format_t& newFormat = _formats[format.left(separator)];
+                newFormat.definition = format.mid(separator + 1);
+                newFormat.resolved = false;
+                newFormat.size = 0;
+            }
+            break;
+        }
+
+        case 'A':
+            if (msgSize > 3) {
+                int     multiId =   _data[payload];
+                quint16 msgId =     qFromLittleEndian<quint16>(_data + payload + 1);
+                QString name =      QString::fromLatin1(payloadChars + 3, qstrnlen(payloadChars + 3, msgSize - 3));
+
+                _msgIdTopics[msgId] = -1;
+                if (topics.isEmpty() || topics.contains(name)) {
+                    int topic = topicIndex(name, multiId);
+                    if (topic == -1) {
+                        topic = _topics.count();
+                        _topics.append({ name, multiId, -1, QVector<qint64>() });
+                    }
+                    _msgIdTopics[msgId] = topic;
+                }
+            }
+            break;
+
+        case 'R':
+            if (msgSize >= sizeof(quint16)) {
+                _msgIdTopics[qFromLittleEndian<quint16>(_data + payload)] = -1;
+            }
+            break;
+
+        case 'O':
+            _dropoutCount++;
+            break;
+
+        default:
+            break;
+        }
+
+        index = nextIndex;
+    }
+}
+
+int ULogReader::_typeSize(const QString& typeName, FieldType& type)
+{
+    static const QHash<QString, QPair<FieldType, int>> types = {
+        { QStringLiteral("int8_t"),     { TypeInt8,     1 } },
+        { QStringLiteral("uint8_t"),    { TypeUInt8,    1 } },
+        { QStringLiteral("int16_t"),    { TypeInt16,    2 } },
+        { QStringLiteral("uint16_t"),   { TypeUInt16,   2 } },
+        { QStringLiteral("int32_t"),    { TypeInt32,    4 } },
+        { QStringLiteral("uint32_t"),   { TypeUInt32,   4 } },
+        { QStringLiteral("int64_t"),    { TypeInt64,    8 } },
+        { QStringLiteral("uint64_t"),   { TypeUInt64,   8 } },
+        { QStringLiteral("float"),      { TypeFloat,    4 } },
+        { QStringLiteral("double"),     { TypeDouble,   8 } },
+        { QStringLiteral("bool"),       { TypeBool,     1 } },
+        { QStringLiteral("char"),       { TypeChar,     1 } },
+    };
+
+    auto typeIter = types.constFind(typeName);
+    if (typeIter == types.constEnd()) {
+        type = TypeUnknown;
+        return 0;
+    }
+    type = typeIter->first;
+    return typeIter->second;
+}
+
+/// Lays out the fields of a format, flattening the fields of nested formats into it
+bool ULogReader::_resolveFormat(const QString& formatName, int depth)
+{
+    auto formatIter = _formats.find(formatName);
+    if (formatIter == _formats.end() || depth > _maxNestingDepth) {
+        return false;
+    }
+    if (formatIter->resolved) {
+        return true;
+    }
+
+    int         offset = 0;
+    QStringList definitions = formatIter->definition.split(';', QString::SkipEmptyParts);
+    for (const QString& definition: definitions) {
+        int separator = definition.lastIndexOf(' ');
+        if (separator == -1) {
+            return false;
+        }
+        QString typeName =  definition.left(separator).trimmed();
+        QString fieldName = definition.mid(separator + 1);
+
+        int arraySize = 1;
+        int arrayStart = typeName.indexOf('[');
+        if (arrayStart != -1) {
+            arraySize = typeName.midRef(arrayStart + 1, typeName.indexOf(']') - arrayStart - 1).toInt();
+            typeName = typeName.left(arrayStart);
+        }
+
+        FieldType   type;
+        int         typeSize = _typeSize(typeName, type);
+        if (typeSize == 0) {
+            // Nested format. Resolving it can not add formats, so formatIter stays valid.
+            if (!_resolveFormat(typeName, depth + 1)) {
+                return false;
+            }
+            const Format_t& nested = *_formats.constFind(typeName);
+            for (int i=0; i<arraySize; i++) {
+                QString prefix = arraySize > 1 ? QStringLiteral("%1[%2].").arg(fieldName).arg(i) : fieldName + '.';
+                for (const QString& nestedName: nested.fieldNames) {
+                    Field_t nestedField = nested.fields[nestedName];
+                    nestedField.offset += offset + (i * nested.size);
+                    formatIter->fields.insert(prefix + nestedName, nestedField);
+                    formatIter->fieldNames.append(prefix + nestedName);
+                }
+            }
+            typeSize = nested.size;
+        } else if (!fieldName.startsWith(QStringLiteral("_padding"))) {
+            formatIter->fields.insert(fieldName, { type, offset, arraySize });
+            formatIter->fieldNames.append(fieldName);
+        }
+        offset += typeSize * arraySize;
+    }
+
+    formatIter->size = offset;
+    formatIter->resolved = true;
+    return true;
+}
+
+QStringList ULogReader::topicNames(void) const
+{
+    QStringList names;
+    for (const Topic_t& topic: _topics) {
+        if (!names.contains(topic.name)) {
+            names.append(topic.name);
+        }
+    }
+    return names;
+}
+
+int ULogReader::topicIndex(const QString& name, int multiId) const
+{
+    for (int i=0; i<_topics.count(); i++) {
+        if (_topics[i].name == name && _topics[i].multiId == multiId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QStringList ULogReader::fieldNames(int topic) const
+{
+    return _formats.value(_topics[topic].name).fieldNames;
+}
+
+ULogReader::Field_t ULogReader::field(int topic, const QString& fieldName) const
+{
+    auto formatIter = _formats.constFind(_topics[topic].name);
+    if (formatIter == _formats.constEnd()) {
+        return { TypeUnknown, -1, 1 };
+    }
+    return formatIter->fields.value(fieldName, { TypeUnknown, -1, 1 });
+}
+
+ULogReader::Message ULogReader::message(int topic, int index) const
+{
+    const Topic_t&  topicInfo = _topics[topic];
+    qint64          offset =    topicInfo.offsets[index];
+
+    // The message header with the message size sits in front of the msg_id which precedes the data
+    int dataSize = qFromLittleEndian<quint16>(_data + offset - sizeof(quint16) - _messageHeaderSize) - static_cast<int>(sizeof(quint16));
+    return Message(_data + offset, dataSize, topicInfo.timestampOffset);
+}
+
+int ULogReader::findMessage(int topic, quint64 timestamp) const
+{
+    // Messages of a topic are logged in time order
+    int first = 0;
+    int last = messageCount(topic);
+    while (first < last) {
+        int middle = first + ((last - first) / 2);
+        if (message(topic, middle).timestamp() < timestamp) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+void ULogReader::forEachMessage(int topic, const std::function<bool(const Message&)>& callback, quint64 startTime, quint64 endTime) const
+{
+    int count = messageCount(topic);
+    for (int i=startTime > 0 ? findMessage(topic, startTime) : 0; i<count; i++) {
+        Message msg = message(topic, i);
+        if (msg.timestamp() >= endTime || !callback(msg)) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(ULogReaderLog)
+
+/// Reads ULog files without loading them into memory.
+///
+/// The file is memory mapped and open makes a single pass over it which records the file offset of every data message
+/// per topic. Messages are then read in place from the mapping. Field values are read through Field_t handles which
+/// are looked up by name once per topic, so iterating a topic costs no string handling and no copies of the messages.
+class ULogReader
+{
+    Q_DECLARE_TR_FUNCTIONS(ULogReader)
+
+public:
+    ULogReader();
+    ~ULogReader();
+
+    enum FieldType {
+        TypeUnknown,
+        TypeInt8,
+        TypeUInt8,
+        TypeInt16,
+        TypeUInt16,
+        TypeInt32,
+        TypeUInt32,
+        TypeInt64,
+        TypeUInt64,
+        TypeFloat,
+        TypeDouble,
+        TypeBool,
+        TypeChar,
+    };
+
+    /// Location of a field within the data of a topic message. Fields of nested types are flattened and named
+    /// "parent.child", or "parent[index].child" for arrays of nested types.
+    typedef struct {
+        FieldType   type;
+        int         offset;     ///< Offset from the start of the message data, -1 for a field which does not exist
+        int         arraySize;
+    } Field_t;
+
+    /// A single data message. Points into the mapped file so it is only valid while the reader is open.
+    class Message
+    {
+    public:
+        Message(const uchar* data, int size, int timestampOffset);
+
+        /// @return Message timestamp in microseconds, 0 if the topic has no timestamp field
+        quint64 timestamp(void) const;
+
+        const uchar*    data(void) const { return _data; }
+        int             size(void) const { return _size; }
+
+        /// Reads a field value as the type it is logged as. T must match the field type. Trailing padding is not
+        /// logged, so reads past the end of the message data return a default value.
+        template<typename T>
+        T value(const Field_t& field, int arrayIndex = 0) const
+        {
+            T   result = T();
+            int offset = field.offset + (arrayIndex * static_cast<int>(sizeof(T)));
+            if (field.offset >= 0 && arrayIndex >= 0 && arrayIndex < field.arraySize && offset + static_cast<int>(sizeof(T)) <= _size) {
+                memcpy(&result, _data + offset, sizeof(T));
+            }
+            return result;
+        }
+
+        /// Reads a numeric field value of any type converted to a double
+        double toDouble(const Field_t& field, int arrayIndex = 0) const;
+
+    private:
+        const uchar*    _data;
+        int             _size;
+        int             _timestampOffset;
+    };
+
+    /// Maps the file and builds the message index
+    ///     @param topics Only index the messages of these topics, all topics if empty
+    ///     @return false: failed, errorString set
+    bool open(const QString& fileName, QString& errorString, const QStringList& topics = QStringList());
+    void close(void);
+
+    bool    isOpen          (void) const { return _data != nullptr; }
+    quint64 startTimestamp  (void) const { return _startTimestamp; }
+    int     dropoutCount    (void) const { return _dropoutCount; }
+
+    int         topicCount      (void) const { return _topics.count(); }
+    QString     topicName       (int topic) const { return _topics[topic].name; }
+    int         topicMultiId    (int topic) const { return _topics[topic].multiId; }
+    QStringList topicNames      (void) const;
+
+    /// @return Index of the topic, -1 if the topic was not logged or not indexed
+    int topicIndex(const QString& name, int multiId = 0) const;
+
+    /// @return Field names of the topic in message order, padding excluded
+    QStringList fieldNames(int topic) const;
+
+    /// Looks up a field of a topic. The returned handle is used to read the field from any message of the topic.
+    Field_t field(int topic, const QString& fieldName) const;
+
+    int     messageCount    (int topic) const { return _topics[topic].offsets.count(); }
+    Message message         (int topic, int index) const;
+
+    /// @return Index of the first message of the topic at or after the timestamp, messageCount if there is none
+    int findMessage(int topic, quint64 timestamp) const;
+
+    /// Calls callback with each message of the topic in the time range [startTime, endTime) in order. Iteration stops
+    /// early if callback returns false.
+    void forEachMessage(int topic, const std::function<bool(const Message&)>& callback, quint64 startTime = 0, quint64 endTime = std::numeric_limits<quint64>::max()) const;
+
+private:
+    typedef struct {
+        QString                 definition;     ///< Field definitions from the format message, "type name;type name;..."
+        bool                    resolved;
+        int                     size;
+        QHash<QString, Field_t> fields;
+        QStringList             fieldNames;
+    } Format_t;
+
+    typedef struct {
+        QString         name;
+        int             multiId;
+        int             timestampOffset;
+        QVector<qint64> offsets;    ///< File offsets of the message data, which follows the message header and msg_id
+    } Topic_t;
+
+    void        _indexMessages      (const QStringList& topics);
+    bool        _resolveFormat      (const QString& formatName, int depth);
+    static int  _typeSize           (const QString& typeName, FieldType& type);
+
+    QFile               _file;
+    const uchar*        _data;
+    qint64              _size;
+    quint64             _startTimestamp;
+    int                 _dropoutCount;
+    QHash<QString, Format_t> _formats;
+    QVector<Topic_t>    _topics;
+    QVector<int>        _msgIdTopics;       ///< Maps a msg_id to its index in _topics, -1 for not indexed
+
+    static const int    _fileHeaderSize =       16;
+    static const int    _messageHeaderSize =    3;
+    static const int    _maxNestingDepth =      8;
+    static const char   _fileMagic[];
+};
@@ -0,0 +1,352 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReaderTest.h"
+#include "ULogReader.h"
+#include "ULogParser.h"
+
+#include <QFile>
+
+ULogReaderTest::ULogReaderTest(void)
+    : _tempDir(nullptr)
+{
+
+}
+
+void ULogReaderTest::init(void)
+{
+    UnitTest::init();
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+}
+
+void ULogReaderTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = nullptr;
+    UnitTest::cleanup();
+}
+
+void ULogReaderTest::_appendMessage(QByteArray& log, char type, const QByteArray& payload)
+{
+    _append<quint16>(log, static_cast<quint16>(payload.size()));
+    log.append(type);
+    log.append(payload);
+}
+
+void ULogReaderTest::_appendFormat(QByteArray& log, const char* format)
+{
+    _appendMessage(log, 'F', QByteArray(format));
+}
+
+void ULogReaderTest::_appendAddLogged(QByteArray& log, int multiId, quint16 msgId, const char* topic)
+{
+    QByteArray payload;
+    _append<quint8>(payload, static_cast<quint8>(multiId));
+    _append<quint16>(payload, msgId);
+    payload.append(topic);
+    _appendMessage(log, 'A', payload);
+}
+
+/// Writes a log with two instances of esc_status, which nests an array of motor, for every iteration and a
+/// camera_capture every _cameraInterval iterations
+QString ULogReaderTest::_writeLog(const QString& name, int iterationCount, int truncateBytes)
+{
+    QByteArray log("ULog\x01\x12\x35", 7);
+    _append<quint8>(log, 1);    // version
+    _append<quint64>(log, 0);   // start timestamp
+
+    _appendFormat(log, "motor:float rpm;uint8_t index;uint8_t[3] _padding0;");
+    _appendFormat(log, "esc_status:uint64_t timestamp;uint16_t count;uint8_t[6] _padding0;motor[2] esc;");
+    _appendFormat(log, "camera_capture:uint64_t timestamp;uint64_t timestamp_utc;double lat;double lon;float alt;float ground_distance;float[4] q;uint32_t seq;int8_t result;uint8_t[7] _padding0;");
+    _appendMessage(log, 'I', QByteArray("\x0b" "char[3] sys" "QGC", 15));
+    _appendAddLogged(log, 0, 0, "esc_status");
+    _appendAddLogged(log, 1, 1, "esc_status");
+    _appendAddLogged(log, 0, 2, "camera_capture");
+
+    for (int i=0; i<iterationCount; i++) {
+        quint64 timestamp = (i + 1) * _timestampStep;
+
+        for (int multiId=0; multiId<2; multiId++) {
+            QByteArray payload;
+            _append<quint16>(payload, static_cast<quint16>(multiId));
+            _append<quint64>(payload, timestamp);
+            _append<quint16>(payload, 2);
+            payload.append(6, '\0');
+            for (int motor=0; motor<2; motor++) {
+                _append<float>(payload, static_cast<float>((i * (motor + 1)) + (multiId * 1000)));
+                _append<quint8>(payload, static_cast<quint8>(motor));
+                payload.append(3, '\0');
+            }
+            _appendMessage(log, 'D', payload);
+        }
+
+        if (i % _cameraInterval == 0) {
+            QByteArray payload;
+            _append<quint16>(payload, 2);
+            _append<quint64>(payload, timestamp);
+            _append<quint64>(payload, timestamp + 1000000);
+            _append<double>(payload, 47.0 + (i * 1e-5));
+            _append<double>(payload, -122.0 - (i * 1e-5));
+            _append<float>(payload, 100.0f + i);
+            _append<float>(payload, 50.0f);
+            _append<float>(payload, 1.0f);
+            _append<float>(payload, 0.0f);
+            _append<float>(payload, 0.0f);
+            _append<float>(payload, 0.0f);
+            _append<quint32>(payload, static_cast<quint32>(i / _cameraInterval));
+            _append<qint8>(payload, 1);
+            // Trailing padding is not logged
+            _appendMessage(log, 'D', payload);
+        }
+
+        if (i == iterationCount / 2) {
+            QByteArray payload;
+            _append<quint16>(payload, 10);
+            _appendMessage(log, 'O', payload);
+        }
+    }
+    log.chop(truncateBytes);
+
+    QString filename = _tempDir->filePath(name);
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(log) != log.size()) {
+        return QString();
+    }
+    return filename;
+}
+
+void ULogReaderTest::_testIndex(void)
+{
+    const int iterationCount = 100;
+    QString filename = _writeLog("index.ulg", iterationCount);
+    QVERIFY(!filename.isEmpty());
+
+    ULogReader reader;
+    QString errorString;
+    QVERIFY2(reader.open(filename, errorString), qPrintable(errorString));
+    QVERIFY(reader.isOpen());
+    QCOMPARE(reader.topicCount(), 3);
+    QCOMPARE(reader.topicNames(), QStringList({ "esc_status", "camera_capture" }));
+    QCOMPARE(reader.dropoutCount(), 1);
+
+    int esc0 = reader.topicIndex("esc_status", 0);
+    int esc1 = reader.topicIndex("esc_status", 1);
+    int camera = reader.topicIndex("camera_capture");
+    QVERIFY(esc0 != -1 && esc1 != -1 && camera != -1);
+    QCOMPARE(reader.topicIndex("esc_status", 2), -1);
+    QCOMPARE(reader.topicIndex("vehicle_status"), -1);
+    QCOMPARE(reader.topicMultiId(esc1), 1);
+    QCOMPARE(reader.messageCount(esc0), iterationCount);
+    QCOMPARE(reader.messageCount(esc1), iterationCount);
+    QCOMPARE(reader.messageCount(camera), iterationCount / _cameraInterval);
+
+    ULogReader::Field_t count = reader.field(esc0, "count");
+    QCOMPARE(count.type, ULogReader::TypeUInt16);
+    QCOMPARE(count.offset, 8);
+    QCOMPARE(reader.field(esc0, "_padding0").offset, -1);
+    QCOMPARE(reader.field(esc0, "missing").offset, -1);
+
+    for (int i=0; i<iterationCount; i++) {
+        ULogReader::Message message = reader.message(esc1, i);
+        QCOMPARE(message.timestamp(), (i + 1) * _timestampStep);
+        QCOMPARE(message.value<quint16>(count), static_cast<quint16>(2));
+    }
+
+    reader.close();
+    QVERIFY(!reader.isOpen());
+    QCOMPARE(reader.topicCount(), 0);
+}
+
+void ULogReaderTest::_testNestedFields(void)
+{
+    QString filename = _writeLog("nested.ulg", 10);
+    QVERIFY(!filename.isEmpty());
+
+    ULogReader reader;
+    QString errorString;
+    QVERIFY2(reader.open(filename, errorString), qPrintable(errorString));
+
+    int esc1 = reader.topicIndex("esc_status", 1);
+    QCOMPARE(reader.fieldNames(esc1), QStringList({ "timestamp", "count", "esc[0].rpm", "esc[0].index", "esc[1].rpm", "esc[1].index" }));
+
+    ULogReader::Field_t rpm0 =   reader.field(esc1, "esc[0].rpm");
+    ULogReader::Field_t rpm1 =   reader.field(esc1, "esc[1].rpm");
+    ULogReader::Field_t index1 = reader.field(esc1, "esc[1].index");
+    QCOMPARE(rpm0.type, ULogReader::TypeFloat);
+    QCOMPARE(rpm0.offset, 16);
+    QCOMPARE(rpm1.offset, 24);
+    QCOMPARE(index1.offset, 28);
+
+    ULogReader::Message message = reader.message(esc1, 7);
+    QCOMPARE(message.value<float>(rpm0), 1007.0f);
+    QCOMPARE(message.value<float>(rpm1), 1014.0f);
+    QCOMPARE(message.value<quint8>(index1), static_cast<quint8>(1));
+    QCOMPARE(message.toDouble(rpm1), 1014.0);
+
+    // Array elements of a primitive type are read by index
+    int camera = reader.topicIndex("camera_capture");
+    ULogReader::Field_t q = reader.field(camera, "q");
+    QCOMPARE(q.arraySize, 4);
+    QCOMPARE(reader.message(camera, 0).value<float>(q, 0), 1.0f);
+    QCOMPARE(reader.message(camera, 0).value<float>(q, 3), 0.0f);
+    QCOMPARE(reader.message(camera, 0).value<float>(q, 4), 0.0f);
+}
+
+void ULogReaderTest::_testTimeRange(void)
+{
+    const int iterationCount = 1000;
+    QString filename = _writeLog("range.ulg", iterationCount);
+    QVERIFY(!filename.isEmpty());
+
+    ULogReader reader;
+    QString errorString;
+    QVERIFY2(reader.open(filename, errorString), qPrintable(errorString));
+    int esc0 = reader.topicIndex("esc_status");
+
+    QCOMPARE(reader.findMessage(esc0, 0), 0);
+    QCOMPARE(reader.findMessage(esc0, 100 * _timestampStep), 99);
+    QCOMPARE(reader.findMessage(esc0, (100 * _timestampStep) + 1), 100);
+    QCOMPARE(reader.findMessage(esc0, (iterationCount + 1) * _timestampStep), iterationCount);
+
+    QList<quint64> timestamps;
+    reader.forEachMessage(esc0, [&timestamps](const ULogReader::Message& message) {
+        timestamps.append(message.timestamp());
+        return true;
+    }, 200 * _timestampStep, 300 * _timestampStep);
+    QCOMPARE(timestamps.count(), 100);
+    QCOMPARE(timestamps.first(), 200 * _timestampStep);
+    QCOMPARE(timestamps.last(), 299 * _timestampStep);
+
+    // Returning false stops the iteration
+    int visitCount = 0;
+    reader.forEachMessage(esc0, [&visitCount](const ULogReader::Message&) {
+        return ++visitCount < 5;
+    });
+    QCOMPARE(visitCount, 5);
+}
+
+void ULogReaderTest::_testTopicFilter(void)
+{
+    const int iterationCount = 100;
+    QString filename = _writeLog("filter.ulg", iterationCount);
+    QVERIFY(!filename.isEmpty());
+
+    ULogReader reader;
+    QString errorString;
+    QVERIFY2(reader.open(filename, errorString, QStringList("camera_capture")), qPrintable(errorString));
+    QCOMPARE(reader.topicCount(), 1);
+    QCOMPARE(reader.topicIndex("esc_status"), -1);
+    QCOMPARE(reader.messageCount(reader.topicIndex("camera_capture")), iterationCount / _cameraInterval);
+}
+
+void ULogReaderTest::_testTruncated(void)
+{
+    // Cut into the last camera_capture message, which is the last message of iteration 90
+    const int iterationCount = 91;
+    QString filename = _writeLog("truncated.ulg", iterationCount, 5);
+    QVERIFY(!filename.isEmpty());
+
+    ULogReader reader;
+    QString errorString;
+    QVERIFY2(reader.open(filename, errorString), qPrintable(errorString));
+    QCOMPARE(reader.messageCount(reader.topicIndex("camera_capture")), (iterationCount / _cameraInterval));
+    QCOMPARE(reader.messageCount(reader.topicIndex("esc_status")), iterationCount);
+}
+
+void ULogReaderTest::_testBadMagic(void)
+{
+    QString filename = _tempDir->filePath("bad.ulg");
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(64, 'x'));
+    file.close();
+
+    ULogReader reader;
+    QString errorString;
+    QVERIFY(!reader.open(filename, errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!reader.isOpen());
+
+    QVERIFY(!reader.open(_tempDir->filePath("missing.ulg"), errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void ULogReaderTest::_testCameraCapture(void)
+{
+    const int iterationCount = 100;
+    QString filename = _writeLog("camera.ulg", iterationCount);
+    QVERIFY(!filename.isEmpty());
+
+    ULogReader reader;
+    QString errorString;
+    QVERIFY2(reader.open(filename, errorString, QStringList(ULogParser::cameraCaptureTopic)), qPrintable(errorString));
+
+    ULogParser parser;
+    QList<GeoTagWorker::cameraFeedbackPacket> cameraFeedback;
+    QVERIFY2(parser.getTagsFromLog(reader, cameraFeedback, errorString), qPrintable(errorString));
+    QCOMPARE(cameraFeedback.count(), iterationCount / _cameraInterval);
+
+    for (int i=0; i<cameraFeedback.count(); i++) {
+        const GeoTagWorker::cameraFeedbackPacket& feedback = cameraFeedback[i];
+        int iteration = i * _cameraInterval;
+        QCOMPARE(feedback.timestamp, ((iteration + 1) * _timestampStep) / 1.0e6);
+        QCOMPARE(feedback.imageSequence, static_cast<uint32_t>(i));
+        QCOMPARE(feedback.latitude, 47.0 + (iteration * 1e-5));
+        QVERIFY(qAbs(feedback.longitude - (-122.0 - (iteration * 1e-5))) < 1e-9);
+        QCOMPARE(feedback.altitude, 100.0f + iteration);
+        QCOMPARE(feedback.groundDistance, 50.0f);
+        QCOMPARE(feedback.attitudeQuaternion[0], 1.0f);
+        QCOMPARE(feedback.captureResult, static_cast<uint8_t>(1));
+    }
+
+    // A log without camera_capture messages fails
+    QVERIFY2(reader.open(filename, errorString, QStringList("esc_status")), qPrintable(errorString));
+    cameraFeedback.clear();
+    QVERIFY(!parser.getTagsFromLog(reader, cameraFeedback, errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void ULogReaderTest::_benchmarkIndex_data(void)
+{
+    QTest::addColumn<int>("iterationCount");
+    QTest::addColumn<bool>("filtered");
+
+    QTest::newRow("100k all topics") <<     100000 <<   false;
+    QTest::newRow("100k camera only") <<    100000 <<   true;
+    QTest::newRow("1M all topics") <<       1000000 <<  false;
+    QTest::newRow("1M camera only") <<      1000000 <<  true;
+}
+
+void ULogReaderTest::_benchmarkIndex(void)
+{
+    QFETCH(int, iterationCount);
+    QFETCH(bool, filtered);
+
+    // 1M iterations is a log of about 110MB
+    QString filename = _writeLog("benchmark.ulg", iterationCount);
+    QVERIFY(!filename.isEmpty());
+
+    QStringList topics;
+    if (filtered) {
+        topics.append(ULogParser::cameraCaptureTopic);
+    }
+
+    int feedbackCount = 0;
+    QBENCHMARK {
+        ULogReader reader;
+        ULogParser parser;
+        QString errorString;
+        QList<GeoTagWorker::cameraFeedbackPacket> cameraFeedback;
+        QVERIFY(reader.open(filename, errorString, topics));
+        QVERIFY(parser.getTagsFromLog(reader, cameraFeedback, errorString));
+        feedbackCount = cameraFeedback.count();
+    }
+    QCOMPARE(feedbackCount, iterationCount / _cameraInterval);
+}
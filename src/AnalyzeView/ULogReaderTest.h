@@ -0,0 +1,55 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for ULogReader and the ULog geotagging parser built on it
+class ULogReaderTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ULogReaderTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _testIndex(void);
+    void _testNestedFields(void);
+    void _testTimeRange(void);
+    void _testTopicFilter(void);
+    void _testTruncated(void);
+    void _testBadMagic(void);
+    void _testCameraCapture(void);
+    void _benchmarkIndex_data(void);
+    void _benchmarkIndex(void);
+
+private:
+    QString _writeLog       (const QString& name, int iterationCount, int truncateBytes = 0);
+    void    _appendMessage  (QByteArray& log, char type, const QByteArray& payload);
+    void    _appendFormat   (QByteArray& log, const char* format);
+    void    _appendAddLogged(QByteArray& log, int multiId, quint16 msgId, const char* topic);
+
+    template<typename T>
+    void _append(QByteArray& bytes, T value)
+    {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    QTemporaryDir* _tempDir;
+
+    static const quint64    _timestampStep = 1000;
+    static const int        _cameraInterval = 10;
+};
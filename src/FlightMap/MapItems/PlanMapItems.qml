@@ -29,7 +29,7 @@ Item {
     property var    _missionController:         masterController.missionController
     property var    _geoFenceController:        masterController.geoFenceController
     property var    _rallyPointController:      masterController.rallyPointController
-    property var    _missionLineViewComponent
+    property var    _missionPathPolyline
 
     // Add the mission item visuals to the map
     Repeater {
@@ -46,25 +46,54 @@ Item {
         }
     }
 
+    // Add the mission path to the map. The polyline keeps its own copy of the path and applies the model's
+    // row changes point by point, so moving an item only replaces that item's point.
     Component.onCompleted: {
-        _missionLineViewComponent = missionLineViewComponent.createObject(map)
-        if (_missionLineViewComponent.status === Component.Error)
-            console.log(_missionLineViewComponent.errorString())
-        map.addMapItem(_missionLineViewComponent)
+        _missionPathPolyline = missionPathComponent.createObject(map)
+        if (_missionPathPolyline.status === Component.Error)
+            console.log(_missionPathPolyline.errorString())
+        map.addMapItem(_missionPathPolyline)
     }
 
     Component.onDestruction: {
-        _missionLineViewComponent.destroy()
+        _missionPathPolyline.destroy()
     }
 
     Component {
-        id: missionLineViewComponent
+        id: missionPathComponent
 
         MapPolyline {
+            id:         missionPathPolyline
             line.width: 3
             line.color: "#be781c"                           // Hack, can't get palette to work in here
             z:          QGroundControl.zOrderWaypointLines
-            path:       _missionController.waypointPath
+            // MapPolyline does not remove the line from the map when its path goes empty
+            visible:    _pathModel.count > 1
+
+            property var _pathModel: _missionController.waypointPath
+
+            on_PathModelChanged: path = _pathModel.path()
+
+            Connections {
+                target: missionPathPolyline._pathModel
+
+                onDataChanged: {
+                    for (var i = topLeft.row; i <= bottomRight.row; i++) {
+                        missionPathPolyline.replaceCoordinate(i, target.coordinateAt(i))
+                    }
+                }
+                onRowsInserted: {
+                    for (var i = first; i <= last; i++) {
+                        missionPathPolyline.insertCoordinate(i, target.coordinateAt(i))
+                    }
+                }
+                onRowsRemoved: {
+                    for (var i = first; i <= last; i++) {
+                        missionPathPolyline.removeCoordinate(first)
+                    }
+                }
+                onModelReset: missionPathPolyline.path = target.path()
+            }
         }
     }
 }
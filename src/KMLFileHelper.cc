@@ -11,50 +11,188 @@
 
 #include <QFile>
 #include <QVariant>
+#include <QXmlStreamReader>
+
+#include <algorithm>
 
 const char* KMLFileHelper::_errorPrefix = QT_TR_NOOP("KML file load failed. %1");
 
-QDomDocument KMLFileHelper::_loadFile(const QString& kmlFile, QString& errorString)
+/// Streams through the KML file. When loading coordinates reading always runs to the end so that malformed xml is
+/// reported no matter where in the file it is.
+///     @param coordsShapeType Polygon: collect the outer boundary of the first Polygon, Polyline: collect the first
+///                             LineString, Error: only look for which shape types are present. This stops at the
+///                             first Polygon since that takes precedence over any LineString.
+///     @param result[out] Shape types found and collected coordinates
+/// @return false: file could not be read or parsed, errorString is set
+bool KMLFileHelper::_scanFile(const QString& kmlFile, ShapeFileHelper::ShapeType coordsShapeType, ScanResult_t& result, QString& errorString, const ShapeFileHelper::ProgressCallback& progress)
 {
     QFile file(kmlFile);
 
     errorString.clear();
+    result.polygonFound =       false;
+    result.polylineFound =      false;
+    result.coordinatesFound =   false;
+    result.coords.clear();
 
     if (!file.exists()) {
         errorString = QString(_errorPrefix).arg(tr("File not found: %1").arg(kmlFile));
-        return QDomDocument();
+        return false;
     }
 
     if (!file.open(QIODevice::ReadOnly)) {
         errorString = QString(_errorPrefix).arg(tr("Unable to open file: %1 error: $%2").arg(kmlFile).arg(file.errorString()));
-        return QDomDocument();
+        return false;
+    }
+
+    const QString   shapeElementName =  coordsShapeType == ShapeFileHelper::Polygon ? QStringLiteral("Polygon") : QStringLiteral("LineString");
+    qint64          fileSize =          file.size();
+    QStringList     elementPath;
+    int             shapeDepth =        -1;     // Depth of the first shape element of the requested type, -2 once it is closed
+    bool            collecting =        false;
+    bool            coordinatesValid =  true;
+    QString         pendingTuple;
+    QXmlStreamReader xml(&file);
+
+    while (!xml.atEnd()) {
+        switch (xml.readNext()) {
+        case QXmlStreamReader::StartElement:
+            elementPath.append(xml.name().toString());
+            if (xml.name() == QLatin1String("Polygon")) {
+                result.polygonFound = true;
+                if (coordsShapeType == ShapeFileHelper::Error) {
+                    return true;
+                }
+            } else if (xml.name() == QLatin1String("LineString")) {
+                result.polylineFound = true;
+            }
+            if (coordsShapeType != ShapeFileHelper::Error) {
+                if (shapeDepth == -1 && xml.name() == shapeElementName) {
+                    shapeDepth = elementPath.count() - 1;
+                } else if (shapeDepth >= 0 && !result.coordinatesFound && _isCoordinatesPath(elementPath, shapeDepth, coordsShapeType)) {
+                    collecting = true;
+                }
+            }
+            break;
+        case QXmlStreamReader::EndElement:
+            if (collecting) {
+                collecting = false;
+                result.coordinatesFound = true;
+                if (!pendingTuple.isEmpty()) {
+                    coordinatesValid &= _parseCoordinateTuple(pendingTuple, result.coords);
+                    pendingTuple.clear();
+                }
+            }
+            if (shapeDepth == elementPath.count() - 1) {
+                shapeDepth = -2;
+            }
+            elementPath.removeLast();
+            break;
+        case QXmlStreamReader::Characters:
+            if (collecting) {
+                coordinatesValid &= _parseCoordinateText(xml.text(), pendingTuple, result.coords);
+                if (progress && fileSize > 0) {
+                    progress(static_cast<double>(file.pos()) / fileSize);
+                }
+            }
+            break;
+        default:
+            break;
+        }
     }
 
-    QDomDocument doc;
-    QString errorMessage;
-    int errorLine;
-    if (!doc.setContent(&file, &errorMessage, &errorLine)) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(errorMessage).arg(errorLine));
-        return QDomDocument();
+    if (xml.hasError()) {
+        errorString = QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(xml.errorString()).arg(xml.lineNumber()));
+        return false;
+    }
+    if (!coordinatesValid) {
+        errorString = QString(_errorPrefix).arg(tr("Unable to parse coordinates in KML file: %1").arg(kmlFile));
+        return false;
     }
 
-    return doc;
+    if (progress) {
+        progress(1.0);
+    }
+
+    return true;
+}
+
+/// @return true: elementPath is the coordinates element of the shape which starts at shapeDepth
+bool KMLFileHelper::_isCoordinatesPath(const QStringList& elementPath, int shapeDepth, ShapeFileHelper::ShapeType shapeType)
+{
+    if (elementPath.last() != QLatin1String("coordinates")) {
+        return false;
+    }
+    if (shapeType == ShapeFileHelper::Polygon) {
+        return elementPath.count() == shapeDepth + 4 &&
+                elementPath[shapeDepth + 1] == QLatin1String("outerBoundaryIs") &&
+                elementPath[shapeDepth + 2] == QLatin1String("LinearRing");
+    } else {
+        return elementPath.count() == shapeDepth + 2;
+    }
+}
+
+/// Parses the next chunk of coordinates element text. A tuple may be split across chunks, the unfinished part is
+/// carried over in pendingTuple.
+/// @return false: a malformed tuple was found
+bool KMLFileHelper::_parseCoordinateText(const QStringRef& text, QString& pendingTuple, QList<QGeoCoordinate>& coords)
+{
+    bool valid = true;
+    int tupleStart = -1;
+
+    for (int i=0; i<text.length(); i++) {
+        if (text.at(i).isSpace()) {
+            if (tupleStart != -1) {
+                pendingTuple.append(text.mid(tupleStart, i - tupleStart));
+                tupleStart = -1;
+            }
+            if (!pendingTuple.isEmpty()) {
+                valid &= _parseCoordinateTuple(pendingTuple, coords);
+                pendingTuple.clear();
+            }
+        } else if (tupleStart == -1) {
+            tupleStart = i;
+        }
+    }
+    if (tupleStart != -1) {
+        pendingTuple.append(text.mid(tupleStart));
+    }
+
+    return valid;
+}
+
+/// Parses a single "lon,lat[,alt]" tuple
+bool KMLFileHelper::_parseCoordinateTuple(const QString& tuple, QList<QGeoCoordinate>& coords)
+{
+    int lonEnd = tuple.indexOf(QLatin1Char(','));
+    if (lonEnd == -1) {
+        return false;
+    }
+    int latEnd = tuple.indexOf(QLatin1Char(','), lonEnd + 1);
+
+    bool lonOk, latOk;
+    QGeoCoordinate coord;
+    coord.setLongitude(tuple.leftRef(lonEnd).toDouble(&lonOk));
+    coord.setLatitude(tuple.midRef(lonEnd + 1, latEnd == -1 ? -1 : latEnd - lonEnd - 1).toDouble(&latOk));
+    if (!lonOk || !latOk) {
+        return false;
+    }
+
+    coords.append(coord);
+    return true;
 }
 
 ShapeFileHelper::ShapeType KMLFileHelper::determineShapeType(const QString& kmlFile, QString& errorString)
 {
-    QDomDocument domDocument = KMLFileHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    ScanResult_t result;
+    if (!_scanFile(kmlFile, ShapeFileHelper::Error, result, errorString, ShapeFileHelper::ProgressCallback())) {
         return ShapeFileHelper::Error;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("Polygon");
-    if (rgNodes.count()) {
+    if (result.polygonFound) {
         return ShapeFileHelper::Polygon;
     }
 
-    rgNodes = domDocument.elementsByTagName("LineString");
-    if (rgNodes.count()) {
+    if (result.polylineFound) {
         return ShapeFileHelper::Polyline;
     }
 
@@ -62,60 +200,43 @@ ShapeFileHelper::ShapeType KMLFileHelper::determineShapeType(const QString& kmlF
     return ShapeFileHelper::Error;
 }
 
-bool KMLFileHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString)
+bool KMLFileHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString, const ShapeFileHelper::ProgressCallback& progress)
 {
     errorString.clear();
     vertices.clear();
 
-    QDomDocument domDocument = KMLFileHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    ScanResult_t result;
+    if (!_scanFile(kmlFile, ShapeFileHelper::Polygon, result, errorString, progress)) {
         return false;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("Polygon");
-    if (rgNodes.count() == 0) {
+    if (!result.polygonFound) {
         errorString = QString(_errorPrefix).arg(tr("Unable to find Polygon node in KML"));
         return false;
     }
 
-    QDomNode coordinatesNode = rgNodes.item(0).namedItem("outerBoundaryIs").namedItem("LinearRing").namedItem("coordinates");
-    if (coordinatesNode.isNull()) {
+    if (!result.coordinatesFound) {
         errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
         return false;
     }
 
-    QString coordinatesString = coordinatesNode.toElement().text().simplified();
-    QStringList rgCoordinateStrings = coordinatesString.split(" ");
-
-    QList<QGeoCoordinate> rgCoords;
-    for (int i=0; i<rgCoordinateStrings.count()-1; i++) {
-        QString coordinateString = rgCoordinateStrings[i];
-
-        QStringList rgValueStrings = coordinateString.split(",");
-
-        QGeoCoordinate coord;
-        coord.setLongitude(rgValueStrings[0].toDouble());
-        coord.setLatitude(rgValueStrings[1].toDouble());
-
-        rgCoords.append(coord);
+    // The last coordinate closes the ring
+    QList<QGeoCoordinate>& rgCoords = result.coords;
+    if (!rgCoords.isEmpty()) {
+        rgCoords.removeLast();
     }
 
     // Determine winding, reverse if needed. QGC wants clockwise winding
     double sum = 0;
     for (int i=0; i<rgCoords.count(); i++) {
-        QGeoCoordinate coord1 = rgCoords[i];
-        QGeoCoordinate coord2 = (i == rgCoords.count() - 1) ? rgCoords[0] : rgCoords[i+1];
+        const QGeoCoordinate& coord1 = rgCoords[i];
+        const QGeoCoordinate& coord2 = (i == rgCoords.count() - 1) ? rgCoords[0] : rgCoords[i+1];
 
         sum += (coord2.longitude() - coord1.longitude()) * (coord2.latitude() + coord1.latitude());
     }
     bool reverse = sum < 0.0;
     if (reverse) {
-        QList<QGeoCoordinate> rgReversed;
-
-        for (int i=0; i<rgCoords.count(); i++) {
-            rgReversed.prepend(rgCoords[i]);
-        }
-        rgCoords = rgReversed;
+        std::reverse(rgCoords.begin(), rgCoords.end());
     }
 
     vertices = rgCoords;
@@ -123,45 +244,27 @@ bool KMLFileHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordi
     return true;
 }
 
-bool KMLFileHelper::loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString)
+bool KMLFileHelper::loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString, const ShapeFileHelper::ProgressCallback& progress)
 {
     errorString.clear();
     coords.clear();
 
-    QDomDocument domDocument = KMLFileHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    ScanResult_t result;
+    if (!_scanFile(kmlFile, ShapeFileHelper::Polyline, result, errorString, progress)) {
         return false;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("LineString");
-    if (rgNodes.count() == 0) {
+    if (!result.polylineFound) {
         errorString = QString(_errorPrefix).arg(tr("Unable to find LineString node in KML"));
         return false;
     }
 
-    QDomNode coordinatesNode = rgNodes.item(0).namedItem("coordinates");
-    if (coordinatesNode.isNull()) {
+    if (!result.coordinatesFound) {
         errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
         return false;
     }
 
-    QString coordinatesString = coordinatesNode.toElement().text().simplified();
-    QStringList rgCoordinateStrings = coordinatesString.split(" ");
-
-    QList<QGeoCoordinate> rgCoords;
-    for (int i=0; i<rgCoordinateStrings.count()-1; i++) {
-        QString coordinateString = rgCoordinateStrings[i];
-
-        QStringList rgValueStrings = coordinateString.split(",");
-
-        QGeoCoordinate coord;
-        coord.setLongitude(rgValueStrings[0].toDouble());
-        coord.setLatitude(rgValueStrings[1].toDouble());
-
-        rgCoords.append(coord);
-    }
-
-    coords = rgCoords;
+    coords = result.coords;
 
     return true;
 }
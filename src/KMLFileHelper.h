@@ -10,23 +10,36 @@
 #pragma once
 
 #include <QObject>
-#include <QDomDocument>
 #include <QList>
 #include <QGeoCoordinate>
+#include <QStringList>
+#include <QStringRef>
 
 #include "ShapeFileHelper.h"
 
+/// Loads shapes from KML files. Files are streamed with QXmlStreamReader so only the coordinates of the requested
+/// shape are held in memory, not a DOM of the whole document. All methods are safe to call from a worker thread.
 class KMLFileHelper : public QObject
 {
     Q_OBJECT
 
 public:
     static ShapeFileHelper::ShapeType determineShapeType(const QString& kmlFile, QString& errorString);
-    static bool loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString);
-    static bool loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString);
+    static bool loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString, const ShapeFileHelper::ProgressCallback& progress = ShapeFileHelper::ProgressCallback());
+    static bool loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString, const ShapeFileHelper::ProgressCallback& progress = ShapeFileHelper::ProgressCallback());
 
 private:
-    static QDomDocument _loadFile(const QString& kmlFile, QString& errorString);
+    typedef struct {
+        bool                    polygonFound;
+        bool                    polylineFound;
+        bool                    coordinatesFound;
+        QList<QGeoCoordinate>   coords;
+    } ScanResult_t;
+
+    static bool _scanFile           (const QString& kmlFile, ShapeFileHelper::ShapeType coordsShapeType, ScanResult_t& result, QString& errorString, const ShapeFileHelper::ProgressCallback& progress);
+    static bool _isCoordinatesPath  (const QStringList& elementPath, int shapeDepth, ShapeFileHelper::ShapeType shapeType);
+    static bool _parseCoordinateText(const QStringRef& text, QString& pendingTuple, QList<QGeoCoordinate>& coords);
+    static bool _parseCoordinateTuple(const QString& tuple, QList<QGeoCoordinate>& coords);
 
     static const char* _errorPrefix;
 };
@@ -52,12 +52,22 @@ CorridorScanComplexItem::CorridorScanComplexItem(Vehicle* vehicle, bool flyView,
     connect(&_corridorWidthFact,    &Fact::valueChanged,            this, &CorridorScanComplexItem::_rebuildCorridorPolygon);
 
     if (!kmlFile.isEmpty()) {
-        _corridorPolyline.loadKMLFile(kmlFile);
-        _corridorPolyline.setDirty(false);
+        // The shape only arrives once the background load completes, the item starts out clean from there
+        connect(&_corridorPolyline, &QGCMapPolyline::loadingChanged, this, &CorridorScanComplexItem::_shapeFileLoadingChanged);
+        _corridorPolyline.loadKMLFileInBackground(kmlFile);
     }
     setDirty(false);
 }
 
+void CorridorScanComplexItem::_shapeFileLoadingChanged(bool loading)
+{
+    if (!loading) {
+        disconnect(&_corridorPolyline, &QGCMapPolyline::loadingChanged, this, &CorridorScanComplexItem::_shapeFileLoadingChanged);
+        _corridorPolyline.setDirty(false);
+        setDirty(false);
+    }
+}
+
 void CorridorScanComplexItem::save(QJsonArray&  planItems)
 {
     QJsonObject saveObject;
@@ -325,29 +335,31 @@ void CorridorScanComplexItem::_rebuildCorridorPolygon(void)
     _surveyAreaPolygon.appendVertices(rgCoord);
 }
 
-void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
+TransectStyleComplexItem::TransectBuilder CorridorScanComplexItem::_transectBuilder(void)
 {
-    if (_ignoreRecalc) {
-        return;
-    }
-
-    // If the transects are getting rebuilt then any previsouly loaded mission items are now invalid
-    if (_loadedMissionItemsParent) {
-        _loadedMissionItems.clear();
-        _loadedMissionItemsParent->deleteLater();
-        _loadedMissionItemsParent = NULL;
-    }
+    TransectParams_t params;
+    params.corridorPolyline =   _corridorPolyline.coordinateList();
+    params.transectSpacing =    _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    params.corridorWidth =      _corridorWidthFact.rawValue().toDouble();
+    params.transectCount =      _transectCount();
+    params.entryPoint =         _entryPoint;
+    params.turnAroundDistance = _hasTurnaround() ? _turnAroundDistanceFact.rawValue().toDouble() : 0;
+
+    return [params]() { return _buildTransects(params); };
+}
 
-    _transects.clear();
-    _transectsPathHeightInfo.clear();
+/// Runs on a worker thread, only uses the params snapshot
+QList<QList<TransectStyleComplexItem::CoordInfo_t>> CorridorScanComplexItem::_buildTransects(const TransectParams_t& params)
+{
+    QList<QList<TransectStyleComplexItem::CoordInfo_t>> transects;
 
-    double transectSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
-    double fullWidth = _corridorWidthFact.rawValue().toDouble();
+    double transectSpacing = params.transectSpacing;
+    double fullWidth = params.corridorWidth;
     double halfWidth = fullWidth / 2.0;
-    int transectCount = _transectCount();
+    int transectCount = params.transectCount;
     double normalizedTransectPosition = transectSpacing / 2.0;
 
-    if (_corridorPolyline.count() >= 2) {
+    if (params.corridorPolyline.count() >= 2) {
         // First build up the transects all going the same direction
         //qDebug() << "_rebuildTransectsPhase1";
         for (int i=0; i<transectCount; i++) {
@@ -363,7 +375,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
 
             // Turn transect into CoordInfo transect
             QList<TransectStyleComplexItem::CoordInfo_t> transect;
-            QList<QGeoCoordinate> transectCoords = _corridorPolyline.offsetPolyline(offsetDistance);
+            QList<QGeoCoordinate> transectCoords = QGCMapPolyline::offsetPolyline(params.corridorPolyline, offsetDistance);
             for (int j=1; j<transectCoords.count() - 1; j++) {
                 TransectStyleComplexItem::CoordInfo_t coordInfo = { transectCoords[j], CoordTypeInterior };
                 transect.append(coordInfo);
@@ -374,9 +386,9 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             transect.append(coordInfo);
 
             // Extend the transect ends for turnaround
-            if (_hasTurnaround()) {
+            if (params.turnAroundDistance > 0) {
                  QGeoCoordinate turnaroundCoord;
-                 double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+                 double turnAroundDistance = params.turnAroundDistance;
 
                  double azimuth = transectCoords[0].azimuthTo(transectCoords[1]);
                  turnaroundCoord = transectCoords[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -398,7 +410,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             }
 #endif
 
-            _transects.append(transect);
+            transects.append(transect);
             normalizedTransectPosition += transectSpacing;
         }
 
@@ -410,7 +422,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
 
         bool reverseTransects = false;
         bool reverseVertices = false;
-        switch (_entryPoint) {
+        switch (params.entryPoint) {
         case 0:
             reverseTransects = false;
             reverseVertices = false;
@@ -430,26 +442,26 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
         }
         if (reverseTransects) {
             QList<QList<TransectStyleComplexItem::CoordInfo_t>> reversedTransects;
-            for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: _transects) {
+            for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: transects) {
                 reversedTransects.prepend(transect);
             }
-            _transects = reversedTransects;
+            transects = reversedTransects;
         }
         if (reverseVertices) {
-            for (int i=0; i<_transects.count(); i++) {
+            for (int i=0; i<transects.count(); i++) {
                 QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
-                for (const TransectStyleComplexItem::CoordInfo_t& vertex: _transects[i]) {
+                for (const TransectStyleComplexItem::CoordInfo_t& vertex: transects[i]) {
                     reversedVertices.prepend(vertex);
                 }
-                _transects[i] = reversedVertices;
+                transects[i] = reversedVertices;
             }
         }
 
         // Adjust to lawnmower pattern
         reverseVertices = false;
-        for (int i=0; i<_transects.count(); i++) {
+        for (int i=0; i<transects.count(); i++) {
             // We must reverse the vertices for every other transect in order to make a lawnmower pattern
-            QList<TransectStyleComplexItem::CoordInfo_t> transectVertices = _transects[i];
+            QList<TransectStyleComplexItem::CoordInfo_t> transectVertices = transects[i];
             if (reverseVertices) {
                 reverseVertices = false;
                 QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
@@ -460,9 +472,11 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             } else {
                 reverseVertices = true;
             }
-            _transects[i] = transectVertices;
+            transects[i] = transectVertices;
         }
     }
+
+    return transects;
 }
 
 void CorridorScanComplexItem::_recalcComplexDistance(void)
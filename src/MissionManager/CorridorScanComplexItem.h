@@ -61,14 +61,29 @@ public:
 
 private slots:
     void _polylineDirtyChanged      (bool dirty);
+    void _shapeFileLoadingChanged   (bool loading);
     void _rebuildCorridorPolygon    (void);
 
     // Overrides from TransectStyleComplexItem
-    void _rebuildTransectsPhase1    (void) final;
     void _recalcComplexDistance     (void) final;
     void _recalcCameraShots         (void) final;
 
 private:
+    /// Everything transect generation reads from the item, captured so it can run off the main thread
+    typedef struct {
+        QList<QGeoCoordinate>   corridorPolyline;
+        double                  transectSpacing;
+        double                  corridorWidth;
+        int                     transectCount;
+        int                     entryPoint;
+        double                  turnAroundDistance;
+    } TransectParams_t;
+
+    // Overrides from TransectStyleComplexItem
+    TransectBuilder _transectBuilder(void) final;
+
+    static QList<QList<CoordInfo_t>> _buildTransects(const TransectParams_t& params);
+
     int _transectCount              (void) const;
     void _buildAndAppendMissionItems(QList<MissionItem*>& items, QObject* missionItemParent);
     void _appendLoadedMissionItems  (QList<MissionItem*>& items, QObject* missionItemParent);
@@ -20,6 +20,8 @@
 #include "JsonHelper.h"
 #include "QGCQGeoCoordinate.h"
 #include "AppSettings.h"
+#include "FlyViewSettings.h"
+#include "SettingsManager.h"
 #include "PlanMasterController.h"
 
 #include <QJsonDocument>
@@ -40,6 +42,7 @@ GeoFenceController::GeoFenceController(PlanMasterController* masterController, Q
     , _dirty                    (false)
     , _itemsRequested           (false)
     , _px4ParamCircularFenceFact(NULL)
+    , _fenceMonitor             (NULL)
 {
     connect(&_polygons, &QmlObjectListModel::countChanged, this, &GeoFenceController::_updateContainsItems);
     connect(&_circles,  &QmlObjectListModel::countChanged, this, &GeoFenceController::_updateContainsItems);
@@ -58,6 +61,16 @@ void GeoFenceController::start(bool flyView)
 
     PlanElementController::start(flyView);
     _init();
+
+    // The Fly view checks all vehicles against the fence it is showing. This is done by a separate object since the
+    // connections to the manager vehicle are dropped on managerVehicleChanged.
+    if (flyView && !_fenceMonitor) {
+        Fact* warningDistanceFact = qgcApp()->toolbox()->settingsManager()->flyViewSettings()->geoFenceWarningDistance();
+        _fenceMonitor = new GeoFenceMonitor(qgcApp()->toolbox()->multiVehicleManager(), warningDistanceFact->rawValue().toDouble(), this);
+        connect(_fenceMonitor,          &GeoFenceMonitor::fenceStateChanged,    this, &GeoFenceController::_fenceStateChanged);
+        connect(warningDistanceFact,    &Fact::rawValueChanged,                 this, &GeoFenceController::_fenceWarningDistanceChanged);
+        _updateFenceMonitor();
+    }
 }
 
 void GeoFenceController::_init(void)
@@ -200,6 +213,7 @@ void GeoFenceController::removeAll(void)
     setBreachReturnPoint(QGeoCoordinate());
     _polygons.clearAndDeleteContents();
     _circles.clearAndDeleteContents();
+    _updateFenceMonitor();
 }
 
 void GeoFenceController::removeAllFromVehicle(void)
@@ -294,6 +308,35 @@ void GeoFenceController::_setFenceFromManager(const QList<QGCFencePolygon>& poly
     }
 
     setDirty(false);
+    _updateFenceMonitor();
+}
+
+void GeoFenceController::_updateFenceMonitor(void)
+{
+    if (_fenceMonitor) {
+        _fenceMonitor->setFences(&_polygons, &_circles);
+    }
+}
+
+void GeoFenceController::_fenceStateChanged(Vehicle* vehicle, int state, double distance)
+{
+    switch (state) {
+    case GeoFenceEvaluator::FenceWarning:
+        qgcApp()->showMessage(tr("Vehicle %1 is %2 m from a GeoFence boundary").arg(vehicle->id()).arg(qRound(distance)));
+        break;
+    case GeoFenceEvaluator::FenceBreach:
+        qgcApp()->showMessage(tr("Vehicle %1 has breached a GeoFence").arg(vehicle->id()));
+        break;
+    default:
+        break;
+    }
+}
+
+void GeoFenceController::_fenceWarningDistanceChanged(QVariant value)
+{
+    if (_fenceMonitor) {
+        _fenceMonitor->setWarningDistance(value.toDouble());
+    }
 }
 
 void GeoFenceController::_setReturnPointFromManager(QGeoCoordinate breachReturnPoint)
@@ -17,6 +17,7 @@
 #include "Vehicle.h"
 #include "MultiVehicleManager.h"
 #include "QGCLoggingCategory.h"
+#include "GeoFenceMonitor.h"
 
 Q_DECLARE_LOGGING_CATEGORY(GeoFenceControllerLog)
 
@@ -98,10 +99,13 @@ private slots:
     void _managerSendComplete       (bool error);
     void _managerRemoveAllComplete  (bool error);
     void _parametersReady           (void);
+    void _fenceStateChanged         (Vehicle* vehicle, int state, double distance);
+    void _fenceWarningDistanceChanged(QVariant value);
 
 private:
     void _init(void);
     void _signalAll(void);
+    void _updateFenceMonitor(void);
 
     GeoFenceManager*    _geoFenceManager;
     bool                _dirty;
@@ -110,6 +114,7 @@ private:
     QGeoCoordinate      _breachReturnPoint;
     bool                _itemsRequested;
     Fact*               _px4ParamCircularFenceFact;
+    GeoFenceMonitor*    _fenceMonitor;
 
     static const char* _px4ParamCircularFence;
 
@@ -0,0 +1,284 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoFenceEvaluator.h"
+#include "QGCGeo.h"
+
+#include <QLineF>
+#include <QtMath>
+
+#include <limits>
+
+GeoFenceEvaluator::GeoFenceEvaluator(double warningDistance)
+    : _warningDistance      (warningDistance)
+    , _searchRadius         (warningDistance * 3)
+    , _hasInclusionFence    (false)
+    , _indexValid           (false)
+    , _cellSize             (0)
+    , _gridColumns          (0)
+    , _gridRows             (0)
+    , _fullEvaluationCount  (0)
+{
+
+}
+
+void GeoFenceEvaluator::clear(void)
+{
+    _tangentOrigin = QGeoCoordinate();
+    _fences.clear();
+    _hasInclusionFence = false;
+    _indexValid = false;
+    _gridCells.clear();
+    _gridColumns = _gridRows = 0;
+    _vehicles.clear();
+    _fullEvaluationCount = 0;
+}
+
+QPointF GeoFenceEvaluator::_toLocal(const QGeoCoordinate& coord) const
+{
+    if (coord == _tangentOrigin) {
+        // This avoids a nan calculation that comes out of convertGeoToNed
+        return QPointF(0, 0);
+    }
+
+    double y, x, down;
+    convertGeoToNed(coord, _tangentOrigin, &y, &x, &down);
+    return QPointF(x, y);
+}
+
+void GeoFenceEvaluator::addPolygon(const QList<QGeoCoordinate>& vertices, bool inclusion)
+{
+    int count = vertices.count();
+    if (count > 1 && vertices.first() == vertices.last()) {
+        count--;
+    }
+    if (count < 3) {
+        return;
+    }
+    if (!_tangentOrigin.isValid()) {
+        _tangentOrigin = vertices.first();
+    }
+
+    Fence_t fence;
+    fence.inclusion =   inclusion;
+    fence.circle =      false;
+    fence.radius =      0;
+
+    QPointF topLeft(std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    QPointF bottomRight(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    fence.vertices.reserve(count);
+    for (int i=0; i<count; i++) {
+        QPointF vertex = _toLocal(vertices[i]);
+        fence.vertices.append(vertex);
+        topLeft.setX(qMin(topLeft.x(), vertex.x()));
+        topLeft.setY(qMin(topLeft.y(), vertex.y()));
+        bottomRight.setX(qMax(bottomRight.x(), vertex.x()));
+        bottomRight.setY(qMax(bottomRight.y(), vertex.y()));
+    }
+    fence.searchBounds = QRectF(topLeft, bottomRight).adjusted(-_searchRadius, -_searchRadius, _searchRadius, _searchRadius);
+
+    _fences.append(fence);
+    _hasInclusionFence |= inclusion;
+    _indexValid = false;
+}
+
+void GeoFenceEvaluator::addCircle(const QGeoCoordinate& center, double radius, bool inclusion)
+{
+    if (radius <= 0) {
+        return;
+    }
+    if (!_tangentOrigin.isValid()) {
+        _tangentOrigin = center;
+    }
+
+    Fence_t fence;
+    fence.inclusion =   inclusion;
+    fence.circle =      true;
+    fence.center =      _toLocal(center);
+    fence.radius =      radius;
+
+    double extent = radius + _searchRadius;
+    fence.searchBounds = QRectF(fence.center.x() - extent, fence.center.y() - extent, extent * 2, extent * 2);
+
+    _fences.append(fence);
+    _hasInclusionFence |= inclusion;
+    _indexValid = false;
+}
+
+/// Buckets the fence search bounds into a uniform grid. The cell size is the average fence search size, limited so
+/// that the grid never gets larger than _maxGridDimension in either direction.
+void GeoFenceEvaluator::_buildIndex(void)
+{
+    _indexValid = true;
+    _gridCells.clear();
+    _gridColumns = _gridRows = 0;
+    _vehicles.clear();
+
+    if (_fences.isEmpty()) {
+        return;
+    }
+
+    double sizeSum = 0;
+    _gridBounds = _fences[0].searchBounds;
+    for (const Fence_t& fence: _fences) {
+        _gridBounds |= fence.searchBounds;
+        sizeSum += qMax(fence.searchBounds.width(), fence.searchBounds.height());
+    }
+
+    _cellSize = qMax(sizeSum / _fences.count(), qMax(_gridBounds.width(), _gridBounds.height()) / _maxGridDimension);
+    _cellSize = qMax(_cellSize, 1.0);
+    _gridColumns =  qBound(1, qCeil(_gridBounds.width() / _cellSize), _maxGridDimension);
+    _gridRows =     qBound(1, qCeil(_gridBounds.height() / _cellSize), _maxGridDimension);
+    _gridCells.resize(_gridColumns * _gridRows);
+
+    for (int i=0; i<_fences.count(); i++) {
+        const QRectF& bounds = _fences[i].searchBounds;
+        int firstColumn =   qBound(0, static_cast<int>((bounds.left() - _gridBounds.left()) / _cellSize), _gridColumns - 1);
+        int lastColumn =    qBound(0, static_cast<int>((bounds.right() - _gridBounds.left()) / _cellSize), _gridColumns - 1);
+        int firstRow =      qBound(0, static_cast<int>((bounds.top() - _gridBounds.top()) / _cellSize), _gridRows - 1);
+        int lastRow =       qBound(0, static_cast<int>((bounds.bottom() - _gridBounds.top()) / _cellSize), _gridRows - 1);
+        for (int row=firstRow; row<=lastRow; row++) {
+            for (int column=firstColumn; column<=lastColumn; column++) {
+                _gridCells[row * _gridColumns + column].append(i);
+            }
+        }
+    }
+}
+
+/// Point in polygon (crossing number) and distance to the boundary in a single pass over the edges
+void GeoFenceEvaluator::_fenceDistance(const Fence_t& fence, const QPointF& point, bool& inside, double& distance) const
+{
+    if (fence.circle) {
+        double centerDistance = QLineF(fence.center, point).length();
+        inside = centerDistance < fence.radius;
+        distance = qAbs(centerDistance - fence.radius);
+        return;
+    }
+
+    inside = false;
+    double minDistanceSq = std::numeric_limits<double>::max();
+    const QVector<QPointF>& vertices = fence.vertices;
+    for (int i=0, j=vertices.count()-1; i<vertices.count(); j=i++) {
+        const QPointF& p1 = vertices[j];
+        const QPointF& p2 = vertices[i];
+
+        if ((p2.y() > point.y()) != (p1.y() > point.y()) &&
+                point.x() < (p1.x() - p2.x()) * (point.y() - p2.y()) / (p1.y() - p2.y()) + p2.x()) {
+            inside = !inside;
+        }
+
+        QPointF edge =      p2 - p1;
+        double  lengthSq =  QPointF::dotProduct(edge, edge);
+        double  t =         lengthSq > 0 ? qBound(0.0, QPointF::dotProduct(point - p1, edge) / lengthSq, 1.0) : 0;
+        QPointF offset =    point - (p1 + (edge * t));
+        minDistanceSq = qMin(minDistanceSq, QPointF::dotProduct(offset, offset));
+    }
+    distance = qSqrt(minDistanceSq);
+}
+
+GeoFenceEvaluator::Result_t GeoFenceEvaluator::_evaluateLocal(const QPointF& point) const
+{
+    // Fences which are not in the cell of the point are at least the search radius away
+    double  exclusionDistance =     _searchRadius;
+    int     exclusionIndex =        -1;
+    double  inclusionDistance =     -1;     // Distance to the boundary of the containing inclusion fence
+    int     inclusionIndex =        -1;
+    double  outsideInclusionDistance = _searchRadius;
+    int     outsideInclusionIndex = -1;
+
+    if (_gridColumns > 0 && _gridBounds.contains(point)) {
+        int column =    qMin(static_cast<int>((point.x() - _gridBounds.left()) / _cellSize), _gridColumns - 1);
+        int row =       qMin(static_cast<int>((point.y() - _gridBounds.top()) / _cellSize), _gridRows - 1);
+
+        for (int fenceIndex: _gridCells[row * _gridColumns + column]) {
+            const Fence_t& fence = _fences[fenceIndex];
+            if (!fence.searchBounds.contains(point)) {
+                continue;
+            }
+
+            bool    inside;
+            double  distance;
+            _fenceDistance(fence, point, inside, distance);
+
+            if (fence.inclusion) {
+                if (inside) {
+                    // Overlapping inclusion fences form a union, use the one the vehicle is deepest inside of
+                    if (distance > inclusionDistance) {
+                        inclusionDistance = distance;
+                        inclusionIndex = fenceIndex;
+                    }
+                } else if (distance < outsideInclusionDistance) {
+                    outsideInclusionDistance = distance;
+                    outsideInclusionIndex = fenceIndex;
+                }
+            } else if (inside) {
+                return { FenceBreach, distance, fenceIndex };
+            } else if (distance < exclusionDistance) {
+                exclusionDistance = distance;
+                exclusionIndex = fenceIndex;
+            }
+        }
+    }
+
+    if (_hasInclusionFence && inclusionIndex == -1) {
+        return { FenceBreach, outsideInclusionDistance, outsideInclusionIndex };
+    }
+
+    Result_t result = { FenceClear, exclusionDistance, exclusionIndex };
+    if (inclusionIndex != -1 && inclusionDistance < result.distance) {
+        result.distance = inclusionDistance;
+        result.fenceIndex = inclusionIndex;
+    }
+    if (result.distance < _warningDistance) {
+        result.state = FenceWarning;
+    }
+    return result;
+}
+
+GeoFenceEvaluator::Result_t GeoFenceEvaluator::evaluate(const QGeoCoordinate& position)
+{
+    if (!_indexValid) {
+        _buildIndex();
+    }
+    return _evaluateLocal(_toLocal(position));
+}
+
+GeoFenceEvaluator::Result_t GeoFenceEvaluator::update(int vehicleId, const QGeoCoordinate& position)
+{
+    if (!_indexValid) {
+        _buildIndex();
+    }
+
+    QPointF point = _toLocal(position);
+
+    // Every fence boundary was at least result.distance away at the last full evaluation. Until the vehicle has moved
+    // far enough to close that down to the warning distance its state can not have changed.
+    auto vehicleIter = _vehicles.find(vehicleId);
+    if (vehicleIter != _vehicles.end() && vehicleIter->result.state == FenceClear) {
+        double moved = QLineF(vehicleIter->position, point).length();
+        if (moved < vehicleIter->result.distance - _warningDistance) {
+            Result_t result = vehicleIter->result;
+            result.distance -= moved;
+            return result;
+        }
+    }
+
+    _fullEvaluationCount++;
+    VehicleState_t vehicleState;
+    vehicleState.position = point;
+    vehicleState.result = _evaluateLocal(point);
+    _vehicles[vehicleId] = vehicleState;
+
+    return vehicleState.result;
+}
+
+void GeoFenceEvaluator::removeVehicle(int vehicleId)
+{
+    _vehicles.remove(vehicleId);
+}
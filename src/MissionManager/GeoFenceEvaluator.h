@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QList>
+#include <QVector>
+#include <QMap>
+#include <QPointF>
+#include <QRectF>
+#include <QGeoCoordinate>
+
+/// Ground side GeoFence checking of vehicle positions against inclusion/exclusion polygons and circles.
+///
+/// Fences are converted to a local tangent plane and their bounding boxes, grown by the search radius, are bucketed into
+/// a uniform grid. A position is only tested against the fences of its grid cell. Each vehicle also remembers its
+/// clearance from the last full evaluation: while it is clear of all fences, updates which have not moved it far enough
+/// to possibly reach the warning distance are answered from the cache. This keeps the cost per update roughly constant
+/// no matter how many fences are loaded.
+class GeoFenceEvaluator
+{
+public:
+    /// @param warningDistance Distance in meters to a fence boundary at which a vehicle is considered to be approaching the fence
+    GeoFenceEvaluator(double warningDistance);
+
+    enum FenceState {
+        FenceClear,     ///< Further than the warning distance from all fences
+        FenceWarning,   ///< Within the warning distance of a fence boundary
+        FenceBreach,    ///< Inside an exclusion fence or outside all inclusion fences
+    };
+
+    typedef struct {
+        FenceState  state;
+        double      distance;   ///< Meters to the nearest relevant fence boundary. A lower bound while the vehicle is clear of all fences.
+        int         fenceIndex; ///< Index of the nearest fence in the order fences were added, -1 for none
+    } Result_t;
+
+    /// Removes all fences and all vehicle state
+    void clear(void);
+
+    /// Adds a polygon fence. Changing the fences rebuilds the index on the next evaluation and drops all vehicle state.
+    void addPolygon(const QList<QGeoCoordinate>& vertices, bool inclusion);
+
+    /// Adds a circular fence
+    void addCircle(const QGeoCoordinate& center, double radius, bool inclusion);
+
+    int fenceCount(void) const { return _fences.count(); }
+
+    /// Evaluates a position against all fences without using or updating any vehicle state
+    Result_t evaluate(const QGeoCoordinate& position);
+
+    /// Incrementally evaluates a new position for the specified vehicle
+    Result_t update(int vehicleId, const QGeoCoordinate& position);
+
+    /// Drops the state for the specified vehicle
+    void removeVehicle(int vehicleId);
+
+    /// Number of full evaluations done by update, the others were answered from the vehicle cache
+    int fullEvaluationCount(void) const { return _fullEvaluationCount; }
+
+private:
+    typedef struct {
+        bool                inclusion;
+        bool                circle;
+        QVector<QPointF>    vertices;       ///< Polygon vertices
+        QPointF             center;         ///< Circle center
+        double              radius;         ///< Circle radius
+        QRectF              searchBounds;   ///< Bounding box grown by the search radius
+    } Fence_t;
+
+    typedef struct {
+        QPointF     position;
+        Result_t    result;
+    } VehicleState_t;
+
+    void        _buildIndex         (void);
+    QPointF     _toLocal            (const QGeoCoordinate& coord) const;
+    Result_t    _evaluateLocal      (const QPointF& point) const;
+    void        _fenceDistance      (const Fence_t& fence, const QPointF& point, bool& inside, double& distance) const;
+
+    double                  _warningDistance;
+    double                  _searchRadius;
+    QGeoCoordinate          _tangentOrigin;
+    QVector<Fence_t>        _fences;
+    bool                    _hasInclusionFence;
+    bool                    _indexValid;
+    QRectF                  _gridBounds;
+    double                  _cellSize;
+    int                     _gridColumns;
+    int                     _gridRows;
+    QVector<QVector<int>>   _gridCells;
+    QMap<int, VehicleState_t> _vehicles;
+    int                     _fullEvaluationCount;
+
+    static const int _maxGridDimension = 256;
+};
@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoFenceEvaluatorTest.h"
+#include "GeoFenceMonitor.h"
+#include "QGCApplication.h"
+
+#include <QtMath>
+
+const double GeoFenceEvaluatorTest::_warningDistance = 50;
+
+GeoFenceEvaluatorTest::GeoFenceEvaluatorTest(void)
+    : _origin(47.633033, -122.08794)
+{
+
+}
+
+QGeoCoordinate GeoFenceEvaluatorTest::_offset(double north, double east) const
+{
+    return _origin.atDistanceAndAzimuth(north, 0).atDistanceAndAzimuth(east, 90);
+}
+
+/// Square with the south west corner at the specified offset
+QList<QGeoCoordinate> GeoFenceEvaluatorTest::_square(double north, double east, double size) const
+{
+    return { _offset(north, east), _offset(north + size, east), _offset(north + size, east + size), _offset(north, east + size) };
+}
+
+double GeoFenceEvaluatorTest::_randomDouble(double min, double max)
+{
+    return min + ((max - min) * qrand() / RAND_MAX);
+}
+
+void GeoFenceEvaluatorTest::_addRandomFences(GeoFenceEvaluator& evaluator, int count, double areaSize)
+{
+    for (int i=0; i<count; i++) {
+        double north =  _randomDouble(0, areaSize);
+        double east =   _randomDouble(0, areaSize);
+        double size =   _randomDouble(20, 200);
+        if (i % 2) {
+            evaluator.addCircle(_offset(north, east), size / 2, false /* inclusion */);
+        } else {
+            evaluator.addPolygon(_square(north, east, size), false /* inclusion */);
+        }
+    }
+}
+
+void GeoFenceEvaluatorTest::_testExclusionPolygon(void)
+{
+    GeoFenceEvaluator evaluator(_warningDistance);
+    evaluator.addPolygon(_square(0, 0, 1000), false /* inclusion */);
+    QCOMPARE(evaluator.fenceCount(), 1);
+
+    GeoFenceEvaluator::Result_t result = evaluator.evaluate(_offset(500, 500));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceBreach);
+    QCOMPARE(result.fenceIndex, 0);
+
+    result = evaluator.evaluate(_offset(500, -20));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceWarning);
+    QVERIFY(qAbs(result.distance - 20) < 0.5);
+
+    result = evaluator.evaluate(_offset(500, -100));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceClear);
+
+    // Far outside of the index
+    result = evaluator.evaluate(_offset(-10000, -10000));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceClear);
+    QCOMPARE(result.fenceIndex, -1);
+}
+
+void GeoFenceEvaluatorTest::_testInclusionPolygon(void)
+{
+    GeoFenceEvaluator evaluator(_warningDistance);
+    evaluator.addPolygon(_square(0, 0, 1000), true /* inclusion */);
+    evaluator.addPolygon(_square(400, 400, 100), false /* inclusion */);
+
+    GeoFenceEvaluator::Result_t result = evaluator.evaluate(_offset(200, 200));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceClear);
+
+    result = evaluator.evaluate(_offset(200, 980));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceWarning);
+    QCOMPARE(result.fenceIndex, 0);
+    QVERIFY(qAbs(result.distance - 20) < 0.5);
+
+    result = evaluator.evaluate(_offset(380, 450));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceWarning);
+    QCOMPARE(result.fenceIndex, 1);
+
+    result = evaluator.evaluate(_offset(450, 450));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceBreach);
+    QCOMPARE(result.fenceIndex, 1);
+
+    // Outside the inclusion fence, both near it and far away
+    result = evaluator.evaluate(_offset(200, 1010));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceBreach);
+    result = evaluator.evaluate(_offset(-10000, -10000));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceBreach);
+}
+
+void GeoFenceEvaluatorTest::_testCircles(void)
+{
+    GeoFenceEvaluator evaluator(_warningDistance);
+    evaluator.addCircle(_origin, 500, true /* inclusion */);
+    evaluator.addCircle(_offset(0, 2000), 500, true /* inclusion */);
+    evaluator.addCircle(_offset(0, 2000), 100, false /* inclusion */);
+
+    QCOMPARE(evaluator.evaluate(_origin).state, GeoFenceEvaluator::FenceClear);
+    QCOMPARE(evaluator.evaluate(_offset(0, 480)).state, GeoFenceEvaluator::FenceWarning);
+    QCOMPARE(evaluator.evaluate(_offset(0, 1000)).state, GeoFenceEvaluator::FenceBreach);
+    QCOMPARE(evaluator.evaluate(_offset(0, 1700)).state, GeoFenceEvaluator::FenceClear);
+    QCOMPARE(evaluator.evaluate(_offset(0, 1880)).state, GeoFenceEvaluator::FenceWarning);
+    QCOMPARE(evaluator.evaluate(_offset(0, 2000)).state, GeoFenceEvaluator::FenceBreach);
+
+    GeoFenceEvaluator::Result_t result = evaluator.evaluate(_offset(0, 2120));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceWarning);
+    QCOMPARE(result.fenceIndex, 2);
+    QVERIFY(qAbs(result.distance - 20) < 0.5);
+
+    evaluator.clear();
+    QCOMPARE(evaluator.fenceCount(), 0);
+    QCOMPARE(evaluator.evaluate(_offset(0, 1000)).state, GeoFenceEvaluator::FenceClear);
+}
+
+/// Random walks through a field of fences must give the same fence state from update as from a full evaluation
+void GeoFenceEvaluatorTest::_testIncrementalMatchesFull(void)
+{
+    const double areaSize = 5000;
+
+    qsrand(42);
+    GeoFenceEvaluator evaluator(_warningDistance);
+    _addRandomFences(evaluator, 200, areaSize);
+
+    int updateCount = 0;
+    for (int vehicleId=1; vehicleId<=5; vehicleId++) {
+        double north =  _randomDouble(0, areaSize);
+        double east =   _randomDouble(0, areaSize);
+        for (int step=0; step<1000; step++) {
+            north += _randomDouble(-15, 15);
+            east +=  _randomDouble(-15, 15);
+            QGeoCoordinate position = _offset(north, east);
+
+            GeoFenceEvaluator::Result_t incremental =   evaluator.update(vehicleId, position);
+            GeoFenceEvaluator::Result_t full =          evaluator.evaluate(position);
+            updateCount++;
+
+            QCOMPARE(incremental.state, full.state);
+            if (incremental.state == GeoFenceEvaluator::FenceClear) {
+                // Cached distance is a lower bound
+                QVERIFY(incremental.distance <= full.distance + 0.01);
+            } else {
+                QCOMPARE(incremental.fenceIndex, full.fenceIndex);
+            }
+        }
+    }
+    QVERIFY(evaluator.fullEvaluationCount() < updateCount);
+}
+
+/// Each vehicle keeps its own fence state, which only steps back down once the vehicle is past the hysteresis band
+void GeoFenceEvaluatorTest::_testMonitorHysteresis(void)
+{
+    GeoFenceMonitor monitor(qgcApp()->toolbox()->multiVehicleManager(), _warningDistance);
+    monitor._evaluator.addPolygon(_square(0, 0, 1000), false /* inclusion */);
+
+    GeoFenceEvaluator::Result_t result;
+    const int vehicleCount = 50;
+    for (int id=1; id<=vehicleCount; id++) {
+        monitor._vehicleStates[id] = GeoFenceEvaluator::FenceClear;
+        QVERIFY(!monitor._updateVehicleState(id, _offset(500, -500 - id), result));
+    }
+
+    // Only the vehicles which approach the fence change state
+    for (int id=1; id<=vehicleCount; id++) {
+        bool approaching = id % 2;
+        QCOMPARE(monitor._updateVehicleState(id, _offset(500, approaching ? -30 : -400), result), approaching);
+        if (approaching) {
+            QCOMPARE(result.state, GeoFenceEvaluator::FenceWarning);
+        }
+    }
+
+    // Position noise just past the warning distance keeps the warning
+    QVERIFY(!monitor._updateVehicleState(1, _offset(500, -_warningDistance - 1), result));
+    QVERIFY(!monitor._updateVehicleState(1, _offset(500, -_warningDistance + 1), result));
+    QCOMPARE(monitor._vehicleStates[1], GeoFenceEvaluator::FenceWarning);
+
+    // Into the fence and back out by less than the hysteresis distance stays breached
+    QVERIFY(monitor._updateVehicleState(1, _offset(500, 10), result));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceBreach);
+    QVERIFY(!monitor._updateVehicleState(1, _offset(500, -1), result));
+    QVERIFY(monitor._updateVehicleState(1, _offset(500, -20), result));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceWarning);
+
+    // Clear again once beyond the band
+    QVERIFY(monitor._updateVehicleState(1, _offset(500, -100), result));
+    QCOMPARE(result.state, GeoFenceEvaluator::FenceClear);
+    QCOMPARE(monitor._vehicleStates[3], GeoFenceEvaluator::FenceWarning);
+    QCOMPARE(monitor._vehicleStates[2], GeoFenceEvaluator::FenceClear);
+}
+
+void GeoFenceEvaluatorTest::_benchmarkUpdate(void)
+{
+    const int    vehicleCount = 50;
+    const double areaSize =     20000;
+
+    qsrand(42);
+    GeoFenceEvaluator evaluator(_warningDistance);
+    _addRandomFences(evaluator, 500, areaSize);
+
+    QList<QPointF> positions;
+    for (int i=0; i<vehicleCount; i++) {
+        positions.append(QPointF(_randomDouble(0, areaSize), _randomDouble(0, areaSize)));
+    }
+
+    int updateCount = 0;
+    QBENCHMARK {
+        for (int i=0; i<vehicleCount; i++) {
+            positions[i] += QPointF(_randomDouble(-5, 5), _randomDouble(-5, 5));
+            evaluator.update(i, _offset(positions[i].x(), positions[i].y()));
+            updateCount++;
+        }
+    }
+    QVERIFY(evaluator.fullEvaluationCount() <= updateCount);
+}
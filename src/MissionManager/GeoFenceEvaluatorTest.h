@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "GeoFenceEvaluator.h"
+
+class GeoFenceEvaluatorTest : public UnitTest
+{
+    Q_OBJECT
+    
+public:
+    GeoFenceEvaluatorTest(void);
+
+private slots:
+    void _testExclusionPolygon(void);
+    void _testInclusionPolygon(void);
+    void _testCircles(void);
+    void _testIncrementalMatchesFull(void);
+    void _testMonitorHysteresis(void);
+    void _benchmarkUpdate(void);
+
+private:
+    QGeoCoordinate          _offset         (double north, double east) const;
+    QList<QGeoCoordinate>   _square         (double north, double east, double size) const;
+    double                  _randomDouble   (double min, double max);
+    void                    _addRandomFences(GeoFenceEvaluator& evaluator, int count, double areaSize);
+
+    QGeoCoordinate _origin;
+
+    static const double _warningDistance;
+};
@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoFenceMonitor.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
+#include "QmlObjectListModel.h"
+#include "QGCFencePolygon.h"
+#include "QGCFenceCircle.h"
+
+QGC_LOGGING_CATEGORY(GeoFenceMonitorLog, "GeoFenceMonitorLog")
+
+const double GeoFenceMonitor::_hysteresisDistance = 5.0;
+
+GeoFenceMonitor::GeoFenceMonitor(MultiVehicleManager* multiVehicleManager, double warningDistance, QObject* parent)
+    : QObject               (parent)
+    , _multiVehicleManager  (multiVehicleManager)
+    , _polygons             (nullptr)
+    , _circles              (nullptr)
+    , _warningDistance      (warningDistance)
+    , _evaluator            (warningDistance)
+{
+    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded,   this, &GeoFenceMonitor::_vehicleAdded);
+    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &GeoFenceMonitor::_vehicleRemoved);
+
+    QmlObjectListModel* vehicles = _multiVehicleManager->vehicles();
+    for (int i=0; i<vehicles->count(); i++) {
+        _vehicleAdded(vehicles->value<Vehicle*>(i));
+    }
+}
+
+void GeoFenceMonitor::setFences(QmlObjectListModel* polygons, QmlObjectListModel* circles)
+{
+    _polygons = polygons;
+    _circles = circles;
+    _loadFences();
+}
+
+void GeoFenceMonitor::setWarningDistance(double warningDistance)
+{
+    if (!qFuzzyCompare(warningDistance, _warningDistance)) {
+        // The fence search bounds are sized from the warning distance, so the fences are reloaded into a new evaluator
+        _warningDistance = warningDistance;
+        _evaluator = GeoFenceEvaluator(warningDistance);
+        _loadFences();
+    }
+}
+
+void GeoFenceMonitor::_loadFences(void)
+{
+    _evaluator.clear();
+
+    if (_polygons) {
+        for (int i=0; i<_polygons->count(); i++) {
+            QGCFencePolygon* polygon = _polygons->value<QGCFencePolygon*>(i);
+            _evaluator.addPolygon(polygon->coordinateList(), polygon->inclusion());
+        }
+    }
+    if (_circles) {
+        for (int i=0; i<_circles->count(); i++) {
+            QGCFenceCircle* circle = _circles->value<QGCFenceCircle*>(i);
+            _evaluator.addCircle(circle->center(), circle->radius()->rawValue().toDouble(), circle->inclusion());
+        }
+    }
+    qCDebug(GeoFenceMonitorLog) << "_loadFences fenceCount" << _evaluator.fenceCount();
+
+    // Re-check everyone against the new fences
+    QmlObjectListModel* vehicles = _multiVehicleManager->vehicles();
+    for (int i=0; i<vehicles->count(); i++) {
+        Vehicle* vehicle = vehicles->value<Vehicle*>(i);
+        if (_vehicleStates.contains(vehicle->id())) {
+            _checkVehicle(vehicle, vehicle->coordinate());
+        }
+    }
+}
+
+void GeoFenceMonitor::_vehicleAdded(Vehicle* vehicle)
+{
+    _vehicleStates[vehicle->id()] = GeoFenceEvaluator::FenceClear;
+    connect(vehicle, &Vehicle::coordinateChanged, this, &GeoFenceMonitor::_vehicleCoordinateChanged);
+    _checkVehicle(vehicle, vehicle->coordinate());
+}
+
+void GeoFenceMonitor::_vehicleRemoved(Vehicle* vehicle)
+{
+    disconnect(vehicle, &Vehicle::coordinateChanged, this, &GeoFenceMonitor::_vehicleCoordinateChanged);
+    _vehicleStates.remove(vehicle->id());
+    _evaluator.removeVehicle(vehicle->id());
+}
+
+void GeoFenceMonitor::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
+{
+    Vehicle* vehicle = qobject_cast<Vehicle*>(sender());
+    if (vehicle) {
+        _checkVehicle(vehicle, coordinate);
+    }
+}
+
+void GeoFenceMonitor::_checkVehicle(Vehicle* vehicle, const QGeoCoordinate& coordinate)
+{
+    GeoFenceEvaluator::Result_t result;
+    if (_updateVehicleState(vehicle->id(), coordinate, result)) {
+        emit fenceStateChanged(vehicle, result.state, result.distance);
+    }
+}
+
+/// Evaluates a new position for the specified vehicle
+/// @return true: fence state of the vehicle changed, result holds the new state
+bool GeoFenceMonitor::_updateVehicleState(int vehicleId, const QGeoCoordinate& coordinate, GeoFenceEvaluator::Result_t& result)
+{
+    if (!coordinate.isValid() || _evaluator.fenceCount() == 0) {
+        return false;
+    }
+
+    result = _evaluator.update(vehicleId, coordinate);
+    GeoFenceEvaluator::FenceState& vehicleState = _vehicleStates[vehicleId];
+
+    // Only step down to a lesser state once the vehicle is clearly past the boundary it crossed
+    if (vehicleState == GeoFenceEvaluator::FenceBreach && result.state != GeoFenceEvaluator::FenceBreach && result.distance < _hysteresisDistance) {
+        return false;
+    }
+    if (vehicleState == GeoFenceEvaluator::FenceWarning && result.state == GeoFenceEvaluator::FenceClear && result.distance < _warningDistance + _hysteresisDistance) {
+        return false;
+    }
+
+    if (result.state == vehicleState) {
+        return false;
+    }
+    qCDebug(GeoFenceMonitorLog) << "Fence state changed vehicle:state:distance:fence" << vehicleId << result.state << result.distance << result.fenceIndex;
+    vehicleState = result.state;
+    return true;
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QGeoCoordinate>
+
+#include "GeoFenceEvaluator.h"
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(GeoFenceMonitorLog)
+
+class MultiVehicleManager;
+class QmlObjectListModel;
+class Vehicle;
+
+/// Checks the positions of all connected vehicles against a set of GeoFences on the ground side and signals when a
+/// vehicle gets close to or breaches a fence.
+class GeoFenceMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @param warningDistance Distance in meters to a fence boundary at which a vehicle is considered to be approaching the fence
+    GeoFenceMonitor(MultiVehicleManager* multiVehicleManager, double warningDistance, QObject* parent = nullptr);
+
+    /// Replaces the fences vehicles are checked against
+    ///     @param polygons List of QGCFencePolygon
+    ///     @param circles List of QGCFenceCircle
+    void setFences(QmlObjectListModel* polygons, QmlObjectListModel* circles);
+
+    /// Changes the warning distance and re-checks all vehicles against it
+    void setWarningDistance(double warningDistance);
+
+signals:
+    /// Signalled when the fence state of a vehicle changes
+    ///     @param state GeoFenceEvaluator::FenceState
+    ///     @param distance Distance to the nearest fence boundary in meters
+    void fenceStateChanged(Vehicle* vehicle, int state, double distance);
+
+private slots:
+    void _vehicleAdded              (Vehicle* vehicle);
+    void _vehicleRemoved            (Vehicle* vehicle);
+    void _vehicleCoordinateChanged  (QGeoCoordinate coordinate);
+
+private:
+    void _loadFences            (void);
+    void _checkVehicle          (Vehicle* vehicle, const QGeoCoordinate& coordinate);
+    bool _updateVehicleState    (int vehicleId, const QGeoCoordinate& coordinate, GeoFenceEvaluator::Result_t& result);
+
+    MultiVehicleManager*                            _multiVehicleManager;
+    QmlObjectListModel*                             _polygons;
+    QmlObjectListModel*                             _circles;
+    double                                          _warningDistance;
+    GeoFenceEvaluator                               _evaluator;
+    QMap<int, GeoFenceEvaluator::FenceState>        _vehicleStates;     ///< Fence state by vehicle id
+
+    /// A vehicle must be this many meters past the point where it entered a state before it leaves it again. This
+    /// keeps position noise along a boundary from flipping the state back and forth.
+    static const double _hysteresisDistance;
+
+    friend class GeoFenceEvaluatorTest;
+};
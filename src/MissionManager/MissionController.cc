@@ -69,11 +69,19 @@ MissionController::MissionController(PlanMasterController* masterController, QOb
     , _progressPct              (0)
     , _currentPlanViewIndex     (-1)
     , _currentPlanViewItem      (nullptr)
+    , _minAltSeen               (qQNaN())
+    , _maxAltSeen               (qQNaN())
+    , _recalcWaypointLinesQueued        (false)
+    , _recalcFlightStatusQueuedIndex    (-1)
+    , _recalcFlightStatusQueuedLastIndex(-1)
 {
     _resetMissionFlightStatus();
     managerVehicleChanged(_managerVehicle);
     _updateTimer.setSingleShot(true);
     connect(&_updateTimer, &QTimer::timeout, this, &MissionController::_updateTimeout);
+    _recalcTimer.setSingleShot(true);
+    _recalcTimer.setInterval(0);
+    connect(&_recalcTimer, &QTimer::timeout, this, &MissionController::_processQueuedRecalc);
 }
 
 MissionController::~MissionController()
@@ -180,10 +188,12 @@ void MissionController::_newMissionItemsAvailableFromVehicle(bool removeAllReque
             i = 1;
         }
 
+        QObjectList simpleItems;
         for (; i < newMissionItems.count(); i++) {
             const MissionItem* missionItem = newMissionItems[i];
-            newControllerMissionItems->append(new SimpleMissionItem(_controllerVehicle, _flyView, *missionItem, this));
+            simpleItems.append(new SimpleMissionItem(_controllerVehicle, _flyView, *missionItem, this));
         }
+        newControllerMissionItems->append(simpleItems);
 
         _deinitAllVisualItems();
         _visualItems->deleteLater();
@@ -594,6 +604,7 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
     int nextComplexItemIndex= 0;
     int nextSequenceNumber = 1; // Start with 1 since home is in 0
     QJsonArray itemArray(json[_jsonItemsKey].toArray());
+    QObjectList loadedItems;
 
     qCDebug(MissionControllerLog) << "Json load: simple item loop start simpleItemCount:ComplexItemCount" << itemArray.count() << surveyItems.count();
     do {
@@ -605,7 +616,7 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
 
             if (complexItem->sequenceNumber() == nextSequenceNumber) {
                 qCDebug(MissionControllerLog) << "Json load: injecting complex item expectedSequence:actualSequence:" << nextSequenceNumber << complexItem->sequenceNumber();
-                visualItems->append(complexItem);
+                loadedItems.append(complexItem);
                 nextSequenceNumber = complexItem->lastSequenceNumber() + 1;
                 nextComplexItemIndex++;
                 continue;
@@ -626,12 +637,13 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
             if (item->load(itemObject, itemObject["id"].toInt(), errorString)) {
                 qCDebug(MissionControllerLog) << "Json load: adding simple item expectedSequence:actualSequence" << nextSequenceNumber << item->sequenceNumber();
                 nextSequenceNumber = item->lastSequenceNumber() + 1;
-                visualItems->append(item);
+                loadedItems.append(item);
             } else {
                 return false;
             }
         }
     } while (nextSimpleItemIndex < itemArray.count() || nextComplexItemIndex < surveyItems.count());
+    visualItems->append(loadedItems);
 
     if (json.contains(_jsonPlannedHomePositionKey)) {
         SimpleMissionItem* item = new SimpleMissionItem(_controllerVehicle, _flyView, visualItems);
@@ -668,6 +680,12 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
 
     qCDebug(MissionControllerLog) << "MissionController::_loadJsonMissionFileV2 itemCount:" << json[_jsonItemsKey].toArray().count();
 
+    // Parse the items first so a bad file fails before any of the items, with their full Fact sets, are created
+    QList<LoadItemInfo_t> rgItemInfo;
+    if (!_parseJsonMissionItemsV2(json[_jsonItemsKey].toArray(), rgItemInfo, errorString)) {
+        return false;
+    }
+
     // Mission Settings
     AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
 
@@ -694,127 +712,146 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
     visualItems->insert(0, settingsItem);
     qCDebug(MissionControllerLog) << "plannedHomePosition" << homeCoordinate;
 
-    // Read mission items
+    // Create the mission items. They are collected and added to the list in one go so the model only signals once.
 
+    QObjectList rgLoadedItems;
+    rgLoadedItems.reserve(rgItemInfo.count());
     int nextSequenceNumber = 1; // Start with 1 since home is in 0
-    const QJsonArray rgMissionItems(json[_jsonItemsKey].toArray());
-    for (int i=0; i<rgMissionItems.count(); i++) {
+    for (const LoadItemInfo_t& itemInfo: rgItemInfo) {
+        VisualMissionItem* item = _createLoadedItem(itemInfo, visualItems, nextSequenceNumber, errorString);
+        if (!item) {
+            return false;
+        }
+        rgLoadedItems.append(item);
+    }
+
+    // Fix up the DO_JUMP commands jump sequence number by finding the item with the matching doJumpId
+    QHash<int, int> doJumpIdToSequenceNumber;
+    for (QObject* object: rgLoadedItems) {
+        SimpleMissionItem* targetItem = qobject_cast<SimpleMissionItem*>(object);
+        if (targetItem && !doJumpIdToSequenceNumber.contains(targetItem->missionItem().doJumpId())) {
+            doJumpIdToSequenceNumber[targetItem->missionItem().doJumpId()] = targetItem->sequenceNumber();
+        }
+    }
+    for (QObject* object: rgLoadedItems) {
+        SimpleMissionItem* doJumpItem = qobject_cast<SimpleMissionItem*>(object);
+        if (doJumpItem && doJumpItem->command() == MAV_CMD_DO_JUMP) {
+            int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
+            if (!doJumpIdToSequenceNumber.contains(findDoJumpId)) {
+                errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
+                return false;
+            }
+            doJumpItem->missionItem().setParam1(doJumpIdToSequenceNumber[findDoJumpId]);
+        }
+    }
+
+    visualItems->append(rgLoadedItems);
+
+    return true;
+}
+
+bool MissionController::_parseJsonMissionItemsV2(const QJsonArray& rgItems, QList<LoadItemInfo_t>& rgItemInfo, QString& errorString)
+{
+    rgItemInfo.reserve(rgItems.count());
+
+    for (int i=0; i<rgItems.count(); i++) {
         // Convert to QJsonObject
-        const QJsonValue& itemValue = rgMissionItems[i];
+        const QJsonValue& itemValue = rgItems[i];
         if (!itemValue.isObject()) {
             errorString = tr("Mission item %1 is not an object").arg(i);
             return false;
         }
-        const QJsonObject itemObject = itemValue.toObject();
-
-        // Load item based on type
+        LoadItemInfo_t itemInfo;
+        itemInfo.json = itemValue.toObject();
 
         QList<JsonHelper::KeyValidateInfo> itemKeyInfoList = {
             { VisualMissionItem::jsonTypeKey,  QJsonValue::String, true },
         };
-        if (!JsonHelper::validateKeys(itemObject, itemKeyInfoList, errorString)) {
+        if (!JsonHelper::validateKeys(itemInfo.json, itemKeyInfoList, errorString)) {
             return false;
         }
-        QString itemType = itemObject[VisualMissionItem::jsonTypeKey].toString();
+        QString itemType = itemInfo.json[VisualMissionItem::jsonTypeKey].toString();
 
         if (itemType == VisualMissionItem::jsonTypeSimpleItemValue) {
-            SimpleMissionItem* simpleItem = new SimpleMissionItem(_controllerVehicle, _flyView, visualItems);
-            if (simpleItem->load(itemObject, nextSequenceNumber, errorString)) {
-                qCDebug(MissionControllerLog) << "Loading simple item: nextSequenceNumber:command" << nextSequenceNumber << simpleItem->command();
-                nextSequenceNumber = simpleItem->lastSequenceNumber() + 1;
-                visualItems->append(simpleItem);
-            } else {
-                return false;
-            }
+            itemInfo.type = LoadItemSimple;
         } else if (itemType == VisualMissionItem::jsonTypeComplexItemValue) {
             QList<JsonHelper::KeyValidateInfo> complexItemKeyInfoList = {
                 { ComplexMissionItem::jsonComplexItemTypeKey,  QJsonValue::String, true },
             };
-            if (!JsonHelper::validateKeys(itemObject, complexItemKeyInfoList, errorString)) {
+            if (!JsonHelper::validateKeys(itemInfo.json, complexItemKeyInfoList, errorString)) {
                 return false;
             }
-            QString complexItemType = itemObject[ComplexMissionItem::jsonComplexItemTypeKey].toString();
+            QString complexItemType = itemInfo.json[ComplexMissionItem::jsonComplexItemTypeKey].toString();
 
             if (complexItemType == SurveyComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Survey: nextSequenceNumber" << nextSequenceNumber;
-                SurveyComplexItem* surveyItem = new SurveyComplexItem(_controllerVehicle, _flyView, QString() /* kmlFile */, visualItems);
-                if (!surveyItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = surveyItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "Survey load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(surveyItem);
+                itemInfo.type = LoadItemSurvey;
             } else if (complexItemType == FixedWingLandingComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Fixed Wing Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
-                FixedWingLandingComplexItem* landingItem = new FixedWingLandingComplexItem(_controllerVehicle, _flyView, visualItems);
-                if (!landingItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "FW Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
+                itemInfo.type = LoadItemFixedWingLanding;
             } else if (complexItemType == StructureScanComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Structure Scan: nextSequenceNumber" << nextSequenceNumber;
-                StructureScanComplexItem* structureItem = new StructureScanComplexItem(_controllerVehicle, _flyView, QString() /* kmlFile */, visualItems);
-                if (!structureItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = structureItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "Structure Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(structureItem);
+                itemInfo.type = LoadItemStructureScan;
             } else if (complexItemType == CorridorScanComplexItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Corridor Scan: nextSequenceNumber" << nextSequenceNumber;
-                CorridorScanComplexItem* corridorItem = new CorridorScanComplexItem(_controllerVehicle, _flyView, QString() /* kmlFile */, visualItems);
-                if (!corridorItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = corridorItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "Corridor Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(corridorItem);
+                itemInfo.type = LoadItemCorridorScan;
             } else if (complexItemType == MissionSettingsItem::jsonComplexItemTypeValue) {
-                qCDebug(MissionControllerLog) << "Loading Mission Settings: nextSequenceNumber" << nextSequenceNumber;
-                MissionSettingsItem* settingsItem = new MissionSettingsItem(_controllerVehicle, _flyView, visualItems);
-                if (!settingsItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
-                }
-                nextSequenceNumber = settingsItem->lastSequenceNumber() + 1;
-                qCDebug(MissionControllerLog) << "Mission Settings load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(settingsItem);
+                itemInfo.type = LoadItemMissionSettings;
             } else {
                 errorString = tr("Unsupported complex item type: %1").arg(complexItemType);
+                return false;
             }
         } else {
             errorString = tr("Unknown item type: %1").arg(itemType);
             return false;
         }
+
+        rgItemInfo.append(itemInfo);
     }
 
-    // Fix up the DO_JUMP commands jump sequence number by finding the item with the matching doJumpId
-    for (int i=0; i<visualItems->count(); i++) {
-        if (visualItems->value<VisualMissionItem*>(i)->isSimpleItem()) {
-            SimpleMissionItem* doJumpItem = visualItems->value<SimpleMissionItem*>(i);
-            if (doJumpItem->command() == MAV_CMD_DO_JUMP) {
-                bool found = false;
-                int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
-                for (int j=0; j<visualItems->count(); j++) {
-                    if (visualItems->value<VisualMissionItem*>(j)->isSimpleItem()) {
-                        SimpleMissionItem* targetItem = visualItems->value<SimpleMissionItem*>(j);
-                        if (targetItem->missionItem().doJumpId() == findDoJumpId) {
-                            doJumpItem->missionItem().setParam1(targetItem->sequenceNumber());
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-                if (!found) {
-                    errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
-                    return false;
-                }
-            }
+    return true;
+}
+
+/// Creates and loads a single item from the parse pass
+///     @param nextSequenceNumber Sequence number for the item, updated to the sequence number following the item
+/// @return Loaded item, nullptr for error
+VisualMissionItem* MissionController::_createLoadedItem(const LoadItemInfo_t& itemInfo, QObject* parent, int& nextSequenceNumber, QString& errorString)
+{
+    if (itemInfo.type == LoadItemSimple) {
+        SimpleMissionItem* simpleItem = new SimpleMissionItem(_controllerVehicle, _flyView, parent);
+        if (!simpleItem->load(itemInfo.json, nextSequenceNumber, errorString)) {
+            simpleItem->deleteLater();
+            return nullptr;
         }
+        qCDebug(MissionControllerLog) << "Loaded simple item: nextSequenceNumber:command" << nextSequenceNumber << simpleItem->command();
+        nextSequenceNumber = simpleItem->lastSequenceNumber() + 1;
+        return simpleItem;
     }
 
-    return true;
+    ComplexMissionItem* complexItem = nullptr;
+    switch (itemInfo.type) {
+    case LoadItemSurvey:
+        complexItem = new SurveyComplexItem(_controllerVehicle, _flyView, QString() /* kmlFile */, parent);
+        break;
+    case LoadItemFixedWingLanding:
+        complexItem = new FixedWingLandingComplexItem(_controllerVehicle, _flyView, parent);
+        break;
+    case LoadItemStructureScan:
+        complexItem = new StructureScanComplexItem(_controllerVehicle, _flyView, QString() /* kmlFile */, parent);
+        break;
+    case LoadItemCorridorScan:
+        complexItem = new CorridorScanComplexItem(_controllerVehicle, _flyView, QString() /* kmlFile */, parent);
+        break;
+    case LoadItemMissionSettings:
+    default:
+        complexItem = new MissionSettingsItem(_controllerVehicle, _flyView, parent);
+        break;
+    }
+
+    if (!complexItem->load(itemInfo.json, nextSequenceNumber, errorString)) {
+        complexItem->deleteLater();
+        return nullptr;
+    }
+    qCDebug(MissionControllerLog) << "Loaded" << complexItem->commandName() << ": sequenceNumber:lastSequenceNumber" << nextSequenceNumber << complexItem->lastSequenceNumber();
+    nextSequenceNumber = complexItem->lastSequenceNumber() + 1;
+
+    return complexItem;
 }
 
 bool MissionController::_loadItemsFromJson(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString)
@@ -865,6 +902,7 @@ bool MissionController::_loadTextMissionFile(QTextStream& stream, QmlObjectListM
         _addMissionSettings(visualItems, true /* addToCenter */);
         MissionSettingsItem* settingsItem = visualItems->value<MissionSettingsItem*>(0);
 
+        QObjectList loadedItems;
         while (!stream.atEnd()) {
             SimpleMissionItem* item = new SimpleMissionItem(_controllerVehicle, _flyView, visualItems);
 
@@ -872,7 +910,7 @@ bool MissionController::_loadTextMissionFile(QTextStream& stream, QmlObjectListM
                 if (firstItem && plannedHomePositionInFile) {
                     settingsItem->setCoordinate(item->coordinate());
                 } else {
-                    visualItems->append(item);
+                    loadedItems.append(item);
                 }
                 firstItem = false;
             } else {
@@ -880,6 +918,7 @@ bool MissionController::_loadTextMissionFile(QTextStream& stream, QmlObjectListM
                 return false;
             }
         }
+        visualItems->append(loadedItems);
     } else {
         errorString = tr("The mission file is not compatible with this version of %1.").arg(qgcApp()->applicationName());
         return false;
@@ -1087,13 +1126,15 @@ void MissionController::_addWaypointLineSegment(CoordVectHashTable& prevItemPair
 
         // FIXME: We should ideally have signals for 2D position change, alt change, and 3D position change
         // Not optimal, but still pretty fast, do a full update of range/bearing/altitudes
-        connect(pair.second, &VisualMissionItem::coordinateChanged, this, &MissionController::_recalcMissionFlightStatus);
+        connect(pair.second, &VisualMissionItem::coordinateChanged, this, &MissionController::_queueRecalcMissionFlightStatus);
         _linesTable[pair] = linevect;
     }
 }
 
 void MissionController::_recalcWaypointLines(void)
 {
+    _recalcWaypointLinesQueued = false;
+
     bool                firstCoordinateItem =   true;
     VisualMissionItem*  lastCoordinateItem =    qobject_cast<VisualMissionItem*>(_visualItems->get(0));
 
@@ -1104,7 +1145,8 @@ void MissionController::_recalcWaypointLines(void)
     CoordVectHashTable old_table = _linesTable;
     _linesTable.clear();
     _waypointLines.clear();
-    _waypointPath.clear();
+
+    QVector<QGeoCoordinate> waypointPath;
 
     bool linkEndToHome;
     SimpleMissionItem* lastItem = _visualItems->value<SimpleMissionItem*>(_visualItems->count() - 1);
@@ -1135,13 +1177,13 @@ void MissionController::_recalcWaypointLines(void)
                     _addWaypointLineSegment(old_table, pair);
                 }
             }
-            _waypointPath.append(QVariant::fromValue(item->coordinate()));
+            waypointPath.append(item->coordinate());
             lastCoordinateItem = item;
         }
     }
 
     if (linkStartToHome && homePositionValid) {
-        _waypointPath.prepend(QVariant::fromValue(_settingsItem->coordinate()));
+        waypointPath.prepend(_settingsItem->coordinate());
     }
 
     if (linkEndToHome && lastCoordinateItem != _settingsItem && homePositionValid) {
@@ -1149,7 +1191,7 @@ void MissionController::_recalcWaypointLines(void)
             VisualItemPair pair(lastCoordinateItem, _settingsItem);
             _addWaypointLineSegment(old_table, pair);
         } else {
-            _waypointPath.append(QVariant::fromValue(_settingsItem->coordinate()));
+            waypointPath.append(_settingsItem->coordinate());
         }
     }
 
@@ -1170,16 +1212,10 @@ void MissionController::_recalcWaypointLines(void)
 
     _recalcMissionFlightStatus();
 
-    if (_waypointPath.count() == 0) {
-        // MapPolyLine has a bug where if you can from a path which has elements to an empty path the line drawn
-        // is not cleared from the map. This hack works around that since it causes the previous lines to be remove
-        // as then doesn't draw anything on the map.
-        _waypointPath.append(QVariant::fromValue(QGeoCoordinate(0, 0)));
-        _waypointPath.append(QVariant::fromValue(QGeoCoordinate(0, 0)));
-    }
+    // Only the rows which differ from the previous path are signalled to the map
+    _waypointPath.setPath(waypointPath);
 
     emit waypointLinesChanged();
-    emit waypointPathChanged();
 }
 
 void MissionController::_updateBatteryInfo(int waypointIndex)
@@ -1242,37 +1278,155 @@ void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, dou
     }
 }
 
-void MissionController::_recalcMissionFlightStatus()
+void MissionController::_recalcMissionFlightStatus(void)
 {
-    if (!_visualItems->count()) {
+    _recalcMissionFlightStatusFrom(0, -1);
+}
+
+/// Returns true if the state handed to an item is the same as in the previous pass in everything but the cumulative
+/// totals. The item and everything after it will then calculate the same values as before.
+bool MissionController::_flightStatusConverged(const FlightStatusState_t& oldState, const FlightStatusState_t& newState, int firstChangedIndex, int lastChangedIndex) const
+{
+    const MissionFlightStatus_t& oldStatus = oldState.missionFlightStatus;
+    const MissionFlightStatus_t& newStatus = newState.missionFlightStatus;
+
+    // Distances are calculated from the previous coordinate item, which must not have changed itself
+    if (newState.lastCoordinateItemIndex != oldState.lastCoordinateItemIndex ||
+            (newState.lastCoordinateItemIndex >= firstChangedIndex && newState.lastCoordinateItemIndex <= lastChangedIndex)) {
+        return false;
+    }
+    if (newState.firstCoordinateItem != oldState.firstCoordinateItem ||
+            newState.vtolInHover != oldState.vtolInHover ||
+            newState.linkStartToHome != oldState.linkStartToHome) {
+        return false;
+    }
+    if (newStatus.cruiseSpeed != oldStatus.cruiseSpeed ||
+            newStatus.hoverSpeed != oldStatus.hoverSpeed ||
+            newStatus.vehicleSpeed != oldStatus.vehicleSpeed ||
+            newStatus.vehicleYaw != oldStatus.vehicleYaw) {
+        return false;
+    }
+    if ((newStatus.gimbalYaw != oldStatus.gimbalYaw && !(qIsNaN(newStatus.gimbalYaw) && qIsNaN(oldStatus.gimbalYaw))) ||
+            (newStatus.gimbalPitch != oldStatus.gimbalPitch && !(qIsNaN(newStatus.gimbalPitch) && qIsNaN(oldStatus.gimbalPitch)))) {
+        return false;
+    }
+
+    // The battery change point depends on where the cumulative totals cross the battery capacity, so it can only be
+    // carried over once it has been found
+    return newStatus.mAhBattery == 0 || newStatus.batteryChangePoint != -1;
+}
+
+/// Moves the saved states from index on over to the new running state of a converged recalc. The cumulative totals are
+/// offset by the difference at index and the running maximums are rebuilt from the saved item contributions.
+void MissionController::_shiftFlightStatusStates(int index, const FlightStatusState_t& newState)
+{
+    const MissionFlightStatus_t&    newStatus = newState.missionFlightStatus;
+    const MissionFlightStatus_t     oldStatus = _flightStatusStates[index].missionFlightStatus;
+
+    double totalDistanceDelta =     newStatus.totalDistance - oldStatus.totalDistance;
+    double totalTimeDelta =         newStatus.totalTime - oldStatus.totalTime;
+    double hoverDistanceDelta =     newStatus.hoverDistance - oldStatus.hoverDistance;
+    double hoverTimeDelta =         newStatus.hoverTime - oldStatus.hoverTime;
+    double cruiseDistanceDelta =    newStatus.cruiseDistance - oldStatus.cruiseDistance;
+    double cruiseTimeDelta =        newStatus.cruiseTime - oldStatus.cruiseTime;
+
+    double maxTelemetryDistance =   newStatus.maxTelemetryDistance;
+    double minAltSeen =             newState.minAltSeen;
+    double maxAltSeen =             newState.maxAltSeen;
+
+    for (int i=index; i<_flightStatusStates.count(); i++) {
+        FlightStatusState_t&    state = _flightStatusStates[i];
+        MissionFlightStatus_t&  status = state.missionFlightStatus;
+
+        status.totalDistance +=     totalDistanceDelta;
+        status.totalTime +=         totalTimeDelta;
+        status.hoverDistance +=     hoverDistanceDelta;
+        status.hoverTime +=         hoverTimeDelta;
+        status.cruiseDistance +=    cruiseDistanceDelta;
+        status.cruiseTime +=        cruiseTimeDelta;
+        status.maxTelemetryDistance = maxTelemetryDistance;
+        state.minAltSeen =          minAltSeen;
+        state.maxAltSeen =          maxAltSeen;
+
+        status.batteryChangePoint = newStatus.batteryChangePoint;
+        if (status.mAhBattery != 0 && status.batteriesRequired != -1) {
+            status.hoverAmpsTotal = (status.hoverTime / 60.0) * status.hoverAmps;
+            status.cruiseAmpsTotal = (status.cruiseTime / 60.0) * status.cruiseAmps;
+            status.batteriesRequired = ceil((status.hoverAmpsTotal + status.cruiseAmpsTotal) / status.ampMinutesAvailable);
+        }
+
+        maxTelemetryDistance =  qMax(maxTelemetryDistance, state.itemTelemetryDistance);
+        minAltSeen =            std::min(minAltSeen, state.itemMinAlt);
+        maxAltSeen =            std::max(maxAltSeen, state.itemMaxAlt);
+    }
+}
+
+/// Recalculates flight status for the items from startIndex on. Items before startIndex are untouched, the
+/// running totals are restored from the state saved before startIndex was processed by the previous pass.
+/// Once the pass is past the changed items and an item is handed the same state as in the previous pass, the rest of
+/// the list would calculate the same values again. The pass then stops and only the saved totals are patched up.
+///     @param startIndex       First item which changed, 0 for a full recalc
+///     @param lastChangedIndex Last item which changed, -1 to always recalc through to the end of the list
+void MissionController::_recalcMissionFlightStatusFrom(int startIndex, int lastChangedIndex)
+{
+    // Anything queued is covered by this pass as long as it doesn't start later
+    if (_recalcFlightStatusQueuedIndex >= startIndex) {
+        _recalcFlightStatusQueuedIndex = -1;
+    }
+
+    if (!_visualItems || !_visualItems->count()) {
         return;
     }
 
-    bool                firstCoordinateItem =   true;
-    VisualMissionItem*  lastCoordinateItem =    qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+    if (startIndex <= 0 || startIndex >= _visualItems->count() || _flightStatusStates.count() != _visualItems->count() + 1) {
+        // Changes to the settings item or outside of the items can affect everything
+        startIndex = 0;
+        lastChangedIndex = -1;
+    }
 
     bool showHomePosition = _settingsItem->coordinate().isValid();
+    const double homePositionAltitude = _settingsItem->coordinate().altitude();
 
-    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus";
+    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus startIndex" << startIndex;
 
     // If home position is valid we can calculate distances between all waypoints.
     // If home position is not valid we can only calculate distances between waypoints which are
     // both relative altitude.
 
-    // No values for first item
-    lastCoordinateItem->setAltDifference(0.0);
-    lastCoordinateItem->setAzimuth(0.0);
-    lastCoordinateItem->setDistance(0.0);
+    bool    firstCoordinateItem;
+    int     lastCoordinateItemIndex;
+    bool    vtolInHover;
+    bool    linkStartToHome;
+    double  minAltSeen;
+    double  maxAltSeen;
 
-    double minAltSeen = 0.0;
-    double maxAltSeen = 0.0;
-    const double homePositionAltitude = _settingsItem->coordinate().altitude();
-    minAltSeen = maxAltSeen = _settingsItem->coordinate().altitude();
+    if (startIndex == 0) {
+        // No values for first item
+        VisualMissionItem* firstItem = qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+        firstItem->setAltDifference(0.0);
+        firstItem->setAzimuth(0.0);
+        firstItem->setDistance(0.0);
 
-    _resetMissionFlightStatus();
+        _resetMissionFlightStatus();
+
+        firstCoordinateItem =       true;
+        lastCoordinateItemIndex =   0;
+        vtolInHover =               true;
+        linkStartToHome =           false;
+        minAltSeen = maxAltSeen =   homePositionAltitude;
+        _flightStatusStates.resize(_visualItems->count() + 1);
+    } else {
+        const FlightStatusState_t& state = _flightStatusStates[startIndex];
+        _missionFlightStatus =      state.missionFlightStatus;
+        firstCoordinateItem =       state.firstCoordinateItem;
+        lastCoordinateItemIndex =   state.lastCoordinateItemIndex;
+        vtolInHover =               state.vtolInHover;
+        linkStartToHome =           state.linkStartToHome;
+        minAltSeen =                state.minAltSeen;
+        maxAltSeen =                state.maxAltSeen;
+    }
+    VisualMissionItem* lastCoordinateItem = qobject_cast<VisualMissionItem*>(_visualItems->get(lastCoordinateItemIndex));
 
-    bool vtolInHover = true;
-    bool linkStartToHome = false;
     bool linkEndToHome = false;
 
     if (showHomePosition) {
@@ -1284,11 +1438,33 @@ void MissionController::_recalcMissionFlightStatus()
         }
     }
 
-    for (int i=0; i<_visualItems->count(); i++) {
+    int convergedIndex = -1;
+    for (int i=startIndex; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
         SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(item);
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(item);
 
+        FlightStatusState_t newState;
+        newState.missionFlightStatus =      _missionFlightStatus;
+        newState.firstCoordinateItem =      firstCoordinateItem;
+        newState.lastCoordinateItemIndex =  lastCoordinateItemIndex;
+        newState.vtolInHover =              vtolInHover;
+        newState.linkStartToHome =          linkStartToHome;
+        newState.minAltSeen =               minAltSeen;
+        newState.maxAltSeen =               maxAltSeen;
+        newState.itemTelemetryDistance =    0;
+        newState.itemMinAlt =               std::numeric_limits<double>::max();
+        newState.itemMaxAlt =               std::numeric_limits<double>::lowest();
+
+        if (lastChangedIndex != -1 && i > lastChangedIndex && _flightStatusConverged(_flightStatusStates[i], newState, startIndex, lastChangedIndex)) {
+            convergedIndex = i;
+            _shiftFlightStatusStates(i, newState);
+            break;
+        }
+
+        FlightStatusState_t& state = _flightStatusStates[i];
+        state = newState;
+
         // Assume the worst
         item->setAzimuth(0.0);
         item->setDistance(0.0);
@@ -1378,14 +1554,16 @@ void MissionController::_recalcMissionFlightStatus()
             if (item->coordinateHasRelativeAltitude()) {
                 absoluteAltitude += homePositionAltitude;
             }
-            minAltSeen = std::min(minAltSeen, absoluteAltitude);
-            maxAltSeen = std::max(maxAltSeen, absoluteAltitude);
+            state.itemMinAlt = std::min(state.itemMinAlt, absoluteAltitude);
+            state.itemMaxAlt = std::max(state.itemMaxAlt, absoluteAltitude);
 
             double terrainAltitude = item->terrainAltitude();
             if (!qIsNaN(terrainAltitude)) {
-                minAltSeen = std::min(minAltSeen, terrainAltitude);
-                maxAltSeen = std::max(maxAltSeen, terrainAltitude);
+                state.itemMinAlt = std::min(state.itemMinAlt, terrainAltitude);
+                state.itemMaxAlt = std::max(state.itemMaxAlt, terrainAltitude);
             }
+            minAltSeen = std::min(minAltSeen, state.itemMinAlt);
+            maxAltSeen = std::max(maxAltSeen, state.itemMaxAlt);
 
             if (!item->isStandaloneCoordinate()) {
                 firstCoordinateItem = false;
@@ -1405,7 +1583,8 @@ void MissionController::_recalcMissionFlightStatus()
                     item->setAzimuth(azimuth);
                     item->setDistance(distance);
 
-                    _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, _calcDistanceToHome(item, _settingsItem));
+                    state.itemTelemetryDistance = qMax(state.itemTelemetryDistance, _calcDistanceToHome(item, _settingsItem));
+                    _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, state.itemTelemetryDistance);
 
                     // Calculate time/distance
                     double hoverTime = distance / _missionFlightStatus.hoverSpeed;
@@ -1416,7 +1595,8 @@ void MissionController::_recalcMissionFlightStatus()
                 if (complexItem) {
                     // Add in distance/time inside complex items as well
                     double distance = complexItem->complexDistance();
-                    _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, complexItem->greatestDistanceTo(complexItem->exitCoordinate()));
+                    state.itemTelemetryDistance = qMax(state.itemTelemetryDistance, complexItem->greatestDistanceTo(complexItem->exitCoordinate()));
+                    _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, state.itemTelemetryDistance);
 
                     double hoverTime = distance / _missionFlightStatus.hoverSpeed;
                     double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
@@ -1426,9 +1606,33 @@ void MissionController::_recalcMissionFlightStatus()
                 item->setMissionFlightStatus(_missionFlightStatus);
 
                 lastCoordinateItem = item;
+                lastCoordinateItemIndex = i;
             }
         }
     }
+
+    FlightStatusState_t& endState = _flightStatusStates[_visualItems->count()];
+    if (convergedIndex == -1) {
+        endState.missionFlightStatus =      _missionFlightStatus;
+        endState.firstCoordinateItem =      firstCoordinateItem;
+        endState.lastCoordinateItemIndex =  lastCoordinateItemIndex;
+        endState.vtolInHover =              vtolInHover;
+        endState.linkStartToHome =          linkStartToHome;
+        endState.minAltSeen =               minAltSeen;
+        endState.maxAltSeen =               maxAltSeen;
+        endState.itemTelemetryDistance =    0;
+        endState.itemMinAlt =               std::numeric_limits<double>::max();
+        endState.itemMaxAlt =               std::numeric_limits<double>::lowest();
+    } else {
+        // Items from convergedIndex on are unchanged, pick up the patched up state after the last item
+        qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus converged at" << convergedIndex;
+        _missionFlightStatus =      endState.missionFlightStatus;
+        lastCoordinateItemIndex =   endState.lastCoordinateItemIndex;
+        vtolInHover =               endState.vtolInHover;
+        minAltSeen =                endState.minAltSeen;
+        maxAltSeen =                endState.maxAltSeen;
+        lastCoordinateItem =        qobject_cast<VisualMissionItem*>(_visualItems->get(lastCoordinateItemIndex));
+    }
     lastCoordinateItem->setMissionVehicleYaw(_missionFlightStatus.vehicleYaw);
 
     if (linkEndToHome && lastCoordinateItem != _settingsItem) {
@@ -1456,9 +1660,17 @@ void MissionController::_recalcMissionFlightStatus()
     emit batteryChangePointChanged(_missionFlightStatus.batteryChangePoint);
     emit batteriesRequiredChanged(_missionFlightStatus.batteriesRequired);
 
-    // Walk the list again calculating altitude percentages
+    // Walk the list again calculating altitude percentages. Items outside of the recalculated ones only change if the range did.
     double altRange = maxAltSeen - minAltSeen;
-    for (int i=0; i<_visualItems->count(); i++) {
+    int percentStartIndex = startIndex;
+    int percentEndIndex = convergedIndex == -1 ? _visualItems->count() : convergedIndex;
+    if (minAltSeen != _minAltSeen || maxAltSeen != _maxAltSeen) {
+        _minAltSeen = minAltSeen;
+        _maxAltSeen = maxAltSeen;
+        percentStartIndex = 0;
+        percentEndIndex = _visualItems->count();
+    }
+    for (int i=percentStartIndex; i<percentEndIndex; i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         if (item->specifiesCoordinate()) {
@@ -1487,6 +1699,45 @@ void MissionController::_recalcMissionFlightStatus()
     _updateTimer.start(UPDATE_TIMEOUT);
 }
 
+/// Flight status is recalculated from the item which signalled the change onwards. Bursts of changes are
+/// coalesced into a single pass on the next event loop turn.
+void MissionController::_queueRecalcMissionFlightStatus(void)
+{
+    int index = 0;
+    VisualMissionItem* item = qobject_cast<VisualMissionItem*>(sender());
+    if (item && _visualItems) {
+        index = qMax(0, _visualItems->indexOf(item));
+    }
+
+    if (_recalcFlightStatusQueuedIndex == -1) {
+        _recalcFlightStatusQueuedIndex = _recalcFlightStatusQueuedLastIndex = index;
+    } else {
+        _recalcFlightStatusQueuedIndex = qMin(_recalcFlightStatusQueuedIndex, index);
+        _recalcFlightStatusQueuedLastIndex = qMax(_recalcFlightStatusQueuedLastIndex, index);
+    }
+    _recalcTimer.start();
+}
+
+void MissionController::_queueRecalcWaypointLines(void)
+{
+    _recalcWaypointLinesQueued = true;
+    _recalcTimer.start();
+}
+
+void MissionController::_processQueuedRecalc(void)
+{
+    if (!_visualItems) {
+        return;
+    }
+
+    if (_recalcWaypointLinesQueued) {
+        // Also recalcs the flight status from the start
+        _recalcWaypointLines();
+    } else if (_recalcFlightStatusQueuedIndex != -1) {
+        _recalcMissionFlightStatusFrom(_recalcFlightStatusQueuedIndex, _recalcFlightStatusQueuedLastIndex);
+    }
+}
+
 // This will update the sequence numbers to be sequential starting from 0
 void MissionController::_recalcSequence(void)
 {
@@ -1510,21 +1761,30 @@ void MissionController::_recalcSequence(void)
 // This will update the child item hierarchy
 void MissionController::_recalcChildItems(void)
 {
-    VisualMissionItem* currentParentItem = qobject_cast<VisualMissionItem*>(_visualItems->get(0));
-
-    currentParentItem->childItems()->clear();
+    VisualMissionItem*  currentParentItem = qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+    QObjectList         currentChildItems;
 
     for (int i=1; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         // Set up non-coordinate item child hierarchy
         if (item->specifiesCoordinate()) {
-            item->childItems()->clear();
+            _setChildItems(currentParentItem, currentChildItems);
+            currentChildItems.clear();
             currentParentItem = item;
         } else if (item->isSimpleItem()) {
-            currentParentItem->childItems()->append(item);
+            currentChildItems.append(item);
         }
     }
+    _setChildItems(currentParentItem, currentChildItems);
+}
+
+/// Updates the child list of an item with a single model reset, only if the children actually changed
+void MissionController::_setChildItems(VisualMissionItem* parentItem, const QObjectList& childItems)
+{
+    if (*parentItem->childItems()->objectList() != childItems) {
+        parentItem->childItems()->resetObjectList(childItems);
+    }
 }
 
 void MissionController::_setPlannedHomePositionFromFirstCoordinate(const QGeoCoordinate& clickCoordinate)
@@ -1631,14 +1891,14 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
 {
     setDirty(false);
 
-    connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::coordinateHasRelativeAltitudeChanged,       this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::exitCoordinateHasRelativeAltitudeChanged,   this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_recalcMissionFlightStatus);
+    connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_queueRecalcWaypointLines);
+    connect(visualItem, &VisualMissionItem::coordinateHasRelativeAltitudeChanged,       this, &MissionController::_queueRecalcWaypointLines);
+    connect(visualItem, &VisualMissionItem::exitCoordinateHasRelativeAltitudeChanged,   this, &MissionController::_queueRecalcWaypointLines);
+    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_queueRecalcMissionFlightStatus);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_queueRecalcMissionFlightStatus);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_queueRecalcMissionFlightStatus);
+    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_queueRecalcMissionFlightStatus);
+    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_queueRecalcMissionFlightStatus);
     connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_recalcSequence);
 
     if (visualItem->isSimpleItem()) {
@@ -1652,8 +1912,8 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     } else {
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(visualItem);
         if (complexItem) {
-            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_recalcMissionFlightStatus);
-            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_recalcMissionFlightStatus);
+            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_queueRecalcMissionFlightStatus);
+            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_queueRecalcMissionFlightStatus);
         } else {
             qWarning() << "ComplexMissionItem not found";
         }
@@ -1698,8 +1958,8 @@ void MissionController::managerVehicleChanged(Vehicle* managerVehicle)
     connect(_missionManager, &MissionManager::resumeMissionReady,       this, &MissionController::resumeMissionReady);
     connect(_missionManager, &MissionManager::resumeMissionUploadFail,  this, &MissionController::resumeMissionUploadFail);
     connect(_managerVehicle, &Vehicle::homePositionChanged,             this, &MissionController::_managerVehicleHomePositionChanged);
-    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_recalcMissionFlightStatus);
-    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_recalcMissionFlightStatus);
+    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_queueRecalcMissionFlightStatus);
+    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_queueRecalcMissionFlightStatus);
     connect(_managerVehicle, &Vehicle::vehicleTypeChanged,              this, &MissionController::complexMissionItemNamesChanged);
 
     if (!_masterController->offline()) {
@@ -17,8 +17,11 @@
 #include "QGCLoggingCategory.h"
 
 #include "QGCGeoBoundingCube.h"
+#include "WaypointPathModel.h"
 
 #include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
 
 class CoordinateVector;
 class VisualMissionItem;
@@ -69,7 +72,7 @@ public:
 
     Q_PROPERTY(QmlObjectListModel*  visualItems             READ visualItems                NOTIFY visualItemsChanged)
     Q_PROPERTY(QmlObjectListModel*  waypointLines           READ waypointLines              NOTIFY waypointLinesChanged)        ///< Used by Plan view only for interactive editing
-    Q_PROPERTY(QVariantList         waypointPath            READ waypointPath               NOTIFY waypointPathChanged)         ///< Used by Fly view only for static display
+    Q_PROPERTY(WaypointPathModel*   waypointPath            READ waypointPath               CONSTANT)                           ///< Used by Fly view only for static display
     Q_PROPERTY(QStringList          complexMissionItemNames READ complexMissionItemNames    NOTIFY complexMissionItemNamesChanged)
     Q_PROPERTY(QGeoCoordinate       plannedHomePosition     READ plannedHomePosition        NOTIFY plannedHomePositionChanged)
 
@@ -169,7 +172,7 @@ public:
 
     QmlObjectListModel* visualItems                 (void) { return _visualItems; }
     QmlObjectListModel* waypointLines               (void) { return &_waypointLines; }
-    QVariantList        waypointPath                (void) { return _waypointPath; }
+    WaypointPathModel*  waypointPath                (void) { return &_waypointPath; }
     QStringList         complexMissionItemNames     (void) const;
     QGeoCoordinate      plannedHomePosition         (void) const;
     VisualMissionItem*  currentPlanViewItem         (void) const;
@@ -203,7 +206,6 @@ public:
 signals:
     void visualItemsChanged             (void);
     void waypointLinesChanged           (void);
-    void waypointPathChanged            (void);
     void newItemsFromVehicle            (void);
     void missionDistanceChanged         (double missionDistance);
     void missionTimeChanged             (void);
@@ -234,6 +236,9 @@ private slots:
     void _currentMissionIndexChanged(int sequenceNumber);
     void _recalcWaypointLines(void);
     void _recalcMissionFlightStatus(void);
+    void _queueRecalcWaypointLines(void);
+    void _queueRecalcMissionFlightStatus(void);
+    void _processQueuedRecalc(void);
     void _updateContainsItems(void);
     void _progressPctChanged(double progressPct);
     void _visualItemsDirtyChanged(bool dirty);
@@ -244,9 +249,26 @@ private slots:
     void _recalcAll(void);
 
 private:
+    /// Item types which can be loaded from a V2 mission file
+    typedef enum {
+        LoadItemSimple,
+        LoadItemSurvey,
+        LoadItemFixedWingLanding,
+        LoadItemStructureScan,
+        LoadItemCorridorScan,
+        LoadItemMissionSettings,
+    } LoadItemType_t;
+
+    /// Result of the parse pass of a V2 mission file, items are only created once the whole file has been validated
+    typedef struct {
+        LoadItemType_t  type;
+        QJsonObject     json;
+    } LoadItemInfo_t;
+
     void _init(void);
     void _recalcSequence(void);
     void _recalcChildItems(void);
+    void _setChildItems(VisualMissionItem* parentItem, const QObjectList& childItems);
     void _recalcAllWithClickCoordinate(QGeoCoordinate& clickCoordinate);
     void _initAllVisualItems(void);
     void _deinitAllVisualItems(void);
@@ -262,6 +284,8 @@ private:
     bool _loadJsonMissionFile(const QByteArray& bytes, QmlObjectListModel* visualItems, QString& errorString);
     bool _loadJsonMissionFileV1(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
     bool _loadJsonMissionFileV2(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
+    bool _parseJsonMissionItemsV2(const QJsonArray& rgItems, QList<LoadItemInfo_t>& rgItemInfo, QString& errorString);
+    VisualMissionItem* _createLoadedItem(const LoadItemInfo_t& itemInfo, QObject* parent, int& nextSequenceNumber, QString& errorString);
     bool _loadTextMissionFile(QTextStream& stream, QmlObjectListModel* visualItems, QString& errorString);
     int _nextSequenceNumber(void);
     void _scanForAdditionalSettings(QmlObjectListModel* visualItems, Vehicle* vehicle);
@@ -277,6 +301,7 @@ private:
     void _addTimeDistance(bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum);
     int _insertComplexMissionItemWorker(ComplexMissionItem* complexItem, int i);
     void _warnIfTerrainFrameUsed(void);
+    void _recalcMissionFlightStatusFrom(int startIndex, int lastChangedIndex);
 
 private:
     MissionManager*         _missionManager;
@@ -284,7 +309,7 @@ private:
     QmlObjectListModel*     _visualItems;
     MissionSettingsItem*    _settingsItem;
     QmlObjectListModel      _waypointLines;
-    QVariantList            _waypointPath;
+    WaypointPathModel       _waypointPath;
     CoordVectHashTable      _linesTable;
     bool                    _firstItemsFromVehicle;
     bool                    _itemsRequested;
@@ -299,6 +324,32 @@ private:
     QGCGeoBoundingCube      _travelBoundingCube;
     QGeoCoordinate          _takeoffCoordinate;
 
+    /// Running state of the flight status recalc before an item is processed, lets a recalc restart part way through the list
+    typedef struct {
+        MissionFlightStatus_t   missionFlightStatus;
+        bool                    firstCoordinateItem;
+        int                     lastCoordinateItemIndex;
+        bool                    vtolInHover;
+        bool                    linkStartToHome;
+        double                  minAltSeen;
+        double                  maxAltSeen;
+        // Contribution of the item itself to the running maximums, used to patch up later states when a recalc converges
+        double                  itemTelemetryDistance;
+        double                  itemMinAlt;
+        double                  itemMaxAlt;
+    } FlightStatusState_t;
+
+    bool _flightStatusConverged     (const FlightStatusState_t& oldState, const FlightStatusState_t& newState, int firstChangedIndex, int lastChangedIndex) const;
+    void _shiftFlightStatusStates   (int index, const FlightStatusState_t& newState);
+
+    QVector<FlightStatusState_t> _flightStatusStates;               ///< One entry per visual item plus the state after the last item
+    double                  _minAltSeen;                            ///< Altitude range used for the last altitude percentages
+    double                  _maxAltSeen;
+    QTimer                  _recalcTimer;                           ///< Coalesces queued recalcs into one pass per event loop turn
+    bool                    _recalcWaypointLinesQueued;
+    int                     _recalcFlightStatusQueuedIndex;         ///< First item needing a flight status recalc, -1 for none
+    int                     _recalcFlightStatusQueuedLastIndex;     ///< Last item needing a flight status recalc
+
     static const char*  _settingsGroup;
 
     // Json file keys for persistence
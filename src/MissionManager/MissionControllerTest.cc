@@ -17,6 +17,8 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 
+#include <QFile>
+
 MissionControllerTest::MissionControllerTest(void)
     : _multiSpyMissionController(NULL)
     , _multiSpyMissionItem(NULL)
@@ -218,12 +220,98 @@ void MissionControllerTest::_testGimbalRecalc(void)
     MissionSettingsItem* settingsItem = _missionController->visualItems()->value<MissionSettingsItem*>(0);
     settingsItem->cameraSection()->setSpecifyGimbal(true);
     settingsItem->cameraSection()->gimbalYaw()->setRawValue(0.0);
+    QTest::qWait(10);   // Recalc is coalesced to the next event loop pass
     for (int i=1; i<_missionController->visualItems()->count(); i++) {
         VisualMissionItem* visualItem = _missionController->visualItems()->value<VisualMissionItem*>(i);
         QCOMPARE(visualItem->missionGimbalYaw(), 0.0);
     }
 }
 
+void MissionControllerTest::_testCoalescedRecalc(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+    for (int i=1; i<=6; i++) {
+        _missionController->insertSimpleMissionItem(QGeoCoordinate(47.0 + i * 0.001, 8.0 + (i % 2) * 0.001, 50), i);
+    }
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+
+    // A burst of changes to items in the second half of the mission only recalcs once
+    QSignalSpy distanceSpy(_missionController, &MissionController::missionDistanceChanged);
+    for (int i=0; i<10; i++) {
+        visualItems->value<SimpleMissionItem*>(4)->setCoordinate(QGeoCoordinate(47.004, 8.002 + i * 0.0001, 50));
+        visualItems->value<SimpleMissionItem*>(5)->setCoordinate(QGeoCoordinate(47.005, 8.003 + i * 0.0001, 50));
+    }
+    QCOMPARE(distanceSpy.count(), 0);
+    QTest::qWait(10);
+    QCOMPARE(distanceSpy.count(), 1);
+
+    double incrementalDistance = _missionController->missionDistance();
+    double incrementalTime = _missionController->missionTime();
+    QList<double> incrementalItemDistances;
+    for (int i=0; i<visualItems->count(); i++) {
+        incrementalItemDistances.append(visualItems->value<VisualMissionItem*>(i)->distance());
+    }
+
+    // Moving the planned home position forces a full recalc, moving it back must give the same results
+    MissionSettingsItem* settingsItem = visualItems->value<MissionSettingsItem*>(0);
+    QGeoCoordinate homeCoordinate = settingsItem->coordinate();
+    settingsItem->setCoordinate(homeCoordinate.atDistanceAndAzimuth(100, 0));
+    settingsItem->setCoordinate(homeCoordinate);
+    QTest::qWait(10);
+
+    QVERIFY(qAbs(_missionController->missionDistance() - incrementalDistance) < 0.001);
+    QVERIFY(qAbs(_missionController->missionTime() - incrementalTime) < 0.001);
+    for (int i=0; i<visualItems->count(); i++) {
+        QVERIFY(qAbs(visualItems->value<VisualMissionItem*>(i)->distance() - incrementalItemDistances[i]) < 0.001);
+    }
+}
+
+void MissionControllerTest::_testConvergedRecalc(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+    for (int i=1; i<=40; i++) {
+        _missionController->insertSimpleMissionItem(QGeoCoordinate(47.0 + i * 0.001, 8.0 + (i % 3) * 0.001, 50 + (i % 5) * 10), i);
+    }
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+
+    // Moving an item in the middle of the mission only affects the items up to where the flight state is the same
+    // again. Every recalculated item resets its azimuth before setting it again, items further down must not be touched.
+    VisualMissionItem* downstreamItem = visualItems->value<VisualMissionItem*>(30);
+    QSignalSpy downstreamAzimuthSpy(downstreamItem, &VisualMissionItem::azimuthChanged);
+    visualItems->value<SimpleMissionItem*>(10)->setCoordinate(QGeoCoordinate(47.010, 8.004, 80));
+    QTest::qWait(10);
+    QCOMPARE(downstreamAzimuthSpy.count(), 0);
+
+    // Then an item past the first convergence point, which resumes from the patched up saved state
+    visualItems->value<SimpleMissionItem*>(35)->setCoordinate(QGeoCoordinate(47.035, 7.996, 150));
+    QTest::qWait(10);
+
+    double incrementalDistance =        _missionController->missionDistance();
+    double incrementalTime =            _missionController->missionTime();
+    double incrementalMaxTelemetry =    _missionController->missionMaxTelemetry();
+    QList<double> incrementalItemDistances;
+    QList<double> incrementalAltPercents;
+    for (int i=0; i<visualItems->count(); i++) {
+        incrementalItemDistances.append(visualItems->value<VisualMissionItem*>(i)->distance());
+        incrementalAltPercents.append(visualItems->value<VisualMissionItem*>(i)->altPercent());
+    }
+
+    // A full recalc must give the same results
+    MissionSettingsItem* settingsItem = visualItems->value<MissionSettingsItem*>(0);
+    QGeoCoordinate homeCoordinate = settingsItem->coordinate();
+    settingsItem->setCoordinate(homeCoordinate.atDistanceAndAzimuth(100, 0));
+    settingsItem->setCoordinate(homeCoordinate);
+    QTest::qWait(10);
+
+    QVERIFY(qAbs(_missionController->missionDistance() - incrementalDistance) < 0.001);
+    QVERIFY(qAbs(_missionController->missionTime() - incrementalTime) < 0.001);
+    QVERIFY(qAbs(_missionController->missionMaxTelemetry() - incrementalMaxTelemetry) < 0.001);
+    for (int i=0; i<visualItems->count(); i++) {
+        QVERIFY(qAbs(visualItems->value<VisualMissionItem*>(i)->distance() - incrementalItemDistances[i]) < 0.001);
+        QVERIFY(qAbs(visualItems->value<VisualMissionItem*>(i)->altPercent() - incrementalAltPercents[i]) < 0.001);
+    }
+}
+
 void MissionControllerTest::_testLoadJsonSectionAvailable(void)
 {
     _initForFirmwareType(MAV_AUTOPILOT_PX4);
@@ -247,3 +335,31 @@ void MissionControllerTest::_testLoadJsonSectionAvailable(void)
 
     }
 }
+
+void MissionControllerTest::_benchmarkLoadPlan_data(void)
+{
+    QTest::addColumn<QString>("filename");
+    QTest::addColumn<int>("itemCount");
+
+    // Old file format missions, so the legacy load path is measured along with the file read
+    QTest::newRow("100 waypoints") << QStringLiteral(":/unittest/100Waypoints.mission") << 99;
+    QTest::newRow("800 waypoints") << QStringLiteral(":/unittest/800Waypoints.mission") << 828;
+}
+
+void MissionControllerTest::_benchmarkLoadPlan(void)
+{
+    QFETCH(QString, filename);
+    QFETCH(int, itemCount);
+
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    QString errorString;
+    QBENCHMARK {
+        QFile file(filename);
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        QVERIFY2(_missionController->loadJsonFile(file, errorString), qPrintable(errorString));
+        // The previous item list is deleted later, don't let the lists pile up between iterations
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+    QCOMPARE(_missionController->visualItems()->count(), itemCount + 1);
+}
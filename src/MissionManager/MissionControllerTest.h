@@ -33,11 +33,15 @@ private slots:
     void cleanup(void);
 
     void _testGimbalRecalc(void);
+    void _testCoalescedRecalc(void);
+    void _testConvergedRecalc(void);
     void _testLoadJsonSectionAvailable(void);
     void _testEmptyVehicleAPM(void);
     void _testEmptyVehiclePX4(void);
     void _testAddWayppointAPM(void);
     void _testAddWayppointPX4(void);
+    void _benchmarkLoadPlan_data(void);
+    void _benchmarkLoadPlan(void);
 
 private:
 #if 0
@@ -329,3 +329,63 @@ void MissionManagerTest::_testReadFailureHandlingPX4(void)
     _initForFirmwareType(MAV_AUTOPILOT_PX4);
     _testReadFailureHandlingWorker();
 }
+
+/// Writes and then reads back a mission of the specified size
+void MissionManagerTest::_roundTrip(int itemCount, int transferWindow)
+{
+    _missionManager->setTransferWindow(transferWindow);
+    _multiSpyMissionManager->clearAllSignals();
+
+    // Editor has a home position item on the front, so we do the same
+    QList<MissionItem*> missionItems;
+    for (int i=0; i<=itemCount; i++) {
+        missionItems.append(new MissionItem(i, MAV_CMD_NAV_WAYPOINT, MAV_FRAME_GLOBAL_RELATIVE_ALT, 0, 0, 0, 0, 47.0 + i * 0.001, 8.0, 50, true, false, this));
+    }
+
+    _missionManager->writeMissionItems(missionItems);
+    QVERIFY(_multiSpyMissionManager->waitForSignalByIndex(sendCompleteSignalIndex, _missionManagerSignalWaitTime));
+    QVERIFY(!_multiSpyMissionManager->pullBoolFromSignalIndex(sendCompleteSignalIndex));
+    _multiSpyMissionManager->clearAllSignals();
+
+    _missionManager->loadFromVehicle();
+    QVERIFY(_multiSpyMissionManager->waitForSignalByIndex(newMissionItemsAvailableSignalIndex, _missionManagerSignalWaitTime));
+    QVERIFY(_multiSpyMissionManager->checkNoSignalByMask(errorSignalMask));
+    _multiSpyMissionManager->clearAllSignals();
+
+    // PX4 does not get the home position, the items must come back complete and in order
+    const QList<MissionItem*>& readItems = _missionManager->missionItems();
+    QCOMPARE(readItems.count(), itemCount);
+    for (int i=0; i<itemCount; i++) {
+        QCOMPARE(readItems[i]->sequenceNumber(), i);
+        // MISSION_ITEM carries the coordinate as a float
+        QVERIFY(qAbs(readItems[i]->param5() - (47.0 + (i + 1) * 0.001)) < 0.0001);
+    }
+}
+
+void MissionManagerTest::_testPipelinedTransferPX4(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    const int itemCount = 50;
+    const int transferWindow = 8;
+    _mockLink->setMissionLinkConditions(10 /* latencyMsecs */, 0 /* lossPercent */);
+
+    // Strict protocol: one item per round trip
+    _roundTrip(itemCount, 1 /* transferWindow */);
+    QCOMPARE(_mockLink->missionWriteRequestCount(), itemCount);
+    QCOMPARE(_mockLink->missionMaxReadRequestsInFlight(), 1);
+
+    // Pipelined: each round trip moves a whole window
+    _mockLink->setMissionTransferWindow(transferWindow);
+    _roundTrip(itemCount, transferWindow);
+    QCOMPARE(_mockLink->missionWriteRequestCount(), (itemCount + transferWindow - 1) / transferWindow);
+    QVERIFY(_mockLink->missionMaxReadRequestsInFlight() > 1);
+    QVERIFY(_mockLink->missionMaxReadRequestsInFlight() <= transferWindow);
+
+    // Lost items, requests and acks must be recovered by retries
+    _mockLink->setMissionLinkConditions(10 /* latencyMsecs */, 5 /* lossPercent */);
+    _roundTrip(itemCount, transferWindow);
+
+    _mockLink->setMissionLinkConditions(0, 0);
+    _mockLink->setMissionTransferWindow(1);
+}
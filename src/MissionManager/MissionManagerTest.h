@@ -31,12 +31,14 @@ private slots:
     void _testWriteFailureHandlingAPM(void);
     void _testReadFailureHandlingPX4(void);
     void _testReadFailureHandlingAPM(void);
+    void _testPipelinedTransferPX4(void);
 
 private:
     void _roundTripItems(MockLinkMissionItemHandler::FailureMode_t failureMode, bool shouldFail);
     void _writeItems(MockLinkMissionItemHandler::FailureMode_t failureMode, bool shouldFail);
     void _testWriteFailureHandlingWorker(void);
     void _testReadFailureHandlingWorker(void);
+    void _roundTrip(int itemCount, int transferWindow);
     
     static const TestCase_t _rgTestCases[];
     static const size_t     _cTestCases;
@@ -16,9 +16,13 @@
 #include "FirmwarePlugin.h"
 #include "MAVLinkProtocol.h"
 #include "QGCApplication.h"
+#include "SettingsManager.h"
+#include "AppSettings.h"
 #include "MissionCommandTree.h"
 #include "MissionCommandUIInfo.h"
 
+#include <algorithm>
+
 QGC_LOGGING_CATEGORY(PlanManagerLog, "PlanManagerLog")
 
 PlanManager::PlanManager(Vehicle* vehicle, MAV_MISSION_TYPE planType)
@@ -31,6 +35,8 @@ PlanManager::PlanManager(Vehicle* vehicle, MAV_MISSION_TYPE planType)
     , _resumeMission            (false)
     , _lastMissionRequest       (-1)
     , _missionItemCountToRead   (-1)
+    , _transferWindow           (0)
+    , _activeTransferWindow     (1)
     , _currentMissionIndex      (-1)
     , _lastCurrentIndex         (-1)
 {
@@ -199,7 +205,14 @@ void PlanManager::_ackTimeout(void)
         break;
     case AckMissionRequest:
         // MISSION_REQUEST is expected, or MISSION_ACK to end sequence
-        if (_itemIndicesToWrite.count() == 0) {
+        if (_itemIndicesToWrite.count() == 0 && _activeTransferWindow > 1 && _retryCount <= _maxRetryCount && _writeMissionItems.count() != 0) {
+            // A vehicle which accepts items ahead of their request answers a repeated last item with the final MISSION_ACK,
+            // which covers a lost ack.
+            _retryCount++;
+            qCDebug(PlanManagerLog) << QStringLiteral("Retrying %1 final MISSION_ITEM retry Count").arg(_planTypeString()) << _retryCount;
+            _sendMissionItem(_writeMissionItems.count() - 1, _vehicle->capabilityBits() & MAV_PROTOCOL_CAPABILITY_MISSION_INT);
+            _startAckTimeout(AckMissionRequest);
+        } else if (_itemIndicesToWrite.count() == 0) {
             // Vehicle did not send final MISSION_ACK at end of sequence
             _sendError(VehicleError, tr("Mission write failed, vehicle failed to send final ack."));
             _finishTransaction(false);
@@ -288,6 +301,9 @@ bool PlanManager::_checkForExpectedAck(AckType_t receivedAck)
 void PlanManager::_readTransactionComplete(void)
 {
     qCDebug(PlanManagerLog) << "_readTransactionComplete read sequence complete";
+
+    // Items can arrive out of order when more than one request is outstanding
+    std::sort(_missionItems.begin(), _missionItems.end(), [](const MissionItem* item1, const MissionItem* item2) { return item1->sequenceNumber() < item2->sequenceNumber(); });
     
     mavlink_message_t message;
     
@@ -345,8 +361,18 @@ void PlanManager::_requestNextMissionItem(void)
         return;
     }
 
-    qCDebug(PlanManagerLog) << QStringLiteral("_requestNextMissionItem %1 sequenceNumber:retry").arg(_planTypeString()) << _itemIndicesToRead[0] << _retryCount;
+    qCDebug(PlanManagerLog) << QStringLiteral("_requestNextMissionItem %1 sequenceNumber:window:retry").arg(_planTypeString()) << _itemIndicesToRead[0] << _activeTransferWindow << _retryCount;
+
+    // Request the whole window. On a retry this re-requests every item which is still outstanding.
+    int requestCount = qMin(_activeTransferWindow, _itemIndicesToRead.count());
+    for (int i=0; i<requestCount; i++) {
+        _requestMissionItem(_itemIndicesToRead[i]);
+    }
+    _startAckTimeout(AckMissionItem);
+}
 
+void PlanManager::_requestMissionItem(int sequenceNumber)
+{
     mavlink_message_t message;
     if (_vehicle->capabilityBits() & MAV_PROTOCOL_CAPABILITY_MISSION_INT) {
         mavlink_msg_mission_request_int_pack_chan(qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
@@ -355,8 +381,8 @@ void PlanManager::_requestNextMissionItem(void)
                                                   &message,
                                                   _vehicle->id(),
                                                   MAV_COMP_ID_AUTOPILOT1,
-                                                  _itemIndicesToRead[0],
-                _planType);
+                                                  sequenceNumber,
+                                                  _planType);
     } else {
         mavlink_msg_mission_request_pack_chan(qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
                                               qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
@@ -364,12 +390,11 @@ void PlanManager::_requestNextMissionItem(void)
                                               &message,
                                               _vehicle->id(),
                                               MAV_COMP_ID_AUTOPILOT1,
-                                              _itemIndicesToRead[0],
-                _planType);
+                                              sequenceNumber,
+                                              _planType);
     }
     
     _vehicle->sendMessageOnLink(_dedicatedLink, message);
-    _startAckTimeout(AckMissionItem);
 }
 
 void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool missionItemInt)
@@ -481,6 +506,12 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool miss
     _retryCount = 0;
     if (_itemIndicesToRead.count() == 0) {
         _readTransactionComplete();
+    } else if (_activeTransferWindow > 1) {
+        // The rest of the window is still outstanding, only the item which just moved into the window needs a request
+        if (_itemIndicesToRead.count() >= _activeTransferWindow) {
+            _requestMissionItem(_itemIndicesToRead[_activeTransferWindow - 1]);
+        }
+        _startAckTimeout(AckMissionItem);
     } else {
         _requestNextMissionItem();
     }
@@ -525,9 +556,31 @@ void PlanManager::_handleMissionRequest(const mavlink_message_t& message, bool m
     } else {
         _itemIndicesToWrite.removeOne(missionRequest.seq);
     }
-    
-    MissionItem* item = _writeMissionItems[missionRequest.seq];
-    qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionRequest %1 sequenceNumber:command").arg(_planTypeString()) << missionRequest.seq << item->command();
+    _retryCount = 0;
+
+    _sendMissionItem(missionRequest.seq, missionItemInt);
+
+    // Send the items which follow ahead of their requests. A vehicle which accepts them will not request them, which
+    // saves a round trip per item.
+    int aheadCount = 0;
+    for (int i=0; i<_itemIndicesToWrite.count() && aheadCount<_activeTransferWindow-1; ) {
+        int sequenceNumber = _itemIndicesToWrite[i];
+        if (sequenceNumber > missionRequest.seq) {
+            _itemIndicesToWrite.removeAt(i);
+            _sendMissionItem(sequenceNumber, missionItemInt);
+            aheadCount++;
+        } else {
+            i++;
+        }
+    }
+
+    _startAckTimeout(AckMissionRequest);
+}
+
+void PlanManager::_sendMissionItem(int sequenceNumber, bool missionItemInt)
+{
+    MissionItem* item = _writeMissionItems[sequenceNumber];
+    qCDebug(PlanManagerLog) << QStringLiteral("_sendMissionItem %1 sequenceNumber:command").arg(_planTypeString()) << sequenceNumber << item->command();
 
     mavlink_message_t   messageOut;
     if (missionItemInt) {
@@ -537,10 +590,10 @@ void PlanManager::_handleMissionRequest(const mavlink_message_t& message, bool m
                                                &messageOut,
                                                _vehicle->id(),
                                                MAV_COMP_ID_AUTOPILOT1,
-                                               missionRequest.seq,
+                                               sequenceNumber,
                                                item->frame(),
                                                item->command(),
-                                               missionRequest.seq == 0,
+                                               sequenceNumber == 0,
                                                item->autoContinue(),
                                                item->param1(),
                                                item->param2(),
@@ -557,10 +610,10 @@ void PlanManager::_handleMissionRequest(const mavlink_message_t& message, bool m
                                            &messageOut,
                                            _vehicle->id(),
                                            MAV_COMP_ID_AUTOPILOT1,
-                                           missionRequest.seq,
+                                           sequenceNumber,
                                            item->frame(),
                                            item->command(),
-                                           missionRequest.seq == 0,
+                                           sequenceNumber == 0,
                                            item->autoContinue(),
                                            item->param1(),
                                            item->param2(),
@@ -573,7 +626,6 @@ void PlanManager::_handleMissionRequest(const mavlink_message_t& message, bool m
     }
     
     _vehicle->sendMessageOnLink(_dedicatedLink, messageOut);
-    _startAckTimeout(AckMissionRequest);
 }
 
 void PlanManager::_handleMissionAck(const mavlink_message_t& message)
@@ -974,6 +1026,9 @@ void PlanManager::_setTransactionInProgress(TransactionType_t type)
 {
     if (_transactionInProgress  != type) {
         qCDebug(PlanManagerLog) << "_setTransactionInProgress" << _planTypeString() << type;
+        if (type != TransactionNone) {
+            _activeTransferWindow = qMax(1, _transferWindow > 0 ? _transferWindow : qgcApp()->toolbox()->settingsManager()->appSettings()->missionTransferWindow()->rawValue().toInt());
+        }
         _transactionInProgress = type;
         emit inProgressChanged(inProgress());
     }
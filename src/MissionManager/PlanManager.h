@@ -56,6 +56,11 @@ public:
     ///     Signals removeAllComplete when done
     void removeAll(void);
 
+    /// Overrides the number of items which can be in flight at once during a read or write. Takes effect on the
+    /// next transaction.
+    ///     @param transferWindow Number of items, 0 to use the missionTransferWindow setting
+    void setTransferWindow(int transferWindow) { _transferWindow = transferWindow; }
+
     /// Error codes returned in error signal
     typedef enum {
         InternalError,
@@ -117,6 +122,8 @@ protected:
     void _handleMissionRequest(const mavlink_message_t& message, bool missionItemInt);
     void _handleMissionAck(const mavlink_message_t& message);
     void _requestNextMissionItem(void);
+    void _requestMissionItem(int sequenceNumber);
+    void _sendMissionItem(int sequenceNumber, bool missionItemInt);
     void _clearMissionItems(void);
     void _sendError(ErrorCode_t errorCode, const QString& errorMsg);
     QString _ackTypeToString(AckType_t ackType);
@@ -148,6 +155,8 @@ protected:
     QList<int>          _itemIndicesToRead;     ///< List of mission items which still need to be requested from vehicle
     int                 _lastMissionRequest;    ///< Index of item last requested by MISSION_REQUEST
     int                 _missionItemCountToRead;///< Count of all mission items to read
+    int                 _transferWindow;        ///< Transfer window override, 0 for the setting
+    int                 _activeTransferWindow;  ///< Number of items which can be in flight during the current transaction
 
     QList<MissionItem*> _missionItems;          ///< Set of mission items on vehicle
     QList<MissionItem*> _writeMissionItems;     ///< Set of mission items currently being written to vehicle
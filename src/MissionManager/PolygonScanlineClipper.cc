@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PolygonScanlineClipper.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+PolygonScanlineClipper::PolygonScanlineClipper(const QList<QPolygonF>& rings)
+{
+    for (const QPolygonF& ring: rings) {
+        int count = ring.count();
+        if (count > 1 && ring.first() == ring.last()) {
+            count--;
+        }
+        if (count < 3) {
+            continue;
+        }
+        for (int i=0; i<count; i++) {
+            const QPointF& p1 = ring[i];
+            const QPointF& p2 = ring[(i + 1) % count];
+            if (p1 != p2) {
+                _edges.append({ p1, p2 });
+            }
+        }
+    }
+}
+
+QPointF PolygonScanlineClipper::rotatePoint(const QPointF& point, const QPointF& origin, double angle)
+{
+    QPointF rotated;
+    double radians = (M_PI / 180.0) * -angle;
+
+    rotated.setX(((point.x() - origin.x()) * cos(radians)) - ((point.y() - origin.y()) * sin(radians)) + origin.x());
+    rotated.setY(((point.x() - origin.x()) * sin(radians)) + ((point.y() - origin.y()) * cos(radians)) + origin.y());
+
+    return rotated;
+}
+
+QList<QLineF> PolygonScanlineClipper::_flatten(const QList<QList<QLineF>>& scanLines)
+{
+    QList<QLineF> segments;
+    for (const QList<QLineF>& scanLine: scanLines) {
+        segments.append(scanLine);
+    }
+    return segments;
+}
+
+QList<QLineF> PolygonScanlineClipper::clipVerticalLines(double firstX, double spacing, int lineCount) const
+{
+    return _flatten(_clip(_edges, firstX, spacing, lineCount));
+}
+
+QList<QLineF> PolygonScanlineClipper::clipRotatedLines(const QPointF& origin, double angle, double firstX, double spacing, int lineCount) const
+{
+    return _flatten(clipRotatedScanLines(origin, angle, firstX, spacing, lineCount));
+}
+
+QList<QList<QLineF>> PolygonScanlineClipper::clipRotatedScanLines(const QPointF& origin, double angle, double firstX, double spacing, int lineCount) const
+{
+    QVector<Edge_t> rotatedEdges;
+    rotatedEdges.reserve(_edges.count());
+    for (const Edge_t& edge: _edges) {
+        rotatedEdges.append({ rotatePoint(edge.p1, origin, -angle), rotatePoint(edge.p2, origin, -angle) });
+    }
+
+    QList<QList<QLineF>> scanLines = _clip(rotatedEdges, firstX, spacing, lineCount);
+    for (QList<QLineF>& scanLine: scanLines) {
+        for (QLineF& segment: scanLine) {
+            segment = QLineF(rotatePoint(segment.p1(), origin, angle), rotatePoint(segment.p2(), origin, angle));
+        }
+    }
+    return scanLines;
+}
+
+QList<QList<QLineF>> PolygonScanlineClipper::_clip(const QVector<Edge_t>& edges, double firstX, double spacing, int lineCount) const
+{
+    QList<QList<QLineF>> scanLines;
+
+    if (lineCount <= 0 || (lineCount > 1 && spacing <= 0)) {
+        return scanLines;
+    }
+
+    // Bucket the crossing of each edge by line. An edge covers the half open range [p1.x, p2.x) so a vertex shared
+    // by two edges is counted once when the line passes through the boundary and twice (or never) at a local extreme.
+    // This keeps the crossing count on every line even.
+    QVector<QVector<double>> crossings(lineCount);
+    for (const Edge_t& edge: edges) {
+        // Edges parallel to the lines never produce a crossing
+        if (edge.p1.x() == edge.p2.x()) {
+            continue;
+        }
+        const QPointF& left =   edge.p1.x() < edge.p2.x() ? edge.p1 : edge.p2;
+        const QPointF& right =  edge.p1.x() < edge.p2.x() ? edge.p2 : edge.p1;
+
+        double firstIndex = lineCount > 1 ? ceil((left.x() - firstX) / spacing) - 1 : 0;
+        double slope = (right.y() - left.y()) / (right.x() - left.x());
+
+        for (int i=static_cast<int>(qBound(0.0, firstIndex, static_cast<double>(lineCount))); i<lineCount; i++) {
+            double x = firstX + (i * spacing);
+            if (x < left.x()) {
+                continue;
+            }
+            if (x >= right.x()) {
+                break;
+            }
+            crossings[i].append(left.y() + ((x - left.x()) * slope));
+        }
+    }
+
+    for (int i=0; i<lineCount; i++) {
+        QVector<double>& lineCrossings = crossings[i];
+        if (lineCrossings.count() < 2) {
+            continue;
+        }
+        std::sort(lineCrossings.begin(), lineCrossings.end());
+
+        double x = firstX + (i * spacing);
+        QList<QLineF> segments;
+        for (int j=0; j+1<lineCrossings.count(); j+=2) {
+            if (lineCrossings[j] < lineCrossings[j+1]) {
+                segments.append(QLineF(x, lineCrossings[j], x, lineCrossings[j+1]));
+            }
+        }
+        if (!segments.isEmpty()) {
+            scanLines.append(segments);
+        }
+    }
+
+    return scanLines;
+}
@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QList>
+#include <QVector>
+#include <QPolygonF>
+#include <QLineF>
+
+/// Clips a set of evenly spaced parallel lines against an area in a local planar frame (for example NED meters).
+///
+/// The area is given as a list of rings: an outer boundary followed by any number of exclusion holes. Inside is
+/// determined with the even-odd rule, so ring winding does not matter and concave boundaries are supported directly.
+/// Edges are bucketed by the lines they cross, so a clip costs O(n + k log k) for n edges and k intersections instead
+/// of testing every line against every edge.
+class PolygonScanlineClipper
+{
+public:
+    /// @param rings Outer boundary followed by holes. Rings may be open or closed (last point == first point).
+    PolygonScanlineClipper(const QList<QPolygonF>& rings);
+
+    /// Clips the vertical lines x = firstX + i * spacing, for i in [0, lineCount).
+    ///     @return Inside segments ordered by line and then by increasing y. Each segment runs from low to high y.
+    QList<QLineF> clipVerticalLines(double firstX, double spacing, int lineCount) const;
+
+    /// Clips parallel lines which are vertical in a frame rotated by angle degrees about origin. The rotation
+    /// matches the one used for survey transect generation (positive angle rotates clockwise). Resulting segments
+    /// are rotated back into the original frame.
+    ///     @param firstX x of the first line in the rotated frame
+    QList<QLineF> clipRotatedLines(const QPointF& origin, double angle, double firstX, double spacing, int lineCount) const;
+
+    /// Same as clipRotatedLines but with the segments grouped by line. Lines which miss the area are left out.
+    ///     @return One entry per line, segments ordered along the line as for clipVerticalLines
+    QList<QList<QLineF>> clipRotatedScanLines(const QPointF& origin, double angle, double firstX, double spacing, int lineCount) const;
+
+    /// Rotates point about origin by angle degrees (positive clockwise)
+    static QPointF rotatePoint(const QPointF& point, const QPointF& origin, double angle);
+
+private:
+    typedef struct {
+        QPointF p1;
+        QPointF p2;
+    } Edge_t;
+
+    QList<QList<QLineF>>    _clip       (const QVector<Edge_t>& edges, double firstX, double spacing, int lineCount) const;
+    static QList<QLineF>    _flatten    (const QList<QList<QLineF>>& scanLines);
+
+    QVector<Edge_t> _edges;
+};
@@ -0,0 +1,188 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PolygonScanlineClipperTest.h"
+
+#include <QtMath>
+
+PolygonScanlineClipperTest::PolygonScanlineClipperTest(void)
+{
+
+}
+
+double PolygonScanlineClipperTest::_randomDouble(double min, double max)
+{
+    return min + ((max - min) * qrand() / RAND_MAX);
+}
+
+/// Star shaped polygons with random radii are concave in most places and never self intersect
+QPolygonF PolygonScanlineClipperTest::_randomStarPolygon(int vertexCount, double minRadius, double maxRadius, bool clockwise)
+{
+    QPolygonF polygon;
+    for (int i=0; i<vertexCount; i++) {
+        double angle = (clockwise ? -2.0 : 2.0) * M_PI * i / vertexCount;
+        double radius = _randomDouble(minRadius, maxRadius);
+        polygon << QPointF(radius * cos(angle), radius * sin(angle));
+    }
+    return polygon;
+}
+
+bool PolygonScanlineClipperTest::_segmentCovers(const QList<QLineF>& segments, double x, double y)
+{
+    for (const QLineF& segment: segments) {
+        if (segment.p1().x() == x && y >= segment.p1().y() && y <= segment.p2().y()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PolygonScanlineClipperTest::_testConcave(void)
+{
+    // C shape opening to the east. The line through the opening must be split in two.
+    QPolygonF polygon;
+    polygon << QPointF(0, 0) << QPointF(30, 0) << QPointF(30, 10) << QPointF(10, 10) << QPointF(10, 20) << QPointF(30, 20) << QPointF(30, 30) << QPointF(0, 30);
+
+    QList<QLineF> segments = PolygonScanlineClipper({ polygon }).clipVerticalLines(5, 15, 2);
+    QCOMPARE(segments.count(), 3);
+    QCOMPARE(segments[0], QLineF(5, 0, 5, 30));
+    QCOMPARE(segments[1], QLineF(20, 0, 20, 10));
+    QCOMPARE(segments[2], QLineF(20, 20, 20, 30));
+
+    // Grouped by line, the split line keeps both of its segments
+    QList<QList<QLineF>> scanLines = PolygonScanlineClipper({ polygon }).clipRotatedScanLines(QPointF(15, 15), 0, 5, 15, 2);
+    QCOMPARE(scanLines.count(), 2);
+    QCOMPARE(scanLines[0], QList<QLineF>({ segments[0] }));
+    QCOMPARE(scanLines[1], QList<QLineF>({ segments[1], segments[2] }));
+}
+
+void PolygonScanlineClipperTest::_testHole(void)
+{
+    QPolygonF outer;
+    outer << QPointF(0, 0) << QPointF(30, 0) << QPointF(30, 30) << QPointF(0, 30) << QPointF(0, 0);
+    QPolygonF hole;
+    hole << QPointF(10, 10) << QPointF(20, 10) << QPointF(20, 20) << QPointF(10, 20);
+
+    QList<QLineF> segments = PolygonScanlineClipper({ outer, hole }).clipVerticalLines(5, 10, 2);
+    QCOMPARE(segments.count(), 3);
+    QCOMPARE(segments[0], QLineF(5, 0, 5, 30));
+    QCOMPARE(segments[1], QLineF(15, 0, 15, 10));
+    QCOMPARE(segments[2], QLineF(15, 20, 15, 30));
+}
+
+void PolygonScanlineClipperTest::_testVertexHits(void)
+{
+    // Lines through the west and east points touch a single vertex and must not produce segments. The middle line
+    // passes through the north and south vertices.
+    QPolygonF diamond;
+    diamond << QPointF(0, 10) << QPointF(10, 0) << QPointF(20, 10) << QPointF(10, 20);
+
+    QList<QLineF> segments = PolygonScanlineClipper({ diamond }).clipVerticalLines(0, 10, 3);
+    QCOMPARE(segments.count(), 1);
+    QCOMPARE(segments[0], QLineF(10, 0, 10, 20));
+
+    // Line running along an edge and through a reflex vertex
+    QPolygonF notch;
+    notch << QPointF(0, 0) << QPointF(20, 0) << QPointF(20, 20) << QPointF(10, 10) << QPointF(0, 20);
+
+    segments = PolygonScanlineClipper({ notch }).clipVerticalLines(0, 10, 3);
+    QCOMPARE(segments.count(), 2);
+    QCOMPARE(segments[0], QLineF(0, 0, 0, 20));
+    QCOMPARE(segments[1], QLineF(10, 0, 10, 10));
+}
+
+void PolygonScanlineClipperTest::_testRotated(void)
+{
+    QPolygonF square;
+    square << QPointF(0, 0) << QPointF(30, 0) << QPointF(30, 30) << QPointF(0, 30);
+    QPointF center(15, 15);
+
+    // No rotation must match the vertical clip
+    PolygonScanlineClipper clipper({ square });
+    QCOMPARE(clipper.clipRotatedLines(center, 0, 5, 10, 3), clipper.clipVerticalLines(5, 10, 3));
+
+    // Rotated a quarter turn the lines run east/west
+    QList<QLineF> segments = clipper.clipRotatedLines(center, 90, 5, 10, 3);
+    QCOMPARE(segments.count(), 3);
+    for (const QLineF& segment: segments) {
+        QVERIFY(qAbs(segment.p1().y() - segment.p2().y()) < 1e-9);
+        QVERIFY(qAbs(segment.length() - 30) < 1e-9);
+    }
+
+    // All segments of a rotated clip run the same direction
+    segments = clipper.clipRotatedLines(center, 37, -20, 2, 35);
+    QVERIFY(segments.count() > 1);
+    for (const QLineF& segment: segments) {
+        QVERIFY(qAbs(segment.angleTo(segments.first())) < 1e-6 || qAbs(segment.angleTo(segments.first()) - 360) < 1e-6);
+    }
+}
+
+void PolygonScanlineClipperTest::_testRandomPolygons(void)
+{
+    // Compare the clipped segments against point in polygon tests at random locations along each line
+    qsrand(42);
+
+    for (int iteration=0; iteration<100; iteration++) {
+        QPolygonF outer = _randomStarPolygon(3 + (qrand() % 200), 50, 100, iteration & 1);
+        QPolygonF hole = _randomStarPolygon(3 + (qrand() % 20), 5, 20, !(iteration & 1));
+
+        double firstX = -110;
+        double spacing = _randomDouble(0.5, 5.0);
+        int lineCount = static_cast<int>(220 / spacing);
+
+        QList<QLineF> segments = PolygonScanlineClipper({ outer, hole }).clipVerticalLines(firstX, spacing, lineCount);
+        QVERIFY(!segments.isEmpty());
+
+        int segmentIndex = 0;
+        for (int i=0; i<lineCount; i++) {
+            double x = firstX + (i * spacing);
+
+            QList<QLineF> lineSegments;
+            while (segmentIndex < segments.count() && segments[segmentIndex].p1().x() == x) {
+                const QLineF& segment = segments[segmentIndex++];
+                QVERIFY(segment.p1().y() < segment.p2().y());
+                lineSegments.append(segment);
+            }
+
+            for (int j=0; j<20; j++) {
+                QPointF point(x, _randomDouble(-110, 110));
+                bool inside = outer.containsPoint(point, Qt::OddEvenFill) && !hole.containsPoint(point, Qt::OddEvenFill);
+                QCOMPARE(_segmentCovers(lineSegments, point.x(), point.y()), inside);
+            }
+        }
+        QCOMPARE(segmentIndex, segments.count());
+    }
+}
+
+void PolygonScanlineClipperTest::_benchmarkClip_data(void)
+{
+    QTest::addColumn<int>("vertexCount");
+    QTest::addColumn<int>("lineCount");
+
+    QTest::newRow("1000 vertices")  << 1000     << 500;
+    QTest::newRow("10000 vertices") << 10000    << 2000;
+}
+
+void PolygonScanlineClipperTest::_benchmarkClip(void)
+{
+    QFETCH(int, vertexCount);
+    QFETCH(int, lineCount);
+
+    qsrand(42);
+    QPolygonF outer = _randomStarPolygon(vertexCount, 500, 1000, false);
+    QPolygonF hole = _randomStarPolygon(vertexCount / 10, 100, 300, true);
+    PolygonScanlineClipper clipper({ outer, hole });
+    double spacing = 2000.0 / lineCount;
+
+    QList<QLineF> segments;
+    QBENCHMARK {
+        segments = clipper.clipRotatedLines(QPointF(0, 0), 30, -1000, spacing, lineCount);
+    }
+    QVERIFY(segments.count() >= lineCount / 2);
+}
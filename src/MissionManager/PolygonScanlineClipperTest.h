@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "PolygonScanlineClipper.h"
+
+class PolygonScanlineClipperTest : public UnitTest
+{
+    Q_OBJECT
+    
+public:
+    PolygonScanlineClipperTest(void);
+
+private slots:
+    void _testConcave(void);
+    void _testHole(void);
+    void _testVertexHits(void);
+    void _testRotated(void);
+    void _testRandomPolygons(void);
+    void _benchmarkClip_data(void);
+    void _benchmarkClip(void);
+
+private:
+    QPolygonF   _randomStarPolygon(int vertexCount, double minRadius, double maxRadius, bool clockwise);
+    double      _randomDouble(double min, double max);
+    bool        _segmentCovers(const QList<QLineF>& segments, double x, double y);
+};
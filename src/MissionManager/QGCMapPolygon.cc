@@ -13,6 +13,8 @@
 #include "QGCQGeoCoordinate.h"
 #include "QGCApplication.h"
 #include "ShapeFileHelper.h"
+#include "ShapeFileLoader.h"
+#include "SettingsManager.h"
 
 #include <QGeoRectangle>
 #include <QDebug>
@@ -29,6 +31,8 @@ QGCMapPolygon::QGCMapPolygon(QObject* parent)
     , _centerDrag           (false)
     , _ignoreCenterUpdates  (false)
     , _interactive          (false)
+    , _shapeFileLoader      (nullptr)
+    , _loadProgress         (0)
 {
     _init();
 }
@@ -39,6 +43,8 @@ QGCMapPolygon::QGCMapPolygon(const QGCMapPolygon& other, QObject* parent)
     , _centerDrag           (false)
     , _ignoreCenterUpdates  (false)
     , _interactive          (false)
+    , _shapeFileLoader      (nullptr)
+    , _loadProgress         (0)
 {
     *this = other;
 
@@ -460,6 +466,7 @@ bool QGCMapPolygon::loadKMLOrSHPFile(const QString& file)
         qgcApp()->showMessage(errorString);
         return false;
     }
+    ShapeFileHelper::simplify(rgCoords, _simplifyTolerance(), true /* closed */);
 
     clear();
     appendVertices(rgCoords);
@@ -467,6 +474,47 @@ bool QGCMapPolygon::loadKMLOrSHPFile(const QString& file)
     return true;
 }
 
+void QGCMapPolygon::loadKMLOrSHPFileInBackground(const QString& file)
+{
+    if (!_shapeFileLoader) {
+        _shapeFileLoader = new ShapeFileLoader(this);
+        connect(_shapeFileLoader, &ShapeFileLoader::loadComplete,   this, &QGCMapPolygon::_shapeFileLoadComplete);
+        connect(_shapeFileLoader, &ShapeFileLoader::progress,       this, &QGCMapPolygon::_shapeFileLoadProgress);
+    }
+    _shapeFileLoadProgress(0);
+    _shapeFileLoader->load(file, ShapeFileHelper::Polygon, _simplifyTolerance());
+    emit loadingChanged(true);
+}
+
+bool QGCMapPolygon::loading(void) const
+{
+    return _shapeFileLoader && _shapeFileLoader->loading();
+}
+
+void QGCMapPolygon::_shapeFileLoadComplete(bool success, QList<QGeoCoordinate> coords, QString errorString)
+{
+    if (success) {
+        clear();
+        appendVertices(coords);
+    } else {
+        qgcApp()->showMessage(errorString);
+    }
+    emit loadingChanged(false);
+}
+
+void QGCMapPolygon::_shapeFileLoadProgress(double fraction)
+{
+    if (_loadProgress != fraction) {
+        _loadProgress = fraction;
+        emit loadProgressChanged(fraction);
+    }
+}
+
+double QGCMapPolygon::_simplifyTolerance(void) const
+{
+    return qgcApp()->toolbox()->settingsManager()->appSettings()->shapeImportSimplifyTolerance()->rawValue().toDouble();
+}
+
 double QGCMapPolygon::area(void) const
 {
     // https://www.mathopenref.com/coordpolygonarea2.html
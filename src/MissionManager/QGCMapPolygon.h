@@ -17,6 +17,8 @@
 
 #include "QmlObjectListModel.h"
 
+class ShapeFileLoader;
+
 /// The QGCMapPolygon class provides a polygon which can be displayed on a map using a map visuals control.
 /// It maintains a representation of the polygon on QVariantList and QmlObjectListModel format.
 class QGCMapPolygon : public QObject
@@ -36,6 +38,8 @@ public:
     Q_PROPERTY(QGeoCoordinate       center      READ center         WRITE setCenter         NOTIFY centerChanged)
     Q_PROPERTY(bool                 centerDrag  READ centerDrag     WRITE setCenterDrag     NOTIFY centerDragChanged)
     Q_PROPERTY(bool                 interactive READ interactive    WRITE setInteractive    NOTIFY interactiveChanged)
+    Q_PROPERTY(bool                 loading     READ loading                                NOTIFY loadingChanged)      ///< true: background load in progress
+    Q_PROPERTY(double               loadProgress READ loadProgress                          NOTIFY loadProgressChanged) ///< Fraction (0-1) of the background load done
 
     Q_INVOKABLE void clear(void);
     Q_INVOKABLE void appendVertex(const QGeoCoordinate& coordinate);
@@ -60,6 +64,10 @@ public:
     /// @return true: success
     Q_INVOKABLE bool loadKMLOrSHPFile(const QString& file);
 
+    /// Loads a polygon from a KML/SHP file on a worker thread. The polygon is replaced once loading completes, load
+    /// errors are shown to the user.
+    void loadKMLOrSHPFileInBackground(const QString& file);
+
     /// Returns the path in a list of QGeoCoordinate's format
     QList<QGeoCoordinate> coordinateList(void) const;
 
@@ -94,6 +102,8 @@ public:
     QGeoCoordinate  center      (void) const { return _center; }
     bool            centerDrag  (void) const { return _centerDrag; }
     bool            interactive (void) const { return _interactive; }
+    bool            loading     (void) const;
+    double          loadProgress(void) const { return _loadProgress; }
 
     QVariantList        path        (void) const { return _polygonPath; }
     QmlObjectListModel* qmlPathModel(void) { return &_polygonModel; }
@@ -115,14 +125,19 @@ signals:
     void centerChanged      (QGeoCoordinate center);
     void centerDragChanged  (bool centerDrag);
     void interactiveChanged (bool interactive);
+    void loadingChanged     (bool loading);         ///< Signalled with false once a background load has replaced the path, or failed
+    void loadProgressChanged(double loadProgress);
 
 private slots:
     void _polygonModelCountChanged(int count);
     void _polygonModelDirtyChanged(bool dirty);
     void _updateCenter(void);
+    void _shapeFileLoadComplete(bool success, QList<QGeoCoordinate> coords, QString errorString);
+    void _shapeFileLoadProgress(double fraction);
 
 private:
     void _init(void);
+    double _simplifyTolerance(void) const;
     QPolygonF _toPolygonF(void) const;
     QGeoCoordinate _coordFromPointF(const QPointF& point) const;
     QPointF _pointFFromCoord(const QGeoCoordinate& coordinate) const;
@@ -134,6 +149,8 @@ private:
     bool                _centerDrag;
     bool                _ignoreCenterUpdates;
     bool                _interactive;
+    ShapeFileLoader*    _shapeFileLoader;
+    double              _loadProgress;
 };
 
 #endif
@@ -13,6 +13,8 @@
 #include "QGCQGeoCoordinate.h"
 #include "QGCApplication.h"
 #include "KMLFileHelper.h"
+#include "ShapeFileLoader.h"
+#include "SettingsManager.h"
 
 #include <QGeoRectangle>
 #include <QDebug>
@@ -27,6 +29,8 @@ QGCMapPolyline::QGCMapPolyline(QObject* parent)
     : QObject               (parent)
     , _dirty                (false)
     , _interactive          (false)
+    , _shapeFileLoader      (nullptr)
+    , _loadProgress         (0)
 {
     _init();
 }
@@ -35,6 +39,8 @@ QGCMapPolyline::QGCMapPolyline(const QGCMapPolyline& other, QObject* parent)
     : QObject               (parent)
     , _dirty                (false)
     , _interactive          (false)
+    , _shapeFileLoader      (nullptr)
+    , _loadProgress         (0)
 {
     *this = other;
 
@@ -258,15 +264,20 @@ QGeoCoordinate QGCMapPolyline::vertexCoordinate(int vertex) const
 }
 
 QList<QPointF> QGCMapPolyline::nedPolyline(void)
+{
+    return nedPolyline(coordinateList());
+}
+
+QList<QPointF> QGCMapPolyline::nedPolyline(const QList<QGeoCoordinate>& polyline)
 {
     QList<QPointF>  nedPolyline;
 
-    if (count() > 0) {
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+    if (polyline.count() > 0) {
+        QGeoCoordinate  tangentOrigin = polyline[0];
 
-        for (int i=0; i<_polylinePath.count(); i++) {
+        for (int i=0; i<polyline.count(); i++) {
             double y, x, down;
-            QGeoCoordinate vertex = vertexCoordinate(i);
+            const QGeoCoordinate& vertex = polyline[i];
             if (i == 0) {
                 // This avoids a nan calculation that comes out of convertGeoToNed
                 x = y = 0;
@@ -282,14 +293,19 @@ QList<QPointF> QGCMapPolyline::nedPolyline(void)
 
 
 QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
+{
+    return offsetPolyline(coordinateList(), distance);
+}
+
+QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(const QList<QGeoCoordinate>& polyline, double distance)
 {
     QList<QGeoCoordinate> rgNewPolyline;
 
     // I'm sure there is some beautiful famous algorithm to do this, but here is a brute force method
 
-    if (count() > 1) {
+    if (polyline.count() > 1) {
         // Convert the polygon to NED
-        QList<QPointF> rgNedVertices = nedPolyline();
+        QList<QPointF> rgNedVertices = nedPolyline(polyline);
 
         // Walk the edges, offsetting by the specified distance
         QList<QLineF> rgOffsetEdges;
@@ -310,7 +326,7 @@ QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
             rgOffsetEdges.append(offsetEdge);
         }
 
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+        QGeoCoordinate  tangentOrigin = polyline[0];
 
         // Add first vertex
         QGeoCoordinate coord;
@@ -345,6 +361,7 @@ bool QGCMapPolyline::loadKMLFile(const QString& kmlFile)
         qgcApp()->showMessage(errorString);
         return false;
     }
+    ShapeFileHelper::simplify(rgCoords, _simplifyTolerance(), false /* closed */);
 
     clear();
     appendVertices(rgCoords);
@@ -352,6 +369,47 @@ bool QGCMapPolyline::loadKMLFile(const QString& kmlFile)
     return true;
 }
 
+void QGCMapPolyline::loadKMLFileInBackground(const QString& kmlFile)
+{
+    if (!_shapeFileLoader) {
+        _shapeFileLoader = new ShapeFileLoader(this);
+        connect(_shapeFileLoader, &ShapeFileLoader::loadComplete,   this, &QGCMapPolyline::_shapeFileLoadComplete);
+        connect(_shapeFileLoader, &ShapeFileLoader::progress,       this, &QGCMapPolyline::_shapeFileLoadProgress);
+    }
+    _shapeFileLoadProgress(0);
+    _shapeFileLoader->load(kmlFile, ShapeFileHelper::Polyline, _simplifyTolerance());
+    emit loadingChanged(true);
+}
+
+bool QGCMapPolyline::loading(void) const
+{
+    return _shapeFileLoader && _shapeFileLoader->loading();
+}
+
+void QGCMapPolyline::_shapeFileLoadComplete(bool success, QList<QGeoCoordinate> coords, QString errorString)
+{
+    if (success) {
+        clear();
+        appendVertices(coords);
+    } else {
+        qgcApp()->showMessage(errorString);
+    }
+    emit loadingChanged(false);
+}
+
+void QGCMapPolyline::_shapeFileLoadProgress(double fraction)
+{
+    if (_loadProgress != fraction) {
+        _loadProgress = fraction;
+        emit loadProgressChanged(fraction);
+    }
+}
+
+double QGCMapPolyline::_simplifyTolerance(void) const
+{
+    return qgcApp()->toolbox()->settingsManager()->appSettings()->shapeImportSimplifyTolerance()->rawValue().toDouble();
+}
+
 void QGCMapPolyline::_polylineModelDirtyChanged(bool dirty)
 {
     if (dirty) {
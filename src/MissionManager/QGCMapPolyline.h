@@ -15,6 +15,8 @@
 
 #include "QmlObjectListModel.h"
 
+class ShapeFileLoader;
+
 class QGCMapPolyline : public QObject
 {
     Q_OBJECT
@@ -30,6 +32,8 @@ public:
     Q_PROPERTY(QmlObjectListModel*  pathModel   READ qmlPathModel                           CONSTANT)
     Q_PROPERTY(bool                 dirty       READ dirty          WRITE setDirty          NOTIFY dirtyChanged)
     Q_PROPERTY(bool                 interactive READ interactive    WRITE setInteractive    NOTIFY interactiveChanged)
+    Q_PROPERTY(bool                 loading     READ loading                                NOTIFY loadingChanged)      ///< true: background load in progress
+    Q_PROPERTY(double               loadProgress READ loadProgress                          NOTIFY loadProgressChanged) ///< Fraction (0-1) of the background load done
 
     Q_INVOKABLE void clear(void);
     Q_INVOKABLE void appendVertex(const QGeoCoordinate& coordinate);
@@ -48,10 +52,19 @@ public:
     /// @return Offset set of vertices
     QList<QGeoCoordinate> offsetPolyline(double distance);
 
+    /// Offsets the edges of the specified polyline by the specified distance in meters. Does not touch any
+    /// QGCMapPolyline state so it is safe to call from a worker thread.
+    /// @return Offset set of vertices
+    static QList<QGeoCoordinate> offsetPolyline(const QList<QGeoCoordinate>& polyline, double distance);
+
     /// Loads a polyline from a KML file
     /// @return true: success
     Q_INVOKABLE bool loadKMLFile(const QString& kmlFile);
 
+    /// Loads a polyline from a KML file on a worker thread. The polyline is replaced once loading completes, load
+    /// errors are shown to the user.
+    void loadKMLFileInBackground(const QString& kmlFile);
+
     /// Returns the path in a list of QGeoCoordinate's format
     QList<QGeoCoordinate> coordinateList(void) const;
 
@@ -72,6 +85,9 @@ public:
     /// Convert polyline to NED and return (D is ignored)
     QList<QPointF> nedPolyline(void);
 
+    /// Converts the specified polyline to NED using the first vertex as the tangent origin
+    static QList<QPointF> nedPolyline(const QList<QGeoCoordinate>& polyline);
+
     /// Returns the length of the polyline in meters
     double length(void) const;
 
@@ -81,6 +97,8 @@ public:
     bool            dirty       (void) const { return _dirty; }
     void            setDirty    (bool dirty);
     bool            interactive (void) const { return _interactive; }
+    bool            loading     (void) const;
+    double          loadProgress(void) const { return _loadProgress; }
     QVariantList    path        (void) const { return _polylinePath; }
 
     QmlObjectListModel* qmlPathModel(void) { return &_polylineModel; }
@@ -98,13 +116,18 @@ signals:
     void dirtyChanged       (bool dirty);
     void cleared            (void);
     void interactiveChanged (bool interactive);
+    void loadingChanged     (bool loading);         ///< Signalled with false once a background load has replaced the path, or failed
+    void loadProgressChanged(double loadProgress);
 
 private slots:
     void _polylineModelCountChanged(int count);
     void _polylineModelDirtyChanged(bool dirty);
+    void _shapeFileLoadComplete(bool success, QList<QGeoCoordinate> coords, QString errorString);
+    void _shapeFileLoadProgress(double fraction);
 
 private:
     void _init(void);
+    double _simplifyTolerance(void) const;
     QGeoCoordinate _coordFromPointF(const QPointF& point) const;
     QPointF _pointFFromCoord(const QGeoCoordinate& coordinate) const;
 
@@ -112,4 +135,6 @@ private:
     QmlObjectListModel  _polylineModel;
     bool                _dirty;
     bool                _interactive;
+    ShapeFileLoader*    _shapeFileLoader;
+    double              _loadProgress;
 };
@@ -86,13 +86,23 @@ StructureScanComplexItem::StructureScanComplexItem(Vehicle* vehicle, bool flyVie
     _recalcLayerInfo();
 
     if (!kmlOrShpFile.isEmpty()) {
-        _structurePolygon.loadKMLOrSHPFile(kmlOrShpFile);
-        _structurePolygon.setDirty(false);
+        // The shape only arrives once the background load completes, the item starts out clean from there
+        connect(&_structurePolygon, &QGCMapPolygon::loadingChanged, this, &StructureScanComplexItem::_shapeFileLoadingChanged);
+        _structurePolygon.loadKMLOrSHPFileInBackground(kmlOrShpFile);
     }
 
     setDirty(false);
 }
 
+void StructureScanComplexItem::_shapeFileLoadingChanged(bool loading)
+{
+    if (!loading) {
+        disconnect(&_structurePolygon, &QGCMapPolygon::loadingChanged, this, &StructureScanComplexItem::_shapeFileLoadingChanged);
+        _structurePolygon.setDirty(false);
+        setDirty(false);
+    }
+}
+
 void StructureScanComplexItem::_setScanDistance(double scanDistance)
 {
     if (!qFuzzyCompare(_scanDistance, scanDistance)) {
@@ -117,6 +117,7 @@ signals:
 private slots:
     void _setDirty(void);
     void _polygonDirtyChanged       (bool dirty);
+    void _shapeFileLoadingChanged   (bool loading);
     void _flightPathChanged         (void);
     void _clearInternal             (void);
     void _updateCoordinateAltitudes (void);
@@ -16,8 +16,10 @@
 #include "QGCQGeoCoordinate.h"
 #include "SettingsManager.h"
 #include "AppSettings.h"
+#include "PolygonScanlineClipper.h"
 
 #include <QPolygonF>
+#include <QtMath>
 
 QGC_LOGGING_CATEGORY(SurveyComplexItemLog, "SurveyComplexItemLog")
 
@@ -98,12 +100,22 @@ SurveyComplexItem::SurveyComplexItem(Vehicle* vehicle, bool flyView, const QStri
     connect(&_cameraCalc, &CameraCalc::distanceToSurfaceRelativeChanged, this, &SurveyComplexItem::exitCoordinateHasRelativeAltitudeChanged);
 
     if (!kmlOrShpFile.isEmpty()) {
-        _surveyAreaPolygon.loadKMLOrSHPFile(kmlOrShpFile);
-        _surveyAreaPolygon.setDirty(false);
+        // The shape only arrives once the background load completes, the item starts out clean from there
+        connect(&_surveyAreaPolygon, &QGCMapPolygon::loadingChanged, this, &SurveyComplexItem::_shapeFileLoadingChanged);
+        _surveyAreaPolygon.loadKMLOrSHPFileInBackground(kmlOrShpFile);
     }
     setDirty(false);
 }
 
+void SurveyComplexItem::_shapeFileLoadingChanged(bool loading)
+{
+    if (!loading) {
+        disconnect(&_surveyAreaPolygon, &QGCMapPolygon::loadingChanged, this, &SurveyComplexItem::_shapeFileLoadingChanged);
+        _surveyAreaPolygon.setDirty(false);
+        setDirty(false);
+    }
+}
+
 void SurveyComplexItem::save(QJsonArray&  planItems)
 {
     QJsonObject saveObject;
@@ -165,7 +177,7 @@ bool SurveyComplexItem::load(const QJsonObject& complexObject, int sequenceNumbe
         }
 
         // V2/3 doesn't include individual items so we need to rebuild manually
-        _rebuildTransects();
+        _rebuildTransectsNow();
     }
 
     return true;
@@ -437,7 +449,21 @@ bool SurveyComplexItem::_gridAngleIsNorthSouthTransects()
     return gridAngle < 45.0 || (gridAngle > 360.0 - 45.0) || (gridAngle > 90.0 + 45.0 && gridAngle < 270.0 - 45.0);
 }
 
-void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects)
+/// Splits scan line transects, which hold the end points of all segments along the scan line, into one transect per segment
+QList<QList<QGeoCoordinate>> SurveyComplexItem::_splitScanLines(const QList<QList<QGeoCoordinate>>& scanLines)
+{
+    QList<QList<QGeoCoordinate>> transects;
+
+    for (const QList<QGeoCoordinate>& scanLine: scanLines) {
+        for (int i=0; i+1<scanLine.count(); i+=2) {
+            transects.append({ scanLine[i], scanLine[i+1] });
+        }
+    }
+
+    return transects;
+}
+
+void SurveyComplexItem::_adjustTransectsToEntryPointLocation(int entryPoint, QList<QList<QGeoCoordinate>>& transects)
 {
     if (transects.count() == 0) {
         return;
@@ -446,10 +472,10 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
     bool reversePoints = false;
     bool reverseTransects = false;
 
-    if (_entryPoint == EntryLocationBottomLeft || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationBottomLeft || entryPoint == EntryLocationBottomRight) {
         reversePoints = true;
     }
-    if (_entryPoint == EntryLocationTopRight || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationTopRight || entryPoint == EntryLocationBottomRight) {
         reverseTransects = true;
     }
 
@@ -462,18 +488,7 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
         _reverseTransectOrder(transects);
     }
 
-    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << _entryPoint;
-}
-
-QPointF SurveyComplexItem::_rotatePoint(const QPointF& point, const QPointF& origin, double angle)
-{
-    QPointF rotated;
-    double radians = (M_PI / 180.0) * -angle;
-
-    rotated.setX(((point.x() - origin.x()) * cos(radians)) - ((point.y() - origin.y()) * sin(radians)) + origin.x());
-    rotated.setY(((point.x() - origin.x()) * sin(radians)) + ((point.y() - origin.y()) * cos(radians)) + origin.y());
-
-    return rotated;
+    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << entryPoint;
 }
 
 void SurveyComplexItem::_intersectLinesWithRect(const QList<QLineF>& lineList, const QRectF& boundRect, QList<QLineF>& resultLines)
@@ -533,73 +548,6 @@ void SurveyComplexItem::_intersectLinesWithRect(const QList<QLineF>& lineList, c
     }
 }
 
-void SurveyComplexItem::_intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines)
-{
-    resultLines.clear();
-
-    for (int i=0; i<lineList.count(); i++) {
-        const QLineF& line = lineList[i];
-        QList<QPointF> intersections;
-
-        // Intersect the line with all the polygon edges
-        for (int j=0; j<polygon.count()-1; j++) {
-            QPointF intersectPoint;
-            QLineF polygonLine = QLineF(polygon[j], polygon[j+1]);
-            if (line.intersect(polygonLine, &intersectPoint) == QLineF::BoundedIntersection) {
-                if (!intersections.contains(intersectPoint)) {
-                    intersections.append(intersectPoint);
-                }
-            }
-        }
-
-        // We now have one or more intersection points all along the same line. Find the two
-        // which are furthest away from each other to form the transect.
-        if (intersections.count() > 1) {
-            QPointF firstPoint;
-            QPointF secondPoint;
-            double currentMaxDistance = 0;
-
-            for (int i=0; i<intersections.count(); i++) {
-                for (int j=0; j<intersections.count(); j++) {
-                    QLineF lineTest(intersections[i], intersections[j]);
-                    \
-                    double newMaxDistance = lineTest.length();
-                    if (newMaxDistance > currentMaxDistance) {
-                        firstPoint = intersections[i];
-                        secondPoint = intersections[j];
-                        currentMaxDistance = newMaxDistance;
-                    }
-                }
-            }
-
-            resultLines += QLineF(firstPoint, secondPoint);
-        }
-    }
-}
-
-/// Adjust the line segments such that they are all going the same direction with respect to going from P1->P2
-void SurveyComplexItem::_adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines)
-{
-    qreal firstAngle = 0;
-    for (int i=0; i<lineList.count(); i++) {
-        const QLineF& line = lineList[i];
-        QLineF adjustedLine;
-
-        if (i == 0) {
-            firstAngle = line.angle();
-        }
-
-        if (qAbs(line.angle() - firstAngle) > 1.0) {
-            adjustedLine.setP1(line.p2());
-            adjustedLine.setP2(line.p1());
-        } else {
-            adjustedLine = line;
-        }
-
-        resultLines += adjustedLine;
-    }
-}
-
 double SurveyComplexItem::_clampGridAngle90(double gridAngle)
 {
     // Clamp grid angle to -90<->90. This prevents transects from being rotated to a reversed order.
@@ -749,54 +697,54 @@ double SurveyComplexItem::_turnaroundDistance(void) const
     return _turnAroundDistanceFact.rawValue().toDouble();
 }
 
-void SurveyComplexItem::_rebuildTransectsPhase1(void)
+TransectStyleComplexItem::TransectBuilder SurveyComplexItem::_transectBuilder(void)
 {
-    bool split = splitConcavePolygons()->rawValue().toBool();
-	if (split) {
-		_rebuildTransectsPhase1WorkerSplitPolygons(false /* refly */);
-	} else {
-		_rebuildTransectsPhase1WorkerSinglePolygon(false /* refly */);
-	}
-    if (_refly90DegreesFact.rawValue().toBool()) {
-    	if (split) {
-    		_rebuildTransectsPhase1WorkerSplitPolygons(true /* refly */);
-    	} else {
-    		_rebuildTransectsPhase1WorkerSinglePolygon(true /* refly */);
-    	}
-    }
+    TransectParams_t params;
+    params.polygon =                _surveyAreaPolygon.coordinateList();
+    params.gridAngle =              _gridAngleFact.rawValue().toDouble();
+    params.gridSpacing =            _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    params.entryPoint =             _entryPoint;
+    params.refly90Degrees =         _refly90DegreesFact.rawValue().toBool();
+    params.flyAlternateTransects =  _flyAlternateTransectsFact.rawValue().toBool();
+    params.splitConcavePolygons =   _splitConcavePolygonsFact.rawValue().toBool();
+    params.triggerCamera =          triggerCamera();
+    params.hoverAndCapture =        hoverAndCaptureEnabled();
+    params.triggerDistance =        triggerDistance();
+    params.turnAroundDistance =     _hasTurnaround() ? _turnaroundDistance() : 0;
+
+    return [params]() {
+        QList<QList<CoordInfo_t>> transects;
+        if (params.splitConcavePolygons) {
+            _rebuildTransectsPhase1WorkerSplitPolygons(params, false /* refly */, transects);
+        } else {
+            _rebuildTransectsPhase1WorkerSinglePolygon(params, false /* refly */, transects);
+        }
+        if (params.refly90Degrees) {
+            if (params.splitConcavePolygons) {
+                _rebuildTransectsPhase1WorkerSplitPolygons(params, true /* refly */, transects);
+            } else {
+                _rebuildTransectsPhase1WorkerSinglePolygon(params, true /* refly */, transects);
+            }
+        }
+        return transects;
+    };
 }
 
-void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
+void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(const TransectParams_t& params, bool refly, QList<QList<CoordInfo_t>>& coordInfoTransects)
 {
-    if (_ignoreRecalc) {
-        return;
-    }
-
-    // If the transects are getting rebuilt then any previously loaded mission items are now invalid
-    if (_loadedMissionItemsParent) {
-        _loadedMissionItems.clear();
-        _loadedMissionItemsParent->deleteLater();
-        _loadedMissionItemsParent = nullptr;
-    }
-
-    // First pass will clear old transect data, refly will append to existing data
-    if (!refly) {
-        _transects.clear();
-        _transectsPathHeightInfo.clear();
-    }
-
-    if (_surveyAreaPolygon.count() < 3) {
+    // Refly appends to the transects from the first pass
+    if (params.polygon.count() < 3) {
         return;
     }
 
     // Convert polygon to NED
 
     QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
+    QGeoCoordinate tangentOrigin = params.polygon[0];
+    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - polygon.count():tangentOrigin" << params.polygon.count() << tangentOrigin;
+    for (int i=0; i<params.polygon.count(); i++) {
         double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
+        QGeoCoordinate vertex = params.polygon[i];
         if (i == 0) {
             // This avoids a nan calculation that comes out of convertGeoToNed
             x = y = 0;
@@ -809,8 +757,8 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
 
     // Generate transects
 
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    double gridAngle = params.gridAngle;
+    double gridSpacing = params.gridSpacing;
 
     gridAngle = _clampGridAngle90(gridAngle);
     gridAngle += refly ? 90 : 0;
@@ -831,76 +779,48 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
     QPointF boundingCenter = boundingRect.center();
     qCDebug(SurveyComplexItemLog) << "Bounding rect" << boundingRect.topLeft().x() << boundingRect.topLeft().y() << boundingRect.bottomRight().x() << boundingRect.bottomRight().y();
 
-    // Create set of rotated parallel lines within the expanded bounding rect. Make the lines larger than the
-    // bounding box to guarantee intersection.
-
-    QList<QLineF> lineList;
-
-    // Transects are generated to be as long as the largest width/height of the bounding rect plus some fudge factor.
-    // This way they will always be guaranteed to intersect with a polygon edge no matter what angle they are rotated to.
-    // They are initially generated with the transects flowing from west to east and then points within the transect north to south.
+    // Clip a set of parallel lines, rotated to the grid angle about the bounding rect center, against the polygon.
+    // Transects are generated to cover the largest width/height of the bounding rect plus some fudge factor. This way
+    // they will always cover the polygon no matter what angle they are rotated to. In the rotated frame the transects
+    // flow from west to east and the points within a transect north to south. A concave polygon can produce more than one
+    // segment along the same scan line, those are kept together so the scan line is flown as a whole.
     double maxWidth = qMax(boundingRect.width(), boundingRect.height()) + 2000.0;
     double halfWidth = maxWidth / 2.0;
-    double transectX = boundingCenter.x() - halfWidth;
-    double transectXMax = transectX + maxWidth;
-    while (transectX < transectXMax) {
-        double transectYTop = boundingCenter.y() - halfWidth;
-        double transectYBottom = boundingCenter.y() + halfWidth;
-
-        lineList += QLineF(_rotatePoint(QPointF(transectX, transectYTop), boundingCenter, gridAngle), _rotatePoint(QPointF(transectX, transectYBottom), boundingCenter, gridAngle));
-        transectX += gridSpacing;
-    }
-
-    // Now intersect the lines with the polygon
-    QList<QLineF> intersectLines;
-#if 1
-    _intersectLinesWithPolygon(lineList, polygon, intersectLines);
-#else
-    // This is handy for debugging grid problems, not for release
-    intersectLines = lineList;
-#endif
-
-    // Less than two transects intersected with the polygon:
-    //      Create a single transect which goes through the center of the polygon
-    //      Intersect it with the polygon
-    if (intersectLines.count() < 2) {
-        _surveyAreaPolygon.center();
-        QLineF firstLine = lineList.first();
-        QPointF lineCenter = firstLine.pointAt(0.5);
-        QPointF centerOffset = boundingCenter - lineCenter;
-        firstLine.translate(centerOffset);
-        lineList.clear();
-        lineList.append(firstLine);
-        intersectLines = lineList;
-        _intersectLinesWithPolygon(lineList, polygon, intersectLines);
-    }
-
-    // Make sure all lines are going the same direction. Polygon intersection leads to lines which
-    // can be in varied directions depending on the order of the intesecting sides.
-    QList<QLineF> resultLines;
-    _adjustLineDirection(intersectLines, resultLines);
+    int lineCount = gridSpacing > 0 ? qCeil(maxWidth / gridSpacing) : 0;
+    PolygonScanlineClipper clipper({ polygon });
+    QList<QList<QLineF>> scanLines = clipper.clipRotatedScanLines(boundingCenter, gridAngle, boundingCenter.x() - halfWidth, gridSpacing, lineCount);
 
-    // Convert from NED to Geo
+    // Less than two scan lines intersected with the polygon:
+    //      Create a single scan line which goes through the center of the polygon
+    if (scanLines.count() < 2) {
+        scanLines = clipper.clipRotatedScanLines(boundingCenter, gridAngle, boundingCenter.x(), gridSpacing, 1);
+    }
+
+    // Convert from NED to Geo. Until the scan lines are split into segments below, each transect holds the end points of
+    // all segments along one scan line in order. Reversing the points of a transect then reverses the direction the scan
+    // line is flown as well as the order of its segments, and alternate transects are chosen per scan line.
     QList<QList<QGeoCoordinate>> transects;
-    for (const QLineF& line : resultLines) {
+    for (const QList<QLineF>& scanLine : scanLines) {
         QGeoCoordinate          coord;
         QList<QGeoCoordinate>   transect;
 
-        convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-        convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
+        for (const QLineF& line : scanLine) {
+            convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
+            transect.append(coord);
+            convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
+            transect.append(coord);
+        }
 
         transects.append(transect);
     }
 
-    _adjustTransectsToEntryPointLocation(transects);
+    _adjustTransectsToEntryPointLocation(params.entryPoint, transects);
 
     if (refly) {
-        _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
+        _optimizeTransectsForShortestDistance(coordInfoTransects.last().last().coord, transects);
     }
 
-    if (_flyAlternateTransectsFact.rawValue().toBool()) {
+    if (params.flyAlternateTransects) {
         QList<QList<QGeoCoordinate>> alternatingTransects;
         for (int i=0; i<transects.count(); i++) {
             if (!(i & 1)) {
@@ -933,7 +853,9 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         transects[i] = transectVertices;
     }
 
-    // Convert to CoordInfo transects and append to _transects
+    transects = _splitScanLines(transects);
+
+    // Convert to CoordInfo transects and append to coordInfoTransects
     for (const QList<QGeoCoordinate>& transect : transects) {
         QGeoCoordinate                                  coord;
         QList<TransectStyleComplexItem::CoordInfo_t>    coordInfoTransect;
@@ -945,14 +867,14 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         coordInfoTransect.append(coordInfo);
 
         // For hover and capture we need points for each camera location within the transect
-        if (triggerCamera() && hoverAndCaptureEnabled()) {
+        if (params.triggerCamera && params.hoverAndCapture) {
             double transectLength = transect[0].distanceTo(transect[1]);
             double transectAzimuth = transect[0].azimuthTo(transect[1]);
-            if (triggerDistance() < transectLength) {
-                int cInnerHoverPoints = static_cast<int>(floor(transectLength / triggerDistance()));
+            if (params.triggerDistance < transectLength) {
+                int cInnerHoverPoints = static_cast<int>(floor(transectLength / params.triggerDistance));
                 qCDebug(SurveyComplexItemLog) << "cInnerHoverPoints" << cInnerHoverPoints;
                 for (int i=0; i<cInnerHoverPoints; i++) {
-                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(triggerDistance() * (i + 1), transectAzimuth);
+                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(params.triggerDistance * (i + 1), transectAzimuth);
                     TransectStyleComplexItem::CoordInfo_t coordInfo = { hoverCoord, CoordTypeInteriorHoverTrigger };
                     coordInfoTransect.insert(1 + i, coordInfo);
                 }
@@ -960,9 +882,9 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         }
 
         // Extend the transect ends for turnaround
-        if (_hasTurnaround()) {
+        if (params.turnAroundDistance > 0) {
             QGeoCoordinate turnaroundCoord;
-            double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+            double turnAroundDistance = params.turnAroundDistance;
 
             double azimuth = transect[0].azimuthTo(transect[1]);
             turnaroundCoord = transect[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -977,42 +899,26 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
             coordInfoTransect.append(coordInfo);
         }
 
-        _transects.append(coordInfoTransect);
+        coordInfoTransects.append(coordInfoTransect);
     }
 }
 
 
-void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
+void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(const TransectParams_t& params, bool refly, QList<QList<CoordInfo_t>>& coordInfoTransects)
 {
-    if (_ignoreRecalc) {
-        return;
-    }
-
-    // If the transects are getting rebuilt then any previously loaded mission items are now invalid
-    if (_loadedMissionItemsParent) {
-        _loadedMissionItems.clear();
-        _loadedMissionItemsParent->deleteLater();
-        _loadedMissionItemsParent = nullptr;
-    }
-
-    // First pass will clear old transect data, refly will append to existing data
-    if (!refly) {
-        _transects.clear();
-        _transectsPathHeightInfo.clear();
-    }
-
-    if (_surveyAreaPolygon.count() < 3) {
+    // Refly appends to the transects from the first pass
+    if (params.polygon.count() < 3) {
         return;
     }
 
     // Convert polygon to NED
 
     QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
+    QGeoCoordinate tangentOrigin = params.polygon[0];
+    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - polygon.count():tangentOrigin" << params.polygon.count() << tangentOrigin;
+    for (int i=0; i<params.polygon.count(); i++) {
         double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
+        QGeoCoordinate vertex = params.polygon[i];
         if (i == 0) {
             // This avoids a nan calculation that comes out of convertGeoToNed
             x = y = 0;
@@ -1059,7 +965,7 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
         // TODO figure out tangent origin
         // TODO improve selection of entry points
 //        qCDebug(SurveyComplexItemLog) << "Transects from polynom p " << p;
-        _rebuildTransectsFromPolygon(refly, *p, tangentOrigin, vMatch);
+        _rebuildTransectsFromPolygon(params, refly, *p, tangentOrigin, vMatch, coordInfoTransects);
     }
 }
 
@@ -1210,12 +1116,12 @@ bool SurveyComplexItem::_VertexIsReflex(const QPolygonF& polygon, const QPointF*
 }
 
 
-void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF& polygon, const QGeoCoordinate& tangentOrigin, const QPointF* const transitionPoint)
+void SurveyComplexItem::_rebuildTransectsFromPolygon(const TransectParams_t& params, bool refly, const QPolygonF& polygon, const QGeoCoordinate& tangentOrigin, const QPointF* const transitionPoint, QList<QList<CoordInfo_t>>& coordInfoTransects)
 {
     // Generate transects
 
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    double gridAngle = params.gridAngle;
+    double gridSpacing = params.gridSpacing;
 
     gridAngle = _clampGridAngle90(gridAngle);
     gridAngle += refly ? 90 : 0;
@@ -1230,54 +1136,22 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
     QPointF boundingCenter = boundingRect.center();
     qCDebug(SurveyComplexItemLog) << "Bounding rect" << boundingRect.topLeft().x() << boundingRect.topLeft().y() << boundingRect.bottomRight().x() << boundingRect.bottomRight().y();
 
-    // Create set of rotated parallel lines within the expanded bounding rect. Make the lines larger than the
-    // bounding box to guarantee intersection.
-
-    QList<QLineF> lineList;
-
-    // Transects are generated to be as long as the largest width/height of the bounding rect plus some fudge factor.
-    // This way they will always be guaranteed to intersect with a polygon edge no matter what angle they are rotated to.
-    // They are initially generated with the transects flowing from west to east and then points within the transect north to south.
+    // Clip a set of parallel lines, rotated to the grid angle about the bounding rect center, against the polygon.
+    // Transects are generated to cover the largest width/height of the bounding rect plus some fudge factor. This way
+    // they will always cover the polygon no matter what angle they are rotated to. In the rotated frame the transects
+    // flow from west to east and the points within a transect north to south. A concave polygon can produce more than one
+    // segment along the same scan line, those are kept together so the scan line is flown as a whole.
     double maxWidth = qMax(boundingRect.width(), boundingRect.height()) + 2000.0;
     double halfWidth = maxWidth / 2.0;
-    double transectX = boundingCenter.x() - halfWidth;
-    double transectXMax = transectX + maxWidth;
-    while (transectX < transectXMax) {
-        double transectYTop = boundingCenter.y() - halfWidth;
-        double transectYBottom = boundingCenter.y() + halfWidth;
-
-        lineList += QLineF(_rotatePoint(QPointF(transectX, transectYTop), boundingCenter, gridAngle), _rotatePoint(QPointF(transectX, transectYBottom), boundingCenter, gridAngle));
-        transectX += gridSpacing;
-    }
-
-    // Now intersect the lines with the polygon
-    QList<QLineF> intersectLines;
-#if 1
-    _intersectLinesWithPolygon(lineList, polygon, intersectLines);
-#else
-    // This is handy for debugging grid problems, not for release
-    intersectLines = lineList;
-#endif
-
-    // Less than two transects intersected with the polygon:
-    //      Create a single transect which goes through the center of the polygon
-    //      Intersect it with the polygon
-    if (intersectLines.count() < 2) {
-        _surveyAreaPolygon.center();
-        QLineF firstLine = lineList.first();
-        QPointF lineCenter = firstLine.pointAt(0.5);
-        QPointF centerOffset = boundingCenter - lineCenter;
-        firstLine.translate(centerOffset);
-        lineList.clear();
-        lineList.append(firstLine);
-        intersectLines = lineList;
-        _intersectLinesWithPolygon(lineList, polygon, intersectLines);
-    }
-
-    // Make sure all lines are going the same direction. Polygon intersection leads to lines which
-    // can be in varied directions depending on the order of the intesecting sides.
-    QList<QLineF> resultLines;
-    _adjustLineDirection(intersectLines, resultLines);
+    int lineCount = gridSpacing > 0 ? qCeil(maxWidth / gridSpacing) : 0;
+    PolygonScanlineClipper clipper({ polygon });
+    QList<QList<QLineF>> scanLines = clipper.clipRotatedScanLines(boundingCenter, gridAngle, boundingCenter.x() - halfWidth, gridSpacing, lineCount);
+
+    // Less than two scan lines intersected with the polygon:
+    //      Create a single scan line which goes through the center of the polygon
+    if (scanLines.count() < 2) {
+        scanLines = clipper.clipRotatedScanLines(boundingCenter, gridAngle, boundingCenter.x(), gridSpacing, 1);
+    }
 
     // Convert from NED to Geo
     QList<QList<QGeoCoordinate>> transects;
@@ -1291,25 +1165,28 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         transects.append(transect);
     }
 
-    for (const QLineF& line: resultLines) {
+    // Each transect holds the end points of all segments along one scan line, see _rebuildTransectsPhase1WorkerSinglePolygon
+    for (const QList<QLineF>& scanLine: scanLines) {
         QList<QGeoCoordinate>   transect;
         QGeoCoordinate          coord;
 
-        convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-        convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
+        for (const QLineF& line: scanLine) {
+            convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
+            transect.append(coord);
+            convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
+            transect.append(coord);
+        }
 
         transects.append(transect);
     }
 
-    _adjustTransectsToEntryPointLocation(transects);
+    _adjustTransectsToEntryPointLocation(params.entryPoint, transects);
 
     if (refly) {
-        _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
+        _optimizeTransectsForShortestDistance(coordInfoTransects.last().last().coord, transects);
     }
 
-    if (_flyAlternateTransectsFact.rawValue().toBool()) {
+    if (params.flyAlternateTransects) {
         QList<QList<QGeoCoordinate>> alternatingTransects;
         for (int i=0; i<transects.count(); i++) {
             if (!(i & 1)) {
@@ -1342,7 +1219,9 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         transects[i] = transectVertices;
     }
 
-    // Convert to CoordInfo transects and append to _transects
+    transects = _splitScanLines(transects);
+
+    // Convert to CoordInfo transects and append to coordInfoTransects
     for (const QList<QGeoCoordinate>& transect: transects) {
         QGeoCoordinate                                  coord;
         QList<TransectStyleComplexItem::CoordInfo_t>    coordInfoTransect;
@@ -1354,14 +1233,14 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         coordInfoTransect.append(coordInfo);
 
         // For hover and capture we need points for each camera location within the transect
-        if (triggerCamera() && hoverAndCaptureEnabled()) {
+        if (params.triggerCamera && params.hoverAndCapture) {
             double transectLength = transect[0].distanceTo(transect[1]);
             double transectAzimuth = transect[0].azimuthTo(transect[1]);
-            if (triggerDistance() < transectLength) {
-                int cInnerHoverPoints = static_cast<int>(floor(transectLength / triggerDistance()));
+            if (params.triggerDistance < transectLength) {
+                int cInnerHoverPoints = static_cast<int>(floor(transectLength / params.triggerDistance));
                 qCDebug(SurveyComplexItemLog) << "cInnerHoverPoints" << cInnerHoverPoints;
                 for (int i=0; i<cInnerHoverPoints; i++) {
-                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(triggerDistance() * (i + 1), transectAzimuth);
+                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(params.triggerDistance * (i + 1), transectAzimuth);
                     TransectStyleComplexItem::CoordInfo_t coordInfo = { hoverCoord, CoordTypeInteriorHoverTrigger };
                     coordInfoTransect.insert(1 + i, coordInfo);
                 }
@@ -1369,9 +1248,9 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         }
 
         // Extend the transect ends for turnaround
-        if (_hasTurnaround()) {
+        if (params.turnAroundDistance > 0) {
             QGeoCoordinate turnaroundCoord;
-            double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+            double turnAroundDistance = params.turnAroundDistance;
 
             double azimuth = transect[0].azimuthTo(transect[1]);
             turnaroundCoord = transect[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -1386,9 +1265,9 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
             coordInfoTransect.append(coordInfo);
         }
 
-        _transects.append(coordInfoTransect);
+        coordInfoTransects.append(coordInfoTransect);
     }
-    qCDebug(SurveyComplexItemLog) << "_transects.size() " << _transects.size();
+    qCDebug(SurveyComplexItemLog) << "coordInfoTransects.size() " << coordInfoTransects.size();
 }
 
 void SurveyComplexItem::_recalcComplexDistance(void)
@@ -10,6 +10,8 @@
 #include "SurveyComplexItemTest.h"
 #include "QGCApplication.h"
 
+#include <algorithm>
+
 SurveyComplexItemTest::SurveyComplexItemTest(void)
     : _offlineVehicle(NULL)
 {
@@ -185,3 +187,119 @@ void SurveyComplexItemTest::_testItemCount(void)
     QCOMPARE(items.count() - 1, _surveyItem->lastSequenceNumber());
     items.clear();
 }
+
+void SurveyComplexItemTest::_testBackgroundBuild(void)
+{
+    _setPolygon();
+    _surveyItem->gridAngle()->setRawValue(45);
+    QVariantList syncPoints = _surveyItem->visualTransectPoints();
+    QVERIFY(syncPoints.count() > 0);
+
+    _surveyItem->setBuildTransectsInBackground(true);
+
+    // A burst of edits must collapse into builds which end up at the state of the last edit
+    for (double gridAngle=0; gridAngle<=45; gridAngle+=5) {
+        _surveyItem->gridAngle()->setRawValue(gridAngle);
+    }
+    QVERIFY(_surveyItem->buildingTransects());
+    QVERIFY(!_surveyItem->readyForSave());
+
+    QSignalSpy spyPoints(_surveyItem, &TransectStyleComplexItem::visualTransectPointsChanged);
+    while (_surveyItem->buildingTransects()) {
+        QVERIFY(spyPoints.wait(10000));
+    }
+    QVERIFY(_surveyItem->readyForSave());
+    QCOMPARE(_surveyItem->visualTransectPoints(), syncPoints);
+}
+
+/// Validates the visit order of a U shaped survey area. Scan lines through the notch cross the area twice, both segments
+/// must be flown one after the other in the same direction and the direction must alternate between scan lines.
+void SurveyComplexItemTest::_checkScanLineOrder(bool flyAlternateTransects)
+{
+    _surveyItem->flyAlternateTransects()->setRawValue(flyAlternateTransects);
+
+    QVariantList points = _surveyItem->visualTransectPoints();
+    QVERIFY(points.count() > 0);
+    QCOMPARE(points.count() % 2, 0);
+
+    // Group the segments by scan line in visit order, a scan line must not show up again once it is left
+    QList<double>                   lineLongitudes;
+    QList<QList<QGeoCoordinate>>    lines;
+    for (int i=0; i<points.count(); i+=2) {
+        QGeoCoordinate entry =  points[i].value<QGeoCoordinate>();
+        QGeoCoordinate exit =   points[i+1].value<QGeoCoordinate>();
+        QVERIFY(qAbs(entry.longitude() - exit.longitude()) < 1e-5);
+        if (lineLongitudes.isEmpty() || qAbs(lineLongitudes.last() - entry.longitude()) > 1e-5) {
+            for (double longitude: lineLongitudes) {
+                QVERIFY(qAbs(longitude - entry.longitude()) > 1e-5);
+            }
+            lineLongitudes.append(entry.longitude());
+            lines.append(QList<QGeoCoordinate>());
+        }
+        lines.last() << entry << exit;
+    }
+
+    // Lines at 35 and 80 meters east miss the notch, the remaining four cross it
+    QCOMPARE(lines.count(), 6);
+    int splitLines = 0;
+    for (const QList<QGeoCoordinate>& line: lines) {
+        if (line.count() == 4) {
+            splitLines++;
+        }
+    }
+    QCOMPARE(splitLines, 4);
+
+    // Points along a scan line move in the flight direction, which alternates between the scan lines flown
+    bool previousNorthbound = false;
+    for (int i=0; i<lines.count(); i++) {
+        const QList<QGeoCoordinate>& line = lines[i];
+        bool northbound = line.last().latitude() > line.first().latitude();
+        for (int j=1; j<line.count(); j++) {
+            QCOMPARE(line[j].latitude() > line[j-1].latitude(), northbound);
+        }
+        if (i > 0) {
+            QVERIFY(northbound != previousNorthbound);
+        }
+        previousNorthbound = northbound;
+    }
+
+    // Scan lines are visited west to east (or east to west), with alternate transects every other line first and the
+    // skipped lines on the way back
+    QList<double> sortedLongitudes = lineLongitudes;
+    std::sort(sortedLongitudes.begin(), sortedLongitudes.end());
+    if (lineLongitudes.first() != sortedLongitudes.first()) {
+        std::reverse(sortedLongitudes.begin(), sortedLongitudes.end());
+    }
+    QList<double> expectedLongitudes;
+    if (flyAlternateTransects) {
+        for (int i=0; i<sortedLongitudes.count(); i+=2) {
+            expectedLongitudes.append(sortedLongitudes[i]);
+        }
+        for (int i=sortedLongitudes.count()-1; i>0; i--) {
+            if (i & 1) {
+                expectedLongitudes.append(sortedLongitudes[i]);
+            }
+        }
+    } else {
+        expectedLongitudes = sortedLongitudes;
+    }
+    QCOMPARE(lineLongitudes, expectedLongitudes);
+}
+
+void SurveyComplexItemTest::_testConcaveScanLines(void)
+{
+    // U shaped area, 300 meters square with a 100 meter wide notch cut in from the east side
+    QGeoCoordinate origin(47.633, -122.088);
+    QList<QPointF> eastNorthPoints = { QPointF(0, 0), QPointF(300, 0), QPointF(300, 100), QPointF(100, 100), QPointF(100, 200), QPointF(300, 200), QPointF(300, 300), QPointF(0, 300) };
+    for (const QPointF& point: eastNorthPoints) {
+        _mapPolygon->appendVertex(origin.atDistanceAndAzimuth(point.y(), 0).atDistanceAndAzimuth(point.x(), 90));
+    }
+
+    // North/south scan lines 45 meters apart, none of them through a vertex
+    _surveyItem->cameraCalc()->cameraName()->setRawValue(CameraCalc::manualCameraName());
+    _surveyItem->cameraCalc()->adjustedFootprintSide()->setRawValue(45);
+    _surveyItem->gridAngle()->setRawValue(0);
+
+    _checkScanLineOrder(false /* flyAlternateTransects */);
+    _checkScanLineOrder(true /* flyAlternateTransects */);
+}
@@ -33,11 +33,14 @@ private slots:
     void _testGridAngle(void);
     void _testEntryLocation(void);
     void _testItemCount(void);
+    void _testBackgroundBuild(void);
+    void _testConcaveScanLines(void);
 
 private:
 
     double _clampGridAngle180(double gridAngle);
     void _setPolygon(void);
+    void _checkScanLineOrder(bool flyAlternateTransects);
 
     // SurveyComplexItem signals
 
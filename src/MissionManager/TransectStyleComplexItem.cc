@@ -16,8 +16,10 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 #include "QGCQGeoCoordinate.h"
+#include "QGCApplication.h"
 
 #include <QPolygonF>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(TransectStyleComplexItemLog, "TransectStyleComplexItemLog")
 
@@ -43,6 +45,8 @@ TransectStyleComplexItem::TransectStyleComplexItem(Vehicle* vehicle, bool flyVie
     : ComplexMissionItem                (vehicle, flyView, parent)
     , _sequenceNumber                   (0)
     , _terrainPolyPathQuery             (nullptr)
+    , _terrainAdjustGeneration          (new QAtomicInt(0))
+    , _buildTransectsInBackground       (!qgcApp()->runningUnitTests())
     , _ignoreRecalc                     (false)
     , _complexDistance                  (0)
     , _cameraShots                      (0)
@@ -57,6 +61,9 @@ TransectStyleComplexItem::TransectStyleComplexItem(Vehicle* vehicle, bool flyVie
     , _terrainAdjustToleranceFact       (settingsGroup, _metaDataMap[terrainAdjustToleranceName])
     , _terrainAdjustMaxClimbRateFact    (settingsGroup, _metaDataMap[terrainAdjustMaxClimbRateName])
     , _terrainAdjustMaxDescentRateFact  (settingsGroup, _metaDataMap[terrainAdjustMaxDescentRateName])
+    , _transectBuildWatcher             (nullptr)
+    , _transectBuildGeneration          (0)
+    , _transectBuildPending             (false)
 {
     _terrainQueryTimer.setInterval(_terrainQueryTimeoutMsecs);
     _terrainQueryTimer.setSingleShot(true);
@@ -227,6 +234,9 @@ bool TransectStyleComplexItem::_load(const QJsonObject& complexObject, QString&
     _coordinate = _visualTransectPoints.count() ? _visualTransectPoints.first().value<QGeoCoordinate>() : QGeoCoordinate();
     _exitCoordinate = _visualTransectPoints.count() ? _visualTransectPoints.last().value<QGeoCoordinate>() : QGeoCoordinate();
 
+    // Any build in progress is for the state before the load
+    _cancelTransectBuild();
+
     // Load generated mission items
     _loadedMissionItemsParent = new QObject(this);
     QJsonArray missionItemsJsonArray = innerObject[_jsonItemsKey].toArray();
@@ -344,13 +354,99 @@ bool TransectStyleComplexItem::hoverAndCaptureAllowed(void) const
     return _vehicle->multiRotor() || _vehicle->vtol();
 }
 
+/// Requests a rebuild of the transects from the current item state. Rebuilds run on a worker thread one at a time. Requests
+/// which come in while a build is running collapse into a single build from the newest state once it completes.
 void TransectStyleComplexItem::_rebuildTransects(void)
 {
     if (_ignoreRecalc) {
         return;
     }
 
-    _rebuildTransectsPhase1();
+    if (!_buildTransectsInBackground) {
+        _rebuildTransectsNow();
+        return;
+    }
+
+    // Terrain data and adjustments in flight are for the old transects
+    _cancelTerrainAdjust();
+
+    _transectBuildGeneration++;
+    if (_transectBuildWatcher) {
+        _transectBuildPending = true;
+    } else {
+        _startTransectBuild();
+    }
+}
+
+/// Rebuilds the transects synchronously, superseding any build running on a worker thread
+void TransectStyleComplexItem::_rebuildTransectsNow(void)
+{
+    if (_ignoreRecalc) {
+        return;
+    }
+
+    _cancelTerrainAdjust();
+    _cancelTransectBuild();
+
+    TransectBuilder builder = _transectBuilder();
+    _publishTransects(builder());
+}
+
+void TransectStyleComplexItem::_startTransectBuild(void)
+{
+    // The builder holds a snapshot of the item state, the worker never touches the item itself
+    TransectBuilder builder =       _transectBuilder();
+    int             generation =    _transectBuildGeneration;
+
+    _transectBuildPending = false;
+    _transectBuildWatcher = new QFutureWatcher<TransectBuildResult_t>(this);
+    connect(_transectBuildWatcher, &QFutureWatcherBase::finished, this, &TransectStyleComplexItem::_transectBuildDone);
+    _transectBuildWatcher->setFuture(QtConcurrent::run([builder, generation]() {
+        TransectBuildResult_t result;
+        result.generation = generation;
+        result.transects =  builder();
+        return result;
+    }));
+}
+
+void TransectStyleComplexItem::_transectBuildDone(void)
+{
+    TransectBuildResult_t result = _transectBuildWatcher->result();
+    _transectBuildWatcher->deleteLater();
+    _transectBuildWatcher = nullptr;
+
+    if (_transectBuildPending) {
+        qCDebug(TransectStyleComplexItemLog) << "_transectBuildDone dropping superseded result generation" << result.generation;
+        _startTransectBuild();
+        return;
+    }
+    if (result.generation != _transectBuildGeneration || _ignoreRecalc) {
+        qCDebug(TransectStyleComplexItemLog) << "_transectBuildDone dropping cancelled result generation" << result.generation;
+        return;
+    }
+
+    _publishTransects(result.transects);
+}
+
+/// Drops pending rebuild requests and makes sure the result of a running build is never published
+void TransectStyleComplexItem::_cancelTransectBuild(void)
+{
+    _transectBuildGeneration++;
+    _transectBuildPending = false;
+}
+
+/// Phase 2 of a rebuild: takes over newly built transects and updates everything derived from them
+void TransectStyleComplexItem::_publishTransects(const QList<QList<CoordInfo_t>>& transects)
+{
+    // If the transects are getting rebuilt then any previously loaded mission items are now invalid
+    if (_loadedMissionItemsParent) {
+        _loadedMissionItems.clear();
+        _loadedMissionItemsParent->deleteLater();
+        _loadedMissionItemsParent = nullptr;
+    }
+
+    _transects = transects;
+    _transectsPathHeightInfo.clear();
 
     if (_followTerrain) {
         // Query the terrain data. Once available terrain heights will be calculated
@@ -457,61 +553,136 @@ void TransectStyleComplexItem::_reallyQueryTransectsPathHeightInfo(void)
 
 void TransectStyleComplexItem::_polyPathTerrainData(bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo)
 {
+    if (_terrainPolyPathQuery != sender()) {
+        qWarning() << "TransectStyleComplexItem::_polyPathTerrainData _terrainPolyPathQuery != sender()";
+    }
+    disconnect(_terrainPolyPathQuery, &TerrainPolyPathQuery::terrainDataReceived, this, &TransectStyleComplexItem::_polyPathTerrainData);
+    _terrainPolyPathQuery = nullptr;
+
     _transectsPathHeightInfo.clear();
 
     if (success) {
         // Break out into individual transects
+        QList<QList<TerrainPathQuery::PathHeightInfo_t>> transectsPathHeightInfo;
         int pathHeightIndex = 0;
         for (int i=0; i<_transects.count(); i++) {
-            _transectsPathHeightInfo.append(QList<TerrainPathQuery::PathHeightInfo_t>());
+            transectsPathHeightInfo.append(QList<TerrainPathQuery::PathHeightInfo_t>());
             int cPathHeight = _transects[i].count() - 1;
             while (cPathHeight-- > 0) {
-                _transectsPathHeightInfo[i].append(rgPathHeightInfo[pathHeightIndex++]);
+                if (pathHeightIndex >= rgPathHeightInfo.count()) {
+                    qCWarning(TransectStyleComplexItemLog) << "_polyPathTerrainData terrain data does not match transects";
+                    return;
+                }
+                transectsPathHeightInfo[i].append(rgPathHeightInfo[pathHeightIndex++]);
             }
             pathHeightIndex++;  // There is an extra on between each transect
         }
 
         // Now that we have terrain data we can adjust
-        _adjustTransectsForTerrain();
+        _startTerrainAdjust(transectsPathHeightInfo);
     }
-
-    if (_terrainPolyPathQuery != sender()) {
-        qWarning() << "TransectStyleComplexItem::_polyPathTerrainData _terrainPolyPathQuery != sender()";
-    }
-    disconnect(_terrainPolyPathQuery, &TerrainPolyPathQuery::terrainDataReceived, this, &TransectStyleComplexItem::_polyPathTerrainData);
-    _terrainPolyPathQuery = NULL;
 }
 
 bool TransectStyleComplexItem::readyForSave(void) const
 {
+    if (_transectBuildWatcher) {
+        // Transects are out of date until the build completes
+        return false;
+    }
+
     // Make sure we have the terrain data we need
     return _followTerrain ? _transectsPathHeightInfo.count() : true;
 }
 
-void TransectStyleComplexItem::_adjustTransectsForTerrain(void)
+/// Drops any pending terrain query and tells running terrain adjustments to stop
+void TransectStyleComplexItem::_cancelTerrainAdjust(void)
 {
-    if (_followTerrain) {
-        if (!readyForSave()) {
-            qCWarning(TransectStyleComplexItemLog) << "_adjustTransectPointsForTerrain called when terrain data not ready";
-            qgcApp()->showMessage(tr("INTERNAL ERROR: TransectStyleComplexItem::_adjustTransectPointsForTerrain called when terrain data not ready. Plan will be incorrect."));
-            return;
-        }
+    _terrainAdjustGeneration->fetchAndAddOrdered(1);
 
-        // First step is add all interstitial points at max resolution
-        for (int i=0; i<_transects.count(); i++) {
-            _addInterstitialTerrainPoints(_transects[i], _transectsPathHeightInfo[i]);
-        }
+    if (_terrainPolyPathQuery) {
+        // Let the signal fall on the floor
+        disconnect(_terrainPolyPathQuery, &TerrainPolyPathQuery::terrainDataReceived, this, &TransectStyleComplexItem::_polyPathTerrainData);
+        _terrainPolyPathQuery = nullptr;
+    }
+}
 
-        for (int i=0; i<_transects.count(); i++) {
-            _adjustForMaxRates(_transects[i]);
+/// Adjusts a copy of the transects for terrain on a worker thread. The result is only applied if no rebuild happened in the meantime.
+void TransectStyleComplexItem::_startTerrainAdjust(const QList<QList<TerrainPathQuery::PathHeightInfo_t>>& transectsPathHeightInfo)
+{
+    if (!_followTerrain) {
+        return;
+    }
+
+    TerrainAdjustParams_t params;
+    params.requestedAltitude =  _cameraCalc.distanceToSurface()->rawValue().toDouble();
+    params.maxClimbRate =       _terrainAdjustMaxClimbRateFact.rawValue().toDouble();
+    params.maxDescentRate =     _terrainAdjustMaxDescentRateFact.rawValue().toDouble();
+    params.flightSpeed =        _missionFlightStatus.vehicleSpeed;
+    params.tolerance =          _terrainAdjustToleranceFact.rawValue().toDouble();
+
+    int                                 generation =        _terrainAdjustGeneration->fetchAndAddOrdered(1) + 1;
+    QSharedPointer<QAtomicInt>          currentGeneration = _terrainAdjustGeneration;
+    QList<QList<CoordInfo_t>>           transects =         _transects;
+
+    QFutureWatcher<TerrainAdjustResult_t>* watcher = new QFutureWatcher<TerrainAdjustResult_t>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() { _terrainAdjustDone(watcher); });
+    watcher->setFuture(QtConcurrent::run([params, transects, transectsPathHeightInfo, currentGeneration, generation]() {
+        TerrainAdjustResult_t result;
+        result.generation =                 generation;
+        result.transects =                  transects;
+        result.transectsPathHeightInfo =    transectsPathHeightInfo;
+        result.completed =                  _adjustTransectsForTerrain(params, result.transects, transectsPathHeightInfo, *currentGeneration, generation);
+        return result;
+    }));
+}
+
+void TransectStyleComplexItem::_terrainAdjustDone(QFutureWatcher<TerrainAdjustResult_t>* watcher)
+{
+    TerrainAdjustResult_t result = watcher->result();
+    watcher->deleteLater();
+
+    if (!result.completed || result.generation != _terrainAdjustGeneration->loadAcquire() || !_followTerrain) {
+        qCDebug(TransectStyleComplexItemLog) << "_terrainAdjustDone dropping superseded result generation" << result.generation;
+        return;
+    }
+
+    _transects = result.transects;
+    _transectsPathHeightInfo = result.transectsPathHeightInfo;
+    emit lastSequenceNumberChanged(lastSequenceNumber());
+}
+
+/// Runs on a worker thread, only touches its arguments
+/// @return false: a newer generation was started before the adjustment finished, transects are incomplete
+bool TransectStyleComplexItem::_adjustTransectsForTerrain(const TerrainAdjustParams_t& params, QList<QList<CoordInfo_t>>& transects, const QList<QList<TerrainPathQuery::PathHeightInfo_t>>& transectsPathHeightInfo, const QAtomicInt& currentGeneration, int generation)
+{
+    if (transectsPathHeightInfo.count() != transects.count()) {
+        qCWarning(TransectStyleComplexItemLog) << "_adjustTransectsForTerrain terrain data does not match transects";
+        return false;
+    }
+
+    // First step is add all interstitial points at max resolution
+    for (int i=0; i<transects.count(); i++) {
+        if (currentGeneration.loadAcquire() != generation) {
+            return false;
         }
+        _addInterstitialTerrainPoints(params, transects[i], transectsPathHeightInfo[i]);
+    }
 
-        for (int i=0; i<_transects.count(); i++) {
-            _adjustForTolerance(_transects[i]);
+    for (int i=0; i<transects.count(); i++) {
+        if (currentGeneration.loadAcquire() != generation) {
+            return false;
         }
+        _adjustForMaxRates(params, transects[i]);
+    }
 
-        emit lastSequenceNumberChanged(lastSequenceNumber());
+    for (int i=0; i<transects.count(); i++) {
+        if (currentGeneration.loadAcquire() != generation) {
+            return false;
+        }
+        _adjustForTolerance(params, transects[i]);
     }
+
+    return true;
 }
 
 /// Returns the altitude in between the two points on a line.
@@ -553,11 +724,11 @@ int TransectStyleComplexItem::_maxPathHeight(const TerrainPathQuery::PathHeightI
     return maxIndex;
 }
 
-void TransectStyleComplexItem::_adjustForMaxRates(QList<CoordInfo_t>& transect)
+void TransectStyleComplexItem::_adjustForMaxRates(const TerrainAdjustParams_t& params, QList<CoordInfo_t>& transect)
 {
-    double maxClimbRate = _terrainAdjustMaxClimbRateFact.rawValue().toDouble();
-    double maxDescentRate = _terrainAdjustMaxDescentRateFact.rawValue().toDouble();
-    double flightSpeed = _missionFlightStatus.vehicleSpeed;
+    double maxClimbRate = params.maxClimbRate;
+    double maxDescentRate = params.maxDescentRate;
+    double flightSpeed = params.flightSpeed;
 
     if (qIsNaN(flightSpeed) || (maxClimbRate == 0 && maxDescentRate == 0)) {
         if (qIsNaN(flightSpeed)) {
@@ -622,11 +793,11 @@ void TransectStyleComplexItem::_adjustForMaxRates(QList<CoordInfo_t>& transect)
     }
 }
 
-void TransectStyleComplexItem::_adjustForTolerance(QList<CoordInfo_t>& transect)
+void TransectStyleComplexItem::_adjustForTolerance(const TerrainAdjustParams_t& params, QList<CoordInfo_t>& transect)
 {
     QList<CoordInfo_t> adjustedPoints;
 
-    double tolerance = _terrainAdjustToleranceFact.rawValue().toDouble();
+    double tolerance = params.tolerance;
 
     int coordIndex = 0;
     while (coordIndex < transect.count()) {
@@ -655,11 +826,11 @@ void TransectStyleComplexItem::_adjustForTolerance(QList<CoordInfo_t>& transect)
     transect = adjustedPoints;
 }
 
-void TransectStyleComplexItem::_addInterstitialTerrainPoints(QList<CoordInfo_t>& transect, const QList<TerrainPathQuery::PathHeightInfo_t>& transectPathHeightInfo)
+void TransectStyleComplexItem::_addInterstitialTerrainPoints(const TerrainAdjustParams_t& params, QList<CoordInfo_t>& transect, const QList<TerrainPathQuery::PathHeightInfo_t>& transectPathHeightInfo)
 {
     QList<CoordInfo_t> adjustedTransect;
 
-    double requestedAltitude = _cameraCalc.distanceToSurface()->rawValue().toDouble();
+    double requestedAltitude = params.requestedAltitude;
 
     for (int i=0; i<transect.count() - 1; i++) {
         CoordInfo_t fromCoordInfo = transect[i];
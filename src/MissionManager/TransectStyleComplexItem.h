@@ -18,6 +18,12 @@
 #include "CameraCalc.h"
 #include "TerrainQuery.h"
 
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QAtomicInt>
+
+#include <functional>
+
 Q_DECLARE_LOGGING_CATEGORY(TransectStyleComplexItemLog)
 
 class TransectStyleComplexItem : public ComplexMissionItem
@@ -68,6 +74,10 @@ public:
 
     void setFollowTerrain(bool followTerrain);
 
+    /// Transects are rebuilt on a worker thread by default. Unit tests turn this off to get synchronous rebuilds.
+    void setBuildTransectsInBackground(bool background) { _buildTransectsInBackground = background; }
+    bool buildingTransects(void) const { return _transectBuildWatcher != nullptr; }
+
     double  triggerDistance         (void) const { return _cameraCalc.adjustedFootprintFrontal()->rawValue().toDouble(); }
     bool    hoverAndCaptureEnabled  (void) const { return hoverAndCapture()->rawValue().toBool(); }
     bool    triggerCamera           (void) const { return triggerDistance() != 0; }
@@ -136,10 +146,10 @@ protected slots:
     void _rebuildTransects                  (void);
 
 protected:
-    virtual void _rebuildTransectsPhase1    (void) = 0; ///< Rebuilds the _transects array
     virtual void _recalcComplexDistance     (void) = 0;
     virtual void _recalcCameraShots         (void) = 0;
 
+    void    _rebuildTransectsNow            (void);
     void    _save                           (QJsonObject& saveObject);
     bool    _load                           (const QJsonObject& complexObject, QString& errorString);
     void    _setExitCoordinate              (const QGeoCoordinate& coordinate);
@@ -166,11 +176,20 @@ protected:
         CoordType       coordType;
     } CoordInfo_t;
 
+    /// Generates the transects from values captured when it was created. It is run on a worker thread so it must
+    /// never touch the item itself.
+    typedef std::function<QList<QList<CoordInfo_t>>(void)> TransectBuilder;
+
+    /// Phase 1 of a rebuild: snapshot the item state needed to generate the _transects array
+    virtual TransectBuilder _transectBuilder(void) = 0;
+
     QVariantList                                        _visualTransectPoints;
     QList<QList<CoordInfo_t>>                           _transects;
     QList<QList<TerrainPathQuery::PathHeightInfo_t>>    _transectsPathHeightInfo;
     TerrainPolyPathQuery*                               _terrainPolyPathQuery;
     QTimer                                              _terrainQueryTimer;
+    QSharedPointer<QAtomicInt>                          _terrainAdjustGeneration;   ///< Incremented to supersede running terrain adjustments
+    bool                                                _buildTransectsInBackground;
 
     bool            _ignoreRecalc;
     double          _complexDistance;
@@ -207,11 +226,44 @@ private slots:
     void _followTerrainChanged              (bool followTerrain);
 
 private:
+    /// Everything the terrain adjustment reads from the item, captured so it can run off the main thread
+    typedef struct {
+        double requestedAltitude;
+        double maxClimbRate;
+        double maxDescentRate;
+        double flightSpeed;
+        double tolerance;
+    } TerrainAdjustParams_t;
+
+    typedef struct {
+        int                         generation;
+        QList<QList<CoordInfo_t>>   transects;
+    } TransectBuildResult_t;
+
+    typedef struct {
+        int                                                 generation;
+        bool                                                completed;      ///< false: superseded before it finished
+        QList<QList<CoordInfo_t>>                           transects;
+        QList<QList<TerrainPathQuery::PathHeightInfo_t>>    transectsPathHeightInfo;
+    } TerrainAdjustResult_t;
+
+    void    _startTransectBuild             (void);
+    void    _transectBuildDone              (void);
+    void    _cancelTransectBuild            (void);
+    void    _publishTransects               (const QList<QList<CoordInfo_t>>& transects);
     void    _queryTransectsPathHeightInfo   (void);
-    void    _adjustTransectsForTerrain      (void);
-    void    _addInterstitialTerrainPoints   (QList<CoordInfo_t>& transect, const QList<TerrainPathQuery::PathHeightInfo_t>& transectPathHeightInfo);
-    void    _adjustForMaxRates              (QList<CoordInfo_t>& transect);
-    void    _adjustForTolerance             (QList<CoordInfo_t>& transect);
-    double  _altitudeBetweenCoords          (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double percentTowardsTo);
-    int     _maxPathHeight                  (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo, int fromIndex, int toIndex, double& maxHeight);
+    void    _cancelTerrainAdjust            (void);
+    void    _startTerrainAdjust             (const QList<QList<TerrainPathQuery::PathHeightInfo_t>>& transectsPathHeightInfo);
+    void    _terrainAdjustDone              (QFutureWatcher<TerrainAdjustResult_t>* watcher);
+
+    static bool     _adjustTransectsForTerrain      (const TerrainAdjustParams_t& params, QList<QList<CoordInfo_t>>& transects, const QList<QList<TerrainPathQuery::PathHeightInfo_t>>& transectsPathHeightInfo, const QAtomicInt& currentGeneration, int generation);
+    static void     _addInterstitialTerrainPoints   (const TerrainAdjustParams_t& params, QList<CoordInfo_t>& transect, const QList<TerrainPathQuery::PathHeightInfo_t>& transectPathHeightInfo);
+    static void     _adjustForMaxRates              (const TerrainAdjustParams_t& params, QList<CoordInfo_t>& transect);
+    static void     _adjustForTolerance             (const TerrainAdjustParams_t& params, QList<CoordInfo_t>& transect);
+    static double   _altitudeBetweenCoords          (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double percentTowardsTo);
+    static int      _maxPathHeight                  (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo, int fromIndex, int toIndex, double& maxHeight);
+
+    QFutureWatcher<TransectBuildResult_t>*  _transectBuildWatcher;      ///< Build currently running on a worker thread, nullptr if none
+    int                                     _transectBuildGeneration;   ///< Incremented for each rebuild request, only the newest is published
+    bool                                    _transectBuildPending;      ///< A rebuild was requested while a build was running
 };
@@ -233,9 +233,10 @@ TransectStyleItem::TransectStyleItem(Vehicle* vehicle, QObject* parent)
 
 }
 
-void TransectStyleItem::_rebuildTransectsPhase1(void)
+TransectStyleComplexItem::TransectBuilder TransectStyleItem::_transectBuilder(void)
 {
     rebuildTransectsPhase1Called = true;
+    return []() { return QList<QList<CoordInfo_t>>(); };
 }
 
 void TransectStyleItem::_recalcComplexDistance(void)
@@ -102,7 +102,10 @@ public:
 
 private slots:
     // Overrides from TransectStyleComplexItem
-    void _rebuildTransectsPhase1    (void) final;
     void _recalcComplexDistance     (void) final;
     void _recalcCameraShots         (void) final;
+
+private:
+    // Overrides from TransectStyleComplexItem
+    TransectBuilder _transectBuilder(void) final;
 };
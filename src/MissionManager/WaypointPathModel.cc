@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "WaypointPathModel.h"
+
+const int WaypointPathModel::CoordinateRole = Qt::UserRole;
+
+WaypointPathModel::WaypointPathModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+
+}
+
+int WaypointPathModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+
+    return _coordinates.count();
+}
+
+QVariant WaypointPathModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= _coordinates.count()) {
+        return QVariant();
+    }
+
+    if (role == CoordinateRole) {
+        return QVariant::fromValue(_coordinates[index.row()]);
+    } else {
+        return QVariant();
+    }
+}
+
+QVariantList WaypointPathModel::path(void) const
+{
+    QVariantList path;
+
+    path.reserve(_coordinates.count());
+    for (const QGeoCoordinate& coordinate: _coordinates) {
+        path.append(QVariant::fromValue(coordinate));
+    }
+    return path;
+}
+
+QGeoCoordinate WaypointPathModel::coordinateAt(int index) const
+{
+    if (index < 0 || index >= _coordinates.count()) {
+        return QGeoCoordinate();
+    }
+    return _coordinates[index];
+}
+
+QHash<int, QByteArray> WaypointPathModel::roleNames(void) const
+{
+    QHash<int, QByteArray> hash;
+
+    hash[CoordinateRole] = "coordinate";
+
+    return hash;
+}
+
+void WaypointPathModel::_rowsChanged(int first, int last)
+{
+    emit dataChanged(index(first), index(last));
+}
+
+void WaypointPathModel::setPath(const QVector<QGeoCoordinate>& coordinates)
+{
+    int oldCount = _coordinates.count();
+    int newCount = coordinates.count();
+    int commonCount = qMin(oldCount, newCount);
+
+    // Changed runs within the rows both paths have
+    int runStart = -1;
+    for (int i=0; i<commonCount; i++) {
+        if (_coordinates[i] != coordinates[i]) {
+            _coordinates[i] = coordinates[i];
+            if (runStart == -1) {
+                runStart = i;
+            }
+        } else if (runStart != -1) {
+            _rowsChanged(runStart, i - 1);
+            runStart = -1;
+        }
+    }
+    if (runStart != -1) {
+        _rowsChanged(runStart, commonCount - 1);
+    }
+
+    if (newCount > oldCount) {
+        beginInsertRows(QModelIndex(), oldCount, newCount - 1);
+        for (int i=oldCount; i<newCount; i++) {
+            _coordinates.append(coordinates[i]);
+        }
+        endInsertRows();
+    } else if (newCount < oldCount) {
+        beginRemoveRows(QModelIndex(), newCount, oldCount - 1);
+        _coordinates.resize(newCount);
+        endRemoveRows();
+    }
+
+    if (newCount != oldCount) {
+        emit countChanged(newCount);
+    }
+}
+
+void WaypointPathModel::clear(void)
+{
+    setPath(QVector<QGeoCoordinate>());
+}
@@ -0,0 +1,52 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QGeoCoordinate>
+#include <QVector>
+
+/// List model for the mission flight path, one row per path vertex. Updates only signal the rows which were
+/// changed, inserted or removed so a view can apply them to its own copy of the path point by point.
+class WaypointPathModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    WaypointPathModel(QObject* parent = nullptr);
+
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    int                             count       (void) const { return _coordinates.count(); }
+    const QVector<QGeoCoordinate>&  coordinates (void) const { return _coordinates; }
+
+    /// @return The whole path, for initializing a view
+    Q_INVOKABLE QVariantList    path            (void) const;
+    Q_INVOKABLE QGeoCoordinate  coordinateAt    (int index) const;
+
+    /// Replaces the path. Rows whose coordinates are unchanged are not signalled.
+    void setPath        (const QVector<QGeoCoordinate>& coordinates);
+    void clear          (void);
+
+    // Overrides from QAbstractListModel
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+signals:
+    void countChanged(int count);
+
+private:
+    void _rowsChanged(int first, int last);
+
+    QVector<QGeoCoordinate> _coordinates;
+
+    static const int CoordinateRole;
+};
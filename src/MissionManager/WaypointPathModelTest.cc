@@ -0,0 +1,128 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "WaypointPathModelTest.h"
+
+#include <QSignalSpy>
+
+WaypointPathModelTest::WaypointPathModelTest(void)
+    : _pathModel(nullptr)
+{
+    _pathPoints << QGeoCoordinate(47.635638361473475, -122.09269407980834) <<
+                   QGeoCoordinate(47.635638361473475, -122.08545246602667) <<
+                   QGeoCoordinate(47.63057923872075, -122.08545246602667) <<
+                   QGeoCoordinate(47.63057923872075, -122.09269407980834);
+}
+
+void WaypointPathModelTest::init(void)
+{
+    UnitTest::init();
+
+    _pathModel = new WaypointPathModel(this);
+}
+
+void WaypointPathModelTest::cleanup(void)
+{
+    delete _pathModel;
+    _pathModel = nullptr;
+}
+
+void WaypointPathModelTest::_testRoles(void)
+{
+    _pathModel->setPath(_pathPoints);
+    QCOMPARE(_pathModel->rowCount(), _pathPoints.count());
+
+    QHash<int, QByteArray> roles = _pathModel->roleNames();
+    int coordinateRole = roles.key("coordinate");
+
+    QVariantList path = _pathModel->path();
+    QCOMPARE(path.count(), _pathPoints.count());
+    for (int i=0; i<_pathPoints.count(); i++) {
+        QModelIndex index = _pathModel->index(i);
+        QCOMPARE(_pathModel->data(index, coordinateRole).value<QGeoCoordinate>(), _pathPoints[i]);
+        QCOMPARE(_pathModel->coordinateAt(i), _pathPoints[i]);
+        QCOMPARE(path[i].value<QGeoCoordinate>(), _pathPoints[i]);
+    }
+    QVERIFY(!_pathModel->coordinateAt(_pathPoints.count()).isValid());
+}
+
+void WaypointPathModelTest::_testChangedRows(void)
+{
+    _pathModel->setPath(_pathPoints);
+
+    QSignalSpy dataChangedSpy(_pathModel, &WaypointPathModel::dataChanged);
+    QSignalSpy insertedSpy(_pathModel, &WaypointPathModel::rowsInserted);
+    QSignalSpy removedSpy(_pathModel, &WaypointPathModel::rowsRemoved);
+    QSignalSpy countChangedSpy(_pathModel, &WaypointPathModel::countChanged);
+
+    // Setting the same path signals nothing
+    _pathModel->setPath(_pathPoints);
+    QCOMPARE(dataChangedSpy.count(), 0);
+
+    // Moving a single vertex changes only that row
+    QVector<QGeoCoordinate> movedPath = _pathPoints;
+    movedPath[2] = QGeoCoordinate(47.6, -122.1);
+    _pathModel->setPath(movedPath);
+    QCOMPARE(dataChangedSpy.count(), 1);
+    QCOMPARE(dataChangedSpy[0][0].toModelIndex().row(), 2);
+    QCOMPARE(dataChangedSpy[0][1].toModelIndex().row(), 2);
+    dataChangedSpy.clear();
+
+    // Moving two separated vertices changes only those rows
+    movedPath[0] = QGeoCoordinate(47.7, -122.1);
+    movedPath[movedPath.count() - 1] = QGeoCoordinate(47.8, -122.1);
+    _pathModel->setPath(movedPath);
+    QCOMPARE(dataChangedSpy.count(), 2);
+    QCOMPARE(dataChangedSpy[0][0].toModelIndex().row(), 0);
+    QCOMPARE(dataChangedSpy[0][1].toModelIndex().row(), 0);
+    QCOMPARE(dataChangedSpy[1][0].toModelIndex().row(), movedPath.count() - 1);
+    QCOMPARE(dataChangedSpy[1][1].toModelIndex().row(), movedPath.count() - 1);
+
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(countChangedSpy.count(), 0);
+}
+
+void WaypointPathModelTest::_testInsertRemoveRows(void)
+{
+    QVector<QGeoCoordinate> shortPath = _pathPoints.mid(0, 2);
+    _pathModel->setPath(shortPath);
+
+    QSignalSpy dataChangedSpy(_pathModel, &WaypointPathModel::dataChanged);
+    QSignalSpy insertedSpy(_pathModel, &WaypointPathModel::rowsInserted);
+    QSignalSpy removedSpy(_pathModel, &WaypointPathModel::rowsRemoved);
+    QSignalSpy countChangedSpy(_pathModel, &WaypointPathModel::countChanged);
+
+    // Growing inserts only the new rows
+    _pathModel->setPath(_pathPoints);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy[0][1].toInt(), 2);
+    QCOMPARE(insertedSpy[0][2].toInt(), 3);
+    QCOMPARE(dataChangedSpy.count(), 0);
+    QCOMPARE(countChangedSpy.count(), 1);
+    QCOMPARE(_pathModel->count(), _pathPoints.count());
+    insertedSpy.clear();
+    countChangedSpy.clear();
+
+    // Shrinking removes only the trailing rows
+    _pathModel->setPath(shortPath);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy[0][1].toInt(), 2);
+    QCOMPARE(removedSpy[0][2].toInt(), 3);
+    QCOMPARE(dataChangedSpy.count(), 0);
+    QCOMPARE(countChangedSpy.count(), 1);
+    QCOMPARE(insertedSpy.count(), 0);
+    removedSpy.clear();
+    countChangedSpy.clear();
+
+    _pathModel->clear();
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(countChangedSpy.count(), 1);
+    QCOMPARE(_pathModel->count(), 0);
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "WaypointPathModel.h"
+
+class WaypointPathModelTest : public UnitTest
+{
+    Q_OBJECT
+    
+public:
+    WaypointPathModelTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+    
+private slots:
+    void _testRoles(void);
+    void _testChangedRows(void);
+    void _testInsertRemoveRows(void);
+
+private:
+    QVector<QGeoCoordinate> _pathPoints;
+    WaypointPathModel*      _pathModel;
+};
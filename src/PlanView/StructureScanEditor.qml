@@ -74,6 +74,14 @@ Rectangle {
             visible:        missionItem.cameraShots > 0 && _cameraMinTriggerInterval !== 0 && _cameraMinTriggerInterval > missionItem.timeBetweenShots
         }
 
+        QGCLabel {
+            anchors.left:   parent.left
+            anchors.right:  parent.right
+            text:           qsTr("Loading shape file: %1%").arg(Math.round(missionItem.structurePolygon.loadProgress * 100))
+            wrapMode:       Text.WordWrap
+            visible:        missionItem.structurePolygon.loading
+        }
+
         CameraCalc {
             cameraCalc:                     missionItem.cameraCalc
             vehicleFlightIsFrontal:         false
@@ -86,6 +86,7 @@
 #include "QGCCameraManager.h"
 #include "CameraCalc.h"
 #include "VisualMissionItem.h"
+#include "WaypointPathModel.h"
 #include "EditPositionDialogController.h"
 #include "FactValueSliderListModel.h"
 #include "ShapeFileHelper.h"
@@ -423,6 +424,7 @@ void QGCApplication::_initCommon()
 
     qmlRegisterUncreatableType<CoordinateVector>    ("QGroundControl",                      1, 0, "CoordinateVector",           kRefOnly);
     qmlRegisterUncreatableType<QmlObjectListModel>  ("QGroundControl",                      1, 0, "QmlObjectListModel",         kRefOnly);
+    qmlRegisterUncreatableType<WaypointPathModel>   ("QGroundControl",                      1, 0, "WaypointPathModel",          kRefOnly);
     qmlRegisterUncreatableType<MissionCommandTree>  ("QGroundControl",                      1, 0, "MissionCommandTree",         kRefOnly);
     qmlRegisterUncreatableType<CameraCalc>          ("QGroundControl",                      1, 0, "CameraCalc",                 kRefOnly);
 
@@ -106,9 +106,7 @@ bool QmlObjectListModel::removeRows(int position, int rows, const QModelIndex& p
     }
     
     beginRemoveRows(QModelIndex(), position, position + rows - 1);
-    for (int row=0; row<rows; row++) {
-        _objectList.removeAt(position);
-    }
+    _objectList.erase(_objectList.begin() + position, _objectList.begin() + position + rows);
     endRemoveRows();
     
     emit countChanged(count());
@@ -132,29 +130,64 @@ const QObject* QmlObjectListModel::operator[](int index) const
     return _objectList[index];
 }
 
-void QmlObjectListModel::clear()
+void QmlObjectListModel::_connectChildDirty(QObject* object, int index)
 {
-    while (rowCount()) {
-        removeAt(0);
+    // Look for a dirtyChanged signal on the object
+    if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
+        if (!_skipDirtyFirstItem || index != 0) {
+            QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+        }
     }
 }
 
-QObject* QmlObjectListModel::removeAt(int i)
+void QmlObjectListModel::_disconnectChildDirty(QObject* object, int index)
 {
-    QObject* removedObject = _objectList[i];
-    if(removedObject) {
+    if (object) {
         // Look for a dirtyChanged signal on the object
-        if (_objectList[i]->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || i != 0) {
-                QObject::disconnect(_objectList[i], SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
+            if (!_skipDirtyFirstItem || index != 0) {
+                QObject::disconnect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
             }
         }
     }
+}
+
+void QmlObjectListModel::clear()
+{
+    removeRange(0, _objectList.count());
+}
+
+QObject* QmlObjectListModel::removeAt(int i)
+{
+    QObject* removedObject = _objectList[i];
+    _disconnectChildDirty(removedObject, i);
     removeRows(i, 1);
     setDirty(true);
     return removedObject;
 }
 
+QObjectList QmlObjectListModel::removeRange(int i, int count)
+{
+    QObjectList removedObjects;
+
+    if (count <= 0) {
+        return removedObjects;
+    }
+    if (i < 0 || i + count > _objectList.count()) {
+        qWarning() << "Invalid range index:count:listCount" << i << count << _objectList.count();
+        return removedObjects;
+    }
+
+    removedObjects = _objectList.mid(i, count);
+    for (int j=0; j<removedObjects.count(); j++) {
+        _disconnectChildDirty(removedObjects[j], i + j);
+    }
+    removeRows(i, count);
+    setDirty(true);
+
+    return removedObjects;
+}
+
 void QmlObjectListModel::insert(int i, QObject* object)
 {
     if (i < 0 || i > _objectList.count()) {
@@ -162,13 +195,7 @@ void QmlObjectListModel::insert(int i, QObject* object)
     }
     
     QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
-    
-    // Look for a dirtyChanged signal on the object
-    if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-        if (!_skipDirtyFirstItem || i != 0) {
-            QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-        }
-    }
+    _connectChildDirty(object, i);
 
     _objectList.insert(i, object);
     insertRows(i, 1);
@@ -181,20 +208,22 @@ void QmlObjectListModel::insert(int i, QList<QObject*> objects)
     if (i < 0 || i > _objectList.count()) {
         qWarning() << "Invalid index index:count" << i << _objectList.count();
     }
+    if (objects.isEmpty()) {
+        return;
+    }
 
     int j = i;
     for (QObject* object: objects) {
         QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
-
-        // Look for a dirtyChanged signal on the object
-        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || j != 0) {
-                QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
-        }
-        j++;
-
-        _objectList.insert(j, object);
+        _connectChildDirty(object, j++);
+    }
+    if (i == _objectList.count()) {
+        _objectList.append(objects);
+    } else {
+        QObjectList tail = _objectList.mid(i);
+        _objectList.erase(_objectList.begin() + i, _objectList.end());
+        _objectList.append(objects);
+        _objectList.append(tail);
     }
 
     insertRows(i, objects.count());
@@ -222,6 +251,32 @@ QObjectList QmlObjectListModel::swapObjectList(const QObjectList& newlist)
     return oldlist;
 }
 
+QObjectList QmlObjectListModel::resetObjectList(const QObjectList& newlist)
+{
+    QObjectList oldlist(_objectList);
+
+    for (int i=0; i<oldlist.count(); i++) {
+        _disconnectChildDirty(oldlist[i], i);
+    }
+    for (int i=0; i<newlist.count(); i++) {
+        QQmlEngine::setObjectOwnership(newlist[i], QQmlEngine::CppOwnership);
+        _connectChildDirty(newlist[i], i);
+    }
+
+    beginResetModel();
+    _objectList = newlist;
+    endResetModel();
+
+    if (oldlist.count() != newlist.count()) {
+        emit countChanged(count());
+    }
+    if (!oldlist.isEmpty() || !newlist.isEmpty()) {
+        setDirty(true);
+    }
+
+    return oldlist;
+}
+
 int QmlObjectListModel::count() const
 {
     return rowCount();
@@ -261,10 +316,7 @@ void QmlObjectListModel::deleteListAndContents()
 
 void QmlObjectListModel::clearAndDeleteContents()
 {
-    beginResetModel();
-    for (int i=0; i<_objectList.count(); i++) {
-        _objectList[i]->deleteLater();
+    for (QObject* object: resetObjectList(QObjectList())) {
+        object->deleteLater();
     }
-    clear();
-    endResetModel();
 }
@@ -39,6 +39,7 @@ public:
     QObjectList swapObjectList      (const QObjectList& newlist);
     void        clear               ();
     QObject*    removeAt            (int i);
+    QObjectList removeRange         (int i, int count);
     QObject*    removeOne           (QObject* object) { return removeAt(indexOf(object)); }
     void        insert              (int i, QObject* object);
     void        insert              (int i, QList<QObject*> objects);
@@ -56,6 +57,10 @@ public:
     /// Clears the list and calls deleteLater on each entry
     void clearAndDeleteContents     ();
 
+    /// Replaces the contents of the list with a single model reset instead of a remove/insert per item. The previous
+    /// contents are returned and are not deleted.
+    QObjectList resetObjectList     (const QObjectList& newlist);
+
     void beginReset                 () { beginResetModel(); }
     void endReset                   () { endResetModel();   }
 
@@ -67,6 +72,9 @@ private slots:
     void _childDirtyChanged         (bool dirty);
     
 private:
+    void _connectChildDirty         (QObject* object, int index);
+    void _disconnectChildDirty      (QObject* object, int index);
+
     // Overrides from QAbstractListModel
     int         rowCount    (const QModelIndex & parent = QModelIndex()) const override;
     QVariant    data        (const QModelIndex & index, int role = Qt::DisplayRole) const override;
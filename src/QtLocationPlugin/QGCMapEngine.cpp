@@ -152,13 +152,13 @@ QGCMapEngine::QGCMapEngine()
 #endif
     , _maxDiskCache(0)
     , _maxMemCache(0)
-    , _prunning(false)
     , _cacheWasReset(false)
     , _isInternetActive(false)
 {
     qRegisterMetaType<QGCMapTask::TaskType>();
     qRegisterMetaType<QGCTile>();
     qRegisterMetaType<QList<QGCTile*>>();
+    qRegisterMetaType<QList<QGCCachedTileSet*>>();
     connect(&_worker, &QGCCacheWorker::updateTotals,   this, &QGCMapEngine::_updateTotals);
     connect(&_worker, &QGCCacheWorker::internetStatus, this, &QGCMapEngine::_internetStatus);
 }
@@ -230,6 +230,7 @@ QGCMapEngine::init()
     } else {
         qCritical() << "Could not find suitable map cache directory.";
     }
+    _worker.setMaxDiskCache(static_cast<quint64>(getMaxDiskCache()) * 1024L * 1024L);
     QGCMapTask* task = new QGCMapTask(QGCMapTask::taskInit);
     _worker.enqueueTask(task);
 }
@@ -298,6 +299,17 @@ QGCMapEngine::hashToType(const QString& hash)
     return static_cast<UrlFactory::MapType>(type.toInt());
 }
 
+//-----------------------------------------------------------------------------
+UrlFactory::MapType
+QGCMapEngine::hashToTile(const QString& hash, int& x, int& y, int& z)
+{
+    //-- Inverse of getTileHash()
+    x = hash.mid(4, 8).toInt();
+    y = hash.mid(12, 8).toInt();
+    z = hash.mid(20, 3).toInt();
+    return static_cast<UrlFactory::MapType>(hash.mid(0, 4).toInt());
+}
+
 //-----------------------------------------------------------------------------
 QGCFetchTileTask*
 QGCMapEngine::createFetchTileTask(UrlFactory::MapType type, int x, int y, int z)
@@ -423,6 +435,7 @@ QGCMapEngine::setMaxDiskCache(quint32 size)
     QSettings settings;
     settings.setValue(kMaxDiskCacheKey, size);
     _maxDiskCache = size;
+    _worker.setMaxDiskCache(static_cast<quint64>(size) * 1024L * 1024L);
 }
 
 //-----------------------------------------------------------------------------
@@ -482,21 +495,8 @@ QGCMapEngine::numberToString(quint64 number)
 void
 QGCMapEngine::_updateTotals(quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize)
 {
+    //-- The cache worker evicts least recently used tiles on its own when idle
     emit updateTotals(totaltiles, totalsize, defaulttiles, defaultsize);
-    quint64 maxSize = static_cast<quint64>(getMaxDiskCache()) * 1024L * 1024L;
-    if(!_prunning && defaultsize > maxSize) {
-        //-- Prune Disk Cache
-        _prunning = true;
-        QGCPruneCacheTask* task = new QGCPruneCacheTask(defaultsize - maxSize);
-        connect(task, &QGCPruneCacheTask::pruned, this, &QGCMapEngine::_pruned);
-        getQGCMapEngine()->addTask(task);
-    }
-}
-//-----------------------------------------------------------------------------
-void
-QGCMapEngine::_pruned()
-{
-    _prunning = false;
 }
 
 //-----------------------------------------------------------------------------
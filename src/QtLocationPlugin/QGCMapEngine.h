@@ -97,6 +97,7 @@ public:
     static int                  long2elevationTileX (double lon, int z);
     static int                  lat2elevationTileY  (double lat, int z);
     static QString              getTileHash         (UrlFactory::MapType type, int x, int y, int z);
+    static UrlFactory::MapType  hashToTile          (const QString& hash, int& x, int& y, int& z);
     static UrlFactory::MapType  getTypeFromName     (const QString &name);
     static QString              bigSizeToString     (quint64 size);
     static QString              numberToString      (quint64 number);
@@ -107,7 +108,6 @@ public:
 
 private slots:
     void _updateTotals          (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
-    void _pruned                ();
     void _internetStatus        (bool active);
 
 signals:
@@ -127,7 +127,6 @@ private:
     QString                 _userAgent;
     quint32                 _maxDiskCache;
     quint32                 _maxMemCache;
-    bool                    _prunning;
     bool                    _cacheWasReset;
     bool                    _isInternetActive;
 };
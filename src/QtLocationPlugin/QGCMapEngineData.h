@@ -24,6 +24,8 @@
 #include <QHash>
 #include <QDateTime>
 
+#include <limits>
+
 #include "QGCMapUrlEngine.h"
 
 class QGCCachedTileSet;
@@ -71,6 +73,79 @@ private:
     UrlFactory::MapType _type;
 };
 
+//-----------------------------------------------------------------------------
+//-- Tiles of a tile set at a given zoom level, stored as an x/y range. Tiles
+//   already in the cache are tracked with one bit per tile (row major).
+//   Ranges with more than kMaxCount tiles get no bitmap and are not valid.
+class QGCTileRange
+{
+public:
+    static constexpr quint64 kMaxCount = static_cast<quint64>(std::numeric_limits<int>::max());
+
+    QGCTileRange(int z = 0, int x0 = 0, int x1 = -1, int y0 = 0, int y1 = -1, const QByteArray& done = QByteArray())
+        : _z(z)
+        , _x0(x0)
+        , _x1(x1)
+        , _y0(y0)
+        , _y1(y1)
+        , _done(done)
+        , _dirty(false)
+    {
+        if(!isValid()) {
+            _done.clear();
+            return;
+        }
+        int bytes = static_cast<int>((count() + 7) / 8);
+        if(_done.size() != bytes) {
+            _done = QByteArray(bytes, 0);
+        }
+    }
+
+    int                 z           () const { return _z; }
+    int                 x0          () const { return _x0; }
+    int                 x1          () const { return _x1; }
+    int                 y0          () const { return _y0; }
+    int                 y1          () const { return _y1; }
+    quint64             width       () const { return _x1 < _x0 ? 0 : static_cast<quint64>(_x1 - _x0 + 1); }
+    quint64             height      () const { return _y1 < _y0 ? 0 : static_cast<quint64>(_y1 - _y0 + 1); }
+    quint64             count       () const { return width() * height(); }
+    bool                isValid     () const { return count() <= kMaxCount; }
+    const QByteArray&   doneBitmap  () const { return _done; }
+    bool                dirty       () const { return _dirty; }
+    void                setDirty    (bool dirty) { _dirty = dirty; }
+
+    bool contains(int x, int y, int z) const
+    {
+        return z == _z && x >= _x0 && x <= _x1 && y >= _y0 && y <= _y1;
+    }
+    quint64 index(int x, int y) const
+    {
+        return static_cast<quint64>(y - _y0) * width() + static_cast<quint64>(x - _x0);
+    }
+    int tileX(quint64 index) const { return _x0 + static_cast<int>(index % width()); }
+    int tileY(quint64 index) const { return _y0 + static_cast<int>(index / width()); }
+    bool isDone(quint64 index) const
+    {
+        return (_done.at(static_cast<int>(index >> 3)) & (1 << (index & 7))) != 0;
+    }
+    void setDone(quint64 index)
+    {
+        if(!isDone(index)) {
+            _done[static_cast<int>(index >> 3)] = _done.at(static_cast<int>(index >> 3)) | static_cast<char>(1 << (index & 7));
+            _dirty = true;
+        }
+    }
+
+private:
+    int         _z;
+    int         _x0;
+    int         _x1;
+    int         _y0;
+    int         _y1;
+    QByteArray  _done;
+    bool        _dirty;
+};
+
 //-----------------------------------------------------------------------------
 class QGCCacheTile : public QObject
 {
@@ -119,7 +194,6 @@ public:
         taskUpdateTileDownloadState,
         taskDeleteTileSet,
         taskRenameTileSet,
-        taskPruneCache,
         taskReset,
         taskExport,
         taskImport
@@ -164,13 +238,14 @@ public:
         : QGCMapTask(QGCMapTask::taskFetchTileSets)
     {}
 
-    void setTileSetFetched(QGCCachedTileSet* tileSet)
+    void setTileSetsFetched(QList<QGCCachedTileSet*> tileSets)
     {
-        emit tileSetFetched(tileSet);
+        emit tileSetsFetched(tileSets);
     }
 
 signals:
-    void            tileSetFetched  (QGCCachedTileSet* tileSet);
+    //-- All sets are delivered at once so the set list is only updated once
+    void            tileSetsFetched (QList<QGCCachedTileSet*> tileSets);
 };
 
 //-----------------------------------------------------------------------------
@@ -345,30 +420,6 @@ private:
     QString     _newName;
 };
 
-//-----------------------------------------------------------------------------
-class QGCPruneCacheTask : public QGCMapTask
-{
-    Q_OBJECT
-public:
-    QGCPruneCacheTask(quint64 amount)
-        : QGCMapTask(QGCMapTask::taskPruneCache)
-        , _amount(amount)
-    {}
-
-    quint64  amount() { return _amount; }
-
-    void setPruned()
-    {
-        emit pruned();
-    }
-
-signals:
-    void pruned();
-
-private:
-    quint64  _amount;
-};
-
 //-----------------------------------------------------------------------------
 class QGCResetTask : public QGCMapTask
 {
@@ -430,10 +481,11 @@ class QGCImportTileTask : public QGCMapTask
 {
     Q_OBJECT
 public:
-    QGCImportTileTask(QString path, bool replace)
+    QGCImportTileTask(QString path, bool replace, UrlFactory::MapType mapType = UrlFactory::Invalid)
         : QGCMapTask(QGCMapTask::taskImport)
         , _path(path)
         , _replace(replace)
+        , _mapType(mapType)
     {}
 
     ~QGCImportTileTask()
@@ -442,6 +494,8 @@ public:
 
     QString                    path     () { return _path; }
     bool                       replace  () { return _replace; }
+    //-- Map type assumed for MBTiles files that don't carry one
+    UrlFactory::MapType        mapType  () { return _mapType; }
 
     void setImportCompleted()
     {
@@ -456,6 +510,7 @@ public:
 private:
     QString                     _path;
     bool                        _replace;
+    UrlFactory::MapType         _mapType;
 
 signals:
     void actionCompleted        ();
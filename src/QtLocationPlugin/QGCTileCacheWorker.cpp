@@ -26,12 +26,20 @@
 #include <QDateTime>
 #include <QApplication>
 #include <QFile>
+#include <QFileInfo>
 
 #include "time.h"
 
 static const char*      kDefaultSet     = "Default Tile Set";
 static const QString    kSession        = QStringLiteral("QGeoTileWorkerSession");
 static const QString    kExportSession  = QStringLiteral("QGeoTileExportSession");
+static const QString    kImportSchema   = QStringLiteral("importdb");
+static const QString    kExportSchema   = QStringLiteral("exportdb");
+//-- MBTiles metadata entries used to restore the QGC map type on import
+static const char*      kMBTilesMapType     = "qgc_map_type";
+static const char*      kMBTilesMapTypeStr  = "qgc_map_type_str";
+//-- SetTotals row holding the totals for the whole cache (set IDs start at 1)
+static const quint64    kTotalsID       = 0;
 
 QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 
@@ -40,6 +48,11 @@ QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 #define LONG_TIMEOUT        5
 #define SHORT_TIMEOUT       2
 
+//-- Number of tiles evicted per pass while idle
+#define PRUNE_BATCH_SIZE    128
+//-- Number of tiles copied per transaction when importing/exporting
+#define TRANSFER_CHUNK_SIZE 1000
+
 //-----------------------------------------------------------------------------
 QGCCacheWorker::QGCCacheWorker()
     : _db(nullptr)
@@ -53,7 +66,11 @@ QGCCacheWorker::QGCCacheWorker()
     , _lastUpdate(0)
     , _updateTimeout(SHORT_TIMEOUT)
     , _hostLookupID(0)
+    , _maxDiskCache(0)
 {
+    //-- Connection names are per worker so more than one cache can be open (unit tests)
+    _session        = QString("%1_%2").arg(kSession).arg(reinterpret_cast<quintptr>(this), 0, 16);
+    _exportSession  = QString("%1_%2").arg(kExportSession).arg(reinterpret_cast<quintptr>(this), 0, 16);
 }
 
 //-----------------------------------------------------------------------------
@@ -68,6 +85,14 @@ QGCCacheWorker::setDatabaseFile(const QString& path)
     _databasePath = path;
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::setMaxDiskCache(quint64 size)
+{
+    QMutexLocker lock(&_mutex);
+    _maxDiskCache = size;
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::quit()
@@ -115,7 +140,7 @@ QGCCacheWorker::run()
         _init();
     }
     if(_valid) {
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
+        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session));
         _db->setDatabaseName(_databasePath);
         _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
         _valid = _db->open();
@@ -153,9 +178,6 @@ QGCCacheWorker::run()
                 case QGCMapTask::taskRenameTileSet:
                     _renameTileSet(task);
                     break;
-                case QGCMapTask::taskPruneCache:
-                    _pruneCache(task);
-                    break;
                 case QGCMapTask::taskReset:
                     _resetCacheDatabase(task);
                     break;
@@ -179,10 +201,17 @@ QGCCacheWorker::run()
             }
             if(!count || (time(nullptr) - _lastUpdate > _updateTimeout)) {
                 if(_valid) {
+                    _saveTileRanges();
+                    _saveTileAccess();
                     _updateTotals();
                 }
             }
         } else {
+            //-- Use idle time to bring the cache back within its size limit. Evicting
+            //   in small batches lets queued fetches run in between.
+            if(_valid && _pruneIdle()) {
+                continue;
+            }
             //-- Wait a bit before shutting things down
             _waitmutex.lock();
             unsigned long timeout = 5000;
@@ -198,9 +227,13 @@ QGCCacheWorker::run()
         }
     }
     if(_db) {
+        if(_valid) {
+            _saveTileRanges();
+            _saveTileAccess();
+        }
         delete _db;
         _db = nullptr;
-        QSqlDatabase::removeDatabase(kSession);
+        QSqlDatabase::removeDatabase(_session);
     }
 }
 //-----------------------------------------------------------------------------
@@ -277,12 +310,14 @@ QGCCacheWorker::_getTile(QGCMapTask* mtask)
     bool found = false;
     QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
     QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
+    QString s = QString("SELECT tile, format, type, tileID FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
     if(query.exec(s)) {
         if(query.next()) {
             QByteArray ar   = query.value(0).toByteArray();
             QString format  = query.value(1).toString();
             UrlFactory::MapType type = static_cast<UrlFactory::MapType>(query.value(2).toInt());
+            //-- Access time is written out in batches (see _saveTileAccess())
+            _accessedTiles.insert(query.value(3).toULongLong());
             qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
             QGCCacheTile* tile = new QGCCacheTile(task->hash(), ar, format, type);
             task->setTileFetched(tile);
@@ -307,6 +342,7 @@ QGCCacheWorker::_getTileSets(QGCMapTask* mtask)
     QString s = QString("SELECT * FROM TileSets ORDER BY defaultSet DESC, name ASC");
     qCDebug(QGCTileCacheLog) << "_getTileSets(): " << s;
     if(query.exec(s)) {
+        QList<QGCCachedTileSet*> sets;
         while(query.next()) {
             QString name = query.value("name").toString();
             QGCCachedTileSet* set = new QGCCachedTileSet(name);
@@ -325,8 +361,9 @@ QGCCacheWorker::_getTileSets(QGCMapTask* mtask)
             _updateSetTotals(set);
             //-- Object created here must be moved to app thread to be used there
             set->moveToThread(QApplication::instance()->thread());
-            task->tileSetFetched(set);
+            sets.append(set);
         }
+        task->setTileSetsFetched(sets);
     } else {
         task->setError("No tile set in database");
     }
@@ -345,7 +382,7 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
         return;
     }
     QSqlQuery subquery(*_db);
-    QString sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(set->id());
+    QString sq = QString("SELECT count, size, uniqueCount, uniqueSize FROM SetTotals WHERE setID = %1").arg(set->id());
     qCDebug(QGCTileCacheLog) << "_updateSetTotals(): " << sq;
     if(subquery.exec(sq)) {
         if(subquery.next()) {
@@ -364,17 +401,9 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
                 }
                 set->setTotalTileSize(avg * set->totalTileCount());
             }
-            //-- Now figure out the count for tiles unique to this set
-            quint32 ucount = 0;
-            quint64 usize  = 0;
-            sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(set->id());
-            if(subquery.exec(sq)) {
-                if(subquery.next()) {
-                    //-- This is only accurate when all tiles are downloaded
-                    ucount = subquery.value(0).toUInt();
-                    usize  = subquery.value(1).toULongLong();
-                }
-            }
+            //-- Count of tiles unique to this set (only accurate when all tiles are downloaded)
+            quint32 ucount = subquery.value(2).toUInt();
+            quint64 usize  = subquery.value(3).toULongLong();
             //-- If we haven't downloaded it all, estimate size of unique tiles
             quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
             if(!ucount) {
@@ -394,20 +423,17 @@ QGCCacheWorker::_updateTotals()
 {
     QSqlQuery query(*_db);
     QString s;
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
+    s = QString("SELECT setID, count, size, uniqueCount, uniqueSize FROM SetTotals WHERE setID IN (%1, %2)").arg(kTotalsID).arg(_getDefaultTileSet());
     qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
     if(query.exec(s)) {
-        if(query.next()) {
-            _totalCount = query.value(0).toUInt();
-            _totalSize  = query.value(1).toULongLong();
-        }
-    }
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
-    if(query.exec(s)) {
-        if(query.next()) {
-            _defaultCount = query.value(0).toUInt();
-            _defaultSize  = query.value(1).toULongLong();
+        while(query.next()) {
+            if(query.value(0).toULongLong() == kTotalsID) {
+                _totalCount   = query.value(1).toUInt();
+                _totalSize    = query.value(2).toULongLong();
+            } else {
+                _defaultCount = query.value(3).toUInt();
+                _defaultSize  = query.value(4).toULongLong();
+            }
         }
     }
     emit updateTotals(_totalCount, _totalSize, _defaultCount, _defaultSize);
@@ -434,7 +460,6 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
 {
     if(_valid) {
         //-- Create Tile Set
-        quint32 actual_count = 0;
         QGCCreateTileSetTask* task = static_cast<QGCCreateTileSetTask*>(mtask);
         QSqlQuery query(*_db);
         query.prepare("INSERT INTO TileSets("
@@ -457,49 +482,14 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
             //-- Get just created (auto-incremented) setID
             quint64 setID = query.lastInsertId().toULongLong();
             task->tileSet()->setId(setID);
-            //-- Prepare Download List
-            quint64 tileCount = 0;
-            _db->transaction();
-            for(int z = task->tileSet()->minZoom(); z <= task->tileSet()->maxZoom(); z++) {
-                QGCTileSet set = QGCMapEngine::getTileCount(z,
-                    task->tileSet()->topleftLon(), task->tileSet()->topleftLat(),
-                    task->tileSet()->bottomRightLon(), task->tileSet()->bottomRightLat(), task->tileSet()->type());
-                tileCount += set.tileCount;
-                UrlFactory::MapType type = task->tileSet()->type();
-                for(int x = set.tileX0; x <= set.tileX1; x++) {
-                    for(int y = set.tileY0; y <= set.tileY1; y++) {
-                        //-- See if tile is already downloaded
-                        QString hash = QGCMapEngine::getTileHash(type, x, y, z);
-                        quint64 tileID = _findTile(hash);
-                        if(!tileID) {
-                            //-- Set to download
-                            query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
-                            query.addBindValue(setID);
-                            query.addBindValue(hash);
-                            query.addBindValue(type);
-                            query.addBindValue(x);
-                            query.addBindValue(y);
-                            query.addBindValue(z);
-                            query.addBindValue(0);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << query.lastError().text();
-                                mtask->setError("Error creating tile set download list");
-                                return;
-                            } else
-                                actual_count++;
-                        } else {
-                            //-- Tile already in the database. No need to dowload.
-                            QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-                            query.prepare(s);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
-                            }
-                            qCDebug(QGCTileCacheLog) << "_createTileSet() Already Cached HASH:" << hash;
-                        }
-                    }
-                }
+            //-- Store tile ranges. Individual tiles are enumerated when downloading.
+            if(!_createTileRanges(setID, task->tileSet()->type(), task->tileSet()->minZoom(), task->tileSet()->maxZoom(),
+                task->tileSet()->topleftLon(), task->tileSet()->topleftLat(),
+                task->tileSet()->bottomRightLon(), task->tileSet()->bottomRightLat())) {
+                _deleteTileSet(setID);
+                mtask->setError("Error creating tile set download list");
+                return;
             }
-            _db->commit();
             //-- Done
             _updateSetTotals(task->tileSet());
             task->setTileSetSaved();
@@ -518,24 +508,49 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
     }
     QList<QGCTile*> tiles;
     QGCGetTileDownloadListTask* task = static_cast<QGCGetTileDownloadListTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
-    if(query.exec(s)) {
-        while(query.next()) {
-            QGCTile* tile = new QGCTile;
-            tile->setHash(query.value("hash").toString());
-            tile->setType(static_cast<UrlFactory::MapType>(query.value("type").toInt()));
-            tile->setX(query.value("x").toInt());
-            tile->setY(query.value("y").toInt());
-            tile->setZ(query.value("z").toInt());
-            tiles.append(tile);
-        }
-        for(int i = 0; i < tiles.size(); i++) {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->hash());
-            if(!query.exec(s)) {
-                qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
+    if(_loadTileRanges(task->setID())) {
+        TileSetRanges& set = _tileRanges[task->setID()];
+        QSqlQuery query(*_db);
+        quint64 first = 0;
+        _db->transaction();
+        for(int i = 0; i < set.ranges.count() && tiles.size() < task->count(); i++) {
+            QGCTileRange& range = set.ranges[i];
+            quint64 count = range.count();
+            //-- Skip ranges already behind the cursor
+            if(set.cursor >= first + count) {
+                first += count;
+                continue;
+            }
+            for(quint64 idx = set.cursor - first; idx < count && tiles.size() < task->count(); idx++) {
+                set.cursor = first + idx + 1;
+                if(range.isDone(idx)) {
+                    continue;
+                }
+                int x = range.tileX(idx);
+                int y = range.tileY(idx);
+                QString hash = QGCMapEngine::getTileHash(set.type, x, y, range.z());
+                quint64 tileID = _findTile(hash);
+                if(tileID) {
+                    //-- Tile already in the database. No need to dowload.
+                    QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(task->setID());
+                    if(!query.exec(s)) {
+                        qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
+                    }
+                    range.setDone(idx);
+                    qCDebug(QGCTileCacheLog) << "_getTileDownloadList() Already Cached HASH:" << hash;
+                    continue;
+                }
+                QGCTile* tile = new QGCTile;
+                tile->setHash(hash);
+                tile->setType(set.type);
+                tile->setX(x);
+                tile->setY(y);
+                tile->setZ(range.z());
+                tiles.append(tile);
             }
+            first += count;
         }
+        _db->commit();
     }
     task->setTileListFetched(tiles);
 }
@@ -548,49 +563,212 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
         return;
     }
     QGCUpdateTileDownloadStateTask* task = static_cast<QGCUpdateTileDownloadStateTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s;
+    if(!_loadTileRanges(task->setID())) {
+        return;
+    }
+    TileSetRanges& set = _tileRanges[task->setID()];
+    if(task->hash() == "*") {
+        //-- Restart enumeration. Tiles not flagged as done (errors) are requested again.
+        if(task->state() == QGCTile::StatePending) {
+            set.cursor = 0;
+        }
+        return;
+    }
+    //-- Errors and pending downloads are implied by the cursor. Only completion is stored.
     if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
-    } else {
-        if(task->hash() == "*") {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
-        } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->hash());
+        int x = 0, y = 0, z = 0;
+        QGCMapEngine::hashToTile(task->hash(), x, y, z);
+        for(int i = 0; i < set.ranges.count(); i++) {
+            if(set.ranges[i].contains(x, y, z)) {
+                set.ranges[i].setDone(set.ranges[i].index(x, y));
+                break;
+            }
         }
     }
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_createTileRanges(quint64 setID, UrlFactory::MapType type, int minZoom, int maxZoom, double topleftLon, double topleftLat, double bottomRightLon, double bottomRightLat)
+{
+    TileSetRanges set;
+    set.type   = type;
+    set.cursor = 0;
+    QSqlQuery query(*_db);
+    _db->transaction();
+    for(int z = minZoom; z <= maxZoom; z++) {
+        QGCTileSet tileSet = QGCMapEngine::getTileCount(z, topleftLon, topleftLat, bottomRightLon, bottomRightLat, type);
+        QGCTileRange range(z, tileSet.tileX0, tileSet.tileX1, tileSet.tileY0, tileSet.tileY1);
+        if(!range.isValid()) {
+            qWarning() << "Map Cache: too many tiles at zoom level" << z << range.count() << "max:" << QGCTileRange::kMaxCount;
+            _db->rollback();
+            return false;
+        }
+        query.prepare("INSERT INTO TileSetRanges(setID, type, z, x0, x1, y0, y1, done) VALUES(?, ?, ?, ?, ?, ?, ?, ?)");
+        query.addBindValue(setID);
+        query.addBindValue(type);
+        query.addBindValue(z);
+        query.addBindValue(range.x0());
+        query.addBindValue(range.x1());
+        query.addBindValue(range.y0());
+        query.addBindValue(range.y1());
+        query.addBindValue(range.doneBitmap());
+        if(!query.exec()) {
+            qWarning() << "Map Cache SQL error (add range into TileSetRanges):" << query.lastError().text();
+            _db->rollback();
+            return false;
+        }
+        set.ranges.append(range);
+    }
+    _db->commit();
+    _tileRanges[setID] = set;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_loadTileRanges(quint64 setID)
+{
+    if(_tileRanges.contains(setID)) {
+        return true;
+    }
+    QSqlQuery query(*_db);
+    QString s = QString("SELECT type, z, x0, x1, y0, y1, done FROM TileSetRanges WHERE setID = %1 ORDER BY z ASC").arg(setID);
     if(!query.exec(s)) {
-        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+        qWarning() << "Map Cache SQL error (load TileSetRanges):" << query.lastError().text();
+        return false;
+    }
+    TileSetRanges set;
+    set.type   = UrlFactory::Invalid;
+    set.cursor = 0;
+    while(query.next()) {
+        set.type = static_cast<UrlFactory::MapType>(query.value(0).toInt());
+        QGCTileRange range(query.value(1).toInt(),
+            query.value(2).toInt(), query.value(3).toInt(),
+            query.value(4).toInt(), query.value(5).toInt(),
+            query.value(6).toByteArray());
+        if(!range.isValid()) {
+            qWarning() << "Map Cache: too many tiles in stored range at zoom level" << range.z() << range.count();
+            return false;
+        }
+        set.ranges.append(range);
     }
+    if(set.ranges.count()) {
+        _tileRanges[setID] = set;
+        return true;
+    }
+    //-- Sets created before ranges existed. Rebuild them from the set bounds.
+    s = QString("SELECT * FROM TileSets WHERE setID = %1 AND defaultSet = 0").arg(setID);
+    if(query.exec(s) && query.next()) {
+        return _createTileRanges(setID,
+            static_cast<UrlFactory::MapType>(query.value("type").toInt()),
+            query.value("minZoom").toInt(), query.value("maxZoom").toInt(),
+            query.value("topleftLon").toDouble(), query.value("topleftLat").toDouble(),
+            query.value("bottomRightLon").toDouble(), query.value("bottomRightLat").toDouble());
+    }
+    return false;
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
+QGCCacheWorker::_saveTileRanges()
 {
-    if(!_testTask(mtask)) {
+    if(!_db) {
         return;
     }
-    QGCPruneCacheTask* task = static_cast<QGCPruneCacheTask*>(mtask);
+    QSqlQuery query(*_db);
+    bool started = false;
+    for(QHash<quint64, TileSetRanges>::iterator it = _tileRanges.begin(); it != _tileRanges.end(); ++it) {
+        for(int i = 0; i < it.value().ranges.count(); i++) {
+            QGCTileRange& range = it.value().ranges[i];
+            if(!range.dirty()) {
+                continue;
+            }
+            if(!started) {
+                _db->transaction();
+                started = true;
+            }
+            query.prepare("UPDATE TileSetRanges SET done = ? WHERE setID = ? AND z = ?");
+            query.addBindValue(range.doneBitmap());
+            query.addBindValue(it.key());
+            query.addBindValue(range.z());
+            if(query.exec()) {
+                range.setDirty(false);
+            } else {
+                qWarning() << "Map Cache SQL error (update TileSetRanges):" << query.lastError().text();
+            }
+        }
+    }
+    if(started) {
+        _db->commit();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-- Evicts up to one batch of tiles totalling at least amount bytes. Returns the number of tiles
+//   evicted, which is what tells the caller whether there was anything left to evict.
+int
+QGCCacheWorker::_pruneTiles(quint64 amount)
+{
+    //-- Make sure recent accesses are taken into account
+    _saveTileAccess();
     QSqlQuery query(*_db);
     QString s;
-    //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, size, hash FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128").arg(_getDefaultTileSet());
-    qint64 amount = (qint64)task->amount();
-    QList<quint64> tlist;
+    //-- Select tiles in default set only, least recently used first.
+    s = QString("SELECT tileID, size, hash FROM Tiles A WHERE "
+                "EXISTS(SELECT 1 FROM SetTiles B WHERE B.tileID = A.tileID AND B.setID = %1) AND "
+                "(SELECT COUNT(*) FROM SetTiles C WHERE C.tileID = A.tileID) = 1 "
+                "ORDER BY date ASC LIMIT %2").arg(_getDefaultTileSet()).arg(PRUNE_BATCH_SIZE);
+    quint64 pruned = 0;
+    QStringList tlist;
     if(query.exec(s)) {
-        while(query.next() && amount >= 0) {
-            tlist << query.value(0).toULongLong();
-            amount -= query.value(1).toULongLong();
-            qCDebug(QGCTileCacheLog) << "_pruneCache() HASH:" << query.value(2).toString();
+        while(pruned < amount && query.next()) {
+            tlist << query.value(0).toString();
+            pruned += query.value(1).toULongLong();
+            qCDebug(QGCTileCacheLog) << "_pruneTiles() HASH:" << query.value(2).toString();
         }
-        while(tlist.count()) {
-            s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tlist[0]);
-            tlist.removeFirst();
-            if(!query.exec(s))
-                break;
+    }
+    if(tlist.count()) {
+        s = QString("DELETE FROM Tiles WHERE tileID IN (%1)").arg(tlist.join(","));
+        if(!query.exec(s)) {
+            qWarning() << "Map Cache SQL error (prune tiles):" << query.lastError().text();
+            return 0;
         }
-        task->setPruned();
+        _updateTotals();
+    }
+    return tlist.count();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_pruneIdle()
+{
+    _mutex.lock();
+    quint64 maxSize = _maxDiskCache;
+    _mutex.unlock();
+    if(!maxSize || _defaultSize <= maxSize) {
+        return false;
+    }
+    return _pruneTiles(_defaultSize - maxSize) != 0;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_saveTileAccess()
+{
+    if(!_db || _accessedTiles.isEmpty()) {
+        return;
+    }
+    //-- The tile date is its (coarse) last access time, used for LRU eviction
+    QStringList ids;
+    foreach(quint64 tileID, _accessedTiles) {
+        ids << QString::number(tileID);
+    }
+    _accessedTiles.clear();
+    QSqlQuery query(*_db);
+    QString s = QString("UPDATE Tiles SET date = %1 WHERE tileID IN (%2)").arg(QDateTime::currentDateTime().toTime_t()).arg(ids.join(","));
+    if(!query.exec(s)) {
+        qWarning() << "Map Cache SQL error (update tile access):" << query.lastError().text();
     }
 }
 
@@ -615,12 +793,15 @@ QGCCacheWorker::_deleteTileSet(qulonglong id)
     //-- Only delete tiles unique to this set
     s = QString("DELETE FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(id);
     query.exec(s);
-    s = QString("DELETE FROM TilesDownload WHERE setID = %1").arg(id);
+    s = QString("DELETE FROM TileSetRanges WHERE setID = %1").arg(id);
     query.exec(s);
+    _tileRanges.remove(id);
     s = QString("DELETE FROM TileSets WHERE setID = %1").arg(id);
     query.exec(s);
     s = QString("DELETE FROM SetTiles WHERE setID = %1").arg(id);
     query.exec(s);
+    s = QString("DELETE FROM SetTotals WHERE setID = %1").arg(id);
+    query.exec(s);
     _updateTotals();
 }
 
@@ -652,16 +833,86 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
     QString s;
     s = QString("DROP TABLE Tiles");
     query.exec(s);
+    _accessedTiles.clear();
     s = QString("DROP TABLE TileSets");
     query.exec(s);
     s = QString("DROP TABLE SetTiles");
     query.exec(s);
-    s = QString("DROP TABLE TilesDownload");
+    s = QString("DROP TABLE SetTotals");
+    query.exec(s);
+    s = QString("DROP TABLE TileSetRanges");
     query.exec(s);
+    _tileRanges.clear();
     _valid = _createDB(_db);
     task->setResetCompleted();
 }
 
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_isMBTiles(const QString& path)
+{
+    return path.endsWith(QStringLiteral(".mbtiles"), Qt::CaseInsensitive);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_attachDatabase(const QString& path, const QString& alias)
+{
+    QSqlQuery query(*_db);
+    query.prepare(QString("ATTACH DATABASE ? AS %1").arg(alias));
+    query.addBindValue(path);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (attach database):" << path << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_detachDatabase(const QString& alias)
+{
+    QSqlQuery query(*_db);
+    if(!query.exec(QString("DETACH DATABASE %1").arg(alias))) {
+        qWarning() << "Map Cache SQL error (detach database):" << query.lastError().text();
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_nextSetTilesChunk(const QString& schema, quint64 setID, quint64 last, quint64& upper)
+{
+    //-- Tiles of a set are copied in chunks of consecutive tile IDs so progress can be reported
+    QSqlQuery query(*_db);
+    QString s = QString("SELECT MAX(tileID) FROM (SELECT tileID FROM %1.SetTiles WHERE setID = %2 AND tileID > %3 ORDER BY tileID LIMIT %4)")
+        .arg(schema).arg(setID).arg(last).arg(TRANSFER_CHUNK_SIZE);
+    if(query.exec(s) && query.next() && !query.value(0).isNull()) {
+        upper = query.value(0).toULongLong();
+        return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCCacheWorker::_uniqueSetName(const QString& name)
+{
+    quint64 setID = 0;
+    if(!_findTileSetID(name, setID)) {
+        return name;
+    }
+    //-- Set with this name already exists. Make name unique.
+    QString testName;
+    int testCount = 0;
+    while (true) {
+        testName.sprintf("%s %02d", name.toLatin1().data(), ++testCount);
+        if(!_findTileSetID(testName, setID) || testCount > 99) {
+            break;
+        }
+    }
+    return testName;
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_importSets(QGCMapTask* mtask)
@@ -670,14 +921,19 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
         return;
     }
     QGCImportTileTask* task = static_cast<QGCImportTileTask*>(mtask);
-    //-- If replacing, simply copy over it
-    if(task->replace()) {
+    if(_isMBTiles(task->path())) {
+        //-- MBTiles files hold a single tile set. They are always merged into the cache.
+        _importMBTiles(task);
+    } else if(task->replace()) {
+        //-- If replacing, simply copy over it
         //-- Close and delete old database
         if(_db) {
             delete _db;
             _db = NULL;
-            QSqlDatabase::removeDatabase(kSession);
+            QSqlDatabase::removeDatabase(_session);
         }
+        _tileRanges.clear();
+        _accessedTiles.clear();
         QFile file(_databasePath);
         file.remove();
         //-- Copy given database
@@ -686,79 +942,56 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
         _init();
         if(_valid) {
             task->setProgress(50);
-            _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
+            _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session));
             _db->setDatabaseName(_databasePath);
             _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
             _valid = _db->open();
         }
         task->setProgress(100);
     } else {
-        //-- Open imported set
-        QSqlDatabase* dbImport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-        dbImport->setDatabaseName(task->path());
-        dbImport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (dbImport->open()) {
-            QSqlQuery query(*dbImport);
+        //-- Attach imported database and copy tiles over with set based inserts
+        if(_attachDatabase(task->path(), kImportSchema)) {
+            QSqlQuery query(*_db);
             //-- Prepare progress report
             quint64 tileCount = 0;
             quint64 currentCount = 0;
+            quint64 totalSaved = 0;
             int lastProgress = -1;
             QString s;
-            s = QString("SELECT COUNT(tileID) FROM Tiles");
+            s = QString("SELECT COUNT(*) FROM %1.SetTiles").arg(kImportSchema);
             if(query.exec(s)) {
                 if(query.next()) {
-                    //-- Total number of tiles in imported database
+                    //-- Total number of set tiles in imported database
                     tileCount  = query.value(0).toULongLong();
                 }
             }
             if(tileCount) {
                 //-- Iterate Tile Sets
-                s = QString("SELECT * FROM TileSets ORDER BY defaultSet DESC, name ASC");
+                s = QString("SELECT * FROM %1.TileSets ORDER BY defaultSet DESC, name ASC").arg(kImportSchema);
                 if(query.exec(s)) {
                     while(query.next()) {
                         QString name            = query.value("name").toString();
                         quint64 setID           = query.value("setID").toULongLong();
-                        QString mapType         = query.value("typeStr").toString();
-                        double  topleftLat      = query.value("topleftLat").toDouble();
-                        double  topleftLon      = query.value("topleftLon").toDouble();
-                        double  bottomRightLat  = query.value("bottomRightLat").toDouble();
-                        double  bottomRightLon  = query.value("bottomRightLon").toDouble();
-                        int     minZoom         = query.value("minZoom").toInt();
-                        int     maxZoom         = query.value("maxZoom").toInt();
-                        int     type            = query.value("type").toInt();
-                        quint32 numTiles        = query.value("numTiles").toUInt();
                         int     defaultSet      = query.value("defaultSet").toInt();
                         quint64 insertSetID     = _getDefaultTileSet();
                         //-- If not default set, create new one
                         if(!defaultSet) {
-                            //-- Check if we have this tile set already
-                            if(_findTileSetID(name, insertSetID)) {
-                                int testCount = 0;
-                                //-- Set with this name already exists. Make name unique.
-                                while (true) {
-                                    QString testName;
-                                    testName.sprintf("%s %02d", name.toLatin1().data(), ++testCount);
-                                    if(!_findTileSetID(testName, insertSetID) || testCount > 99) {
-                                        name = testName;
-                                        break;
-                                    }
-                                }
-                            }
+                            name = _uniqueSetName(name);
                             //-- Create new set
                             QSqlQuery cQuery(*_db);
                             cQuery.prepare("INSERT INTO TileSets("
                                 "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
                                 ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
                             cQuery.addBindValue(name);
-                            cQuery.addBindValue(mapType);
-                            cQuery.addBindValue(topleftLat);
-                            cQuery.addBindValue(topleftLon);
-                            cQuery.addBindValue(bottomRightLat);
-                            cQuery.addBindValue(bottomRightLon);
-                            cQuery.addBindValue(minZoom);
-                            cQuery.addBindValue(maxZoom);
-                            cQuery.addBindValue(type);
-                            cQuery.addBindValue(numTiles);
+                            cQuery.addBindValue(query.value("typeStr").toString());
+                            cQuery.addBindValue(query.value("topleftLat").toDouble());
+                            cQuery.addBindValue(query.value("topleftLon").toDouble());
+                            cQuery.addBindValue(query.value("bottomRightLat").toDouble());
+                            cQuery.addBindValue(query.value("bottomRightLon").toDouble());
+                            cQuery.addBindValue(query.value("minZoom").toInt());
+                            cQuery.addBindValue(query.value("maxZoom").toInt());
+                            cQuery.addBindValue(query.value("type").toInt());
+                            cQuery.addBindValue(query.value("numTiles").toUInt());
                             cQuery.addBindValue(defaultSet);
                             cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
                             if(!cQuery.exec()) {
@@ -769,77 +1002,55 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
                                 insertSetID = cQuery.lastInsertId().toULongLong();
                             }
                         }
-                        //-- Find set tiles
+                        //-- Copy set tiles
                         QSqlQuery cQuery(*_db);
-                        QSqlQuery subQuery(*dbImport);
-                        QString sb = QString("SELECT * FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(setID);
-                        if(subQuery.exec(sb)) {
-                            quint64 tilesFound = 0;
-                            quint64 tilesSaved = 0;
+                        quint64 tilesSaved = 0;
+                        quint64 last  = 0;
+                        quint64 upper = 0;
+                        while(_nextSetTilesChunk(kImportSchema, setID, last, upper)) {
+                            QString range = QString("B.setID = %1 AND B.tileID > %2 AND B.tileID <= %3").arg(setID).arg(last).arg(upper);
                             _db->transaction();
-                            while(subQuery.next()) {
-                                tilesFound++;
-                                QString hash    = subQuery.value("hash").toString();
-                                QString format  = subQuery.value("format").toString();
-                                QByteArray img  = subQuery.value("tile").toByteArray();
-                                int type        = subQuery.value("type").toInt();
-                                //-- Save tile
-                                cQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                cQuery.addBindValue(hash);
-                                cQuery.addBindValue(format);
-                                cQuery.addBindValue(img);
-                                cQuery.addBindValue(img.size());
-                                cQuery.addBindValue(type);
-                                cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                                if(cQuery.exec()) {
-                                    tilesSaved++;
-                                    quint64 importTileID = cQuery.lastInsertId().toULongLong();
-                                    QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(importTileID).arg(insertSetID);
-                                    cQuery.prepare(s);
-                                    cQuery.exec();
-                                    currentCount++;
-                                    if(tileCount) {
-                                        int progress = (int)((double)currentCount / (double)tileCount * 100.0);
-                                        //-- Avoid calling this if (int) progress hasn't changed.
-                                        if(lastProgress != progress) {
-                                            lastProgress = progress;
-                                            task->setProgress(progress);
-                                        }
-                                    }
-                                }
-                            }
-                            _db->commit();
-                            if(tilesSaved) {
-                                //-- Update tile count (if any added)
-                                s = QString("SELECT COUNT(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(insertSetID);
-                                if(cQuery.exec(s)) {
-                                    if(cQuery.next()) {
-                                        quint64 count  = cQuery.value(0).toULongLong();
-                                        s = QString("UPDATE TileSets SET numTiles = %1 WHERE setID = %2").arg(count).arg(insertSetID);
-                                        cQuery.exec(s);
-                                    }
-                                }
-                            }
-                            qint64 uniqueTiles = tilesFound - tilesSaved;
-                            if((quint64)uniqueTiles < tileCount) {
-                                tileCount -= uniqueTiles;
+                            s = QString("INSERT OR IGNORE INTO main.Tiles(hash, format, tile, size, type, date) "
+                                        "SELECT A.hash, A.format, A.tile, A.size, A.type, %1 FROM %2.Tiles A JOIN %2.SetTiles B ON A.tileID = B.tileID WHERE %3")
+                                .arg(QDateTime::currentDateTime().toTime_t()).arg(kImportSchema).arg(range);
+                            if(cQuery.exec(s)) {
+                                tilesSaved += static_cast<quint64>(qMax(0, cQuery.numRowsAffected()));
                             } else {
-                                tileCount = 0;
+                                qWarning() << "Map Cache SQL error (import tiles):" << cQuery.lastError().text();
+                            }
+                            s = QString("INSERT OR IGNORE INTO main.SetTiles(tileID, setID) "
+                                        "SELECT M.tileID, %1 FROM main.Tiles M JOIN %2.Tiles A ON M.hash = A.hash JOIN %2.SetTiles B ON A.tileID = B.tileID WHERE %3")
+                                .arg(insertSetID).arg(kImportSchema).arg(range);
+                            if(cQuery.exec(s)) {
+                                currentCount += static_cast<quint64>(qMax(0, cQuery.numRowsAffected()));
                             }
-                            //-- If there was nothing new in this set, remove it.
-                            if(!tilesSaved && !defaultSet) {
-                                qCDebug(QGCTileCacheLog) << "No unique tiles in" << name << "Removing it.";
-                                _deleteTileSet(insertSetID);
+                            _db->commit();
+                            last = upper;
+                            int progress = static_cast<int>(static_cast<double>(currentCount) / static_cast<double>(tileCount) * 100.0);
+                            //-- Avoid calling this if (int) progress hasn't changed.
+                            if(lastProgress != progress) {
+                                lastProgress = progress;
+                                task->setProgress(progress);
                             }
                         }
+                        totalSaved += tilesSaved;
+                        if(tilesSaved) {
+                            //-- Update tile count (if any added)
+                            s = QString("UPDATE TileSets SET numTiles = (SELECT count FROM SetTotals WHERE setID = %1) WHERE setID = %1").arg(insertSetID);
+                            cQuery.exec(s);
+                        }
+                        //-- If there was nothing new in this set, remove it.
+                        if(!tilesSaved && !defaultSet) {
+                            qCDebug(QGCTileCacheLog) << "No unique tiles in" << name << "Removing it.";
+                            _deleteTileSet(insertSetID);
+                        }
                     }
                 } else {
                     task->setError("No tile set in database");
                 }
             }
-            delete dbImport;
-            QSqlDatabase::removeDatabase(kExportSession);
-            if(!tileCount) {
+            _detachDatabase(kImportSchema);
+            if(!totalSaved) {
                 task->setError("No unique tiles in imported database");
             }
         } else {
@@ -849,6 +1060,109 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
     task->setImportCompleted();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_importMBTiles(QGCImportTileTask* task)
+{
+    if(!_attachDatabase(task->path(), kImportSchema)) {
+        task->setError("Error opening import database");
+        return;
+    }
+    QSqlQuery query(*_db);
+    QString s;
+    //-- Read metadata
+    QHash<QString, QString> metadata;
+    s = QString("SELECT name, value FROM %1.metadata").arg(kImportSchema);
+    if(query.exec(s)) {
+        while(query.next()) {
+            metadata[query.value(0).toString()] = query.value(1).toString();
+        }
+    }
+    UrlFactory::MapType type = task->mapType();
+    if(metadata.contains(kMBTilesMapType)) {
+        type = static_cast<UrlFactory::MapType>(metadata[kMBTilesMapType].toInt());
+    }
+    quint64 tileCount = 0;
+    quint64 maxRowID  = 0;
+    int     minZoom   = 0;
+    int     maxZoom   = 0;
+    s = QString("SELECT COUNT(*), MAX(rowid), MIN(zoom_level), MAX(zoom_level) FROM %1.tiles").arg(kImportSchema);
+    if(query.exec(s) && query.next()) {
+        tileCount = query.value(0).toULongLong();
+        maxRowID  = query.value(1).toULongLong();
+        minZoom   = query.value(2).toInt();
+        maxZoom   = query.value(3).toInt();
+    }
+    if(type == UrlFactory::Invalid) {
+        task->setError("Unknown map type for imported tiles");
+    } else if(!tileCount) {
+        task->setError("No tiles in imported database");
+    } else {
+        //-- Bounds are "left,bottom,right,top"
+        QStringList bounds = metadata.value("bounds").split(",");
+        QString name = QFileInfo(task->path()).completeBaseName();
+        if(!metadata.value("name").isEmpty()) {
+            name = metadata.value("name");
+        }
+        name = _uniqueSetName(name);
+        QString format = metadata.value("format", "png");
+        QSqlQuery cQuery(*_db);
+        cQuery.prepare("INSERT INTO TileSets("
+            "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
+            ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        cQuery.addBindValue(name);
+        cQuery.addBindValue(metadata.value(kMBTilesMapTypeStr));
+        cQuery.addBindValue(bounds.count() == 4 ? bounds[3].toDouble() : 0.0);
+        cQuery.addBindValue(bounds.count() == 4 ? bounds[0].toDouble() : 0.0);
+        cQuery.addBindValue(bounds.count() == 4 ? bounds[1].toDouble() : 0.0);
+        cQuery.addBindValue(bounds.count() == 4 ? bounds[2].toDouble() : 0.0);
+        cQuery.addBindValue(minZoom);
+        cQuery.addBindValue(maxZoom);
+        cQuery.addBindValue(type);
+        cQuery.addBindValue(tileCount);
+        cQuery.addBindValue(0);
+        cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
+        if(!cQuery.exec()) {
+            task->setError("Error adding imported tile set to database");
+        } else {
+            quint64 insertSetID = cQuery.lastInsertId().toULongLong();
+            //-- Same as QGCMapEngine::getTileHash(). MBTiles rows are TMS (y axis flipped).
+            QString hash = QString("'%1' || substr('00000000' || T.tile_column, -8) || substr('00000000' || ((1 << T.zoom_level) - 1 - T.tile_row), -8) || substr('000' || T.zoom_level, -3)")
+                .arg(static_cast<int>(type), 4, 10, QChar('0'));
+            quint64 tilesSaved = 0;
+            int lastProgress = -1;
+            for(quint64 last = 0; last < maxRowID; last += TRANSFER_CHUNK_SIZE) {
+                QString range = QString("T.rowid > %1 AND T.rowid <= %2").arg(last).arg(last + TRANSFER_CHUNK_SIZE);
+                _db->transaction();
+                s = QString("INSERT OR IGNORE INTO main.Tiles(hash, format, tile, size, type, date) "
+                            "SELECT %1, '%2', T.tile_data, length(T.tile_data), %3, %4 FROM %5.tiles T WHERE %6")
+                    .arg(hash).arg(format).arg(type).arg(QDateTime::currentDateTime().toTime_t()).arg(kImportSchema).arg(range);
+                if(cQuery.exec(s)) {
+                    tilesSaved += static_cast<quint64>(qMax(0, cQuery.numRowsAffected()));
+                } else {
+                    qWarning() << "Map Cache SQL error (import MBTiles):" << cQuery.lastError().text();
+                }
+                s = QString("INSERT OR IGNORE INTO main.SetTiles(tileID, setID) "
+                            "SELECT M.tileID, %1 FROM %2.tiles T JOIN main.Tiles M ON M.hash = %3 WHERE %4")
+                    .arg(insertSetID).arg(kImportSchema).arg(hash).arg(range);
+                cQuery.exec(s);
+                _db->commit();
+                int progress = static_cast<int>(static_cast<double>(qMin(last + TRANSFER_CHUNK_SIZE, maxRowID)) / static_cast<double>(maxRowID) * 100.0);
+                if(lastProgress != progress) {
+                    lastProgress = progress;
+                    task->setProgress(progress);
+                }
+            }
+            if(!tilesSaved) {
+                qCDebug(QGCTileCacheLog) << "No unique tiles in" << name << "Removing it.";
+                _deleteTileSet(insertSetID);
+                task->setError("No unique tiles in imported database");
+            }
+        }
+    }
+    _detachDatabase(kImportSchema);
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_exportSets(QGCMapTask* mtask)
@@ -860,101 +1174,173 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
     //-- Delete target if it exists
     QFile file(task->path());
     file.remove();
-    //-- Create exported database
-    QSqlDatabase *dbExport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-    dbExport->setDatabaseName(task->path());
-    dbExport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-    if (dbExport->open()) {
-        if(_createDB(dbExport, false)) {
-            //-- Prepare progress report
-            quint64 tileCount = 0;
-            quint64 currentCount = 0;
-            for(int i = 0; i < task->sets().count(); i++) {
-                QGCCachedTileSet* set = task->sets()[i];
-                //-- Default set has no unique tiles
-                if(set->defaultSet()) {
-                    tileCount += set->totalTileCount();
-                } else {
-                    tileCount += set->uniqueTileCount();
-                }
+    bool mbtiles = _isMBTiles(task->path());
+    if(!mbtiles) {
+        //-- Create exported database
+        QSqlDatabase *dbExport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _exportSession));
+        dbExport->setDatabaseName(task->path());
+        dbExport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+        bool created = false;
+        if (dbExport->open()) {
+            created = _createDB(dbExport, false);
+            if(!created) {
+                task->setError("Error creating export database");
+            }
+        } else {
+            qCritical() << "Map Cache SQL error (create export database):" << dbExport->lastError();
+            task->setError("Error opening export database");
+        }
+        delete dbExport;
+        QSqlDatabase::removeDatabase(_exportSession);
+        if(!created) {
+            task->setExportCompleted();
+            return;
+        }
+    }
+    if(!_attachDatabase(task->path(), kExportSchema)) {
+        task->setError("Error opening export database");
+        task->setExportCompleted();
+        return;
+    }
+    QSqlQuery exportQuery(*_db);
+    QString s;
+    if(mbtiles) {
+        if(!exportQuery.exec(QString("CREATE TABLE %1.metadata (name TEXT, value TEXT)").arg(kExportSchema)) ||
+           !exportQuery.exec(QString("CREATE TABLE %1.tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)").arg(kExportSchema)) ||
+           !exportQuery.exec(QString("CREATE UNIQUE INDEX %1.tile_index ON tiles (zoom_level, tile_column, tile_row)").arg(kExportSchema))) {
+            qWarning() << "Map Cache SQL error (create MBTiles database):" << exportQuery.lastError().text();
+            task->setError("Error creating export database");
+            _detachDatabase(kExportSchema);
+            task->setExportCompleted();
+            return;
+        }
+    }
+    //-- Prepare progress report
+    quint64 tileCount = 0;
+    quint64 currentCount = 0;
+    for(int i = 0; i < task->sets().count(); i++) {
+        tileCount += task->sets()[i]->savedTileCount();
+    }
+    if(!tileCount) {
+        tileCount = 1;
+    }
+    //-- Bounds and zoom range of the exported tiles (MBTiles metadata)
+    double  left   = 180.0;
+    double  bottom = 90.0;
+    double  right  = -180.0;
+    double  top    = -90.0;
+    int     minZoom = static_cast<int>(MAX_MAP_ZOOM);
+    int     maxZoom = 0;
+    //-- Iterate sets to save
+    for(int i = 0; i < task->sets().count(); i++) {
+        QGCCachedTileSet* set = task->sets()[i];
+        quint64 exportSetID = 0;
+        if(mbtiles) {
+            if(!set->defaultSet()) {
+                left    = qMin(left,   set->topleftLon());
+                top     = qMax(top,    set->topleftLat());
+                right   = qMax(right,  set->bottomRightLon());
+                bottom  = qMin(bottom, set->bottomRightLat());
+                minZoom = qMin(minZoom, set->minZoom());
+                maxZoom = qMax(maxZoom, set->maxZoom());
             }
-            if(!tileCount) {
-                tileCount = 1;
+        } else {
+            //-- Create Tile Exported Set
+            exportQuery.prepare(QString("INSERT INTO %1.TileSets("
+                "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
+                ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)").arg(kExportSchema));
+            exportQuery.addBindValue(set->name());
+            exportQuery.addBindValue(set->mapTypeStr());
+            exportQuery.addBindValue(set->topleftLat());
+            exportQuery.addBindValue(set->topleftLon());
+            exportQuery.addBindValue(set->bottomRightLat());
+            exportQuery.addBindValue(set->bottomRightLon());
+            exportQuery.addBindValue(set->minZoom());
+            exportQuery.addBindValue(set->maxZoom());
+            exportQuery.addBindValue(set->type());
+            exportQuery.addBindValue(set->totalTileCount());
+            exportQuery.addBindValue(set->defaultSet());
+            exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
+            if(!exportQuery.exec()) {
+                task->setError("Error adding tile set to exported database");
+                break;
             }
-            //-- Iterate sets to save
-            for(int i = 0; i < task->sets().count(); i++) {
-                QGCCachedTileSet* set = task->sets()[i];
-                //-- Create Tile Exported Set
-                QSqlQuery exportQuery(*dbExport);
-                exportQuery.prepare("INSERT INTO TileSets("
-                    "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
-                    ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-                exportQuery.addBindValue(set->name());
-                exportQuery.addBindValue(set->mapTypeStr());
-                exportQuery.addBindValue(set->topleftLat());
-                exportQuery.addBindValue(set->topleftLon());
-                exportQuery.addBindValue(set->bottomRightLat());
-                exportQuery.addBindValue(set->bottomRightLon());
-                exportQuery.addBindValue(set->minZoom());
-                exportQuery.addBindValue(set->maxZoom());
-                exportQuery.addBindValue(set->type());
-                exportQuery.addBindValue(set->totalTileCount());
-                exportQuery.addBindValue(set->defaultSet());
-                exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                if(!exportQuery.exec()) {
-                    task->setError("Error adding tile set to exported database");
-                    break;
+            //-- Get just created (auto-incremented) setID
+            exportSetID = exportQuery.lastInsertId().toULongLong();
+        }
+        //-- Copy set tiles
+        quint64 last  = 0;
+        quint64 upper = 0;
+        while(_nextSetTilesChunk("main", set->id(), last, upper)) {
+            QString range = QString("B.setID = %1 AND B.tileID > %2 AND B.tileID <= %3").arg(set->id()).arg(last).arg(upper);
+            _db->transaction();
+            if(mbtiles) {
+                //-- MBTiles rows are TMS (y axis flipped). Elevation tiles are not map tiles.
+                s = QString("INSERT OR IGNORE INTO %1.tiles(zoom_level, tile_column, tile_row, tile_data) "
+                            "SELECT CAST(substr(A.hash, 21, 3) AS INTEGER), CAST(substr(A.hash, 5, 8) AS INTEGER), "
+                            "(1 << CAST(substr(A.hash, 21, 3) AS INTEGER)) - 1 - CAST(substr(A.hash, 13, 8) AS INTEGER), A.tile "
+                            "FROM main.Tiles A JOIN main.SetTiles B ON A.tileID = B.tileID WHERE %2 AND A.type != %3")
+                    .arg(kExportSchema).arg(range).arg(UrlFactory::AirmapElevation);
+                if(exportQuery.exec(s)) {
+                    currentCount += static_cast<quint64>(qMax(0, exportQuery.numRowsAffected()));
                 } else {
-                    //-- Get just created (auto-incremented) setID
-                    quint64 exportSetID = exportQuery.lastInsertId().toULongLong();
-                    //-- Find set tiles
-                    QString s = QString("SELECT * FROM SetTiles WHERE setID = %1").arg(set->id());
-                    QSqlQuery query(*_db);
-                    if(query.exec(s)) {
-                        dbExport->transaction();
-                        while(query.next()) {
-                            quint64 tileID = query.value("tileID").toULongLong();
-                            //-- Get tile
-                            QString s = QString("SELECT * FROM Tiles WHERE tileID = \"%1\"").arg(tileID);
-                            QSqlQuery subQuery(*_db);
-                            if(subQuery.exec(s)) {
-                                if(subQuery.next()) {
-                                    QString hash    = subQuery.value("hash").toString();
-                                    QString format  = subQuery.value("format").toString();
-                                    QByteArray img  = subQuery.value("tile").toByteArray();
-                                    int type        = subQuery.value("type").toInt();
-                                    //-- Save tile
-                                    exportQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                    exportQuery.addBindValue(hash);
-                                    exportQuery.addBindValue(format);
-                                    exportQuery.addBindValue(img);
-                                    exportQuery.addBindValue(img.size());
-                                    exportQuery.addBindValue(type);
-                                    exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                                    if(exportQuery.exec()) {
-                                        quint64 exportTileID = exportQuery.lastInsertId().toULongLong();
-                                        QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(exportTileID).arg(exportSetID);
-                                        exportQuery.prepare(s);
-                                        exportQuery.exec();
-                                        currentCount++;
-                                        task->setProgress((int)((double)currentCount / (double)tileCount * 100.0));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    dbExport->commit();
+                    qWarning() << "Map Cache SQL error (export MBTiles):" << exportQuery.lastError().text();
+                }
+            } else {
+                s = QString("INSERT OR IGNORE INTO %1.Tiles(hash, format, tile, size, type, date) "
+                            "SELECT A.hash, A.format, A.tile, A.size, A.type, A.date FROM main.Tiles A JOIN main.SetTiles B ON A.tileID = B.tileID WHERE %2")
+                    .arg(kExportSchema).arg(range);
+                if(!exportQuery.exec(s)) {
+                    qWarning() << "Map Cache SQL error (export tiles):" << exportQuery.lastError().text();
+                }
+                s = QString("INSERT OR IGNORE INTO %1.SetTiles(tileID, setID) "
+                            "SELECT E.tileID, %2 FROM %1.Tiles E JOIN main.Tiles A ON E.hash = A.hash JOIN main.SetTiles B ON A.tileID = B.tileID WHERE %3")
+                    .arg(kExportSchema).arg(exportSetID).arg(range);
+                if(exportQuery.exec(s)) {
+                    currentCount += static_cast<quint64>(qMax(0, exportQuery.numRowsAffected()));
                 }
             }
-        } else {
-            task->setError("Error creating export database");
+            _db->commit();
+            last = upper;
+            task->setProgress(static_cast<int>(qMin(100.0, static_cast<double>(currentCount) / static_cast<double>(tileCount) * 100.0)));
         }
-    } else {
-        qCritical() << "Map Cache SQL error (create export database):" << dbExport->lastError();
-        task->setError("Error opening export database");
     }
-    delete dbExport;
-    QSqlDatabase::removeDatabase(kExportSession);
+    if(mbtiles) {
+        //-- Map type and format are taken from the first exported tile
+        QString format = "png";
+        int     type   = UrlFactory::Invalid;
+        QString typeStr;
+        for(int i = 0; i < task->sets().count() && type == UrlFactory::Invalid; i++) {
+            s = QString("SELECT A.format, A.type FROM main.Tiles A JOIN main.SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 AND A.type != %2 LIMIT 1")
+                .arg(task->sets()[i]->id()).arg(UrlFactory::AirmapElevation);
+            if(exportQuery.exec(s) && exportQuery.next()) {
+                format  = exportQuery.value(0).toString();
+                type    = exportQuery.value(1).toInt();
+                typeStr = task->sets()[i]->mapTypeStr();
+            }
+        }
+        if(minZoom > maxZoom) {
+            minZoom = maxZoom = 0;
+            left = -180.0; bottom = -85.0511; right = 180.0; top = 85.0511;
+        }
+        QList<QPair<QString, QString>> metadata;
+        metadata << qMakePair(QString("name"),          task->sets().count() == 1 ? task->sets()[0]->name() : QString("QGroundControl"));
+        metadata << qMakePair(QString("type"),          QString("baselayer"));
+        metadata << qMakePair(QString("version"),       QString("1.0"));
+        metadata << qMakePair(QString("format"),        format);
+        metadata << qMakePair(QString("bounds"),        QString("%1,%2,%3,%4").arg(left, 0, 'f', 6).arg(bottom, 0, 'f', 6).arg(right, 0, 'f', 6).arg(top, 0, 'f', 6));
+        metadata << qMakePair(QString("minzoom"),       QString::number(minZoom));
+        metadata << qMakePair(QString("maxzoom"),       QString::number(maxZoom));
+        metadata << qMakePair(QString(kMBTilesMapType),    QString::number(type));
+        metadata << qMakePair(QString(kMBTilesMapTypeStr), typeStr);
+        for(int i = 0; i < metadata.count(); i++) {
+            exportQuery.prepare(QString("INSERT INTO %1.metadata(name, value) VALUES(?, ?)").arg(kExportSchema));
+            exportQuery.addBindValue(metadata[i].first);
+            exportQuery.addBindValue(metadata[i].second);
+            exportQuery.exec();
+        }
+    }
+    _detachDatabase(kExportSchema);
     task->setExportCompleted();
 }
 
@@ -976,7 +1362,7 @@ QGCCacheWorker::_init()
     if(!_databasePath.isEmpty()) {
         qCDebug(QGCTileCacheLog) << "Mapping cache directory:" << _databasePath;
         //-- Initialize Database
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
+        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session));
         _db->setDatabaseName(_databasePath);
         _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
         if (_db->open()) {
@@ -990,7 +1376,7 @@ QGCCacheWorker::_init()
         }
         delete _db;
         _db = NULL;
-        QSqlDatabase::removeDatabase(kSession);
+        QSqlDatabase::removeDatabase(_session);
     } else {
         qCritical() << "Could not find suitable cache directory.";
         _failed = true;
@@ -1043,19 +1429,23 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
                 qWarning() << "Map Cache SQL error (create SetTiles db):" << query.lastError().text();
             } else {
                 if(!query.exec(
-                    "CREATE TABLE IF NOT EXISTS TilesDownload ("
+                    "CREATE TABLE IF NOT EXISTS TileSetRanges ("
                     "setID INTEGER, "
-                    "hash TEXT NOT NULL UNIQUE, "
                     "type INTEGER, "
-                    "x INTEGER, "
-                    "y INTEGER, "
                     "z INTEGER, "
-                    "state INTEGER DEFAULT 0)"))
+                    "x0 INTEGER, "
+                    "x1 INTEGER, "
+                    "y0 INTEGER, "
+                    "y1 INTEGER, "
+                    "done BLOB, "
+                    "PRIMARY KEY (setID, z))"))
                 {
-                    qWarning() << "Map Cache SQL error (create TilesDownload db):" << query.lastError().text();
+                    qWarning() << "Map Cache SQL error (create TileSetRanges db):" << query.lastError().text();
                 } else {
+                    //-- Per tile download list used by older versions. Ranges are rebuilt from TileSets.
+                    query.exec("DROP TABLE IF EXISTS TilesDownload");
                     //-- Database it ready for use
-                    res = true;
+                    res = _createTotals(db);
                 }
             }
         }
@@ -1085,6 +1475,91 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
     return res;
 }
 
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_createTotals(QSqlDatabase* db)
+{
+    /*
+        Tile counts and sizes (per set, unique to a set and for the whole cache)
+        are kept in SetTotals and maintained by triggers as tiles are added to or
+        removed from the cache. Reading them is a single row lookup instead of
+        scanning Tiles and SetTiles.
+    */
+    QSqlQuery query(*db);
+    bool exists = false;
+    if(query.exec("SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'SetTotals'")) {
+        exists = query.next();
+    }
+    if(!exists) {
+        //-- Older databases may hold duplicate set entries for a tile
+        query.exec("DELETE FROM SetTiles WHERE rowid NOT IN (SELECT MIN(rowid) FROM SetTiles GROUP BY setID, tileID)");
+        if(!query.exec(
+            "CREATE TABLE SetTotals ("
+            "setID INTEGER PRIMARY KEY NOT NULL, "
+            "count INTEGER DEFAULT 0, "
+            "size INTEGER DEFAULT 0, "
+            "uniqueCount INTEGER DEFAULT 0, "
+            "uniqueSize INTEGER DEFAULT 0)"))
+        {
+            qWarning() << "Map Cache SQL error (create SetTotals db):" << query.lastError().text();
+            return false;
+        }
+    }
+    static const char* statements[] = {
+        "CREATE UNIQUE INDEX IF NOT EXISTS SetTilesIndex ON SetTiles(setID, tileID)",
+        "CREATE INDEX IF NOT EXISTS SetTilesTileIndex ON SetTiles(tileID)",
+        "CREATE INDEX IF NOT EXISTS TilesDateIndex ON Tiles(date)",
+        "CREATE TRIGGER IF NOT EXISTS TileSetsInsert AFTER INSERT ON TileSets BEGIN "
+            "INSERT OR IGNORE INTO SetTotals(setID) VALUES(NEW.setID); "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS TileSetsDelete AFTER DELETE ON TileSets BEGIN "
+            "DELETE FROM SetTotals WHERE setID = OLD.setID; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS TilesInsert AFTER INSERT ON Tiles BEGIN "
+            "UPDATE SetTotals SET count = count + 1, size = size + IFNULL(NEW.size, 0) WHERE setID = 0; "
+        "END",
+        //-- Remove set entries first so their triggers can still see the tile size
+        "CREATE TRIGGER IF NOT EXISTS TilesDelete BEFORE DELETE ON Tiles BEGIN "
+            "DELETE FROM SetTiles WHERE tileID = OLD.tileID; "
+            "UPDATE SetTotals SET count = count - 1, size = size - IFNULL(OLD.size, 0) WHERE setID = 0; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS SetTilesInsert AFTER INSERT ON SetTiles BEGIN "
+            "UPDATE SetTotals SET count = count + 1, size = size + IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0) WHERE setID = NEW.setID; "
+            "UPDATE SetTotals SET uniqueCount = uniqueCount + 1, uniqueSize = uniqueSize + IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0) "
+                "WHERE setID = NEW.setID AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 1; "
+            "UPDATE SetTotals SET uniqueCount = uniqueCount - 1, uniqueSize = uniqueSize - IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0) "
+                "WHERE setID = (SELECT setID FROM SetTiles WHERE tileID = NEW.tileID AND setID != NEW.setID) AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 2; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS SetTilesDelete AFTER DELETE ON SetTiles BEGIN "
+            "UPDATE SetTotals SET count = count - 1, size = size - IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0) WHERE setID = OLD.setID; "
+            "UPDATE SetTotals SET uniqueCount = uniqueCount - 1, uniqueSize = uniqueSize - IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0) "
+                "WHERE setID = OLD.setID AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 0; "
+            "UPDATE SetTotals SET uniqueCount = uniqueCount + 1, uniqueSize = uniqueSize + IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0) "
+                "WHERE setID = (SELECT setID FROM SetTiles WHERE tileID = OLD.tileID) AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 1; "
+        "END",
+    };
+    for(size_t i = 0; i < sizeof(statements) / sizeof(statements[0]); i++) {
+        if(!query.exec(statements[i])) {
+            qWarning() << "Map Cache SQL error (create SetTotals triggers):" << query.lastError().text();
+            return false;
+        }
+    }
+    if(!exists) {
+        //-- One time computation of the totals for existing data
+        db->transaction();
+        query.exec("INSERT INTO SetTotals(setID, count, size) SELECT 0, COUNT(size), IFNULL(SUM(size), 0) FROM Tiles");
+        query.exec(
+            "INSERT INTO SetTotals(setID, count, size, uniqueCount, uniqueSize) SELECT S.setID, "
+            "(SELECT COUNT(A.size) FROM Tiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = S.setID), "
+            "(SELECT IFNULL(SUM(A.size), 0) FROM Tiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = S.setID), "
+            "(SELECT COUNT(A.size) FROM Tiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = S.setID AND (SELECT COUNT(*) FROM SetTiles C WHERE C.tileID = A.tileID) = 1), "
+            "(SELECT IFNULL(SUM(A.size), 0) FROM Tiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = S.setID AND (SELECT COUNT(*) FROM SetTiles C WHERE C.tileID = A.tileID) = 1) "
+            "FROM TileSets S");
+        db->commit();
+    }
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_testInternet()
@@ -27,12 +27,17 @@
 #include <QMutexLocker>
 #include <QtSql/QSqlDatabase>
 #include <QHostInfo>
+#include <QHash>
+#include <QVector>
+#include <QSet>
 
 #include "QGCLoggingCategory.h"
+#include "QGCMapEngineData.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheLog)
 
 class QGCMapTask;
+class QGCImportTileTask;
 class QGCCachedTileSet;
 
 //-----------------------------------------------------------------------------
@@ -46,6 +51,7 @@ public:
     void    quit            ();
     bool    enqueueTask     (QGCMapTask* task);
     void    setDatabaseFile (const QString& path);
+    void    setMaxDiskCache (quint64 size);
 
 protected:
     void    run             ();
@@ -63,7 +69,6 @@ private:
     void        _deleteTileSet          (QGCMapTask* mtask);
     void        _renameTileSet          (QGCMapTask* mtask);
     void        _resetCacheDatabase     (QGCMapTask* mtask);
-    void        _pruneCache             (QGCMapTask* mtask);
     void        _exportSets             (QGCMapTask* mtask);
     void        _importSets             (QGCMapTask* mtask);
     bool        _testTask               (QGCMapTask* mtask);
@@ -74,20 +79,42 @@ private:
     void        _updateSetTotals        (QGCCachedTileSet* set);
     bool        _init                   ();
     bool        _createDB               (QSqlDatabase *db, bool createDefault = true);
+    bool        _createTotals           (QSqlDatabase *db);
     quint64     _getDefaultTileSet      ();
     void        _updateTotals           ();
     void        _deleteTileSet          (qulonglong id);
+    bool        _createTileRanges       (quint64 setID, UrlFactory::MapType type, int minZoom, int maxZoom, double topleftLon, double topleftLat, double bottomRightLon, double bottomRightLat);
+    bool        _loadTileRanges         (quint64 setID);
+    void        _saveTileRanges         ();
+    int         _pruneTiles             (quint64 amount);
+    bool        _pruneIdle              ();
+    void        _saveTileAccess         ();
+    void        _importMBTiles          (QGCImportTileTask* task);
+    bool        _isMBTiles              (const QString& path);
+    bool        _attachDatabase         (const QString& path, const QString& alias);
+    void        _detachDatabase         (const QString& alias);
+    bool        _nextSetTilesChunk      (const QString& schema, quint64 setID, quint64 last, quint64& upper);
+    QString     _uniqueSetName          (const QString& name);
 
 signals:
     void        updateTotals            (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
     void        internetStatus          (bool active);
 
 private:
+    //-- Download state of a tile set. Tiles are enumerated lazily from the ranges.
+    struct TileSetRanges {
+        UrlFactory::MapType     type;
+        QVector<QGCTileRange>   ranges;
+        quint64                 cursor;
+    };
+
     QQueue<QGCMapTask*>     _taskQueue;
     QMutex                  _mutex;
     QMutex                  _waitmutex;
     QWaitCondition          _waitc;
     QString                 _databasePath;
+    QString                 _session;
+    QString                 _exportSession;
     QSqlDatabase*           _db;
     bool                    _valid;
     bool                    _failed;
@@ -99,6 +126,9 @@ private:
     time_t                  _lastUpdate;
     int                     _updateTimeout;
     int                     _hostLookupID;
+    QHash<quint64, TileSetRanges> _tileRanges;
+    quint64                 _maxDiskCache;
+    QSet<quint64>           _accessedTiles;
 };
 
 #endif // QGC_TILE_CACHE_WORKER_H
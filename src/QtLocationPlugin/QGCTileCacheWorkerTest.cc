@@ -0,0 +1,473 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCMapEngine.h"
+#include "QGCMapTileSet.h"
+
+#include <QFile>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+const double QGCTileCacheWorkerTest::_topleftLat =      47.40;
+const double QGCTileCacheWorkerTest::_topleftLon =      8.50;
+const double QGCTileCacheWorkerTest::_bottomRightLat =  47.30;
+const double QGCTileCacheWorkerTest::_bottomRightLon =  8.60;
+
+static const char* kTestSession = "QGCTileCacheWorkerTest";
+
+QGCTileCacheWorkerTest::QGCTileCacheWorkerTest(void)
+    : _tempDir      (nullptr)
+    , _worker       (nullptr)
+    , _totalCount   (0)
+    , _totalSize    (0)
+    , _defaultCount (0)
+    , _defaultSize  (0)
+{
+
+}
+
+void QGCTileCacheWorkerTest::init(void)
+{
+    UnitTest::init();
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+    _totalCount =   0;
+    _totalSize =    0;
+    _defaultCount = 0;
+    _defaultSize =  0;
+}
+
+void QGCTileCacheWorkerTest::cleanup(void)
+{
+    _stopWorker();
+    delete _tempDir;
+    _tempDir = nullptr;
+    UnitTest::cleanup();
+}
+
+void QGCTileCacheWorkerTest::_startWorker(quint64 maxDiskCache)
+{
+    _worker = new QGCCacheWorker();
+    _worker->setDatabaseFile(_tempDir->filePath("cache.db"));
+    _worker->setMaxDiskCache(maxDiskCache);
+    connect(_worker, &QGCCacheWorker::updateTotals, this, [this](quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize) {
+        _totalCount =   totaltiles;
+        _totalSize =    totalsize;
+        _defaultCount = defaulttiles;
+        _defaultSize =  defaultsize;
+    });
+    QVERIFY(_runTask(new QGCMapTask(QGCMapTask::taskInit)));
+}
+
+void QGCTileCacheWorkerTest::_stopWorker(void)
+{
+    if (_worker) {
+        // The worker saves tile ranges and access times when its thread finishes
+        _worker->quit();
+        QVERIFY(_worker->wait(10000));
+        delete _worker;
+        _worker = nullptr;
+    }
+}
+
+/// Runs a task on the worker and waits for it to be done with
+///     @return false: task reported an error
+bool QGCTileCacheWorkerTest::_runTask(QGCMapTask* task)
+{
+    bool failed = false;
+    connect(task, &QGCMapTask::error, task, [&failed](QGCMapTask::TaskType, QString) { failed = true; }, Qt::DirectConnection);
+
+    // The worker deletes tasks (deleteLater) once they have run
+    QSignalSpy spyDestroyed(task, &QObject::destroyed);
+    _worker->enqueueTask(task);
+    return spyDestroyed.wait(10000) && !failed;
+}
+
+QString QGCTileCacheWorkerTest::_hash(int x, int y, int z)
+{
+    return QGCMapEngine::getTileHash(_mapType, x, y, z);
+}
+
+bool QGCTileCacheWorkerTest::_saveTile(int x, int y, int z, int size, quint64 setID)
+{
+    QByteArray image(size, static_cast<char>('a' + ((x + y + z) % 26)));
+    return _runTask(new QGCSaveTileTask(new QGCCacheTile(_hash(x, y, z), image, QStringLiteral("png"), _mapType, setID)));
+}
+
+QGCCachedTileSet* QGCTileCacheWorkerTest::_createTileSet(const QString& name)
+{
+    QGCCachedTileSet* set = new QGCCachedTileSet(name);
+    set->setMapTypeStr(QStringLiteral("Google Street Map"));
+    set->setType(_mapType);
+    set->setTopleftLat(_topleftLat);
+    set->setTopleftLon(_topleftLon);
+    set->setBottomRightLat(_bottomRightLat);
+    set->setBottomRightLon(_bottomRightLon);
+    set->setMinZoom(_minZoom);
+    set->setMaxZoom(_maxZoom);
+
+    quint64 tileCount = 0;
+    for (int z=_minZoom; z<=_maxZoom; z++) {
+        tileCount += QGCMapEngine::getTileCount(z, _topleftLon, _topleftLat, _bottomRightLon, _bottomRightLat, _mapType).tileCount;
+    }
+    set->setTotalTileCount(static_cast<quint32>(tileCount));
+
+    // The task deletes the set unless it was saved
+    if (!_runTask(new QGCCreateTileSetTask(set))) {
+        return nullptr;
+    }
+    return set;
+}
+
+QList<QGCCachedTileSet*> QGCTileCacheWorkerTest::_fetchTileSets(void)
+{
+    QList<QGCCachedTileSet*> sets;
+    QGCFetchTileSetTask* task = new QGCFetchTileSetTask();
+    connect(task, &QGCFetchTileSetTask::tileSetsFetched, task, [&sets](QList<QGCCachedTileSet*> tileSets) { sets = tileSets; }, Qt::DirectConnection);
+    _runTask(task);
+    return sets;
+}
+
+/// @return Number of tiles left to download for the set, -1 for error
+int QGCTileCacheWorkerTest::_downloadList(quint64 setID, QStringList* hashes)
+{
+    QList<QGCTile*> tiles;
+    QGCGetTileDownloadListTask* task = new QGCGetTileDownloadListTask(setID, 100000);
+    connect(task, &QGCGetTileDownloadListTask::tileListFetched, task, [&tiles](QList<QGCTile*> tileList) { tiles = tileList; }, Qt::DirectConnection);
+    if (!_runTask(task)) {
+        return -1;
+    }
+    for (const QGCTile* tile: tiles) {
+        if (hashes) {
+            hashes->append(tile->hash());
+        }
+    }
+    int count = tiles.count();
+    qDeleteAll(tiles);
+    return count;
+}
+
+/// @return Tile image, empty if the tile is not in the cache
+QByteArray QGCTileCacheWorkerTest::_fetchTile(const QString& hash)
+{
+    QByteArray image;
+    QGCFetchTileTask* task = new QGCFetchTileTask(hash);
+    connect(task, &QGCFetchTileTask::tileFetched, task, [&image](QGCCacheTile* tile) { image = tile->img(); delete tile; }, Qt::DirectConnection);
+    _runTask(task);
+    return image;
+}
+
+/// Reads the tile hashes straight from the database. The worker must be stopped.
+QStringList QGCTileCacheWorkerTest::_cachedHashes(void)
+{
+    QStringList hashes;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", kTestSession);
+        db.setDatabaseName(_tempDir->filePath("cache.db"));
+        if (db.open()) {
+            QSqlQuery query(db);
+            if (query.exec("SELECT hash FROM Tiles ORDER BY hash")) {
+                while (query.next()) {
+                    hashes.append(query.value(0).toString());
+                }
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(kTestSession);
+    return hashes;
+}
+
+/// Sets the last access time of tiles straight in the database. The worker must be stopped.
+bool QGCTileCacheWorkerTest::_setTileDates(const QList<QPair<QString, uint>>& dates)
+{
+    bool result = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", kTestSession);
+        db.setDatabaseName(_tempDir->filePath("cache.db"));
+        if (db.open()) {
+            QSqlQuery query(db);
+            result = true;
+            for (const QPair<QString, uint>& date: dates) {
+                query.prepare("UPDATE Tiles SET date = ? WHERE hash = ?");
+                query.addBindValue(date.second);
+                query.addBindValue(date.first);
+                result &= query.exec() && query.numRowsAffected() == 1;
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(kTestSession);
+    return result;
+}
+
+void QGCTileCacheWorkerTest::_testTileRange(void)
+{
+    QGCTileRange range(10, 5, 7, 20, 21);
+    QCOMPARE(range.count(), 6ull);
+    QCOMPARE(range.doneBitmap().size(), 1);
+    QVERIFY(range.contains(7, 20, 10));
+    QVERIFY(!range.contains(8, 20, 10));
+    QVERIFY(!range.contains(7, 20, 11));
+
+    quint64 index = range.index(6, 21);
+    QCOMPARE(range.tileX(index), 6);
+    QCOMPARE(range.tileY(index), 21);
+
+    QVERIFY(!range.dirty());
+    QVERIFY(!range.isDone(index));
+    range.setDone(index);
+    QVERIFY(range.isDone(index));
+    QVERIFY(range.dirty());
+
+    // Ranges are restored from the stored bitmap
+    QGCTileRange restored(10, 5, 7, 20, 21, range.doneBitmap());
+    QVERIFY(restored.isDone(index));
+    QVERIFY(!restored.isDone(0));
+    QVERIFY(!restored.dirty());
+
+    // A bitmap which does not match the range is ignored
+    QGCTileRange mismatched(10, 5, 30, 20, 21, range.doneBitmap());
+    QCOMPARE(mismatched.doneBitmap().size(), 7);
+    QVERIFY(!mismatched.isDone(index));
+
+    QCOMPARE(QGCTileRange().count(), 0ull);
+    QVERIFY(QGCTileRange().isValid());
+
+    // The whole world at zoom 18 does not fit the bitmap and is rejected instead of wrapping
+    const int worldTiles = 1 << 18;
+    QGCTileRange world(18, 0, worldTiles - 1, 0, worldTiles - 1);
+    QCOMPARE(world.count(), static_cast<quint64>(worldTiles) * worldTiles);
+    QVERIFY(!world.isValid());
+    QVERIFY(world.doneBitmap().isEmpty());
+}
+
+void QGCTileCacheWorkerTest::_testDownloadList(void)
+{
+    _startWorker();
+
+    // A tile of the set already in the cache is added to the set instead of being downloaded
+    QGCTileSet zoomTiles = QGCMapEngine::getTileCount(_minZoom, _topleftLon, _topleftLat, _bottomRightLon, _bottomRightLat, _mapType);
+    QString cachedHash = _hash(zoomTiles.tileX0, zoomTiles.tileY0, _minZoom);
+    QVERIFY(_saveTile(zoomTiles.tileX0, zoomTiles.tileY0, _minZoom, 100));
+
+    QGCCachedTileSet* set = _createTileSet(QStringLiteral("Ranges"));
+    QVERIFY(set);
+    quint64 setID = set->id();
+    int expectedCount = static_cast<int>(set->totalTileCount());
+    delete set;
+    QVERIFY(expectedCount > 2);
+
+    QStringList hashes;
+    QCOMPARE(_downloadList(setID, &hashes), expectedCount - 1);
+    QVERIFY(!hashes.contains(cachedHash));
+    QCOMPARE(hashes.toSet().count(), hashes.count());
+
+    // Enumeration carries on from where it stopped
+    QCOMPARE(_downloadList(setID), 0);
+
+    // Restarting lists all tiles which are not done again
+    QVERIFY(_runTask(new QGCUpdateTileDownloadStateTask(setID, QGCTile::StatePending, QStringLiteral("*"))));
+    QCOMPARE(_downloadList(setID), expectedCount - 1);
+
+    QVERIFY(_runTask(new QGCUpdateTileDownloadStateTask(setID, QGCTile::StateComplete, hashes[0])));
+    QVERIFY(_runTask(new QGCUpdateTileDownloadStateTask(setID, QGCTile::StatePending, QStringLiteral("*"))));
+    QCOMPARE(_downloadList(setID), expectedCount - 2);
+
+    // The completion bitmap is stored with the set
+    _stopWorker();
+    _startWorker();
+    hashes.clear();
+    QCOMPARE(_downloadList(setID, &hashes), expectedCount - 2);
+    QVERIFY(!hashes.contains(cachedHash));
+}
+
+void QGCTileCacheWorkerTest::_testTotals(void)
+{
+    _startWorker();
+
+    QVERIFY(_saveTile(1, 1, 12, 100));
+    QVERIFY(_saveTile(2, 1, 12, 200));
+    QVERIFY(_saveTile(3, 1, 12, 300));
+    QTRY_COMPARE(_totalCount, 3u);
+    QCOMPARE(_totalSize, 600ull);
+    QCOMPARE(_defaultCount, 3u);
+    QCOMPARE(_defaultSize, 600ull);
+
+    // One tile shared with the default set, one unique to the set
+    QGCTileSet zoomTiles = QGCMapEngine::getTileCount(_minZoom, _topleftLon, _topleftLat, _bottomRightLon, _bottomRightLat, _mapType);
+    QVERIFY(_saveTile(zoomTiles.tileX0, zoomTiles.tileY0, _minZoom, 400));
+    QGCCachedTileSet* set = _createTileSet(QStringLiteral("Totals"));
+    QVERIFY(set);
+    quint64 setID = set->id();
+    delete set;
+    QVERIFY(_downloadList(setID) > 0);
+    QVERIFY(_saveTile(zoomTiles.tileX0, zoomTiles.tileY0, _maxZoom, 500, setID));
+
+    QTRY_COMPARE(_totalCount, 5u);
+    QCOMPARE(_totalSize, 1500ull);
+    QCOMPARE(_defaultCount, 3u);
+    QCOMPARE(_defaultSize, 600ull);
+
+    QList<QGCCachedTileSet*> sets = _fetchTileSets();
+    QCOMPARE(sets.count(), 2);
+    for (QGCCachedTileSet* fetchedSet: sets) {
+        if (fetchedSet->defaultSet()) {
+            QCOMPARE(fetchedSet->savedTileCount(), 5u);
+            QCOMPARE(fetchedSet->savedTileSize(), 1500ull);
+        } else {
+            QCOMPARE(fetchedSet->id(), setID);
+            QCOMPARE(fetchedSet->savedTileCount(), 2u);
+            QCOMPARE(fetchedSet->savedTileSize(), 900ull);
+            QCOMPARE(fetchedSet->uniqueTileCount(), 1u);
+            QCOMPARE(fetchedSet->uniqueTileSize(), 500ull);
+        }
+    }
+    qDeleteAll(sets);
+
+    // Deleting the set removes its unique tile, the shared tile is now unique to the default set
+    QVERIFY(_runTask(new QGCDeleteTileSetTask(setID)));
+    QTRY_COMPARE(_totalCount, 4u);
+    QCOMPARE(_totalSize, 1000ull);
+    QCOMPARE(_defaultCount, 4u);
+    QCOMPARE(_defaultSize, 1000ull);
+}
+
+void QGCTileCacheWorkerTest::_testPruneOrder(void)
+{
+    QString a = _hash(1, 1, 12);
+    QString b = _hash(2, 1, 12);
+    QString c = _hash(3, 1, 12);
+    QString d = _hash(4, 1, 12);
+
+    _startWorker();
+    QVERIFY(_saveTile(1, 1, 12, 1000));
+    QVERIFY(_saveTile(2, 1, 12, 1000));
+    QVERIFY(_saveTile(3, 1, 12, 1000));
+    QVERIFY(_saveTile(4, 1, 12, 1000));
+    _stopWorker();
+    QVERIFY(_setTileDates({ { a, 100 }, { b, 400 }, { c, 200 }, { d, 300 } }));
+
+    // Reading a tile makes it the most recently used
+    _startWorker();
+    QVERIFY(!_fetchTile(a).isEmpty());
+    _stopWorker();
+
+    // Least recently used tiles are evicted while idle, until the cache is within its limit again
+    _startWorker(2500);
+    QTRY_COMPARE(_defaultSize, 2000ull);
+    QCOMPARE(_defaultCount, 2u);
+    _stopWorker();
+
+    QCOMPARE(_cachedHashes(), QStringList({ a, b }));
+}
+
+void QGCTileCacheWorkerTest::_testExportImport(void)
+{
+    _startWorker();
+
+    QVERIFY(_saveTile(1, 1, 12, 100));
+    QVERIFY(_saveTile(2, 1, 12, 200));
+    QGCCachedTileSet* set = _createTileSet(QStringLiteral("Export"));
+    QVERIFY(set);
+    quint64 setID = set->id();
+    delete set;
+    QGCTileSet zoomTiles = QGCMapEngine::getTileCount(_minZoom, _topleftLon, _topleftLat, _bottomRightLon, _bottomRightLat, _mapType);
+    QVERIFY(_saveTile(zoomTiles.tileX0, zoomTiles.tileY0, _minZoom, 300, setID));
+
+    QStringList hashes({ _hash(1, 1, 12), _hash(2, 1, 12), _hash(zoomTiles.tileX0, zoomTiles.tileY0, _minZoom) });
+    QList<QByteArray> images;
+    for (const QString& hash: hashes) {
+        images.append(_fetchTile(hash));
+        QVERIFY(!images.last().isEmpty());
+    }
+
+    QList<QGCCachedTileSet*> sets = _fetchTileSets();
+    QCOMPARE(sets.count(), 2);
+    QString exportFile = _tempDir->filePath("export.qgctiledb");
+    QVERIFY(_runTask(new QGCExportTileTask(sets.toVector(), exportFile)));
+    qDeleteAll(sets);
+    QVERIFY(QFile::exists(exportFile));
+
+    // Merge into an empty cache
+    QVERIFY(_runTask(new QGCResetTask()));
+    QVERIFY(_fetchTile(hashes[0]).isEmpty());
+
+    int lastProgress = -1;
+    QGCImportTileTask* importTask = new QGCImportTileTask(exportFile, false);
+    connect(importTask, &QGCImportTileTask::actionProgress, importTask, [&lastProgress](int percentage) { lastProgress = percentage; }, Qt::DirectConnection);
+    QVERIFY(_runTask(importTask));
+    QCOMPARE(lastProgress, 100);
+
+    for (int i=0; i<hashes.count(); i++) {
+        QCOMPARE(_fetchTile(hashes[i]), images[i]);
+    }
+    sets = _fetchTileSets();
+    QCOMPARE(sets.count(), 2);
+    for (QGCCachedTileSet* fetchedSet: sets) {
+        if (!fetchedSet->defaultSet()) {
+            QCOMPARE(fetchedSet->name(), QStringLiteral("Export"));
+            QCOMPARE(fetchedSet->savedTileCount(), 1u);
+        }
+    }
+    qDeleteAll(sets);
+}
+
+void QGCTileCacheWorkerTest::_testMBTilesExportImport(void)
+{
+    _startWorker();
+
+    QGCCachedTileSet* set = _createTileSet(QStringLiteral("MBTiles"));
+    QVERIFY(set);
+    quint64 setID = set->id();
+    delete set;
+    QGCTileSet minZoomTiles = QGCMapEngine::getTileCount(_minZoom, _topleftLon, _topleftLat, _bottomRightLon, _bottomRightLat, _mapType);
+    QGCTileSet maxZoomTiles = QGCMapEngine::getTileCount(_maxZoom, _topleftLon, _topleftLat, _bottomRightLon, _bottomRightLat, _mapType);
+    QVERIFY(_saveTile(minZoomTiles.tileX0, minZoomTiles.tileY0, _minZoom, 100, setID));
+    QVERIFY(_saveTile(maxZoomTiles.tileX1, maxZoomTiles.tileY1, _maxZoom, 200, setID));
+
+    QStringList hashes({ _hash(minZoomTiles.tileX0, minZoomTiles.tileY0, _minZoom), _hash(maxZoomTiles.tileX1, maxZoomTiles.tileY1, _maxZoom) });
+    QList<QByteArray> images;
+    for (const QString& hash: hashes) {
+        images.append(_fetchTile(hash));
+        QVERIFY(!images.last().isEmpty());
+    }
+
+    QVector<QGCCachedTileSet*> exportSets;
+    QList<QGCCachedTileSet*> sets = _fetchTileSets();
+    for (QGCCachedTileSet* fetchedSet: sets) {
+        if (!fetchedSet->defaultSet()) {
+            exportSets.append(fetchedSet);
+        }
+    }
+    QCOMPARE(exportSets.count(), 1);
+    QString exportFile = _tempDir->filePath("export.mbtiles");
+    QVERIFY(_runTask(new QGCExportTileTask(exportSets, exportFile)));
+    qDeleteAll(sets);
+
+    // The map type and tile coordinates (TMS rows) come back from the MBTiles file
+    QVERIFY(_runTask(new QGCResetTask()));
+    QVERIFY(_runTask(new QGCImportTileTask(exportFile, false)));
+    for (int i=0; i<hashes.count(); i++) {
+        QCOMPARE(_fetchTile(hashes[i]), images[i]);
+    }
+
+    sets = _fetchTileSets();
+    QCOMPARE(sets.count(), 2);
+    for (QGCCachedTileSet* fetchedSet: sets) {
+        if (!fetchedSet->defaultSet()) {
+            QCOMPARE(fetchedSet->name(), QStringLiteral("MBTiles"));
+            QCOMPARE(fetchedSet->type(), _mapType);
+            QCOMPARE(fetchedSet->minZoom(), _minZoom);
+            QCOMPARE(fetchedSet->maxZoom(), _maxZoom);
+            QCOMPARE(fetchedSet->savedTileCount(), 2u);
+        }
+    }
+    qDeleteAll(sets);
+}
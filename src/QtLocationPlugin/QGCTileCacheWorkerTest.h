@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMapUrlEngine.h"
+
+#include <QTemporaryDir>
+
+class QGCCacheWorker;
+class QGCMapTask;
+class QGCCachedTileSet;
+
+/// Unit test for the map tile cache worker: tile set ranges, cache totals, eviction and import/export.
+/// The worker is run against a database in a temporary directory.
+class QGCTileCacheWorkerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QGCTileCacheWorkerTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _testTileRange(void);
+    void _testDownloadList(void);
+    void _testTotals(void);
+    void _testPruneOrder(void);
+    void _testExportImport(void);
+    void _testMBTilesExportImport(void);
+
+private:
+    void                        _startWorker    (quint64 maxDiskCache = 0);
+    void                        _stopWorker     (void);
+    bool                        _runTask        (QGCMapTask* task);
+    bool                        _saveTile       (int x, int y, int z, int size, quint64 setID = UINT64_MAX);
+    QGCCachedTileSet*           _createTileSet  (const QString& name);
+    QList<QGCCachedTileSet*>    _fetchTileSets  (void);
+    int                         _downloadList   (quint64 setID, QStringList* hashes = nullptr);
+    QByteArray                  _fetchTile      (const QString& hash);
+    QStringList                 _cachedHashes   (void);
+    bool                        _setTileDates   (const QList<QPair<QString, uint>>& dates);
+    QString                     _hash           (int x, int y, int z);
+
+    QTemporaryDir*  _tempDir;
+    QGCCacheWorker* _worker;
+    quint32         _totalCount;
+    quint64         _totalSize;
+    quint32         _defaultCount;
+    quint64         _defaultSize;
+
+    static const UrlFactory::MapType    _mapType = UrlFactory::GoogleMap;
+    static const int                    _minZoom = 10;
+    static const int                    _maxZoom = 11;
+    static const double                 _topleftLat;
+    static const double                 _topleftLon;
+    static const double                 _bottomRightLat;
+    static const double                 _bottomRightLon;
+};
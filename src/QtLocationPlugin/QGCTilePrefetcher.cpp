@@ -0,0 +1,371 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Predictive map tile prefetch
+ *
+ */
+
+#include "QGCTilePrefetcher.h"
+#include "QGCMapEngine.h"
+#include "QGeoMapReplyQGC.h"
+#include "QGroundControlQmlGlobal.h"
+#include "MultiVehicleManager.h"
+#include "MissionManager.h"
+#include "MissionItem.h"
+#include "SettingsManager.h"
+#include "QGCApplication.h"
+#include "Vehicle.h"
+
+#include <QNetworkProxy>
+#include <math.h>
+
+QGC_LOGGING_CATEGORY(QGCTilePrefetcherLog, "QGCTilePrefetcherLog")
+
+const double QGCTilePrefetcher::kCorridorWidth      = 500.0;
+const double QGCTilePrefetcher::kConeHalfAngle      = 30.0;
+const double QGCTilePrefetcher::kLookAheadSeconds   = 60.0;
+const double QGCTilePrefetcher::kMinCourseSpeed     = 2.0;
+
+static const double kEarthCircumference = 40075016.686;
+//-- Prefetch requests in flight at any given time
+static const int    kMaxOutstanding     = 2;
+//-- Bounds on the bookkeeping so a long flight doesn't grow memory
+static const int    kMaxRequested       = 50000;
+static const int    kMaxQueued          = 20000;
+
+//-----------------------------------------------------------------------------
+QGCTilePrefetcher::QGCTilePrefetcher(QObject* parent)
+    : QObject(parent)
+    , _networkManager(nullptr)
+    , _multiVehicleManager(nullptr)
+    , _queuedMapType(UrlFactory::Invalid)
+    , _tilesPerSecond(0)
+    , _outstanding(0)
+{
+    connect(&_timer, &QTimer::timeout, this, &QGCTilePrefetcher::_tick);
+}
+
+//-----------------------------------------------------------------------------
+QGCTilePrefetcher::~QGCTilePrefetcher()
+{
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::init(MultiVehicleManager* multiVehicleManager, Fact* tilesPerSecond)
+{
+    _multiVehicleManager = multiVehicleManager;
+    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded,   this, &QGCTilePrefetcher::_vehicleAdded);
+    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &QGCTilePrefetcher::_vehicleRemoved);
+    connect(tilesPerSecond, &Fact::rawValueChanged, this, &QGCTilePrefetcher::_tilesPerSecondChanged);
+    _tilesPerSecondChanged(tilesPerSecond->rawValue());
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_tilesPerSecondChanged(QVariant value)
+{
+    _tilesPerSecond = value.toInt();
+    if(_tilesPerSecond > 0) {
+        //-- One tile per tick
+        _timer.start(qMax(1, 1000 / _tilesPerSecond));
+    } else {
+        _timer.stop();
+        _clearQueue(_coneQueue);
+        _clearQueue(_pathQueue);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_vehicleAdded(Vehicle* vehicle)
+{
+    connect(vehicle, &Vehicle::coordinateChanged, this, &QGCTilePrefetcher::_vehicleCoordinateChanged);
+    connect(vehicle->missionManager(), &MissionManager::newMissionItemsAvailable, this, &QGCTilePrefetcher::_missionItemsAvailable);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_vehicleRemoved(Vehicle* vehicle)
+{
+    disconnect(vehicle, nullptr, this, nullptr);
+    disconnect(vehicle->missionManager(), nullptr, this, nullptr);
+    _lastConeCoord.remove(vehicle);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
+{
+    Vehicle* vehicle = qobject_cast<Vehicle*>(sender());
+    if(!vehicle || !_tilesPerSecond || !coordinate.isValid()) {
+        return;
+    }
+    double speed = vehicle->groundSpeed()->rawValue().toDouble();
+    if(qIsNaN(speed) || speed < 1.0) {
+        return;
+    }
+    double distance = speed * kLookAheadSeconds;
+    //-- Only recompute the cone once the vehicle has covered a quarter of it
+    if(_lastConeCoord.contains(vehicle) && _lastConeCoord[vehicle].distanceTo(coordinate) < distance / 4.0) {
+        return;
+    }
+    _lastConeCoord[vehicle] = coordinate;
+    VehicleGPSFactGroup* gps = qobject_cast<VehicleGPSFactGroup*>(vehicle->gpsFactGroup());
+    double courseOverGround = gps ? gps->courseOverGround()->rawValue().toDouble() : qQNaN();
+    prefetchCone(coordinate, travelDirection(courseOverGround, vehicle->heading()->rawValue().toDouble(), speed), distance);
+}
+
+//-----------------------------------------------------------------------------
+double
+QGCTilePrefetcher::travelDirection(double courseOverGround, double heading, double groundSpeed)
+{
+    if(qIsNaN(courseOverGround) || groundSpeed < kMinCourseSpeed) {
+        return heading;
+    }
+    return courseOverGround;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_missionItemsAvailable()
+{
+    MissionManager* missionManager = qobject_cast<MissionManager*>(sender());
+    if(!missionManager || !_tilesPerSecond) {
+        return;
+    }
+    QList<QGeoCoordinate> path;
+    const QList<MissionItem*>& items = missionManager->missionItems();
+    for(int i = 0; i < items.count(); i++) {
+        QGeoCoordinate coord = items[i]->coordinate();
+        //-- Items without a position have a 0,0 coordinate
+        if(coord.isValid() && (coord.latitude() != 0.0 || coord.longitude() != 0.0)) {
+            path.append(coord);
+        }
+    }
+    prefetchPath(path, kCorridorWidth);
+}
+
+//-----------------------------------------------------------------------------
+UrlFactory::MapType
+QGCTilePrefetcher::_mapType()
+{
+    FlightMapSettings* settings = qgcApp()->toolbox()->settingsManager()->flightMapSettings();
+    QString mapName = settings->mapProvider()->enumStringValue() + " " + settings->mapType()->enumStringValue();
+    UrlFactory::MapType type = QGCMapEngine::getTypeFromName(mapName);
+    if(type != _queuedMapType) {
+        //-- Map changed. Whatever was queued is for the wrong map.
+        _queuedMapType = type;
+        _coneQueue.clear();
+        _pathQueue.clear();
+        _requested.clear();
+    }
+    return type;
+}
+
+//-----------------------------------------------------------------------------
+QList<int>
+QGCTilePrefetcher::_zoomLevels()
+{
+    //-- The zoom the flight map is displayed at and the one below it
+    int zoom = qBound(1, static_cast<int>(round(QGroundControlQmlGlobal::flightMapZoom())), static_cast<int>(MAX_MAP_ZOOM));
+    QList<int> levels;
+    levels << zoom;
+    if(zoom > 1) {
+        levels << zoom - 1;
+    }
+    return levels;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_enqueueArea(QQueue<PrefetchTile>& queue, const QGeoCoordinate& center, double radius, int zoom)
+{
+    QGeoCoordinate topLeft      = center.atDistanceAndAzimuth(radius * M_SQRT2, 315.0);
+    QGeoCoordinate bottomRight  = center.atDistanceAndAzimuth(radius * M_SQRT2, 135.0);
+    QGCTileSet set = QGCMapEngine::getTileCount(zoom, topLeft.longitude(), topLeft.latitude(), bottomRight.longitude(), bottomRight.latitude(), _queuedMapType);
+    for(int x = set.tileX0; x <= set.tileX1; x++) {
+        for(int y = set.tileY0; y <= set.tileY1; y++) {
+            if(queue.count() >= kMaxQueued) {
+                return;
+            }
+            QString hash = QGCMapEngine::getTileHash(_queuedMapType, x, y, zoom);
+            if(!_requested.contains(hash)) {
+                _requested.insert(hash);
+                PrefetchTile tile = { x, y, zoom };
+                queue.enqueue(tile);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-- Tiles dropped from a queue were never requested, so they may be queued again later
+void
+QGCTilePrefetcher::_clearQueue(QQueue<PrefetchTile>& queue)
+{
+    while(!queue.isEmpty()) {
+        PrefetchTile tile = queue.dequeue();
+        _requested.remove(QGCMapEngine::getTileHash(_queuedMapType, tile.x, tile.y, tile.z));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-- A tile which could not be downloaded is retried the next time its area is queued
+void
+QGCTilePrefetcher::_requestFailed(const QString& hash)
+{
+    _requested.remove(hash);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::prefetchPath(const QList<QGeoCoordinate>& path, double corridorWidth)
+{
+    if(_mapType() == UrlFactory::Invalid || path.isEmpty()) {
+        return;
+    }
+    _clearQueue(_pathQueue);
+    QList<int> levels = _zoomLevels();
+    for(int l = 0; l < levels.count(); l++) {
+        int zoom = levels[l];
+        for(int i = 0; i < path.count(); i++) {
+            //-- Sample each segment at half a tile so the corridor has no gaps
+            double tileSize = kEarthCircumference * cos(path[i].latitude() * M_PI / 180.0) / pow(2.0, zoom);
+            double step     = qMax(tileSize / 2.0, 1.0);
+            _enqueueArea(_pathQueue, path[i], corridorWidth / 2.0, zoom);
+            if(i + 1 < path.count()) {
+                double length  = path[i].distanceTo(path[i + 1]);
+                double azimuth = path[i].azimuthTo(path[i + 1]);
+                for(double d = step; d < length; d += step) {
+                    _enqueueArea(_pathQueue, path[i].atDistanceAndAzimuth(d, azimuth), corridorWidth / 2.0, zoom);
+                }
+            }
+        }
+    }
+    qCDebug(QGCTilePrefetcherLog) << "Mission corridor tiles queued:" << _pathQueue.count();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::prefetchCone(const QGeoCoordinate& coord, double heading, double distance)
+{
+    if(_mapType() == UrlFactory::Invalid) {
+        return;
+    }
+    //-- A new cone supersedes the previous one
+    _clearQueue(_coneQueue);
+    double tanHalfAngle = tan(kConeHalfAngle * M_PI / 180.0);
+    QList<int> levels = _zoomLevels();
+    for(int l = 0; l < levels.count(); l++) {
+        int zoom = levels[l];
+        double tileSize = kEarthCircumference * cos(coord.latitude() * M_PI / 180.0) / pow(2.0, zoom);
+        double step     = qMax(tileSize / 2.0, 1.0);
+        for(double d = 0; d <= distance; d += step) {
+            _enqueueArea(_coneQueue, coord.atDistanceAndAzimuth(d, heading), qMax(d * tanHalfAngle, step), zoom);
+        }
+    }
+    qCDebug(QGCTilePrefetcherLog) << "Look ahead tiles queued:" << _coneQueue.count();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_tick()
+{
+    //-- Interactive map requests always go first
+    if(QGeoTiledMapReplyQGC::requestCount() > 0 || _outstanding >= kMaxOutstanding) {
+        return;
+    }
+    if(!getQGCMapEngine()->isInternetActive() || (_coneQueue.isEmpty() && _pathQueue.isEmpty())) {
+        return;
+    }
+    if(_requested.count() > kMaxRequested) {
+        _requested.clear();
+    }
+    PrefetchTile tile = _coneQueue.count() ? _coneQueue.dequeue() : _pathQueue.dequeue();
+    //-- Check the cache first. Only tiles missing from it are downloaded.
+    QGCFetchTileTask* task = getQGCMapEngine()->createFetchTileTask(_queuedMapType, tile.x, tile.y, tile.z);
+    connect(task, &QGCFetchTileTask::tileFetched, this, &QGCTilePrefetcher::_tileCached);
+    connect(task, &QGCMapTask::error, this, &QGCTilePrefetcher::_tileNotCached);
+    _outstanding++;
+    getQGCMapEngine()->addTask(task);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_tileCached(QGCCacheTile* tile)
+{
+    _outstanding--;
+    tile->deleteLater();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_tileNotCached(QGCMapTask::TaskType, QString)
+{
+    QGCFetchTileTask* task = qobject_cast<QGCFetchTileTask*>(sender());
+    if(!task) {
+        _outstanding--;
+        return;
+    }
+    int x = 0, y = 0, z = 0;
+    UrlFactory::MapType type = QGCMapEngine::hashToTile(task->hash(), x, y, z);
+    if (!_networkManager) {
+        _networkManager = new QNetworkAccessManager(this);
+    }
+    QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(type, x, y, z, _networkManager);
+    if(request.url().isEmpty()) {
+        _outstanding--;
+        _requestFailed(task->hash());
+        return;
+    }
+    request.setAttribute(QNetworkRequest::User, task->hash());
+#if !defined(__mobile__)
+    QNetworkProxy proxy = _networkManager->proxy();
+    QNetworkProxy tProxy;
+    tProxy.setType(QNetworkProxy::DefaultProxy);
+    _networkManager->setProxy(tProxy);
+#endif
+    QNetworkReply* reply = _networkManager->get(request);
+    reply->setParent(nullptr);
+    connect(reply, &QNetworkReply::finished, this, &QGCTilePrefetcher::_networkReplyFinished);
+#if !defined(__mobile__)
+    _networkManager->setProxy(proxy);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTilePrefetcher::_networkReplyFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if(!reply) {
+        return;
+    }
+    _outstanding--;
+    QString hash = reply->request().attribute(QNetworkRequest::User).toString();
+    if(reply->error() == QNetworkReply::NoError) {
+        UrlFactory::MapType type = getQGCMapEngine()->hashToType(hash);
+        QByteArray image = reply->readAll();
+        QString format = getQGCMapEngine()->urlFactory()->getImageFormat(type, image);
+        if(!format.isEmpty()) {
+            getQGCMapEngine()->cacheTile(type, hash, image, format);
+            qCDebug(QGCTilePrefetcherLog) << "Prefetched" << hash;
+        } else {
+            _requestFailed(hash);
+        }
+    } else {
+        qCDebug(QGCTilePrefetcherLog) << "Prefetch error" << reply->errorString();
+        _requestFailed(hash);
+    }
+    reply->deleteLater();
+}
@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Predictive map tile prefetch
+ *
+ *   Warms the tile cache for a corridor around the mission loaded on each
+ *   vehicle and for a cone ahead of each vehicle's direction of travel.
+ *   Requests are rate limited (tiles per second) and held back while the
+ *   map itself has tile requests in flight.
+ */
+
+#ifndef QGC_TILE_PREFETCHER_H
+#define QGC_TILE_PREFETCHER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QQueue>
+#include <QSet>
+#include <QHash>
+#include <QGeoCoordinate>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMapEngineData.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTilePrefetcherLog)
+
+class MultiVehicleManager;
+class Vehicle;
+class Fact;
+
+//-----------------------------------------------------------------------------
+class QGCTilePrefetcher : public QObject
+{
+    Q_OBJECT
+
+    friend class QGCTilePrefetcherTest;
+
+public:
+    QGCTilePrefetcher(QObject* parent = nullptr);
+    ~QGCTilePrefetcher();
+
+    void    init                (MultiVehicleManager* multiVehicleManager, Fact* tilesPerSecond);
+
+    /// Queue the tiles within corridorWidth meters of the path
+    void    prefetchPath        (const QList<QGeoCoordinate>& path, double corridorWidth);
+    /// Queue the tiles ahead of a vehicle
+    ///     @param heading Direction of travel in degrees
+    ///     @param distance Look ahead distance in meters
+    void    prefetchCone        (const QGeoCoordinate& coord, double heading, double distance);
+
+    int     pendingCount        () const { return _coneQueue.count() + _pathQueue.count(); }
+
+    /// Direction of travel for the look ahead cone. This is the course over ground, since a multirotor or a
+    /// crabbing fixed wing does not fly where it points. The heading is only used when the course is unknown or
+    /// too slow to be meaningful.
+    static double travelDirection(double courseOverGround, double heading, double groundSpeed);
+
+    static const double kCorridorWidth;     ///< Default mission corridor width (meters)
+    static const double kConeHalfAngle;     ///< Half angle of the look ahead cone (degrees)
+    static const double kLookAheadSeconds;  ///< Look ahead time at current ground speed
+    static const double kMinCourseSpeed;    ///< Ground speed below which the course over ground is GPS noise (m/s)
+
+private slots:
+    void    _vehicleAdded           (Vehicle* vehicle);
+    void    _vehicleRemoved         (Vehicle* vehicle);
+    void    _vehicleCoordinateChanged(QGeoCoordinate coordinate);
+    void    _missionItemsAvailable  ();
+    void    _tilesPerSecondChanged  (QVariant value);
+    void    _tick                   ();
+    void    _tileCached             (QGCCacheTile* tile);
+    void    _tileNotCached          (QGCMapTask::TaskType type, QString errorString);
+    void    _networkReplyFinished   ();
+
+private:
+    struct PrefetchTile {
+        int x;
+        int y;
+        int z;
+    };
+
+    void    _enqueueArea        (QQueue<PrefetchTile>& queue, const QGeoCoordinate& center, double radius, int zoom);
+    void    _clearQueue         (QQueue<PrefetchTile>& queue);
+    void    _requestFailed      (const QString& hash);
+    QList<int> _zoomLevels      ();
+    UrlFactory::MapType _mapType();
+
+    QTimer                      _timer;
+    QNetworkAccessManager*      _networkManager;
+    MultiVehicleManager*        _multiVehicleManager;
+    QQueue<PrefetchTile>        _coneQueue;
+    QQueue<PrefetchTile>        _pathQueue;
+    QSet<QString>               _requested;
+    QHash<Vehicle*, QGeoCoordinate> _lastConeCoord;
+    UrlFactory::MapType         _queuedMapType;
+    int                         _tilesPerSecond;
+    int                         _outstanding;
+};
+
+#endif // QGC_TILE_PREFETCHER_H
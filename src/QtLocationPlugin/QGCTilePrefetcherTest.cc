@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTilePrefetcherTest.h"
+#include "QGCTilePrefetcher.h"
+#include "QGCMapEngine.h"
+
+static const QGeoCoordinate kPathStart  (47.3977, 8.5456);
+static const QGeoCoordinate kPathEnd    (47.4077, 8.5556);
+
+QGCTilePrefetcherTest::QGCTilePrefetcherTest(void)
+{
+
+}
+
+void QGCTilePrefetcherTest::_testRateLimit(void)
+{
+    QGCTilePrefetcher prefetcher;
+
+    // Disabled by default
+    QVERIFY(!prefetcher._timer.isActive());
+
+    // One tile is requested per tick
+    prefetcher._tilesPerSecondChanged(10);
+    QVERIFY(prefetcher._timer.isActive());
+    QCOMPARE(prefetcher._timer.interval(), 100);
+    prefetcher._tilesPerSecondChanged(100);
+    QCOMPARE(prefetcher._timer.interval(), 10);
+
+    prefetcher.prefetchPath({ kPathStart, kPathEnd }, QGCTilePrefetcher::kCorridorWidth);
+    int pending = prefetcher.pendingCount();
+    QVERIFY(pending > 0);
+
+    // Nothing more goes out while the in flight limit is reached
+    bool internetActive = getQGCMapEngine()->isInternetActive();
+    QMetaObject::invokeMethod(getQGCMapEngine(), "_internetStatus", Qt::DirectConnection, Q_ARG(bool, true));
+    prefetcher._outstanding = 1000;
+    prefetcher._tick();
+    QCOMPARE(prefetcher.pendingCount(), pending);
+    QCOMPARE(prefetcher._outstanding, 1000);
+    QMetaObject::invokeMethod(getQGCMapEngine(), "_internetStatus", Qt::DirectConnection, Q_ARG(bool, internetActive));
+    prefetcher._outstanding = 0;
+
+    // Disabling drops whatever is queued, those tiles can be queued again later
+    prefetcher._tilesPerSecondChanged(0);
+    QVERIFY(!prefetcher._timer.isActive());
+    QCOMPARE(prefetcher.pendingCount(), 0);
+    QVERIFY(prefetcher._requested.isEmpty());
+}
+
+void QGCTilePrefetcherTest::_testDedupe(void)
+{
+    QGCTilePrefetcher prefetcher;
+
+    prefetcher.prefetchPath({ kPathStart, kPathEnd }, QGCTilePrefetcher::kCorridorWidth);
+    int pathCount = prefetcher._pathQueue.count();
+    QVERIFY(pathCount > 0);
+    QCOMPARE(prefetcher._requested.count(), pathCount);
+
+    // Requeuing the same path replaces the queue instead of growing it
+    prefetcher.prefetchPath({ kPathStart, kPathEnd }, QGCTilePrefetcher::kCorridorWidth);
+    QCOMPARE(prefetcher._pathQueue.count(), pathCount);
+
+    // A cone over the start of the path only adds the tiles the corridor does not cover
+    prefetcher.prefetchCone(kPathStart, kPathStart.azimuthTo(kPathEnd), kPathStart.distanceTo(kPathEnd));
+    QCOMPARE(prefetcher._requested.count(), prefetcher.pendingCount());
+
+    QSet<QString> hashes;
+    for (const QQueue<QGCTilePrefetcher::PrefetchTile>* queue: { &prefetcher._coneQueue, &prefetcher._pathQueue }) {
+        for (const QGCTilePrefetcher::PrefetchTile& tile: *queue) {
+            QString hash = QGCMapEngine::getTileHash(prefetcher._queuedMapType, tile.x, tile.y, tile.z);
+            QVERIFY(!hashes.contains(hash));
+            hashes.insert(hash);
+        }
+    }
+    QCOMPARE(hashes.count(), prefetcher.pendingCount());
+}
+
+void QGCTilePrefetcherTest::_testFailedTileRetried(void)
+{
+    QGCTilePrefetcher prefetcher;
+
+    prefetcher.prefetchPath({ kPathStart, kPathEnd }, QGCTilePrefetcher::kCorridorWidth);
+    int pathCount = prefetcher._pathQueue.count();
+    QVERIFY(pathCount > 0);
+
+    // Take a tile off the queue the way a tick does. It is not queued again while it is being fetched.
+    QGCTilePrefetcher::PrefetchTile tile = prefetcher._pathQueue.dequeue();
+    QString hash = QGCMapEngine::getTileHash(prefetcher._queuedMapType, tile.x, tile.y, tile.z);
+    prefetcher.prefetchPath({ kPathStart, kPathEnd }, QGCTilePrefetcher::kCorridorWidth);
+    QCOMPARE(prefetcher._pathQueue.count(), pathCount - 1);
+
+    // Once its download fails it is queued again
+    prefetcher._requestFailed(hash);
+    prefetcher.prefetchPath({ kPathStart, kPathEnd }, QGCTilePrefetcher::kCorridorWidth);
+    QCOMPARE(prefetcher._pathQueue.count(), pathCount);
+}
+
+void QGCTilePrefetcherTest::_testTravelDirection(void)
+{
+    // A vehicle pointing north while flying east prefetches to the east
+    QCOMPARE(QGCTilePrefetcher::travelDirection(90.0, 0.0, 10.0), 90.0);
+
+    // Course is noise while barely moving, and unknown without GPS
+    QCOMPARE(QGCTilePrefetcher::travelDirection(90.0, 0.0, QGCTilePrefetcher::kMinCourseSpeed / 2), 0.0);
+    QCOMPARE(QGCTilePrefetcher::travelDirection(qQNaN(), 45.0, 10.0), 45.0);
+}
@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for the map tile prefetcher: request rate and de-duplication of queued tiles.
+class QGCTilePrefetcherTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QGCTilePrefetcherTest(void);
+
+private slots:
+    void _testRateLimit(void);
+    void _testDedupe(void);
+    void _testFailedTileRetried(void);
+    void _testTravelDirection(void);
+};
@@ -61,6 +61,9 @@ public:
     ~QGeoTiledMapReplyQGC();
     void abort();
 
+    /// Number of map tile requests currently waiting on the network
+    static int requestCount     () { return _requestCount; }
+
 signals:
     void terrainDone            (QByteArray responseBytes, QNetworkReply::NetworkError error);
 
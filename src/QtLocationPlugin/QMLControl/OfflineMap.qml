@@ -211,8 +211,9 @@ Item {
     QGCFileDialog {
         id:             fileDialog
         folder:         QGroundControl.settingsManager.appSettings.missionSavePath
-        nameFilters:    ["Tile Sets (*.qgctiledb)"]
+        nameFilters:    ["Tile Sets (*.qgctiledb)", "MBTiles (*.mbtiles)"]
         fileExtension:  "qgctiledb"
+        fileExtension2: "mbtiles"
 
         onAcceptedForSave: {
             if (QGroundControl.mapEngineManager.exportSets(file)) {
@@ -224,7 +225,7 @@ Item {
         }
 
         onAcceptedForLoad: {
-            if(!QGroundControl.mapEngineManager.importSets(file)) {
+            if(!QGroundControl.mapEngineManager.importSets(file, mapType)) {
                 showList();
             }
             close()
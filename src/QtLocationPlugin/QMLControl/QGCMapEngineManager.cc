@@ -19,6 +19,8 @@
 #include "QGCApplication.h"
 #include "QGCMapTileSet.h"
 #include "QGCMapUrlEngine.h"
+#include "SettingsManager.h"
+#include "TerrainQuery.h"
 
 #include <QSettings>
 #include <QStorageInfo>
@@ -62,6 +64,7 @@ QGCMapEngineManager::setToolbox(QGCToolbox *toolbox)
    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
    qmlRegisterUncreatableType<QGCMapEngineManager>("QGroundControl.QGCMapEngineManager", 1, 0, "QGCMapEngineManager", "Reference only");
    connect(getQGCMapEngine(), &QGCMapEngine::updateTotals, this, &QGCMapEngineManager::_updateTotals);
+   _prefetcher.init(toolbox->multiVehicleManager(), toolbox->settingsManager()->offlineMapsSettings()->prefetchTilesPerSecond());
    _updateDiskFreeSpace();
 }
 
@@ -119,21 +122,25 @@ QGCMapEngineManager::loadTileSets()
         emit tileSetsChanged();
     }
     QGCFetchTileSetTask* task = new QGCFetchTileSetTask();
-    connect(task, &QGCFetchTileSetTask::tileSetFetched, this, &QGCMapEngineManager::_tileSetFetched);
+    connect(task, &QGCFetchTileSetTask::tileSetsFetched, this, &QGCMapEngineManager::_tileSetsFetched);
     connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
     getQGCMapEngine()->addTask(task);
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCMapEngineManager::_tileSetFetched(QGCCachedTileSet* tileSet)
+QGCMapEngineManager::_tileSetsFetched(QList<QGCCachedTileSet*> tileSets)
 {
-    //-- A blank (default) type means it uses various types and not just one
-    if(tileSet->type() == UrlFactory::Invalid) {
-        tileSet->setMapTypeStr("Various");
+    QObjectList sets;
+    for(QGCCachedTileSet* tileSet: tileSets) {
+        //-- A blank (default) type means it uses various types and not just one
+        if(tileSet->type() == UrlFactory::Invalid) {
+            tileSet->setMapTypeStr("Various");
+        }
+        tileSet->setManager(this);
+        sets.append(tileSet);
     }
-    _tileSets.append(tileSet);
-    tileSet->setManager(this);
+    _tileSets.append(sets);
     emit tileSetsChanged();
 }
 
@@ -295,6 +302,8 @@ QGCMapEngineManager::renameTileSet(QGCCachedTileSet* tileSet, QString newName)
 void
 QGCMapEngineManager::_resetCompleted()
 {
+    //-- Terrain tiles went with the rest of the cache
+    TerrainOfflineAirMapQuery::clearTileCache();
     //-- Reload sets
     loadTileSets();
 }
@@ -425,7 +434,7 @@ QGCMapEngineManager::selectedCount() {
 
 //-----------------------------------------------------------------------------
 bool
-QGCMapEngineManager::importSets(QString path) {
+QGCMapEngineManager::importSets(QString path, QString mapType) {
     _importAction = ActionNone;
     emit importActionChanged();
     QString dir = path;
@@ -444,7 +453,7 @@ QGCMapEngineManager::importSets(QString path) {
     if(!dir.isEmpty()) {
         _importAction = ActionImporting;
         emit importActionChanged();
-        QGCImportTileTask* task = new QGCImportTileTask(dir, _importReplace);
+        QGCImportTileTask* task = new QGCImportTileTask(dir, _importReplace, QGCMapEngine::getTypeFromName(mapType));
         connect(task, &QGCImportTileTask::actionCompleted, this, &QGCMapEngineManager::_actionCompleted);
         connect(task, &QGCImportTileTask::actionProgress, this, &QGCMapEngineManager::_actionProgressHandler);
         connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
@@ -19,6 +19,7 @@
 #include "QGCLoggingCategory.h"
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCTilePrefetcher.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCMapEngineManagerLog)
 
@@ -69,7 +70,7 @@ public:
     Q_INVOKABLE void                selectAll               ();
     Q_INVOKABLE void                selectNone              ();
     Q_INVOKABLE bool                exportSets              (QString path = QString());
-    Q_INVOKABLE bool                importSets              (QString path = QString());
+    Q_INVOKABLE bool                importSets              (QString path = QString(), QString mapType = QString());
     Q_INVOKABLE void                resetAction             ();
 
     quint64                         tileCount               () { return _imageSet.tileCount + _elevationSet.tileCount; }
@@ -118,7 +119,7 @@ public slots:
 
 private slots:
     void _tileSetSaved          (QGCCachedTileSet* set);
-    void _tileSetFetched        (QGCCachedTileSet* tileSets);
+    void _tileSetsFetched       (QList<QGCCachedTileSet*> tileSets);
     void _tileSetDeleted        (quint64 setID);
     void _updateTotals          (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
     void _resetCompleted        ();
@@ -146,6 +147,7 @@ private:
     int         _actionProgress;
     ImportAction _importAction;
     bool        _importReplace;
+    QGCTilePrefetcher _prefetcher;
 };
 
 #endif
@@ -111,7 +111,7 @@ ShapeFileHelper::ShapeType SHPFileHelper::determineShapeType(const QString& shpF
     return shapeType;
 }
 
-bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordinate>& vertices, QString& errorString)
+bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordinate>& vertices, QString& errorString, const ShapeFileHelper::ProgressCallback& progress)
 {
     int         utmZone = 0;
     bool        utmSouthernHemisphere;
@@ -135,20 +135,32 @@ bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordi
     }
 
     shpObject = SHPReadObject(shpHandle, 0);
+    if (!shpObject || shpObject->nVertices == 0) {
+        errorString = QString(_errorPrefix).arg(tr("Polygon has no vertices."));
+        goto Error;
+    }
     if (shpObject->nParts != 1) {
         errorString = QString(_errorPrefix).arg(tr("Only single part polygons are supported."));
         goto Error;
     }
 
-    for (int i=0; i<shpObject->nVertices; i++) {
-        double lat, lon;
-        if (utmZone) {
-            UTMXYToLatLon(shpObject->padfX[i], shpObject->padfY[i], utmZone, utmSouthernHemisphere, lat, lon);
-        } else {
-            lat = shpObject->padfY[i];
-            lon = shpObject->padfX[i];
+    // Vertices are converted in chunks so progress can be reported, UTM conversion dominates load time for large shapes
+    vertices.reserve(shpObject->nVertices);
+    for (int chunkStart=0; chunkStart<shpObject->nVertices; chunkStart+=_progressChunkSize) {
+        int chunkEnd = qMin(chunkStart + _progressChunkSize, shpObject->nVertices);
+        for (int i=chunkStart; i<chunkEnd; i++) {
+            double lat, lon;
+            if (utmZone) {
+                UTMXYToLatLon(shpObject->padfX[i], shpObject->padfY[i], utmZone, utmSouthernHemisphere, lat, lon);
+            } else {
+                lat = shpObject->padfY[i];
+                lon = shpObject->padfX[i];
+            }
+            vertices.append(QGeoCoordinate(lat, lon));
+        }
+        if (progress) {
+            progress(static_cast<double>(chunkEnd) / shpObject->nVertices);
         }
-        vertices.append(QGeoCoordinate(lat, lon));
     }
 
     // Filter last vertex such that it differs from first
@@ -160,16 +172,18 @@ bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordi
         }
     }
 
-    // Filter vertex distances to be larger than 1 meter apart
-    {
-        int i = 0;
-        while (i < vertices.count() - 2) {
-            if (vertices[i].distanceTo(vertices[i+1]) < vertexFilterMeters) {
-                vertices.removeAt(i+1);
-            } else {
-                i++;
+    // Filter vertex distances to be larger than vertexFilterMeters apart. Single pass, the last vertex is always kept.
+    if (vertices.count() > 2) {
+        QList<QGeoCoordinate> filteredVertices;
+        filteredVertices.reserve(vertices.count());
+        filteredVertices.append(vertices.first());
+        for (int i=1; i<vertices.count() - 1; i++) {
+            if (filteredVertices.last().distanceTo(vertices[i]) >= vertexFilterMeters) {
+                filteredVertices.append(vertices[i]);
             }
         }
+        filteredVertices.append(vertices.last());
+        vertices = filteredVertices;
     }
 
 Error:
@@ -26,11 +26,12 @@ class SHPFileHelper : public QObject
 
 public:
     static ShapeFileHelper::ShapeType determineShapeType(const QString& shpFile, QString& errorString);
-    static bool loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordinate>& vertices, QString& errorString);
+    static bool loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordinate>& vertices, QString& errorString, const ShapeFileHelper::ProgressCallback& progress = ShapeFileHelper::ProgressCallback());
 
 private:
     static bool         _validateSHPFiles(const QString& shpFile, int* utmZone, bool* utmSouthernHemisphere, QString& errorString);
     static SHPHandle    _loadShape(const QString& shpFile, int* utmZone, bool* utmSouthernHemisphere, QString& errorString);
 
-    static const char* _errorPrefix;
+    static const char*  _errorPrefix;
+    static const int    _progressChunkSize = 4096;  ///< Number of vertices converted between progress reports
 };
@@ -29,6 +29,8 @@ public:
     DEFINE_SETTINGFACT(offlineEditingDescentSpeed)
     DEFINE_SETTINGFACT(batteryPercentRemainingAnnounce)
     DEFINE_SETTINGFACT(defaultMissionItemAltitude)
+    DEFINE_SETTINGFACT(shapeImportSimplifyTolerance)
+    DEFINE_SETTINGFACT(missionTransferWindow)
     DEFINE_SETTINGFACT(telemetrySave)
     DEFINE_SETTINGFACT(telemetrySaveNotArmed)
     DEFINE_SETTINGFACT(audioMuted)
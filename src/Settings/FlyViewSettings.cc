@@ -19,3 +19,4 @@ DECLARE_SETTINGGROUP(FlyView, "FlyView")
 
 DECLARE_SETTINGSFACT(FlyViewSettings, guidedMinimumAltitude)
 DECLARE_SETTINGSFACT(FlyViewSettings, guidedMaximumAltitude)
+DECLARE_SETTINGSFACT(FlyViewSettings, geoFenceWarningDistance)
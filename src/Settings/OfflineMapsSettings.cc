@@ -20,3 +20,7 @@ DECLARE_SETTINGGROUP(OfflineMaps, "OfflineMaps")
 DECLARE_SETTINGSFACT(OfflineMapsSettings, minZoomLevelDownload)
 DECLARE_SETTINGSFACT(OfflineMapsSettings, maxZoomLevelDownload)
 DECLARE_SETTINGSFACT(OfflineMapsSettings, maxTilesForDownload)
+DECLARE_SETTINGSFACT(OfflineMapsSettings, prefetchTilesPerSecond)
+DECLARE_SETTINGSFACT(OfflineMapsSettings, maxTerrainTileMemCache)
+DECLARE_SETTINGSFACT(OfflineMapsSettings, terrainSource)
+DECLARE_SETTINGSFACT(OfflineMapsSettings, terrainDEMDirectory)
@@ -18,10 +18,20 @@ class OfflineMapsSettings : public SettingsGroup
 public:
     OfflineMapsSettings(QObject* parent = nullptr);
 
+    // This enum must match the json meta data
+    typedef enum {
+        TerrainSourceAirMap,
+        TerrainSourceLocalDEM
+    } TerrainSource_t;
+
     DEFINE_SETTING_NAME_GROUP()
     DEFINE_SETTINGFACT(minZoomLevelDownload)
     DEFINE_SETTINGFACT(maxZoomLevelDownload)
     DEFINE_SETTINGFACT(maxTilesForDownload)
+    DEFINE_SETTINGFACT(prefetchTilesPerSecond)
+    DEFINE_SETTINGFACT(maxTerrainTileMemCache)
+    DEFINE_SETTINGFACT(terrainSource)
+    DEFINE_SETTINGFACT(terrainDEMDirectory)
 
 private:
 };
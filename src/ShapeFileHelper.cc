@@ -11,9 +11,14 @@
 #include "AppSettings.h"
 #include "KMLFileHelper.h"
 #include "SHPFileHelper.h"
+#include "QGCGeo.h"
 
 #include <QFile>
 #include <QVariant>
+#include <QVector>
+#include <QPointF>
+#include <QLineF>
+#include <QPair>
 
 const char* ShapeFileHelper::_errorPrefix = QT_TR_NOOP("Shape file load failed. %1");
 
@@ -62,7 +67,7 @@ ShapeFileHelper::ShapeType ShapeFileHelper::determineShapeType(const QString& fi
     return shapeType;
 }
 
-bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString)
+bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString, const ProgressCallback& progress)
 {
     bool success = false;
 
@@ -72,16 +77,16 @@ bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordin
     bool fileIsKML = _fileIsKML(file, errorString);
     if (errorString.isEmpty()) {
         if (fileIsKML) {
-            success = KMLFileHelper::loadPolygonFromFile(file, vertices, errorString);
+            success = KMLFileHelper::loadPolygonFromFile(file, vertices, errorString, progress);
         } else {
-            success = SHPFileHelper::loadPolygonFromFile(file, vertices, errorString);
+            success = SHPFileHelper::loadPolygonFromFile(file, vertices, errorString, progress);
         }
     }
 
     return success;
 }
 
-bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString)
+bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString, const ProgressCallback& progress)
 {
     errorString.clear();
     coords.clear();
@@ -89,7 +94,7 @@ bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordi
     bool fileIsKML = _fileIsKML(file, errorString);
     if (errorString.isEmpty()) {
         if (fileIsKML) {
-            KMLFileHelper::loadPolylineFromFile(file, coords, errorString);
+            KMLFileHelper::loadPolylineFromFile(file, coords, errorString, progress);
         } else {
             errorString = QString(_errorPrefix).arg(tr("Polyline not support from SHP files."));
         }
@@ -98,6 +103,75 @@ bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordi
     return errorString.isEmpty();
 }
 
+/// Distance from point to the segment p1->p2, or to p1 if the segment is degenerate
+double ShapeFileHelper::_distanceToSegment(const QPointF& point, const QPointF& p1, const QPointF& p2)
+{
+    QPointF segment =   p2 - p1;
+    double  lengthSq =  QPointF::dotProduct(segment, segment);
+    double  t =         lengthSq > 0 ? qBound(0.0, QPointF::dotProduct(point - p1, segment) / lengthSq, 1.0) : 0;
+
+    return QLineF(point, p1 + (segment * t)).length();
+}
+
+void ShapeFileHelper::simplify(QList<QGeoCoordinate>& coords, double toleranceMeters, bool closed)
+{
+    int minVertexCount = closed ? 3 : 2;
+    if (toleranceMeters <= 0 || coords.count() <= minVertexCount) {
+        return;
+    }
+
+    // Work in a local tangent plane, which is accurate enough at the scale of a survey boundary. A ring is closed by
+    // repeating the first vertex so the first split is made at the vertex farthest from it.
+    QGeoCoordinate  tangentOrigin = coords[0];
+    int             pointCount =    coords.count() + (closed ? 1 : 0);
+    QVector<QPointF> points(pointCount);
+    for (int i=1; i<coords.count(); i++) {
+        double y, x, down;
+        convertGeoToNed(coords[i], tangentOrigin, &y, &x, &down);
+        points[i] = QPointF(x, y);
+    }
+
+    QVector<bool> keep(pointCount, false);
+    keep[0] = true;
+    keep[pointCount - 1] = true;
+
+    // Iterative rather than recursive so that very long, very noisy lines can not overflow the stack
+    QVector<QPair<int, int>> ranges;
+    ranges.append(qMakePair(0, pointCount - 1));
+    while (!ranges.isEmpty()) {
+        QPair<int, int> range = ranges.takeLast();
+
+        double  maxDistance =   -1;
+        int     maxIndex =      -1;
+        for (int i=range.first + 1; i<range.second; i++) {
+            double distance = _distanceToSegment(points[i], points[range.first], points[range.second]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                maxIndex = i;
+            }
+        }
+
+        if (maxIndex != -1 && maxDistance > toleranceMeters) {
+            keep[maxIndex] = true;
+            ranges.append(qMakePair(range.first, maxIndex));
+            ranges.append(qMakePair(maxIndex, range.second));
+        }
+    }
+
+    QList<QGeoCoordinate> simplified;
+    simplified.reserve(coords.count());
+    for (int i=0; i<coords.count(); i++) {
+        if (keep[i]) {
+            simplified.append(coords[i]);
+        }
+    }
+
+    // A ring which collapses to a line is not simplified at all
+    if (simplified.count() >= minVertexCount) {
+        coords = simplified;
+    }
+}
+
 QStringList ShapeFileHelper::fileDialogKMLFilters(void) const
 {
     return QStringList(tr("KML Files (*.%1)").arg(AppSettings::kmlFileExtension));
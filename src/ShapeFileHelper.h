@@ -12,6 +12,9 @@
 #include <QObject>
 #include <QList>
 #include <QGeoCoordinate>
+#include <QPointF>
+
+#include <functional>
 
 /// Routines for loading polygons or polylines from KML or SHP files.
 class ShapeFileHelper : public QObject
@@ -36,12 +39,21 @@ public:
     QStringList fileDialogKMLFilters        (void) const;
     QStringList fileDialogKMLOrSHPFilters   (void) const;
 
+    /// Called by the loaders with the fraction (0-1) of the file processed so far. Called on the loading thread.
+    typedef std::function<void(double)> ProgressCallback;
+
     static ShapeType determineShapeType(const QString& file, QString& errorString);
-    static bool loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString);
-    static bool loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString);
+    static bool loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString, const ProgressCallback& progress = ProgressCallback());
+    static bool loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString, const ProgressCallback& progress = ProgressCallback());
+
+    /// Removes vertices which lie within toleranceMeters of the simplified shape (Douglas-Peucker)
+    ///     @param closed true: coords are a polygon ring, false: coords are a polyline whose end points are always kept
+    ///     @param toleranceMeters 0 leaves coords untouched
+    static void simplify(QList<QGeoCoordinate>& coords, double toleranceMeters, bool closed);
 
 private:
-    static bool _fileIsKML(const QString& file, QString& errorString);
+    static bool     _fileIsKML          (const QString& file, QString& errorString);
+    static double   _distanceToSegment  (const QPointF& point, const QPointF& p1, const QPointF& p2);
 
     static const char* _errorPrefix;
 };
@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ShapeFileLoader.h"
+
+#include <QFutureInterface>
+#include <QtConcurrent>
+
+ShapeFileLoader::ShapeFileLoader(QObject* parent)
+    : QObject   (parent)
+    , _watcher  (nullptr)
+{
+
+}
+
+ShapeFileLoader::~ShapeFileLoader()
+{
+    cancel();
+}
+
+void ShapeFileLoader::load(const QString& file, ShapeFileHelper::ShapeType shapeType, double simplifyToleranceMeters)
+{
+    cancel();
+
+    // A QFutureInterface is used instead of a plain QtConcurrent::run result so the worker can report progress through
+    // the future. The watcher delivers it on this thread and the worker never touches this object.
+    QFutureInterface<LoadResult_t> futureInterface;
+    futureInterface.setProgressRange(0, _progressSteps);
+    futureInterface.reportStarted();
+
+    _watcher = new QFutureWatcher<LoadResult_t>(this);
+    connect(_watcher, &QFutureWatcherBase::progressValueChanged,   this, &ShapeFileLoader::_progressValueChanged);
+    connect(_watcher, &QFutureWatcherBase::finished,               this, &ShapeFileLoader::_loadFinished);
+    _watcher->setFuture(futureInterface.future());
+
+    QtConcurrent::run([futureInterface, file, shapeType, simplifyToleranceMeters]() mutable {
+        ShapeFileHelper::ProgressCallback progress = [&futureInterface](double fraction) {
+            futureInterface.setProgressValue(static_cast<int>(fraction * _progressSteps));
+        };
+
+        LoadResult_t result;
+        if (shapeType == ShapeFileHelper::Polyline) {
+            result.success = ShapeFileHelper::loadPolylineFromFile(file, result.coords, result.errorString, progress);
+        } else {
+            result.success = ShapeFileHelper::loadPolygonFromFile(file, result.coords, result.errorString, progress);
+        }
+        if (result.success && !futureInterface.isCanceled()) {
+            ShapeFileHelper::simplify(result.coords, simplifyToleranceMeters, shapeType != ShapeFileHelper::Polyline);
+        }
+
+        futureInterface.reportResult(result);
+        futureInterface.reportFinished();
+    });
+}
+
+void ShapeFileLoader::cancel(void)
+{
+    if (_watcher) {
+        _watcher->disconnect(this);
+        _watcher->cancel();
+        _watcher->deleteLater();
+        _watcher = nullptr;
+    }
+}
+
+void ShapeFileLoader::_progressValueChanged(int progressValue)
+{
+    emit progress(static_cast<double>(progressValue) / _progressSteps);
+}
+
+void ShapeFileLoader::_loadFinished(void)
+{
+    QFutureWatcher<LoadResult_t>* watcher = _watcher;
+    _watcher = nullptr;
+    watcher->deleteLater();
+
+    if (watcher->isCanceled() || watcher->future().resultCount() == 0) {
+        return;
+    }
+
+    LoadResult_t result = watcher->result();
+    emit loadComplete(result.success, result.coords, result.errorString);
+}
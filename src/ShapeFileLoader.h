@@ -0,0 +1,59 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QGeoCoordinate>
+#include <QFutureWatcher>
+
+#include "ShapeFileHelper.h"
+
+/// Loads a polygon or polyline from a KML or SHP file on a worker thread. Boundary files with tens of thousands of
+/// vertices take long enough to read that loading them on the gui thread stalls the ui.
+class ShapeFileLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    ShapeFileLoader(QObject* parent = nullptr);
+    ~ShapeFileLoader();
+
+    /// Starts loading the shape. A load which is already running is cancelled, its result is never signalled.
+    ///     @param shapeType Polygon or Polyline
+    ///     @param simplifyToleranceMeters Vertices closer than this to the simplified shape are dropped, 0 keeps all vertices
+    void load(const QString& file, ShapeFileHelper::ShapeType shapeType, double simplifyToleranceMeters);
+
+    /// Cancels the running load if any
+    void cancel(void);
+
+    bool loading(void) const { return _watcher != nullptr; }
+
+signals:
+    /// Fraction (0-1) of the file loaded so far
+    void progress(double fraction);
+
+    void loadComplete(bool success, QList<QGeoCoordinate> coords, QString errorString);
+
+private slots:
+    void _progressValueChanged  (int progressValue);
+    void _loadFinished          (void);
+
+private:
+    typedef struct {
+        bool                    success;
+        QList<QGeoCoordinate>   coords;
+        QString                 errorString;
+    } LoadResult_t;
+
+    QFutureWatcher<LoadResult_t>* _watcher;
+
+    static const int _progressSteps = 1000;
+};
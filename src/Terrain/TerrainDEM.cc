@@ -0,0 +1,863 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainDEM.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QRegularExpression>
+#include <QtEndian>
+#include <QtMath>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TerrainDEMLog, "TerrainDEMLog")
+
+Q_GLOBAL_STATIC(TerrainDEMManager, _terrainDEMManager)
+
+const double TerrainDEMFile::_indexEpsilon = 1e-6;
+const double TerrainDEMManager::_areaEpsilon = 1e-9;
+const int TerrainDEMManager::_maxMappedFiles = 32;
+
+// TIFF/GeoTIFF tags and types used by the reader
+enum {
+    kTiffTagImageWidth          = 256,
+    kTiffTagImageLength         = 257,
+    kTiffTagBitsPerSample       = 258,
+    kTiffTagCompression         = 259,
+    kTiffTagStripOffsets        = 273,
+    kTiffTagSamplesPerPixel     = 277,
+    kTiffTagRowsPerStrip        = 278,
+    kTiffTagTileWidth           = 322,
+    kTiffTagSampleFormat        = 339,
+    kTiffTagModelPixelScale     = 33550,
+    kTiffTagModelTiepoint       = 33922,
+    kTiffTagGeoKeyDirectory     = 34735,
+    kTiffTagGdalNoData          = 42113,
+
+    kTiffTypeAscii              = 2,
+    kTiffTypeShort              = 3,
+    kTiffTypeLong               = 4,
+    kTiffTypeDouble             = 12,
+
+    kGeoKeyModelType            = 1024,
+    kGeoKeyRasterType           = 1025,
+    kGeoModelTypeGeographic     = 2,
+    kGeoRasterPixelIsPoint      = 2,
+};
+
+/// Minimal reader for the values of a TIFF directory entry
+class TiffEntry
+{
+public:
+    TiffEntry(const uchar* base, qint64 size, bool bigEndian, const uchar* entry)
+        : _base(base), _size(size), _bigEndian(bigEndian)
+    {
+        tag =   _u16(entry);
+        type =  _u16(entry + 2);
+        count = _u32(entry + 4);
+        qint64 bytes = static_cast<qint64>(count) * typeSize();
+        if (bytes <= 4) {
+            _values = entry + 8;
+        } else {
+            quint32 offset = _u32(entry + 8);
+            _values = (offset + static_cast<qint64>(bytes) <= _size) ? _base + offset : nullptr;
+        }
+    }
+
+    bool isValid(void) const { return _values != nullptr && typeSize() != 0; }
+
+    int typeSize(void) const {
+        switch (type) {
+        case kTiffTypeAscii:    return 1;
+        case kTiffTypeShort:    return 2;
+        case kTiffTypeLong:     return 4;
+        case kTiffTypeDouble:   return 8;
+        }
+        return 0;
+    }
+
+    double value(int index) const {
+        switch (type) {
+        case kTiffTypeShort:
+            return _u16(_values + index * 2);
+        case kTiffTypeLong:
+            return _u32(_values + index * 4);
+        case kTiffTypeDouble:
+        {
+            quint64 bits = _bigEndian ? qFromBigEndian<quint64>(_values + index * 8) : qFromLittleEndian<quint64>(_values + index * 8);
+            double result;
+            memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+        }
+        return qQNaN();
+    }
+
+    /// ASCII values include their terminating NUL
+    QString string(void) const { return QString::fromLatin1(reinterpret_cast<const char*>(_values), static_cast<int>(qstrnlen(reinterpret_cast<const char*>(_values), count))).trimmed(); }
+
+    quint16 tag;
+    quint16 type;
+    quint32 count;
+
+private:
+    quint16 _u16(const uchar* p) const { return _bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p); }
+    quint32 _u32(const uchar* p) const { return _bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p); }
+
+    const uchar*    _base;
+    qint64          _size;
+    bool            _bigEndian;
+    const uchar*    _values;
+};
+
+TerrainDEMFile::TerrainDEMFile(const QString& path)
+    : _path             (path)
+    , _file             (path)
+    , _data             (nullptr)
+    , _size             (0)
+    , _sampleType       (SampleInt16)
+    , _bytesPerSample   (2)
+    , _bigEndian        (true)
+    , _rows             (0)
+    , _cols             (0)
+    , _rowsPerStrip     (0)
+    , _originLat        (0)
+    , _originLon        (0)
+    , _latSpacing       (0)
+    , _lonSpacing       (0)
+    , _hasNoData        (false)
+    , _noData           (0)
+{
+
+}
+
+TerrainDEMFile::~TerrainDEMFile()
+{
+    unmap();
+}
+
+bool TerrainDEMFile::open(void)
+{
+    if (!map()) {
+        return false;
+    }
+
+    bool ok;
+    if (_path.endsWith(QStringLiteral(".hgt"), Qt::CaseInsensitive)) {
+        ok = _openHGT();
+    } else {
+        ok = _openGeoTIFF();
+    }
+    if (ok) {
+        qCDebug(TerrainDEMLog) << "Opened" << _path << "rows:cols" << _rows << _cols << "sw" << south() << west() << "ne" << north() << east();
+    }
+    unmap();
+    return ok;
+}
+
+bool TerrainDEMFile::map(void)
+{
+    if (_data) {
+        return true;
+    }
+
+    if (!_file.open(QIODevice::ReadOnly)) {
+        qCWarning(TerrainDEMLog) << "Unable to open" << _path << _file.errorString();
+        return false;
+    }
+    qint64 size = _file.size();
+    if (_size != 0 && size != _size) {
+        // The strip layout read by open() no longer matches the file
+        qCWarning(TerrainDEMLog) << "DEM file changed since it was opened" << _path;
+        _file.close();
+        return false;
+    }
+    _size = size;
+    _data = _file.map(0, _size);
+    if (!_data) {
+        qCWarning(TerrainDEMLog) << "Unable to map" << _path << _file.errorString();
+        _file.close();
+        return false;
+    }
+    return true;
+}
+
+void TerrainDEMFile::unmap(void)
+{
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    _file.close();
+}
+
+bool TerrainDEMFile::_openHGT(void)
+{
+    static const QRegularExpression nameRegExp(QStringLiteral("^([NS])(\\d{2})([EW])(\\d{3})$"), QRegularExpression::CaseInsensitiveOption);
+
+    QRegularExpressionMatch match = nameRegExp.match(QFileInfo(_path).completeBaseName());
+    if (!match.hasMatch()) {
+        qCWarning(TerrainDEMLog) << "SRTM file name does not specify its location" << _path;
+        return false;
+    }
+    int size = qRound(sqrt(_size / 2.0));
+    if (size < 2 || static_cast<qint64>(size) * size * 2 != _size) {
+        qCWarning(TerrainDEMLog) << "SRTM file is not a square grid" << _path;
+        return false;
+    }
+
+    double lat = match.captured(2).toInt() * (match.captured(1).compare(QStringLiteral("S"), Qt::CaseInsensitive) == 0 ? -1 : 1);
+    double lon = match.captured(4).toInt() * (match.captured(3).compare(QStringLiteral("W"), Qt::CaseInsensitive) == 0 ? -1 : 1);
+
+    _sampleType =       SampleInt16;
+    _bytesPerSample =   2;
+    _bigEndian =        true;
+    _rows =             size;
+    _cols =             size;
+    _rowsPerStrip =     size;
+    _stripOffsets =     { 0 };
+    _originLat =        lat + 1.0;
+    _originLon =        lon;
+    _latSpacing =       1.0 / (size - 1);
+    _lonSpacing =       _latSpacing;
+    _hasNoData =        true;
+    _noData =           -32768;
+
+    return true;
+}
+
+bool TerrainDEMFile::_openGeoTIFF(void)
+{
+    if (_size < 8) {
+        return false;
+    }
+    if (_data[0] == 'M' && _data[1] == 'M') {
+        _bigEndian = true;
+    } else if (_data[0] == 'I' && _data[1] == 'I') {
+        _bigEndian = false;
+    } else {
+        qCWarning(TerrainDEMLog) << "Not a TIFF file" << _path;
+        return false;
+    }
+    quint16 magic = _bigEndian ? qFromBigEndian<quint16>(_data + 2) : qFromLittleEndian<quint16>(_data + 2);
+    quint32 ifdOffset = _bigEndian ? qFromBigEndian<quint32>(_data + 4) : qFromLittleEndian<quint32>(_data + 4);
+    if (magic != 42 || ifdOffset + 2 > _size) {
+        qCWarning(TerrainDEMLog) << "Unsupported TIFF (BigTIFF or corrupt)" << _path;
+        return false;
+    }
+    quint16 entryCount = _bigEndian ? qFromBigEndian<quint16>(_data + ifdOffset) : qFromLittleEndian<quint16>(_data + ifdOffset);
+    if (ifdOffset + 2 + entryCount * 12 > _size) {
+        return false;
+    }
+
+    int bitsPerSample = 0, compression = 1, samplesPerPixel = 1, sampleFormat = 1;
+    int modelType = 0, rasterType = 1;
+    QVector<double> pixelScale, tiepoint;
+    bool tiled = false;
+
+    for (int i = 0; i < entryCount; i++) {
+        TiffEntry entry(_data, _size, _bigEndian, _data + ifdOffset + 2 + i * 12);
+        if (!entry.isValid()) {
+            continue;
+        }
+        switch (entry.tag) {
+        case kTiffTagImageWidth:        _cols = static_cast<int>(entry.value(0));               break;
+        case kTiffTagImageLength:       _rows = static_cast<int>(entry.value(0));               break;
+        case kTiffTagBitsPerSample:     bitsPerSample = static_cast<int>(entry.value(0));       break;
+        case kTiffTagCompression:       compression = static_cast<int>(entry.value(0));         break;
+        case kTiffTagSamplesPerPixel:   samplesPerPixel = static_cast<int>(entry.value(0));     break;
+        case kTiffTagRowsPerStrip:      _rowsPerStrip = static_cast<int>(qMin(entry.value(0), 1e9)); break;
+        case kTiffTagSampleFormat:      sampleFormat = static_cast<int>(entry.value(0));        break;
+        case kTiffTagTileWidth:         tiled = true;                                           break;
+        case kTiffTagStripOffsets:
+            _stripOffsets.clear();
+            for (quint32 j = 0; j < entry.count; j++) {
+                _stripOffsets.append(static_cast<qint64>(entry.value(j)));
+            }
+            break;
+        case kTiffTagModelPixelScale:
+            for (quint32 j = 0; j < entry.count; j++) {
+                pixelScale.append(entry.value(j));
+            }
+            break;
+        case kTiffTagModelTiepoint:
+            for (quint32 j = 0; j < entry.count; j++) {
+                tiepoint.append(entry.value(j));
+            }
+            break;
+        case kTiffTagGeoKeyDirectory:
+            // Header is 4 shorts, then 4 shorts per key: id, location, count, value
+            for (quint32 j = 4; j + 3 < entry.count; j += 4) {
+                int keyId = static_cast<int>(entry.value(j));
+                if (entry.value(j + 1) == 0) {
+                    if (keyId == kGeoKeyModelType) {
+                        modelType = static_cast<int>(entry.value(j + 3));
+                    } else if (keyId == kGeoKeyRasterType) {
+                        rasterType = static_cast<int>(entry.value(j + 3));
+                    }
+                }
+            }
+            break;
+        case kTiffTagGdalNoData:
+            _noData = entry.string().toDouble(&_hasNoData);
+            break;
+        }
+    }
+
+    if (tiled || compression != 1 || samplesPerPixel != 1) {
+        qCWarning(TerrainDEMLog) << "Only uncompressed, stripped, single band GeoTIFF files are supported" << _path;
+        return false;
+    }
+    if (modelType != kGeoModelTypeGeographic || pixelScale.count() < 2 || tiepoint.count() < 6) {
+        qCWarning(TerrainDEMLog) << "GeoTIFF must be in geographic (lat/lon) coordinates" << _path;
+        return false;
+    }
+    if (bitsPerSample == 16 && sampleFormat == 2) {
+        _sampleType = SampleInt16;
+    } else if (bitsPerSample == 16 && sampleFormat == 1) {
+        _sampleType = SampleUInt16;
+    } else if (bitsPerSample == 32 && sampleFormat == 3) {
+        _sampleType = SampleFloat32;
+    } else if (bitsPerSample == 64 && sampleFormat == 3) {
+        _sampleType = SampleFloat64;
+    } else {
+        qCWarning(TerrainDEMLog) << "Unsupported GeoTIFF sample type bits:format" << bitsPerSample << sampleFormat << _path;
+        return false;
+    }
+    _bytesPerSample = bitsPerSample / 8;
+
+    if (_rowsPerStrip < 1 || _rowsPerStrip > _rows) {
+        // Default is a single strip
+        _rowsPerStrip = _rows;
+    }
+    if (_rows < 2 || _cols < 2 || _stripOffsets.count() < (_rows + _rowsPerStrip - 1) / _rowsPerStrip) {
+        qCWarning(TerrainDEMLog) << "GeoTIFF strip layout is inconsistent" << _path;
+        return false;
+    }
+    for (int strip = 0; strip < _stripOffsets.count(); strip++) {
+        int stripRows = qMin(_rowsPerStrip, _rows - strip * _rowsPerStrip);
+        if (stripRows > 0 && _stripOffsets[strip] + static_cast<qint64>(stripRows) * _cols * _bytesPerSample > _size) {
+            qCWarning(TerrainDEMLog) << "GeoTIFF strip outside of file" << _path;
+            return false;
+        }
+    }
+
+    _lonSpacing = pixelScale[0];
+    _latSpacing = pixelScale[1];
+    // Tiepoint maps raster (I,J) to model (X,Y). PixelIsArea puts it at the corner of the pixel, not the center.
+    double centerOffset = rasterType == kGeoRasterPixelIsPoint ? 0.0 : 0.5;
+    _originLon = tiepoint[3] + (centerOffset - tiepoint[0]) * _lonSpacing;
+    _originLat = tiepoint[4] - (centerOffset - tiepoint[1]) * _latSpacing;
+
+    return _lonSpacing > 0 && _latSpacing > 0;
+}
+
+double TerrainDEMFile::_sample(int row, int col) const
+{
+    const uchar* p = _data + _stripOffsets[row / _rowsPerStrip] + ((static_cast<qint64>(row % _rowsPerStrip) * _cols) + col) * _bytesPerSample;
+
+    double value;
+    switch (_sampleType) {
+    case SampleInt16:
+        value = _bigEndian ? qFromBigEndian<qint16>(p) : qFromLittleEndian<qint16>(p);
+        break;
+    case SampleUInt16:
+        value = _bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+        break;
+    case SampleFloat32:
+    {
+        quint32 bits = _bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        value = result;
+        break;
+    }
+    case SampleFloat64:
+    default:
+    {
+        quint64 bits = _bigEndian ? qFromBigEndian<quint64>(p) : qFromLittleEndian<quint64>(p);
+        memcpy(&value, &bits, sizeof(value));
+        break;
+    }
+    }
+
+    if (_hasNoData && value == _noData) {
+        return qQNaN();
+    }
+    return value;
+}
+
+bool TerrainDEMFile::contains(double latitude, double longitude) const
+{
+    // Allow for rounding in the computed bounds so the edges of a file are inside it
+    const double latEpsilon = _latSpacing * _indexEpsilon;
+    const double lonEpsilon = _lonSpacing * _indexEpsilon;
+    return latitude >= south() - latEpsilon && latitude <= north() + latEpsilon && longitude >= west() - lonEpsilon && longitude <= east() + lonEpsilon;
+}
+
+double TerrainDEMFile::elevation(double latitude, double longitude) const
+{
+    if (!_data || !contains(latitude, longitude)) {
+        return qQNaN();
+    }
+
+    double row = qBound(0.0, (_originLat - latitude) / _latSpacing, static_cast<double>(_rows - 1));
+    double col = qBound(0.0, (longitude - _originLon) / _lonSpacing, static_cast<double>(_cols - 1));
+    int row0 = static_cast<int>(row);
+    int col0 = static_cast<int>(col);
+    int row1 = qMin(row0 + 1, _rows - 1);
+    int col1 = qMin(col0 + 1, _cols - 1);
+    double rowFraction = row - row0;
+    double colFraction = col - col0;
+
+    const int       rows[4] =       { row0, row0, row1, row1 };
+    const int       cols[4] =       { col0, col1, col0, col1 };
+    const double    weights[4] =    { (1 - rowFraction) * (1 - colFraction), (1 - rowFraction) * colFraction, rowFraction * (1 - colFraction), rowFraction * colFraction };
+
+    double sum = 0;
+    double weightSum = 0;
+    for (int i = 0; i < 4; i++) {
+        double value = _sample(rows[i], cols[i]);
+        if (!qIsNaN(value)) {
+            sum += value * weights[i];
+            weightSum += weights[i];
+        }
+    }
+
+    return weightSum > 0 ? sum / weightSum : qQNaN();
+}
+
+QString TerrainDEMFile::_pyramidPath(void) const
+{
+    QFileInfo info(_path);
+    QString key = QStringLiteral("%1|%2|%3").arg(info.absoluteFilePath()).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/TerrainDEM");
+    return QStringLiteral("%1/%2-%3.pyramid").arg(cacheDir).arg(info.completeBaseName()).arg(qHash(key), 8, 16, QChar('0'));
+}
+
+/// Pyramids are built once per file and kept in the cache directory. Files are keyed by path, size
+/// and modification time, so a replaced DEM file is picked up automatically.
+void TerrainDEMFile::loadPyramid(void)
+{
+    QString pyramidPath = _pyramidPath();
+    if (_pyramid.load(pyramidPath, _rows, _cols)) {
+        return;
+    }
+
+    qCDebug(TerrainDEMLog) << "Building min/max pyramid" << _path;
+    _pyramid.build(_rows, _cols, [this](int row, int col) { return _sample(row, col); });
+    QDir().mkpath(QFileInfo(pyramidPath).absolutePath());
+    if (!_pyramid.save(pyramidPath)) {
+        qCWarning(TerrainDEMLog) << "Unable to save min/max pyramid" << pyramidPath;
+    }
+}
+
+bool TerrainDEMFile::stats(const Area_t& area, TerrainMinMaxPyramid::Stats_t& stats)
+{
+    if (!_data) {
+        return false;
+    }
+    if (!_pyramid.isValid()) {
+        loadPyramid();
+    }
+
+    // Sample positions of the area edges. Rows count from the north.
+    const double rowNorth = (_originLat - area.north) / _latSpacing;
+    const double rowSouth = (_originLat - area.south) / _latSpacing;
+    const double colWest  = (area.west - _originLon) / _lonSpacing;
+    const double colEast  = (area.east - _originLon) / _lonSpacing;
+
+    int row0 = area.openNorth ? static_cast<int>(floor(rowNorth + _indexEpsilon)) + 1 : static_cast<int>(ceil(rowNorth - _indexEpsilon));
+    int row1 = area.openSouth ? static_cast<int>(ceil(rowSouth - _indexEpsilon)) - 1 : static_cast<int>(floor(rowSouth + _indexEpsilon));
+    int col0 = area.openWest  ? static_cast<int>(floor(colWest + _indexEpsilon)) + 1  : static_cast<int>(ceil(colWest - _indexEpsilon));
+    int col1 = area.openEast  ? static_cast<int>(ceil(colEast - _indexEpsilon)) - 1   : static_cast<int>(floor(colEast + _indexEpsilon));
+
+    return _pyramid.stats(row0, col0, row1, col1, [this](int row, int col) { return _sample(row, col); }, stats);
+}
+
+TerrainDEMManager::TerrainDEMManager(void)
+    : _scanned  (false)
+    , _lastFile (nullptr)
+{
+
+}
+
+TerrainDEMManager::~TerrainDEMManager()
+{
+    if (_scanWatcher.isRunning()) {
+        _scanWatcher.waitForFinished();
+        qDeleteAll(_scanWatcher.result());
+    }
+    qDeleteAll(_files);
+}
+
+void TerrainDEMManager::_setFiles(const QList<TerrainDEMFile*>& files)
+{
+    qDeleteAll(_files);
+    _files = files;
+    _mappedFiles.clear();
+    _lastFile = nullptr;
+}
+
+void TerrainDEMManager::setDirectory(const QString& directory)
+{
+    if (directory == _directory) {
+        return;
+    }
+    _setFiles(QList<TerrainDEMFile*>());
+    _directory = directory;
+    _scanned = false;
+    emit filesChanged();
+}
+
+void TerrainDEMManager::whenReady(QObject* context, std::function<void(void)> function)
+{
+    if (_scanned) {
+        QTimer::singleShot(0, context, function);
+        return;
+    }
+    _pendingCalls.append(PendingCall_t(context, function));
+    if (!_scanWatcher.isRunning()) {
+        _startScan();
+    }
+}
+
+/// Files are scanned on first use so an unused terrain directory costs nothing at startup
+void TerrainDEMManager::_startScan(void)
+{
+    _scanDirectory = _directory;
+    connect(&_scanWatcher, &QFutureWatcherBase::finished, this, &TerrainDEMManager::_scanFinished, Qt::UniqueConnection);
+    _scanWatcher.setFuture(QtConcurrent::run(&TerrainDEMManager::_scan, _scanDirectory));
+}
+
+void TerrainDEMManager::_scanFinished(void)
+{
+    QList<TerrainDEMFile*> files = _scanWatcher.result();
+    if (_scanDirectory != _directory) {
+        // The directory changed while scanning
+        qDeleteAll(files);
+        if (!_pendingCalls.isEmpty()) {
+            _startScan();
+        }
+        return;
+    }
+
+    _setFiles(files);
+    _scanned = true;
+    emit filesChanged();
+
+    QList<PendingCall_t> pendingCalls = _pendingCalls;
+    _pendingCalls.clear();
+    for (const PendingCall_t& pendingCall: pendingCalls) {
+        if (pendingCall.first) {
+            pendingCall.second();
+        }
+    }
+}
+
+/// Runs on a worker thread. Only the georeferencing of each file is read, samples and min/max pyramids are left
+/// until a query needs them.
+QList<TerrainDEMFile*> TerrainDEMManager::_scan(const QString& directory)
+{
+    QList<TerrainDEMFile*> files;
+    if (directory.isEmpty()) {
+        qCWarning(TerrainDEMLog) << "Local terrain selected but no DEM directory is set";
+        return files;
+    }
+
+    QDirIterator it(directory, { QStringLiteral("*.hgt"), QStringLiteral("*.tif"), QStringLiteral("*.tiff") }, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        TerrainDEMFile* file = new TerrainDEMFile(it.next());
+        if (file->open()) {
+            files.append(file);
+        } else {
+            delete file;
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const TerrainDEMFile* a, const TerrainDEMFile* b) { return a->resolution() < b->resolution(); });
+
+    qCDebug(TerrainDEMLog) << "Found" << files.count() << "DEM files in" << directory;
+    return files;
+}
+
+/// Maps the file for use. Only the most recently used files stay mapped, the others are unmapped and closed.
+/// @return false: file could not be mapped
+bool TerrainDEMManager::_useFile(TerrainDEMFile* file)
+{
+    int index = _mappedFiles.indexOf(file);
+    if (index >= 0) {
+        _mappedFiles.move(index, 0);
+        return true;
+    }
+    if (!file->map()) {
+        return false;
+    }
+    _mappedFiles.prepend(file);
+    while (_mappedFiles.count() > _maxMappedFiles) {
+        _mappedFiles.takeLast()->unmap();
+    }
+    return true;
+}
+
+TerrainDEMFile* TerrainDEMManager::_fileForCoordinate(double latitude, double longitude)
+{
+    if (_lastFile && _lastFile->contains(latitude, longitude)) {
+        return _lastFile;
+    }
+    for (TerrainDEMFile* file: _files) {
+        if (file->contains(latitude, longitude)) {
+            _lastFile = file;
+            return file;
+        }
+    }
+    return nullptr;
+}
+
+double TerrainDEMManager::elevation(const QGeoCoordinate& coordinate)
+{
+    TerrainDEMFile* file = _fileForCoordinate(coordinate.latitude(), coordinate.longitude());
+    double height = file && _useFile(file) ? file->elevation(coordinate.latitude(), coordinate.longitude()) : qQNaN();
+    if (qIsNaN(height) && file) {
+        // Void in the finest file, a coarser file may still have data
+        for (TerrainDEMFile* other: _files) {
+            if (other != file && other->contains(coordinate.latitude(), coordinate.longitude()) && _useFile(other)) {
+                height = other->elevation(coordinate.latitude(), coordinate.longitude());
+                if (!qIsNaN(height)) {
+                    break;
+                }
+            }
+        }
+    }
+    return height;
+}
+
+bool TerrainDEMManager::stats(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, double& minHeight, double& maxHeight, double& avgHeight)
+{
+    // Parts of the area no file has covered yet. Files are visited finest first and each one only contributes the
+    // samples of those parts, so where files overlap every point is counted once, from the finest file.
+    QList<TerrainDEMFile::Area_t> uncovered = { { swCoord.latitude(), swCoord.longitude(), neCoord.latitude(), neCoord.longitude(), false, false, false, false } };
+
+    TerrainMinMaxPyramid::Stats_t total = { qInf(), -qInf(), 0, 0 };
+    for (TerrainDEMFile* file: _files) {
+        QList<TerrainDEMFile::Area_t> remaining;
+        for (const TerrainDEMFile::Area_t& area: uncovered) {
+            TerrainDEMFile::Area_t covered;
+            TerrainMinMaxPyramid::Stats_t fileStats;
+            if (!_splitArea(file, area, covered, remaining)) {
+                continue;
+            }
+            if (!_useFile(file)) {
+                // Nothing is known about the part of the area this file covers
+                return false;
+            }
+            if (file->stats(covered, fileStats)) {
+                total.min = qMin(total.min, fileStats.min);
+                total.max = qMax(total.max, fileStats.max);
+                total.sum += fileStats.sum;
+                total.count += fileStats.count;
+            }
+        }
+        uncovered = remaining;
+        if (uncovered.isEmpty()) {
+            break;
+        }
+    }
+    if (!uncovered.isEmpty()) {
+        qCDebug(TerrainDEMLog) << "Area not fully covered by DEM files" << swCoord << neCoord;
+        return false;
+    }
+    if (total.count == 0) {
+        return false;
+    }
+
+    minHeight = total.min;
+    maxHeight = total.max;
+    avgHeight = total.sum / total.count;
+    return true;
+}
+
+/// Splits an area into the part covered by the file and the parts around it (at most four). The parts around it
+/// are open on the edge they share with the file.
+/// @return false: the file does not overlap the area, which is added to remaining unchanged
+bool TerrainDEMManager::_splitArea(const TerrainDEMFile* file, const TerrainDEMFile::Area_t& area, TerrainDEMFile::Area_t& covered, QList<TerrainDEMFile::Area_t>& remaining)
+{
+    if (file->south() > area.north + _areaEpsilon || file->north() < area.south - _areaEpsilon ||
+            file->west() > area.east + _areaEpsilon || file->east() < area.west - _areaEpsilon) {
+        remaining.append(area);
+        return false;
+    }
+
+    // Full width bands south and north of the file
+    TerrainDEMFile::Area_t band = area;
+    if (file->south() > area.south + _areaEpsilon) {
+        TerrainDEMFile::Area_t south = area;
+        south.north = file->south();
+        south.openNorth = true;
+        remaining.append(south);
+        band.south = file->south();
+        band.openSouth = false;
+    }
+    if (file->north() < area.north - _areaEpsilon) {
+        TerrainDEMFile::Area_t north = area;
+        north.south = file->north();
+        north.openSouth = true;
+        remaining.append(north);
+        band.north = file->north();
+        band.openNorth = false;
+    }
+
+    // West and east of the file within the band
+    covered = band;
+    if (file->west() > area.west + _areaEpsilon) {
+        TerrainDEMFile::Area_t west = band;
+        west.east = file->west();
+        west.openEast = true;
+        remaining.append(west);
+        covered.west = file->west();
+        covered.openWest = false;
+    }
+    if (file->east() < area.east - _areaEpsilon) {
+        TerrainDEMFile::Area_t east = band;
+        east.west = file->east();
+        east.openWest = true;
+        remaining.append(east);
+        covered.east = file->east();
+        covered.openEast = false;
+    }
+
+    return true;
+}
+
+TerrainLocalDEMQuery::TerrainLocalDEMQuery(QObject* parent)
+    : TerrainQueryInterface(parent)
+{
+    connect(_terrainDEMManager(), &TerrainDEMManager::filesChanged, this, &TerrainQueryInterface::terrainDataChanged);
+}
+
+void TerrainLocalDEMQuery::_updateDirectory(void)
+{
+    _terrainDEMManager->setDirectory(qgcApp()->toolbox()->settingsManager()->offlineMapsSettings()->terrainDEMDirectory()->rawValue().toString());
+}
+
+void TerrainLocalDEMQuery::requestCoordinateHeights(const QList<QGeoCoordinate>& coordinates)
+{
+    _updateDirectory();
+
+    // Results are always signalled later, like the other terrain queries
+    _terrainDEMManager->whenReady(this, [this, coordinates]() {
+        QList<double> heights;
+        for (const QGeoCoordinate& coordinate: coordinates) {
+            double height = _terrainDEMManager->elevation(coordinate);
+            if (qIsNaN(height)) {
+                qCDebug(TerrainDEMLog) << "No local terrain data for" << coordinate;
+                emit coordinateHeightsReceived(false, QList<double>());
+                return;
+            }
+            heights.append(height);
+        }
+        emit coordinateHeightsReceived(true, heights);
+    });
+}
+
+bool TerrainLocalDEMQuery::_pathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, PathHeightInfo_t& pathHeightInfo)
+{
+    QList<QGeoCoordinate> coordinates = TerrainQueryInterface::pathCoordinates(fromCoord, toCoord, pathHeightInfo.latStep, pathHeightInfo.lonStep);
+
+    pathHeightInfo.heights.clear();
+    pathHeightInfo.heights.reserve(coordinates.count());
+    for (const QGeoCoordinate& coordinate: coordinates) {
+        double height = _terrainDEMManager->elevation(coordinate);
+        if (qIsNaN(height)) {
+            qCDebug(TerrainDEMLog) << "No local terrain data for" << coordinate;
+            return false;
+        }
+        pathHeightInfo.heights.append(height);
+    }
+    return true;
+}
+
+void TerrainLocalDEMQuery::requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
+{
+    _updateDirectory();
+
+    _terrainDEMManager->whenReady(this, [this, fromCoord, toCoord]() {
+        PathHeightInfo_t pathHeightInfo;
+        if (!_pathHeights(fromCoord, toCoord, pathHeightInfo)) {
+            emit pathHeightsReceived(false, qQNaN(), qQNaN(), QList<double>());
+            return;
+        }
+        emit pathHeightsReceived(true, pathHeightInfo.latStep, pathHeightInfo.lonStep, pathHeightInfo.heights);
+    });
+}
+
+void TerrainLocalDEMQuery::requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath)
+{
+    _updateDirectory();
+
+    _terrainDEMManager->whenReady(this, [this, polyPath]() {
+        QList<PathHeightInfo_t> rgPathHeightInfo;
+        for (int i = 0; i < polyPath.count() - 1; i++) {
+            PathHeightInfo_t pathHeightInfo;
+            if (!_pathHeights(polyPath[i], polyPath[i + 1], pathHeightInfo)) {
+                emit polyPathHeightsReceived(false, QList<PathHeightInfo_t>());
+                return;
+            }
+            rgPathHeightInfo.append(pathHeightInfo);
+        }
+        emit polyPathHeightsReceived(!rgPathHeightInfo.isEmpty(), rgPathHeightInfo);
+    });
+}
+
+void TerrainLocalDEMQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
+{
+    _updateDirectory();
+
+    _terrainDEMManager->whenReady(this, [this, swCoord, neCoord, statsOnly]() {
+        double minHeight, maxHeight, avgHeight;
+        if (!_terrainDEMManager->stats(swCoord, neCoord, minHeight, maxHeight, avgHeight)) {
+            qCDebug(TerrainDEMLog) << "No local terrain data for area" << swCoord << neCoord;
+            emit carpetHeightsReceived(false, qQNaN(), qQNaN(), QList<QList<double>>());
+            return;
+        }
+
+        QList<QList<double>> carpet;
+        if (!statsOnly) {
+            // Rows south to north, columns west to east at the usual terrain spacing
+            QGeoCoordinate nwCoord(neCoord.latitude(), swCoord.longitude());
+            int cRows = qMax(2, static_cast<int>(ceil(swCoord.distanceTo(nwCoord) / TerrainTile::terrainAltitudeSpacing)) + 1);
+            int cCols = qMax(2, static_cast<int>(ceil(nwCoord.distanceTo(neCoord) / TerrainTile::terrainAltitudeSpacing)) + 1);
+            double latStep = (neCoord.latitude() - swCoord.latitude()) / (cRows - 1);
+            double lonStep = (neCoord.longitude() - swCoord.longitude()) / (cCols - 1);
+            for (int row = 0; row < cRows; row++) {
+                QList<double> heights;
+                for (int col = 0; col < cCols; col++) {
+                    double height = _terrainDEMManager->elevation(QGeoCoordinate(swCoord.latitude() + row * latStep, swCoord.longitude() + col * lonStep));
+                    if (qIsNaN(height)) {
+                        emit carpetHeightsReceived(false, qQNaN(), qQNaN(), QList<QList<double>>());
+                        return;
+                    }
+                    heights.append(height);
+                }
+                carpet.append(heights);
+            }
+        }
+
+        emit carpetHeightsReceived(true, minHeight, maxHeight, carpet);
+    });
+}
@@ -0,0 +1,195 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "TerrainQuery.h"
+#include "TerrainMinMaxPyramid.h"
+#include "QGCLoggingCategory.h"
+
+#include <QObject>
+#include <QFile>
+#include <QVector>
+#include <QGeoCoordinate>
+#include <QFutureWatcher>
+#include <QPointer>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainDEMLog)
+
+/// A single local elevation model file. The georeferencing is read up front, the samples are memory mapped
+/// only while the file is in use.
+///
+/// Supported formats:
+///     SRTM .hgt - square big endian int16 grid named after its south west corner (N47E008.hgt)
+///     GeoTIFF   - uncompressed, stripped, single band int16/uint16/float32/float64 in geographic (lat/lon) coordinates
+class TerrainDEMFile
+{
+public:
+    /// Part of a query area in degrees. Samples exactly on an open edge are left out, so areas which
+    /// share that edge do not both count them.
+    typedef struct {
+        double  south;
+        double  west;
+        double  north;
+        double  east;
+        bool    openSouth;
+        bool    openWest;
+        bool    openNorth;
+        bool    openEast;
+    } Area_t;
+
+    TerrainDEMFile(const QString& path);
+    ~TerrainDEMFile();
+
+    /// Reads the georeferencing of the file. The file is left unmapped.
+    /// @return false: unsupported or corrupt file
+    bool open(void);
+
+    /// Maps the samples of an opened file, elevation() and stats() require this
+    /// @return false: file could not be mapped
+    bool map    (void);
+    void unmap  (void);
+    bool mapped (void) const { return _data != nullptr; }
+
+    const QString&  path        (void) const { return _path; }
+    double          south       (void) const { return _originLat - (_rows - 1) * _latSpacing; }
+    double          north       (void) const { return _originLat; }
+    double          west        (void) const { return _originLon; }
+    double          east        (void) const { return _originLon + (_cols - 1) * _lonSpacing; }
+    /// Sample spacing in degrees latitude, smaller is finer
+    double          resolution  (void) const { return _latSpacing; }
+
+    bool contains(double latitude, double longitude) const;
+
+    /// Bilinearly interpolated elevation, voids are left out of the interpolation
+    /// @return NaN: outside of file, void or not mapped
+    double elevation(double latitude, double longitude) const;
+
+    /// Loads the min/max pyramid used by stats(), building it from the grid the first time a file is seen.
+    /// Building reads the whole file.
+    void loadPyramid(void);
+
+    /// Elevation statistics over the part of the area covered by this file. The pyramid is loaded on first use.
+    /// @return false: no data in the area
+    bool stats(const Area_t& area, TerrainMinMaxPyramid::Stats_t& stats);
+
+private:
+    enum SampleType {
+        SampleInt16,
+        SampleUInt16,
+        SampleFloat32,
+        SampleFloat64,
+    };
+
+    bool    _openHGT        (void);
+    bool    _openGeoTIFF    (void);
+    double  _sample         (int row, int col) const;
+    QString _pyramidPath    (void) const;
+
+    QString             _path;
+    QFile               _file;
+    const uchar*        _data;          ///< NULL while unmapped
+    qint64              _size;
+    SampleType          _sampleType;
+    int                 _bytesPerSample;
+    bool                _bigEndian;
+    int                 _rows;
+    int                 _cols;
+    int                 _rowsPerStrip;
+    QVector<qint64>     _stripOffsets;
+    double              _originLat;     ///< Latitude of the center of the north west sample
+    double              _originLon;     ///< Longitude of the center of the north west sample
+    double              _latSpacing;
+    double              _lonSpacing;
+    bool                _hasNoData;
+    double              _noData;
+    TerrainMinMaxPyramid _pyramid;
+
+    static const double _indexEpsilon;  ///< Tolerance in samples for coordinates on the edge of the grid
+
+    friend class TerrainDEMTest;
+};
+
+/// Owns the DEM files found in the directory specified in settings. The directory is scanned on a worker
+/// thread the first time the files are needed.
+class TerrainDEMManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    TerrainDEMManager(void);
+    ~TerrainDEMManager();
+
+    /// Switches to the DEM files in the specified directory. Does nothing if the directory is unchanged.
+    void setDirectory(const QString& directory);
+
+    /// Calls function once the files of the current directory are available, starting the scan if needed.
+    /// The call is always queued, even if the files are already available. Nothing is called if context
+    /// is destroyed first.
+    void whenReady(QObject* context, std::function<void(void)> function);
+
+    /// Must only be called from a whenReady() function
+    /// @return NaN: no file covers the coordinate
+    double elevation(const QGeoCoordinate& coordinate);
+
+    /// Elevation statistics for the specified area. Must only be called from a whenReady() function.
+    /// @return false: the area is not fully covered by the available files
+    bool stats(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, double& minHeight, double& maxHeight, double& avgHeight);
+
+signals:
+    /// The set of files changed, heights from the previous files may no longer be valid
+    void filesChanged(void);
+
+private slots:
+    void _scanFinished(void);
+
+private:
+    typedef QPair<QPointer<QObject>, std::function<void(void)>> PendingCall_t;
+
+    void                            _startScan          (void);
+    static QList<TerrainDEMFile*>   _scan               (const QString& directory);
+    static bool                     _splitArea          (const TerrainDEMFile* file, const TerrainDEMFile::Area_t& area, TerrainDEMFile::Area_t& covered, QList<TerrainDEMFile::Area_t>& remaining);
+    TerrainDEMFile*                 _fileForCoordinate  (double latitude, double longitude);
+    bool                            _useFile            (TerrainDEMFile* file);
+    void                            _setFiles           (const QList<TerrainDEMFile*>& files);
+
+    QString                                     _directory;
+    bool                                        _scanned;       ///< _files are the files of _directory
+    QString                                     _scanDirectory; ///< Directory the running scan is for
+    QFutureWatcher<QList<TerrainDEMFile*>>      _scanWatcher;
+    QList<PendingCall_t>                        _pendingCalls;  ///< Waiting for the scan to finish
+    QList<TerrainDEMFile*>                      _files;         ///< Finest resolution first
+    TerrainDEMFile*                             _lastFile;      ///< Queries tend to stay within one file
+    QList<TerrainDEMFile*>                      _mappedFiles;   ///< Most recently used first
+
+    static const double _areaEpsilon;   ///< Tolerance in degrees when comparing area and file bounds
+    static const int    _maxMappedFiles;///< Keeps a large DEM directory from running out of file handles
+
+    friend class TerrainDEMTest;
+};
+
+/// Terrain queries answered from local DEM files
+class TerrainLocalDEMQuery : public TerrainQueryInterface {
+    Q_OBJECT
+
+public:
+    TerrainLocalDEMQuery(QObject* parent = nullptr);
+
+    // Overrides from TerrainQueryInterface
+    void requestCoordinateHeights   (const QList<QGeoCoordinate>& coordinates) final;
+    void requestPathHeights         (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) final;
+    void requestPolyPathHeights     (const QList<QGeoCoordinate>& polyPath) final;
+    void requestCarpetHeights       (const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) final;
+
+private:
+    void _updateDirectory   (void);
+    bool _pathHeights       (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, PathHeightInfo_t& pathHeightInfo);
+};
@@ -0,0 +1,479 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainDEMTest.h"
+#include "TerrainDEM.h"
+#include "TerrainMinMaxPyramid.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
+
+#include <QSignalSpy>
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QtEndian>
+
+#include <limits>
+
+TerrainDEMTest::TerrainDEMTest(void)
+    : _tempDir(nullptr)
+{
+
+}
+
+void TerrainDEMTest::init(void)
+{
+    UnitTest::init();
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+}
+
+void TerrainDEMTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = nullptr;
+    UnitTest::cleanup();
+}
+
+/// Synthetic terrain: a ramp rising to the south east with a single void in the middle
+double TerrainDEMTest::_height(int row, int col) const
+{
+    if (row == _gridSize / 2 && col == _gridSize / 2) {
+        return qQNaN();
+    }
+    return 100 + row * 2 + col;
+}
+
+/// Writes a 1 degree SRTM file of the synthetic terrain
+///     @param colOffset Column of the terrain the west edge of the file starts at, so neighbouring files agree on their shared edge
+void TerrainDEMTest::_writeHGT(const QString& name, int colOffset)
+{
+    QByteArray bytes(_gridSize * _gridSize * 2, 0);
+    for (int row = 0; row < _gridSize; row++) {
+        for (int col = 0; col < _gridSize; col++) {
+            double height = _height(row, col + colOffset);
+            qint16 value = qIsNaN(height) ? -32768 : static_cast<qint16>(height);
+            qToBigEndian<qint16>(value, reinterpret_cast<uchar*>(bytes.data()) + (row * _gridSize + col) * 2);
+        }
+    }
+    QFile file(_tempDir->filePath(name));
+    QVERIFY(QDir().mkpath(QFileInfo(file).absolutePath()));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(bytes), static_cast<qint64>(bytes.size()));
+}
+
+/// Writes a GeoTIFF of the synthetic terrain with its north west sample at 48N 8E, at the SRTM file spacing. The center
+/// sample is set to the GDAL nodata value. Strips are written to the file in reverse order so their offsets matter.
+///     @param sampleFormat 1: unsigned integer, 2: signed integer, 3: floating point
+///     @param pixelIsPoint false: the tiepoint is the north west corner of the first pixel (PixelIsArea)
+void TerrainDEMTest::_writeGeoTIFF(const QString& name, bool bigEndian, int bitsPerSample, int sampleFormat, bool pixelIsPoint, int rowsPerStrip, int compression)
+{
+    const double        spacing =           1.0 / (_gridSize - 1);
+    const int           bytesPerSample =    bitsPerSample / 8;
+    const int           stripCount =        (_tiffSize + rowsPerStrip - 1) / rowsPerStrip;
+    const QByteArray    noData =            QByteArray::number(_tiffNoData) + '\0';
+    const quint16       typeAscii = 2, typeShort = 3, typeLong = 4, typeDouble = 12;
+
+    // Directory, then the values which do not fit their entry, then the strips
+    const int entryCount =          12;
+    const int ifdOffset =           8;
+    const int stripOffsetsOffset =  ifdOffset + 2 + entryCount * 12 + 4;
+    const int pixelScaleOffset =    stripOffsetsOffset + stripCount * 4;
+    const int tiepointOffset =      pixelScaleOffset + 3 * 8;
+    const int geoKeysOffset =       tiepointOffset + 6 * 8;
+    const int noDataOffset =        geoKeysOffset + 12 * 2;
+    const int stripsOffset =        noDataOffset + noData.size();
+
+    QVector<quint32> stripOffsets;
+    int offset = stripsOffset;
+    for (int strip = stripCount - 1; strip >= 0; strip--) {
+        stripOffsets.prepend(offset);
+        offset += qMin(rowsPerStrip, _tiffSize - strip * rowsPerStrip) * _tiffSize * bytesPerSample;
+    }
+
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setByteOrder(bigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    auto entry = [&stream, typeShort](quint16 tag, quint16 type, quint32 count, quint32 value) {
+        stream << tag << type << count;
+        if (type == typeShort && count == 1) {
+            // Values are left justified in the entry
+            stream << static_cast<quint16>(value) << static_cast<quint16>(0);
+        } else {
+            stream << value;
+        }
+    };
+
+    stream.writeRawData(bigEndian ? "MM" : "II", 2);
+    stream << static_cast<quint16>(42) << static_cast<quint32>(ifdOffset);
+    stream << static_cast<quint16>(entryCount);
+    entry(256,      typeShort,  1,              _tiffSize);
+    entry(257,      typeShort,  1,              _tiffSize);
+    entry(258,      typeShort,  1,              bitsPerSample);
+    entry(259,      typeShort,  1,              compression);
+    entry(273,      typeLong,   stripCount,     stripCount == 1 ? stripOffsets[0] : stripOffsetsOffset);
+    entry(277,      typeShort,  1,              1);
+    entry(278,      typeShort,  1,              rowsPerStrip);
+    entry(339,      typeShort,  1,              sampleFormat);
+    entry(33550,    typeDouble, 3,              pixelScaleOffset);
+    entry(33922,    typeDouble, 6,              tiepointOffset);
+    entry(34735,    typeShort,  12,             geoKeysOffset);
+    entry(42113,    typeAscii,  noData.size(),  noDataOffset);
+    stream << static_cast<quint32>(0);
+
+    for (quint32 stripOffset: stripOffsets) {
+        stream << stripOffset;
+    }
+    stream << spacing << spacing << 0.0;
+    const double cornerOffset = pixelIsPoint ? 0 : spacing / 2;
+    stream << 0.0 << 0.0 << 0.0 << (8.0 - cornerOffset) << (48.0 + cornerOffset) << 0.0;
+    // Key directory header, then geographic model type and raster type
+    for (quint16 value: { 1, 1, 0, 2, 1024, 0, 1, 2, 1025, 0, 1, pixelIsPoint ? 2 : 1 }) {
+        stream << value;
+    }
+    stream.writeRawData(noData.constData(), noData.size());
+
+    if (sampleFormat == 3 && bitsPerSample == 32) {
+        stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    }
+    for (int strip = stripCount - 1; strip >= 0; strip--) {
+        for (int row = strip * rowsPerStrip; row < qMin((strip + 1) * rowsPerStrip, _tiffSize); row++) {
+            for (int col = 0; col < _tiffSize; col++) {
+                double height = (row == _tiffSize / 2 && col == _tiffSize / 2) ? _tiffNoData : _height(row, col);
+                if (sampleFormat == 3) {
+                    stream << height;
+                } else if (sampleFormat == 2) {
+                    stream << static_cast<qint16>(height);
+                } else {
+                    stream << static_cast<quint16>(height);
+                }
+            }
+        }
+    }
+    QCOMPARE(bytes.size(), offset);
+
+    QFile file(_tempDir->filePath(name));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(bytes), static_cast<qint64>(bytes.size()));
+}
+
+void TerrainDEMTest::_testHGTElevation(void)
+{
+    _writeHGT(QStringLiteral("N47E008.hgt"));
+
+    TerrainDEMFile file(_tempDir->filePath(QStringLiteral("N47E008.hgt")));
+    QVERIFY(file.open());
+
+    // Samples are only available while mapped
+    QVERIFY(!file.mapped());
+    QVERIFY(qIsNaN(file.elevation(47.5, 8.5)));
+    QVERIFY(file.map());
+    QVERIFY(qAbs(file.south() - 47.0) < 1e-9);
+    QVERIFY(qAbs(file.west() - 8.0) < 1e-9);
+    QVERIFY(qAbs(file.north() - 48.0) < 1e-9);
+    QVERIFY(qAbs(file.east() - 9.0) < 1e-9);
+
+    double spacing = 1.0 / (_gridSize - 1);
+
+    // Row 0 is the northern edge
+    QVERIFY(qAbs(file.elevation(48.0, 8.0) - _height(0, 0)) < 1e-3);
+    QVERIFY(qAbs(file.elevation(47.0, 9.0) - _height(_gridSize - 1, _gridSize - 1)) < 1e-3);
+
+    // Half way between samples is interpolated
+    double height = file.elevation(48.0 - spacing * 10.5, 8.0 + spacing * 20.5);
+    QVERIFY(qAbs(height - (100 + 10.5 * 2 + 20.5)) < 1e-6);
+
+    // The void sample is left out of the interpolation instead of pulling the height down to -32768
+    int center = _gridSize / 2;
+    height = file.elevation(48.0 - spacing * (center + 0.5), 8.0 + spacing * center);
+    QVERIFY(qAbs(height - _height(center + 1, center)) < 1e-3);
+
+    QVERIFY(qIsNaN(file.elevation(46.9, 8.5)));
+}
+
+void TerrainDEMTest::_testGeoTIFF_data(void)
+{
+    QTest::addColumn<bool>("bigEndian");
+    QTest::addColumn<int>("bitsPerSample");
+    QTest::addColumn<int>("sampleFormat");
+    QTest::addColumn<bool>("pixelIsPoint");
+    QTest::addColumn<int>("rowsPerStrip");
+
+    QTest::newRow("int16, little endian, PixelIsArea, single strip")    << false   << 16 << 2 << false << _tiffSize;
+    QTest::newRow("uint16, big endian, PixelIsPoint, strips")           << true    << 16 << 1 << true  << 3;
+    QTest::newRow("float32, little endian, PixelIsPoint, strips")       << false   << 32 << 3 << true  << 4;
+    QTest::newRow("float64, big endian, PixelIsArea, row strips")       << true    << 64 << 3 << false << 1;
+}
+
+void TerrainDEMTest::_testGeoTIFF(void)
+{
+    QFETCH(bool,    bigEndian);
+    QFETCH(int,     bitsPerSample);
+    QFETCH(int,     sampleFormat);
+    QFETCH(bool,    pixelIsPoint);
+    QFETCH(int,     rowsPerStrip);
+
+    _writeGeoTIFF(QStringLiteral("dem.tif"), bigEndian, bitsPerSample, sampleFormat, pixelIsPoint, rowsPerStrip);
+
+    TerrainDEMFile file(_tempDir->filePath(QStringLiteral("dem.tif")));
+    QVERIFY(file.open());
+    QVERIFY(file.map());
+
+    // PixelIsArea and PixelIsPoint tiepoints both put the north west sample at 48N 8E
+    const double spacing = 1.0 / (_gridSize - 1);
+    QVERIFY(qAbs(file.north() - 48.0) < 1e-9);
+    QVERIFY(qAbs(file.west() - 8.0) < 1e-9);
+    QVERIFY(qAbs(file.south() - (48.0 - (_tiffSize - 1) * spacing)) < 1e-9);
+    QVERIFY(qAbs(file.east() - (8.0 + (_tiffSize - 1) * spacing)) < 1e-9);
+    QVERIFY(qAbs(file.resolution() - spacing) < 1e-12);
+
+    // Every sample comes from the right strip
+    const int center = _tiffSize / 2;
+    for (int row = 0; row < _tiffSize; row++) {
+        for (int col = 0; col < _tiffSize; col++) {
+            double height = file.elevation(48.0 - row * spacing, 8.0 + col * spacing);
+            if (row == center && col == center) {
+                QVERIFY(qIsNaN(height));
+            } else {
+                QVERIFY(qAbs(height - _height(row, col)) < 1e-3);
+            }
+        }
+    }
+
+    // The nodata sample is left out of the interpolation
+    double height = file.elevation(48.0 - spacing * (center + 0.5), 8.0 + spacing * center);
+    QVERIFY(qAbs(height - _height(center + 1, center)) < 1e-3);
+
+    file.unmap();
+
+    // Compressed files are rejected
+    _writeGeoTIFF(QStringLiteral("compressed.tif"), bigEndian, bitsPerSample, sampleFormat, pixelIsPoint, rowsPerStrip, 5 /* LZW */);
+    TerrainDEMFile compressed(_tempDir->filePath(QStringLiteral("compressed.tif")));
+    QVERIFY(!compressed.open());
+}
+
+void TerrainDEMTest::_testPyramidStats(void)
+{
+    TerrainMinMaxPyramid::SampleFunc sample = [this](int row, int col) { return _height(row, col); };
+
+    TerrainMinMaxPyramid pyramid;
+    pyramid.build(_gridSize, _gridSize, sample, 8);
+    QVERIFY(pyramid.isValid());
+    QVERIFY(pyramid.levelCount() > 2);
+
+    // Every level holds min, max, sum and count per block, the top level is a single block
+    const int blocks0 = ((_gridSize + 7) / 8) * ((_gridSize + 7) / 8);
+    QVERIFY(pyramid.byteSize() > blocks0 * 20);
+    QVERIFY(pyramid.byteSize() < blocks0 * 20 * 2);
+
+    const int rects[][4] = {
+        { 0, 0, _gridSize - 1, _gridSize - 1 },
+        { 3, 5, 70, 99 },
+        { 60, 60, 60, 60 },
+        { 0, 17, 7, 17 },
+        { 59, 59, 61, 61 },
+    };
+    for (const auto& rect: rects) {
+        double min = std::numeric_limits<double>::max();
+        double max = std::numeric_limits<double>::lowest();
+        double sum = 0;
+        quint64 count = 0;
+        for (int row = rect[0]; row <= rect[2]; row++) {
+            for (int col = rect[1]; col <= rect[3]; col++) {
+                double value = _height(row, col);
+                if (!qIsNaN(value)) {
+                    min = qMin(min, value);
+                    max = qMax(max, value);
+                    sum += value;
+                    count++;
+                }
+            }
+        }
+
+        TerrainMinMaxPyramid::Stats_t stats;
+        bool found = pyramid.stats(rect[0], rect[1], rect[2], rect[3], sample, stats);
+        QCOMPARE(found, count != 0);
+        if (found) {
+            QCOMPARE(stats.min, min);
+            QCOMPARE(stats.max, max);
+            QCOMPARE(stats.sum, sum);
+            QCOMPARE(stats.count, count);
+        }
+    }
+}
+
+void TerrainDEMTest::_testPyramidSaveLoad(void)
+{
+    TerrainMinMaxPyramid::SampleFunc sample = [this](int row, int col) { return _height(row, col); };
+
+    TerrainMinMaxPyramid pyramid;
+    pyramid.build(_gridSize, _gridSize, sample);
+    QString path = _tempDir->filePath(QStringLiteral("test.pyramid"));
+    QVERIFY(pyramid.save(path));
+
+    TerrainMinMaxPyramid loaded;
+    QVERIFY(!loaded.load(path, _gridSize + 1, _gridSize));
+    QVERIFY(loaded.load(path, _gridSize, _gridSize));
+    QCOMPARE(loaded.levelCount(), pyramid.levelCount());
+
+    TerrainMinMaxPyramid::Stats_t expected, actual;
+    QVERIFY(pyramid.stats(10, 10, 100, 50, sample, expected));
+    QVERIFY(loaded.stats(10, 10, 100, 50, sample, actual));
+    QCOMPARE(actual.min, expected.min);
+    QCOMPARE(actual.max, expected.max);
+    QCOMPARE(actual.count, expected.count);
+}
+
+void TerrainDEMTest::_testLocalDEMQuery(void)
+{
+    _writeHGT(QStringLiteral("N47E008.hgt"));
+    qgcApp()->toolbox()->settingsManager()->offlineMapsSettings()->terrainDEMDirectory()->setRawValue(_tempDir->path());
+
+    TerrainLocalDEMQuery query;
+
+    // Results are signalled later, even once the files are available
+    QSignalSpy coordinateSpy(&query, &TerrainQueryInterface::coordinateHeightsReceived);
+    query.requestCoordinateHeights({ QGeoCoordinate(48.0, 8.0), QGeoCoordinate(47.0, 9.0) });
+    QCOMPARE(coordinateSpy.count(), 0);
+    QVERIFY(coordinateSpy.wait());
+    QCOMPARE(coordinateSpy.count(), 1);
+    QCOMPARE(coordinateSpy[0][0].toBool(), true);
+    QList<double> heights = coordinateSpy[0][1].value<QList<double>>();
+    QCOMPARE(heights.count(), 2);
+    QVERIFY(qAbs(heights[0] - _height(0, 0)) < 1e-3);
+    QVERIFY(qAbs(heights[1] - _height(_gridSize - 1, _gridSize - 1)) < 1e-3);
+
+    // Outside of the available files fails the whole query
+    query.requestCoordinateHeights({ QGeoCoordinate(48.0, 8.0), QGeoCoordinate(10.0, 10.0) });
+    QCOMPARE(coordinateSpy.count(), 1);
+    QVERIFY(coordinateSpy.wait());
+    QCOMPARE(coordinateSpy.count(), 2);
+    QCOMPARE(coordinateSpy[1][0].toBool(), false);
+
+    QSignalSpy pathSpy(&query, &TerrainQueryInterface::pathHeightsReceived);
+    query.requestPathHeights(QGeoCoordinate(47.5, 8.2), QGeoCoordinate(47.51, 8.21));
+    QCOMPARE(pathSpy.count(), 0);
+    QVERIFY(pathSpy.wait());
+    QCOMPARE(pathSpy.count(), 1);
+    QCOMPARE(pathSpy[0][0].toBool(), true);
+    QVERIFY(pathSpy[0][3].value<QList<double>>().count() > 2);
+
+    QSignalSpy carpetSpy(&query, &TerrainQueryInterface::carpetHeightsReceived);
+    query.requestCarpetHeights(QGeoCoordinate(47.0, 8.0), QGeoCoordinate(48.0, 9.0), true /* statsOnly */);
+    QCOMPARE(carpetSpy.count(), 0);
+    QVERIFY(carpetSpy.wait());
+    QCOMPARE(carpetSpy.count(), 1);
+    QCOMPARE(carpetSpy[0][0].toBool(), true);
+    QCOMPARE(carpetSpy[0][1].toDouble(), _height(0, 0));
+    QCOMPARE(carpetSpy[0][2].toDouble(), _height(_gridSize - 1, _gridSize - 1));
+}
+
+void TerrainDEMTest::_testManagerStats(void)
+{
+    // Three files in a row with a gap in the middle, then with the gap filled
+    _writeHGT(QStringLiteral("gap/N47E008.hgt"), 0);
+    _writeHGT(QStringLiteral("gap/N47E010.hgt"), 2 * (_gridSize - 1));
+    _writeHGT(QStringLiteral("full/N47E008.hgt"), 0);
+    _writeHGT(QStringLiteral("full/N47E009.hgt"), _gridSize - 1);
+    _writeHGT(QStringLiteral("full/N47E010.hgt"), 2 * (_gridSize - 1));
+
+    TerrainDEMManager manager;
+    bool ready = false;
+    manager.setDirectory(_tempDir->filePath(QStringLiteral("gap")));
+    manager.whenReady(this, [&ready]() { ready = true; });
+    QVERIFY(!ready);
+    QTRY_VERIFY(ready);
+
+    // All four corners have data but the middle does not
+    double minHeight, maxHeight, avgHeight;
+    QVERIFY(!manager.stats(QGeoCoordinate(47.2, 8.5), QGeoCoordinate(47.8, 10.5), minHeight, maxHeight, avgHeight));
+    QVERIFY(manager.stats(QGeoCoordinate(47.2, 8.5), QGeoCoordinate(47.8, 8.9), minHeight, maxHeight, avgHeight));
+
+    ready = false;
+    manager.setDirectory(_tempDir->filePath(QStringLiteral("full")));
+    manager.whenReady(this, [&ready]() { ready = true; });
+    QTRY_VERIFY(ready);
+
+    // Neighbouring files share their edge samples, those must only be counted once
+    const double    spacing =   1.0 / (_gridSize - 1);
+    const int       row0 =      qRound((48.0 - 47.8) / spacing);
+    const int       row1 =      qRound((48.0 - 47.2) / spacing);
+    const int       col0 =      qRound((8.2 - 8.0) / spacing);
+    const int       col1 =      qRound((10.5 - 8.0) / spacing);
+    double min = std::numeric_limits<double>::max();
+    double max = std::numeric_limits<double>::lowest();
+    double sum = 0;
+    quint64 count = 0;
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            double value = _height(row, col);
+            if (!qIsNaN(value)) {
+                min = qMin(min, value);
+                max = qMax(max, value);
+                sum += value;
+                count++;
+            }
+        }
+    }
+
+    QVERIFY(manager.stats(QGeoCoordinate(47.2, 8.2), QGeoCoordinate(47.8, 10.5), minHeight, maxHeight, avgHeight));
+    QCOMPARE(minHeight, min);
+    QCOMPARE(maxHeight, max);
+    QVERIFY(qAbs(avgHeight - sum / count) < 1e-9);
+}
+
+void TerrainDEMTest::_testMappedFileLimit(void)
+{
+    const int fileCount = TerrainDEMManager::_maxMappedFiles + 8;
+    for (int i = 0; i < fileCount; i++) {
+        _writeHGT(QStringLiteral("N10E%1.hgt").arg(i, 3, 10, QChar('0')), i * (_gridSize - 1));
+    }
+
+    TerrainDEMManager manager;
+    bool ready = false;
+    manager.setDirectory(_tempDir->path());
+    manager.whenReady(this, [&ready]() { ready = true; });
+    QTRY_VERIFY(ready);
+    QCOMPARE(manager._files.count(), fileCount);
+
+    // Scanning only reads the georeferencing, nothing is mapped and no pyramid is loaded
+    for (const TerrainDEMFile* file: manager._files) {
+        QVERIFY(!file->mapped());
+        QVERIFY(!file->_pyramid.isValid());
+    }
+
+    for (int i = 0; i < fileCount; i++) {
+        QVERIFY(!qIsNaN(manager.elevation(QGeoCoordinate(10.25, i + 0.25))));
+    }
+
+    // Only the most recently used files stay mapped
+    int mappedCount = 0;
+    for (const TerrainDEMFile* file: manager._files) {
+        if (file->mapped()) {
+            mappedCount++;
+            QVERIFY(manager._mappedFiles.contains(const_cast<TerrainDEMFile*>(file)));
+        }
+    }
+    QCOMPARE(mappedCount, TerrainDEMManager::_maxMappedFiles);
+    QVERIFY(manager._fileForCoordinate(10.25, fileCount - 0.75)->mapped());
+    QVERIFY(!manager._fileForCoordinate(10.25, 0.25)->mapped());
+
+    // An unmapped file is mapped again when needed
+    QVERIFY(!qIsNaN(manager.elevation(QGeoCoordinate(10.25, 0.25))));
+    QVERIFY(manager._fileForCoordinate(10.25, 0.25)->mapped());
+    QCOMPARE(manager._mappedFiles.count(), TerrainDEMManager::_maxMappedFiles);
+
+    // Pyramids are loaded by the first stats query which needs them
+    double minHeight, maxHeight, avgHeight;
+    QVERIFY(manager.stats(QGeoCoordinate(10.2, 3.2), QGeoCoordinate(10.8, 3.8), minHeight, maxHeight, avgHeight));
+    QVERIFY(manager._fileForCoordinate(10.5, 3.5)->_pyramid.isValid());
+    QVERIFY(!manager._fileForCoordinate(10.5, 5.5)->_pyramid.isValid());
+}
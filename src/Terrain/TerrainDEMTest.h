@@ -0,0 +1,47 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+class TerrainDEMTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TerrainDEMTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _testHGTElevation(void);
+    void _testGeoTIFF_data(void);
+    void _testGeoTIFF(void);
+    void _testPyramidStats(void);
+    void _testPyramidSaveLoad(void);
+    void _testLocalDEMQuery(void);
+    void _testManagerStats(void);
+    void _testMappedFileLimit(void);
+
+private:
+    void    _writeHGT       (const QString& name, int colOffset = 0);
+    void    _writeGeoTIFF   (const QString& name, bool bigEndian, int bitsPerSample, int sampleFormat, bool pixelIsPoint, int rowsPerStrip, int compression = 1);
+    double  _height         (int row, int col) const;
+
+    QTemporaryDir*  _tempDir;
+
+    static const int _gridSize = 121;
+    static const int _tiffSize = 11;
+    static const int _tiffNoData = 9999;
+};
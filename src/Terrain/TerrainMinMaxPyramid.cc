@@ -0,0 +1,256 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainMinMaxPyramid.h"
+
+#include <QFile>
+#include <QDataStream>
+#include <QtMath>
+
+#include <limits>
+
+const quint32 TerrainMinMaxPyramid::_fileMagic =   0x51545059; // "QTPY"
+const quint32 TerrainMinMaxPyramid::_fileVersion = 1;
+
+TerrainMinMaxPyramid::TerrainMinMaxPyramid(void)
+    : _rows     (0)
+    , _cols     (0)
+    , _blockSize(0)
+{
+
+}
+
+void TerrainMinMaxPyramid::build(int rows, int cols, const SampleFunc& sample, int blockSize)
+{
+    _levels.clear();
+    _rows =         rows;
+    _cols =         cols;
+    _blockSize =    blockSize;
+
+    if (rows < 1 || cols < 1 || blockSize < 1) {
+        return;
+    }
+
+    // Level 0 directly from the samples
+    Level_t level;
+    level.width =   (cols + blockSize - 1) / blockSize;
+    level.height =  (rows + blockSize - 1) / blockSize;
+    level.min.fill(std::numeric_limits<float>::max(), level.width * level.height);
+    level.max.fill(std::numeric_limits<float>::lowest(), level.width * level.height);
+    level.sum.fill(0, level.width * level.height);
+    level.count.fill(0, level.width * level.height);
+    for (int row = 0; row < rows; row++) {
+        int rowOffset = (row / blockSize) * level.width;
+        for (int col = 0; col < cols; col++) {
+            double value = sample(row, col);
+            if (qIsNaN(value)) {
+                continue;
+            }
+            int index = rowOffset + col / blockSize;
+            level.min[index] = qMin(level.min[index], static_cast<float>(value));
+            level.max[index] = qMax(level.max[index], static_cast<float>(value));
+            level.sum[index] += value;
+            level.count[index]++;
+        }
+    }
+    _levels.append(level);
+
+    // Each level above merges 2x2 blocks of the one below
+    while (_levels.last().width > 1 || _levels.last().height > 1) {
+        const Level_t& below = _levels.last();
+        Level_t above;
+        above.width =   (below.width + 1) / 2;
+        above.height =  (below.height + 1) / 2;
+        above.min.fill(std::numeric_limits<float>::max(), above.width * above.height);
+        above.max.fill(std::numeric_limits<float>::lowest(), above.width * above.height);
+        above.sum.fill(0, above.width * above.height);
+        above.count.fill(0, above.width * above.height);
+        for (int y = 0; y < below.height; y++) {
+            for (int x = 0; x < below.width; x++) {
+                int from = y * below.width + x;
+                int to = (y / 2) * above.width + x / 2;
+                above.min[to] = qMin(above.min[to], below.min[from]);
+                above.max[to] = qMax(above.max[to], below.max[from]);
+                above.sum[to] += below.sum[from];
+                above.count[to] += below.count[from];
+            }
+        }
+        _levels.append(above);
+    }
+}
+
+void TerrainMinMaxPyramid::_merge(Stats_t& stats, const Level_t& level, int index) const
+{
+    if (level.count[index]) {
+        stats.min = qMin(stats.min, static_cast<double>(level.min[index]));
+        stats.max = qMax(stats.max, static_cast<double>(level.max[index]));
+        stats.sum += level.sum[index];
+        stats.count += level.count[index];
+    }
+}
+
+void TerrainMinMaxPyramid::_blockStats(int level, int blockX, int blockY, int row0, int col0, int row1, int col1, const SampleFunc& sample, Stats_t& stats) const
+{
+    const Level_t& levelData = _levels[level];
+    if (blockX >= levelData.width || blockY >= levelData.height) {
+        return;
+    }
+
+    int size = _blockSize << level;
+    int blockRow0 = blockY * size;
+    int blockCol0 = blockX * size;
+    int blockRow1 = qMin(blockRow0 + size, _rows) - 1;
+    int blockCol1 = qMin(blockCol0 + size, _cols) - 1;
+
+    if (blockRow0 > row1 || blockRow1 < row0 || blockCol0 > col1 || blockCol1 < col0) {
+        return;
+    }
+
+    int index = blockY * levelData.width + blockX;
+    if (levelData.count[index] == 0) {
+        // Nothing but voids in here
+        return;
+    }
+
+    if (blockRow0 >= row0 && blockRow1 <= row1 && blockCol0 >= col0 && blockCol1 <= col1) {
+        _merge(stats, levelData, index);
+    } else if (level == 0) {
+        for (int row = qMax(row0, blockRow0); row <= qMin(row1, blockRow1); row++) {
+            for (int col = qMax(col0, blockCol0); col <= qMin(col1, blockCol1); col++) {
+                double value = sample(row, col);
+                if (!qIsNaN(value)) {
+                    stats.min = qMin(stats.min, value);
+                    stats.max = qMax(stats.max, value);
+                    stats.sum += value;
+                    stats.count++;
+                }
+            }
+        }
+    } else {
+        for (int y = 0; y < 2; y++) {
+            for (int x = 0; x < 2; x++) {
+                _blockStats(level - 1, blockX * 2 + x, blockY * 2 + y, row0, col0, row1, col1, sample, stats);
+            }
+        }
+    }
+}
+
+int TerrainMinMaxPyramid::byteSize(void) const
+{
+    int bytes = 0;
+    for (const Level_t& level: _levels) {
+        bytes += level.min.count() * static_cast<int>(sizeof(float)) +
+                level.max.count() * static_cast<int>(sizeof(float)) +
+                level.sum.count() * static_cast<int>(sizeof(double)) +
+                level.count.count() * static_cast<int>(sizeof(quint32));
+    }
+    return bytes;
+}
+
+bool TerrainMinMaxPyramid::stats(int row0, int col0, int row1, int col1, const SampleFunc& sample, Stats_t& stats) const
+{
+    stats.min =     std::numeric_limits<double>::max();
+    stats.max =     std::numeric_limits<double>::lowest();
+    stats.sum =     0;
+    stats.count =   0;
+
+    if (!isValid()) {
+        return false;
+    }
+
+    row0 = qMax(row0, 0);
+    col0 = qMax(col0, 0);
+    row1 = qMin(row1, _rows - 1);
+    col1 = qMin(col1, _cols - 1);
+    if (row0 > row1 || col0 > col1) {
+        return false;
+    }
+
+    int top = _levels.count() - 1;
+    for (int y = 0; y < _levels[top].height; y++) {
+        for (int x = 0; x < _levels[top].width; x++) {
+            _blockStats(top, x, y, row0, col0, row1, col1, sample, stats);
+        }
+    }
+
+    return stats.count != 0;
+}
+
+bool TerrainMinMaxPyramid::stats(Stats_t& stats) const
+{
+    stats.min =     std::numeric_limits<double>::max();
+    stats.max =     std::numeric_limits<double>::lowest();
+    stats.sum =     0;
+    stats.count =   0;
+
+    if (!isValid()) {
+        return false;
+    }
+    const Level_t& top = _levels.last();
+    for (int i = 0; i < top.count.count(); i++) {
+        _merge(stats, top, i);
+    }
+
+    return stats.count != 0;
+}
+
+bool TerrainMinMaxPyramid::save(const QString& path) const
+{
+    QFile file(path);
+    if (!isValid() || !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << _fileMagic << _fileVersion << static_cast<qint32>(_rows) << static_cast<qint32>(_cols) << static_cast<qint32>(_blockSize) << static_cast<qint32>(_levels.count());
+    for (const Level_t& level: _levels) {
+        stream << static_cast<qint32>(level.width) << static_cast<qint32>(level.height) << level.min << level.max << level.sum << level.count;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+bool TerrainMinMaxPyramid::load(const QString& path, int rows, int cols)
+{
+    _levels.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic, version;
+    qint32  fileRows, fileCols, blockSize, levelCount;
+    stream >> magic >> version >> fileRows >> fileCols >> blockSize >> levelCount;
+    if (stream.status() != QDataStream::Ok || magic != _fileMagic || version != _fileVersion || fileRows != rows || fileCols != cols || blockSize < 1 || levelCount < 1) {
+        return false;
+    }
+
+    QVector<Level_t> levels;
+    for (int i = 0; i < levelCount; i++) {
+        Level_t level;
+        qint32 width, height;
+        stream >> width >> height >> level.min >> level.max >> level.sum >> level.count;
+        level.width = width;
+        level.height = height;
+        int entries = width * height;
+        if (stream.status() != QDataStream::Ok || level.min.count() != entries || level.max.count() != entries || level.sum.count() != entries || level.count.count() != entries) {
+            return false;
+        }
+        levels.append(level);
+    }
+
+    _rows =         rows;
+    _cols =         cols;
+    _blockSize =    blockSize;
+    _levels =       levels;
+
+    return true;
+}
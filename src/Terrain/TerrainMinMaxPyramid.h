@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QString>
+
+#include <functional>
+
+/// Min/max/average quadtree over a row major elevation grid.
+///
+/// Level 0 holds one entry per block of blockSize x blockSize samples. Each higher level
+/// merges 2x2 blocks of the level below until a single block covers the grid. Area statistics
+/// then only touch the blocks which are fully inside the area plus the samples along its edges.
+/// NaN samples (voids) are ignored.
+class TerrainMinMaxPyramid
+{
+public:
+    /// Returns the elevation at the specified grid position
+    typedef std::function<double(int row, int col)> SampleFunc;
+
+    typedef struct {
+        double  min;
+        double  max;
+        double  sum;
+        quint64 count;
+    } Stats_t;
+
+    TerrainMinMaxPyramid(void);
+
+    /// Builds the pyramid by reading every sample of the grid once
+    void build(int rows, int cols, const SampleFunc& sample, int blockSize = 16);
+
+    bool isValid    (void) const { return !_levels.isEmpty(); }
+    int  levelCount (void) const { return _levels.count(); }
+    /// Memory held by the block statistics of all levels
+    int  byteSize   (void) const;
+
+    /// Statistics for the inclusive sample rectangle [row0, row1] x [col0, col1]
+    ///     @param sample Used for the samples of partially covered blocks
+    /// @return false: no valid samples in the rectangle
+    bool stats(int row0, int col0, int row1, int col1, const SampleFunc& sample, Stats_t& stats) const;
+
+    /// Statistics for the whole grid
+    bool stats(Stats_t& stats) const;
+
+    /// Persist the pyramid so it doesn't need to be rebuilt from the grid
+    bool save(const QString& path) const;
+    /// Loads a pyramid saved with save(). Fails if it was built for a grid of a different size.
+    bool load(const QString& path, int rows, int cols);
+
+private:
+    typedef struct {
+        int                 width;
+        int                 height;
+        QVector<float>      min;
+        QVector<float>      max;
+        QVector<double>     sum;
+        QVector<quint32>    count;
+    } Level_t;
+
+    void _merge         (Stats_t& stats, const Level_t& level, int index) const;
+    void _blockStats    (int level, int blockX, int blockY, int row0, int col0, int row1, int col1, const SampleFunc& sample, Stats_t& stats) const;
+
+    int                 _rows;
+    int                 _cols;
+    int                 _blockSize;
+    QVector<Level_t>    _levels;
+
+    static const quint32 _fileMagic;
+    static const quint32 _fileVersion;
+};
@@ -8,9 +8,11 @@
  ****************************************************************************/
 
 #include "TerrainQuery.h"
+#include "TerrainDEM.h"
 #include "QGCMapEngine.h"
 #include "QGeoMapReplyQGC.h"
 #include "QGCApplication.h"
+#include "SettingsManager.h"
 
 #include <QUrl>
 #include <QUrlQuery>
@@ -22,6 +24,11 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QTimer>
+#include <QPoint>
+#include <QPointer>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <QtLocation/private/qgeotilespec_p.h>
 
 #include <cmath>
@@ -32,6 +39,34 @@ QGC_LOGGING_CATEGORY(TerrainQueryVerboseLog, "TerrainQueryVerboseLog")
 Q_GLOBAL_STATIC(TerrainAtCoordinateBatchManager, _TerrainAtCoordinateBatchManager)
 Q_GLOBAL_STATIC(TerrainTileManager, _terrainTileManager)
 
+QList<QGeoCoordinate> TerrainQueryInterface::pathCoordinates(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double& latStep, double& lonStep)
+{
+    QList<QGeoCoordinate> coordinates;
+    double lat = fromCoord.latitude();
+    double lon = fromCoord.longitude();
+    double steps = qMax(1.0, ceil(toCoord.distanceTo(fromCoord) / TerrainTile::terrainAltitudeSpacing));
+    double latDiff = toCoord.latitude() - lat;
+    double lonDiff = toCoord.longitude() - lon;
+    for (double i = 0.0; i <= steps; i = i + 1) {
+        coordinates.append(QGeoCoordinate(lat + latDiff * i / steps, lon + lonDiff * i / steps));
+    }
+    // We always have one too many and we always want the last one to be the endpoint
+    coordinates.last() = toCoord;
+    latStep = coordinates[1].latitude() - coordinates[0].latitude();
+    lonStep = coordinates[1].longitude() - coordinates[0].longitude();
+
+    return coordinates;
+}
+
+TerrainQueryInterface* TerrainQueryInterface::create(QObject* parent)
+{
+    if (qgcApp()->toolbox()->settingsManager()->offlineMapsSettings()->terrainSource()->rawValue().toInt() == OfflineMapsSettings::TerrainSourceLocalDEM) {
+        return new TerrainLocalDEMQuery(parent);
+    } else {
+        return new TerrainOfflineAirMapQuery(parent);
+    }
+}
+
 TerrainAirMapQuery::TerrainAirMapQuery(QObject* parent)
     : TerrainQueryInterface(parent)
 {
@@ -79,6 +114,13 @@ void TerrainAirMapQuery::requestPathHeights(const QGeoCoordinate& fromCoord, con
     _sendQuery(QStringLiteral("/path"), query);
 }
 
+void TerrainAirMapQuery::requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath)
+{
+    // The online path api only returns a single profile per request
+    qCWarning(TerrainQueryLog) << "TerrainAirMapQuery::requestPolyPathHeights not supported, segment count" << polyPath.count() - 1;
+    emit polyPathHeightsReceived(false, QList<PathHeightInfo_t>());
+}
+
 void TerrainAirMapQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
 {
     if (qgcApp()->runningUnitTests()) {
@@ -249,7 +291,7 @@ void TerrainAirMapQuery::_parseCarpetData(const QJsonValue& carpetJson)
 
     QJsonObject statsObject =   jsonObject["stats"].toObject();
     double      minHeight =     statsObject["min"].toDouble();
-    double      maxHeight =     statsObject["min"].toDouble();
+    double      maxHeight =     statsObject["max"].toDouble();
 
     QList<QList<double>> carpet;
     if (!_carpetStatsOnly) {
@@ -273,6 +315,7 @@ TerrainOfflineAirMapQuery::TerrainOfflineAirMapQuery(QObject* parent)
     : TerrainQueryInterface(parent)
 {
     qCDebug(TerrainQueryVerboseLog) << "supportsSsl" << QSslSocket::supportsSsl() << "sslLibraryBuildVersionString" << QSslSocket::sslLibraryBuildVersionString();
+    connect(_terrainTileManager(), &TerrainTileManager::tilesCleared, this, &TerrainQueryInterface::terrainDataChanged);
 }
 
 void TerrainOfflineAirMapQuery::requestCoordinateHeights(const QList<QGeoCoordinate>& coordinates)
@@ -299,6 +342,16 @@ void TerrainOfflineAirMapQuery::requestPathHeights(const QGeoCoordinate& fromCoo
     _terrainTileManager->addPathQuery(this, fromCoord, toCoord);
 }
 
+void TerrainOfflineAirMapQuery::requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath)
+{
+    if (qgcApp()->runningUnitTests()) {
+        emit polyPathHeightsReceived(false, QList<PathHeightInfo_t>());
+        return;
+    }
+
+    _terrainTileManager->addPolyPathQuery(this, polyPath);
+}
+
 void TerrainOfflineAirMapQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
 {
     if (qgcApp()->runningUnitTests()) {
@@ -306,11 +359,7 @@ void TerrainOfflineAirMapQuery::requestCarpetHeights(const QGeoCoordinate& swCoo
         return;
     }
 
-    // TODO
-    Q_UNUSED(swCoord);
-    Q_UNUSED(neCoord);
-    Q_UNUSED(statsOnly);
-    qWarning() << "Carpet queries are currently not supported from offline air map data";
+    _terrainTileManager->addCarpetQuery(this, swCoord, neCoord, statsOnly);
 }
 
 void TerrainOfflineAirMapQuery::_signalCoordinateHeights(bool success, QList<double> heights)
@@ -323,14 +372,46 @@ void TerrainOfflineAirMapQuery::_signalPathHeights(bool success, double latStep,
     emit pathHeightsReceived(success, latStep, lonStep, heights);
 }
 
+void TerrainOfflineAirMapQuery::_signalPolyPathHeights(bool success, const QList<PathHeightInfo_t>& rgPathHeightInfo)
+{
+    emit polyPathHeightsReceived(success, rgPathHeightInfo);
+}
+
 void TerrainOfflineAirMapQuery::_signalCarpetHeights(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet)
 {
     emit carpetHeightsReceived(success, minHeight, maxHeight, carpet);
 }
 
+void TerrainOfflineAirMapQuery::clearTileCache(void)
+{
+    _terrainTileManager()->clearCache();
+}
+
+/// A query this close to a tile edge (fraction of the tile) prefetches the neighbouring tile
+const double TerrainTileManager::_prefetchEdgeMargin = 0.1;
+
 TerrainTileManager::TerrainTileManager(void)
 {
+    Fact* maxCacheFact = qgcApp()->toolbox()->settingsManager()->offlineMapsSettings()->maxTerrainTileMemCache();
+    connect(maxCacheFact, &Fact::rawValueChanged, this, &TerrainTileManager::_maxCacheChanged);
+    _maxCacheChanged(maxCacheFact->rawValue());
+}
 
+void TerrainTileManager::_maxCacheChanged(QVariant value)
+{
+    QMutexLocker locker(&_tilesMutex);
+    int count = _tiles.count();
+    _tiles.setMaxCost(qMax(1, value.toInt()) * 1024);
+    _cacheEvictions += count - _tiles.count();
+}
+
+void TerrainTileManager::clearCache(void)
+{
+    QMutexLocker locker(&_tilesMutex);
+    _tiles.clear();
+    locker.unlock();
+
+    emit tilesCleared();
 }
 
 void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates)
@@ -356,25 +437,15 @@ void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQu
             qCDebug(TerrainQueryLog) << "addCoordinateQuery: All altitudes taken from cached data";
             terrainQueryInterface->_signalCoordinateHeights(coordinates.count() == altitudes.count(), altitudes);
         }
+        _startPrefetch();
     }
 }
 
 void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint)
 {
     // Convert to individual coordinate queries
-    QList<QGeoCoordinate> coordinates;
-    double lat = startPoint.latitude();
-    double lon = startPoint.longitude();
-    double steps = ceil(endPoint.distanceTo(startPoint) / TerrainTile::terrainAltitudeSpacing);
-    double latDiff = endPoint.latitude() - lat;
-    double lonDiff = endPoint.longitude() - lon;
-    for (double i = 0.0; i <= steps; i = i + 1) {
-        coordinates.append(QGeoCoordinate(lat + latDiff * i / steps, lon + lonDiff * i / steps));
-    }
-    // We always have one too many and we always want the last one to be the endpoint
-    coordinates.last() = endPoint;
-    double latStep = coordinates[1].latitude() - coordinates[0].latitude();
-    double lonStep = coordinates[1].longitude() - coordinates[0].longitude();
+    double latStep, lonStep;
+    QList<QGeoCoordinate> coordinates = TerrainQueryInterface::pathCoordinates(startPoint, endPoint, latStep, lonStep);
 
     qCDebug(TerrainQueryLog) << "TerrainTileManager::addPathQuery start:end:coordCount" << startPoint << endPoint << coordinates.count();
 
@@ -395,6 +466,325 @@ void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInt
         qCDebug(TerrainQueryLog) << "addPathQuery: All altitudes taken from cached data";
         terrainQueryInterface->_signalPathHeights(coordinates.count() == altitudes.count(), latStep, lonStep, altitudes);
     }
+    _startPrefetch();
+}
+
+void TerrainTileManager::addPolyPathQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& polyPath)
+{
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::addPolyPathQuery count" << polyPath.count();
+
+    if (polyPath.count() < 2) {
+        qCWarning(TerrainQueryLog) << "addPolyPathQuery: poly path needs at least two coordinates";
+        terrainQueryInterface->_signalPolyPathHeights(false, QList<TerrainQueryInterface::PathHeightInfo_t>());
+        return;
+    }
+
+    // Collect the tiles needed by all segments up front so each one is only loaded once
+    QList<QPoint> tileIndices;
+    QSet<QPair<int, int>> seen;
+    for (int i = 0; i < polyPath.count() - 1; i++) {
+        double latStep, lonStep;
+        for (const QGeoCoordinate& coordinate: TerrainQueryInterface::pathCoordinates(polyPath[i], polyPath[i + 1], latStep, lonStep)) {
+            QPair<int, int> tile(QGCMapEngine::long2elevationTileX(coordinate.longitude(), 1), QGCMapEngine::lat2elevationTileY(coordinate.latitude(), 1));
+            if (!seen.contains(tile)) {
+                seen.insert(tile);
+                tileIndices.append(QPoint(tile.first, tile.second));
+            }
+        }
+    }
+
+    QueuedRequestInfo_t requestInfo = { terrainQueryInterface, QueryMode::QueryModePolyPath, 0, 0, polyPath, QGeoCoordinate(), QGeoCoordinate(), false, tileIndices };
+
+    bool error;
+    QList<TerrainTile> tiles;
+    if (!_getPolyPathTiles(requestInfo, tiles, error)) {
+        qCDebug(TerrainQueryLog) << "TerrainTileManager::addPolyPathQuery queue count:tile count" << _requestQueue.count() << tileIndices.count();
+        _requestQueue.append(requestInfo);
+        return;
+    }
+
+    if (error) {
+        qCWarning(TerrainQueryLog) << "addPolyPathQuery: signalling failure due to internal error";
+        terrainQueryInterface->_signalPolyPathHeights(false, QList<TerrainQueryInterface::PathHeightInfo_t>());
+    } else {
+        qCDebug(TerrainQueryLog) << "addPolyPathQuery: All tiles taken from cached data";
+        _samplePolyPath(terrainQueryInterface, tiles, polyPath);
+    }
+}
+
+void TerrainTileManager::addCarpetQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
+{
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::addCarpetQuery sw:ne:statsOnly" << swCoord << neCoord << statsOnly;
+
+    QueuedRequestInfo_t requestInfo = { terrainQueryInterface, QueryMode::QueryModeCarpet, 0, 0, QList<QGeoCoordinate>(), swCoord, neCoord, statsOnly };
+
+    bool error;
+    double minHeight, maxHeight;
+    QList<QList<double>> carpet;
+    if (!_getCarpet(requestInfo, minHeight, maxHeight, carpet, error)) {
+        qCDebug(TerrainQueryLog) << "TerrainTileManager::addCarpetQuery queue count" << _requestQueue.count();
+        _requestQueue.append(requestInfo);
+        return;
+    }
+
+    if (error) {
+        qCWarning(TerrainQueryLog) << "addCarpetQuery: signalling failure due to internal error";
+        terrainQueryInterface->_signalCarpetHeights(false, qQNaN(), qQNaN(), QList<QList<double>>());
+    } else {
+        qCDebug(TerrainQueryLog) << "addCarpetQuery: All altitudes taken from cached data";
+        terrainQueryInterface->_signalCarpetHeights(true, minHeight, maxHeight, carpet);
+    }
+}
+
+/// Either returns carpet data from cached tiles or queues the download of the first missing tile
+///     @param[out] error true: carpet not returned due to error, false: carpet returned
+/// @return true: carpet returned (check error as well), false: database query queued (carpet not returned)
+bool TerrainTileManager::_getCarpet(QueuedRequestInfo_t& requestInfo, double& minHeight, double& maxHeight, QList<QList<double>>& carpet, bool& error)
+{
+    error = false;
+
+    int tileX0 = QGCMapEngine::long2elevationTileX(requestInfo.swCoord.longitude(), 1);
+    int tileX1 = QGCMapEngine::long2elevationTileX(requestInfo.neCoord.longitude(), 1);
+    int tileY0 = QGCMapEngine::lat2elevationTileY(requestInfo.swCoord.latitude(), 1);
+    int tileY1 = QGCMapEngine::lat2elevationTileY(requestInfo.neCoord.latitude(), 1);
+
+    if (tileX1 < tileX0 || tileY1 < tileY0) {
+        qCWarning(TerrainQueryLog) << "TerrainTileManager::_getCarpet empty area" << requestInfo.swCoord << requestInfo.neCoord;
+        error = true;
+        return true;
+    }
+
+    QMutexLocker locker(&_tilesMutex);
+
+    for (int tileY = tileY0; tileY <= tileY1; tileY++) {
+        for (int tileX = tileX0; tileX <= tileX1; tileX++) {
+            if (!_pinTile(requestInfo, tileX, tileY)) {
+                return false;
+            }
+        }
+    }
+
+    QList<const TerrainTile*> tiles;
+    for (const TerrainTile& tile: requestInfo.pinnedTiles) {
+        tiles.append(&tile);
+    }
+
+    if (!carpetFromTiles(tiles, requestInfo.swCoord, requestInfo.neCoord, requestInfo.statsOnly, minHeight, maxHeight, carpet)) {
+        qCWarning(TerrainQueryLog) << "TerrainTileManager::_getCarpet Internal Error: area not covered by tiles";
+        error = true;
+    }
+
+    return true;
+}
+
+bool TerrainTileManager::carpetFromTiles(const QList<const TerrainTile*>& tiles, const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly, double& minHeight, double& maxHeight, QList<QList<double>>& carpet)
+{
+    carpet.clear();
+
+    // Returns the height at the coordinate from whichever tile contains it, NaN if none do
+    const TerrainTile* lastTile = nullptr;
+    auto elevation = [&tiles, &lastTile](const QGeoCoordinate& coordinate) {
+        if (!lastTile || !lastTile->isIn(coordinate)) {
+            lastTile = nullptr;
+            for (const TerrainTile* tile: tiles) {
+                if (tile->isIn(coordinate)) {
+                    lastTile = tile;
+                    break;
+                }
+            }
+        }
+        return lastTile ? lastTile->elevation(coordinate) : qQNaN();
+    };
+
+    // Whole tiles come straight from the top of their pyramid, others only read samples along the area edge
+    TerrainMinMaxPyramid::Stats_t total = { qInf(), -qInf(), 0, 0 };
+    for (const TerrainTile* tile: tiles) {
+        TerrainMinMaxPyramid::Stats_t tileStats;
+        if (tile->stats(swCoord, neCoord, tileStats)) {
+            total.min = qMin(total.min, tileStats.min);
+            total.max = qMax(total.max, tileStats.max);
+            total.count += tileStats.count;
+        }
+    }
+
+    // Corners are interpolated and may lie between samples, include them as well
+    const QGeoCoordinate corners[4] = { swCoord, neCoord, QGeoCoordinate(swCoord.latitude(), neCoord.longitude()), QGeoCoordinate(neCoord.latitude(), swCoord.longitude()) };
+    for (const QGeoCoordinate& corner: corners) {
+        double height = elevation(corner);
+        if (qIsNaN(height)) {
+            return false;
+        }
+        total.min = qMin(total.min, height);
+        total.max = qMax(total.max, height);
+    }
+    minHeight = total.min;
+    maxHeight = total.max;
+
+    if (!statsOnly) {
+        // Rows south to north, columns west to east at the tile spacing
+        const QGeoCoordinate& nwCoord = corners[3];
+        int cRows = qMax(2, static_cast<int>(ceil(swCoord.distanceTo(nwCoord) / TerrainTile::terrainAltitudeSpacing)) + 1);
+        int cCols = qMax(2, static_cast<int>(ceil(nwCoord.distanceTo(neCoord) / TerrainTile::terrainAltitudeSpacing)) + 1);
+        double latStep = (neCoord.latitude() - swCoord.latitude()) / (cRows - 1);
+        double lonStep = (neCoord.longitude() - swCoord.longitude()) / (cCols - 1);
+        for (int row = 0; row < cRows; row++) {
+            QList<double> heights;
+            heights.reserve(cCols);
+            for (int col = 0; col < cCols; col++) {
+                double height = elevation(QGeoCoordinate(swCoord.latitude() + row * latStep, swCoord.longitude() + col * lonStep));
+                if (qIsNaN(height)) {
+                    carpet.clear();
+                    return false;
+                }
+                heights.append(height);
+            }
+            carpet.append(heights);
+        }
+    }
+
+    return true;
+}
+
+/// Either returns copies of all tiles needed by a poly path query or queues the download of the first missing tile
+///     @param[out] error true: tiles not returned due to error, false: tiles returned
+/// @return true: tiles returned (check error as well), false: database query queued (tiles not returned)
+bool TerrainTileManager::_getPolyPathTiles(QueuedRequestInfo_t& requestInfo, QList<TerrainTile>& tiles, bool& error)
+{
+    error = false;
+    tiles.clear();
+
+    QMutexLocker locker(&_tilesMutex);
+
+    for (const QPoint& tileIndex: requestInfo.tiles) {
+        if (!_pinTile(requestInfo, tileIndex.x(), tileIndex.y())) {
+            return false;
+        }
+    }
+    tiles = requestInfo.pinnedTiles.values();
+
+    return true;
+}
+
+/// Makes sure the request holds the specified tile, queuing its download if it is not in the cache. The request
+/// keeps a copy (sharing the tile data) so tiles found earlier stay available when loading the remaining ones
+/// evicts them from the cache. Must be called with the tiles mutex locked.
+/// @return false: tile download queued
+bool TerrainTileManager::_pinTile(QueuedRequestInfo_t& requestInfo, int tileX, int tileY)
+{
+    QString hash = QGCMapEngine::getTileHash(UrlFactory::AirmapElevation, tileX, tileY, 1);
+    if (requestInfo.pinnedTiles.contains(hash)) {
+        return true;
+    }
+
+    TerrainTile* tile = _tiles.object(hash);
+    if (!tile) {
+        _cacheMisses++;
+        _requestMissingTile(tileX, tileY);
+        return false;
+    }
+    _cacheHits++;
+    requestInfo.pinnedTiles.insert(hash, *tile);
+    return true;
+}
+
+/// Samples all segments on a worker thread and signals the result back on the main thread
+void TerrainTileManager::_samplePolyPath(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<TerrainTile>& tiles, const QList<QGeoCoordinate>& polyPath)
+{
+    QPointer<TerrainOfflineAirMapQuery> terrainQuery(terrainQueryInterface);
+    QFutureWatcher<QList<TerrainQueryInterface::PathHeightInfo_t>>* watcher = new QFutureWatcher<QList<TerrainQueryInterface::PathHeightInfo_t>>(this);
+
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, terrainQuery]() {
+        QList<TerrainQueryInterface::PathHeightInfo_t> rgPathHeightInfo = watcher->result();
+        watcher->deleteLater();
+        if (terrainQuery) {
+            if (rgPathHeightInfo.isEmpty()) {
+                qCWarning(TerrainQueryLog) << "_samplePolyPath: signalling failure due to internal error";
+            }
+            terrainQuery->_signalPolyPathHeights(!rgPathHeightInfo.isEmpty(), rgPathHeightInfo);
+        }
+    });
+
+    watcher->setFuture(QtConcurrent::run([tiles, polyPath]() {
+        QList<const TerrainTile*> tilePointers;
+        for (const TerrainTile& tile: tiles) {
+            tilePointers.append(&tile);
+        }
+        QList<TerrainQueryInterface::PathHeightInfo_t> rgPathHeightInfo;
+        polyPathFromTiles(tilePointers, polyPath, rgPathHeightInfo);
+        return rgPathHeightInfo;
+    }));
+}
+
+bool TerrainTileManager::polyPathFromTiles(const QList<const TerrainTile*>& tiles, const QList<QGeoCoordinate>& polyPath, QList<TerrainQueryInterface::PathHeightInfo_t>& rgPathHeightInfo)
+{
+    rgPathHeightInfo.clear();
+
+    // Sample every segment into flat arrays, pathStart[i] is the index of the first sample of segment i
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    QVector<int>    pathStart;
+    for (int i = 0; i < polyPath.count() - 1; i++) {
+        TerrainQueryInterface::PathHeightInfo_t pathHeightInfo;
+        QList<QGeoCoordinate> coordinates = TerrainQueryInterface::pathCoordinates(polyPath[i], polyPath[i + 1], pathHeightInfo.latStep, pathHeightInfo.lonStep);
+        pathStart.append(latitudes.count());
+        for (const QGeoCoordinate& coordinate: coordinates) {
+            latitudes.append(coordinate.latitude());
+            longitudes.append(coordinate.longitude());
+        }
+        rgPathHeightInfo.append(pathHeightInfo);
+    }
+    pathStart.append(latitudes.count());
+
+    // Group the samples by tile
+    QHash<QPair<int, int>, QVector<int>> tileSamples;
+    for (int i = 0; i < latitudes.count(); i++) {
+        tileSamples[qMakePair(QGCMapEngine::long2elevationTileX(longitudes[i], 1), QGCMapEngine::lat2elevationTileY(latitudes[i], 1))].append(i);
+    }
+
+    QVector<double> heights(latitudes.count(), qQNaN());
+    QVector<double> tileLatitudes;
+    QVector<double> tileLongitudes;
+    QVector<double> tileHeights;
+    for (const QVector<int>& samples: tileSamples) {
+        QGeoCoordinate firstSample(latitudes[samples[0]], longitudes[samples[0]]);
+        const TerrainTile* sampleTile = nullptr;
+        for (const TerrainTile* tile: tiles) {
+            if (tile->isIn(firstSample)) {
+                sampleTile = tile;
+                break;
+            }
+        }
+        if (!sampleTile) {
+            rgPathHeightInfo.clear();
+            return false;
+        }
+
+        int count = samples.count();
+        tileLatitudes.resize(count);
+        tileLongitudes.resize(count);
+        tileHeights.resize(count);
+        for (int i = 0; i < count; i++) {
+            tileLatitudes[i] = latitudes[samples[i]];
+            tileLongitudes[i] = longitudes[samples[i]];
+        }
+        if (sampleTile->elevations(tileLatitudes.constData(), tileLongitudes.constData(), tileHeights.data(), count) != count) {
+            rgPathHeightInfo.clear();
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            heights[samples[i]] = tileHeights[i];
+        }
+    }
+
+    for (int i = 0; i < rgPathHeightInfo.count(); i++) {
+        QList<double>& pathHeights = rgPathHeightInfo[i].heights;
+        pathHeights.reserve(pathStart[i + 1] - pathStart[i]);
+        for (int j = pathStart[i]; j < pathStart[i + 1]; j++) {
+            pathHeights.append(heights[j]);
+        }
+    }
+
+    return true;
 }
 
 /// Either returns altitudes from cache or queues database request
@@ -409,9 +799,11 @@ bool TerrainTileManager::_getAltitudesForCoordinates(const QList<QGeoCoordinate>
         qCDebug(TerrainQueryLog) << "TerrainTileManager::_getAltitudesForCoordinates hash:coordinate" << tileHash << coordinate;
 
         _tilesMutex.lock();
-        if (_tiles.contains(tileHash)) {
-            if (_tiles[tileHash].isIn(coordinate)) {
-                double elevation = _tiles[tileHash].elevation(coordinate);
+        TerrainTile* tile = _tiles.object(tileHash);
+        if (tile) {
+            _cacheHits++;
+            if (tile->isIn(coordinate)) {
+                double elevation = tile->elevation(coordinate);
                 if (qIsNaN(elevation)) {
                     error = true;
                     qCWarning(TerrainQueryLog) << "TerrainTileManager::_getAltitudesForCoordinates Internal Error: negative elevation in tile cache";
@@ -424,19 +816,10 @@ bool TerrainTileManager::_getAltitudesForCoordinates(const QList<QGeoCoordinate>
                 altitudes.push_back(qQNaN());
                 error = true;
             }
+            _prefetchNeighbours(coordinate);
         } else {
-            if (_state != State::Downloading) {
-                QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(UrlFactory::AirmapElevation, QGCMapEngine::long2elevationTileX(coordinate.longitude(), 1), QGCMapEngine::lat2elevationTileY(coordinate.latitude(), 1), 1, &_networkManager);
-                qCDebug(TerrainQueryLog) << "TerrainTileManager::_getAltitudesForCoordinates query from database" << request.url();
-                QGeoTileSpec spec;
-                spec.setX(QGCMapEngine::long2elevationTileX(coordinate.longitude(), 1));
-                spec.setY(QGCMapEngine::lat2elevationTileY(coordinate.latitude(), 1));
-                spec.setZoom(1);
-                spec.setMapId(UrlFactory::AirmapElevation);
-                QGeoTiledMapReplyQGC* reply = new QGeoTiledMapReplyQGC(&_networkManager, request, spec);
-                connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
-                _state = State::Downloading;
-            }
+            _cacheMisses++;
+            _requestMissingTile(QGCMapEngine::long2elevationTileX(coordinate.longitude(), 1), QGCMapEngine::lat2elevationTileY(coordinate.latitude(), 1));
             _tilesMutex.unlock();
 
             return false;
@@ -447,6 +830,104 @@ bool TerrainTileManager::_getAltitudesForCoordinates(const QList<QGeoCoordinate>
     return true;
 }
 
+/// Starts the download of the specified tile
+void TerrainTileManager::_requestTile(int tileX, int tileY)
+{
+    QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(UrlFactory::AirmapElevation, tileX, tileY, 1, &_networkManager);
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::_requestTile query from database" << request.url();
+    QGeoTileSpec spec;
+    spec.setX(tileX);
+    spec.setY(tileY);
+    spec.setZoom(1);
+    spec.setMapId(UrlFactory::AirmapElevation);
+    QGeoTiledMapReplyQGC* reply = new QGeoTiledMapReplyQGC(&_networkManager, request, spec);
+    connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
+}
+
+/// Starts the download of a tile queued requests are waiting for, unless such a download is already in progress.
+/// A prefetch of the same tile which is already in flight is taken over instead of being requested again.
+void TerrainTileManager::_requestMissingTile(int tileX, int tileY)
+{
+    if (_state == State::Downloading) {
+        return;
+    }
+    _state = State::Downloading;
+
+    if (QGCMapEngine::getTileHash(UrlFactory::AirmapElevation, tileX, tileY, 1) == _prefetchHash) {
+        _prefetchHash.clear();
+        return;
+    }
+    _requestTile(tileX, tileY);
+}
+
+/// Queries along a tile edge usually continue into the next tile. Remember it so it can be fetched ahead of time.
+void TerrainTileManager::_prefetchNeighbours(const QGeoCoordinate& coordinate)
+{
+    double tileX = (coordinate.longitude() + 180.0) / QGCMapEngine::srtm1TileSize;
+    double tileY = (coordinate.latitude() + 90.0) / QGCMapEngine::srtm1TileSize;
+    double fractionX = tileX - floor(tileX);
+    double fractionY = tileY - floor(tileY);
+    int offsetX = fractionX < _prefetchEdgeMargin ? -1 : (fractionX > 1.0 - _prefetchEdgeMargin ? 1 : 0);
+    int offsetY = fractionY < _prefetchEdgeMargin ? -1 : (fractionY > 1.0 - _prefetchEdgeMargin ? 1 : 0);
+
+    QList<QPoint> neighbours;
+    if (offsetX) {
+        neighbours.append(QPoint(offsetX, 0));
+    }
+    if (offsetY) {
+        neighbours.append(QPoint(0, offsetY));
+    }
+    if (offsetX && offsetY) {
+        neighbours.append(QPoint(offsetX, offsetY));
+    }
+
+    for (const QPoint& offset: neighbours) {
+        QPoint tile(static_cast<int>(floor(tileX)) + offset.x(), static_cast<int>(floor(tileY)) + offset.y());
+        if (!_prefetchCandidates.contains(tile)) {
+            _prefetchCandidates.append(tile);
+        }
+    }
+}
+
+/// Prefetches one of the neighbour tiles found by earlier queries. Prefetching only happens while no queued request
+/// is waiting for a download, and it does not hold up the download of a tile a new request misses.
+void TerrainTileManager::_startPrefetch(void)
+{
+    if (_state != State::Idle || !_prefetchHash.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&_tilesMutex);
+    while (!_prefetchCandidates.isEmpty()) {
+        QPoint tile = _prefetchCandidates.takeFirst();
+        QString hash = QGCMapEngine::getTileHash(UrlFactory::AirmapElevation, tile.x(), tile.y(), 1);
+        if (!_tiles.contains(hash) && !_prefetchFailed.contains(hash)) {
+            qCDebug(TerrainQueryLog) << "TerrainTileManager::_startPrefetch" << hash;
+            _prefetchHash = hash;
+            _requestTile(tile.x(), tile.y());
+            break;
+        }
+    }
+    _prefetchCandidates.clear();
+}
+
+void TerrainTileManager::_insertTile(const QString& hash, TerrainTile* tile)
+{
+    QMutexLocker locker(&_tilesMutex);
+    if (_tiles.contains(hash)) {
+        delete tile;
+        return;
+    }
+    int count = _tiles.count();
+    // QCache deletes the least recently used tiles to stay within budget
+    if (_tiles.insert(hash, tile, qMax(1, tile->byteSize() / 1024))) {
+        _cacheEvictions += count + 1 - _tiles.count();
+    } else {
+        qCWarning(TerrainQueryLog) << "Terrain tile larger than the whole tile cache" << hash;
+    }
+    qCDebug(TerrainQueryLog) << "Terrain tile cache KB:count:hits:misses:evictions" << _tiles.totalCost() << _tiles.count() << _cacheHits << _cacheMisses << _cacheEvictions;
+}
+
 void TerrainTileManager::_tileFailed(void)
 {
     QList<double>    noAltitudes;
@@ -456,6 +937,10 @@ void TerrainTileManager::_tileFailed(void)
             requestInfo.terrainQueryInterface->_signalCoordinateHeights(false, noAltitudes);
         } else if (requestInfo.queryMode == QueryMode::QueryModePath) {
             requestInfo.terrainQueryInterface->_signalPathHeights(false, requestInfo.latStep, requestInfo.lonStep, noAltitudes);
+        } else if (requestInfo.queryMode == QueryMode::QueryModePolyPath) {
+            requestInfo.terrainQueryInterface->_signalPolyPathHeights(false, QList<TerrainQueryInterface::PathHeightInfo_t>());
+        } else if (requestInfo.queryMode == QueryMode::QueryModeCarpet) {
+            requestInfo.terrainQueryInterface->_signalCarpetHeights(false, qQNaN(), qQNaN(), QList<QList<double>>());
         }
     }
     _requestQueue.clear();
@@ -464,10 +949,10 @@ void TerrainTileManager::_tileFailed(void)
 void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::NetworkError error)
 {
     QGeoTiledMapReplyQGC* reply = qobject_cast<QGeoTiledMapReplyQGC*>(QObject::sender());
-    _state = State::Idle;
 
     if (!reply) {
         qCWarning(TerrainQueryLog) << "Elevation tile fetched but invalid reply data type.";
+        _state = State::Idle;
         return;
     }
 
@@ -475,35 +960,43 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
     QGeoTileSpec spec = reply->tileSpec();
     QString hash = QGCMapEngine::getTileHash(UrlFactory::AirmapElevation, spec.x(), spec.y(), spec.zoom());
 
+    // A prefetch runs alongside the download queued requests are waiting for, only the latter changes the state
+    bool prefetch = hash == _prefetchHash;
+    if (prefetch) {
+        _prefetchHash.clear();
+    } else {
+        _state = State::Idle;
+    }
+
     // handle potential errors
+    bool failed = false;
     if (error != QNetworkReply::NoError) {
         qCWarning(TerrainQueryLog) << "Elevation tile fetching returned error (" << error << ")";
-        _tileFailed();
-        reply->deleteLater();
-        return;
-    }
-    if (responseBytes.isEmpty()) {
+        failed = true;
+    } else if (responseBytes.isEmpty()) {
         qCWarning(TerrainQueryLog) << "Error in fetching elevation tile. Empty response.";
-        _tileFailed();
-        reply->deleteLater();
-        return;
+        failed = true;
     }
+    reply->deleteLater();
 
-    qWarning() << "Received some bytes of terrain data: " << responseBytes.size();
+    if (failed) {
+        if (!prefetch) {
+            _tileFailed();
+            return;
+        }
+        // Queued requests don't depend on a prefetched tile, carry on with them
+        _prefetchFailed.insert(hash);
+    } else {
+        qCDebug(TerrainQueryLog) << "Received some bytes of terrain data: " << responseBytes.size();
 
-    TerrainTile* terrainTile = new TerrainTile(responseBytes);
-    if (terrainTile->isValid()) {
-        _tilesMutex.lock();
-        if (!_tiles.contains(hash)) {
-            _tiles.insert(hash, *terrainTile);
+        TerrainTile* terrainTile = new TerrainTile(responseBytes);
+        if (terrainTile->isValid()) {
+            _insertTile(hash, terrainTile);
         } else {
+            qCWarning(TerrainQueryLog) << "Received invalid tile";
             delete terrainTile;
         }
-        _tilesMutex.unlock();
-    } else {
-        qCWarning(TerrainQueryLog) << "Received invalid tile";
     }
-    reply->deleteLater();
 
     // now try to query the data again
     for (int i = _requestQueue.count() - 1; i >= 0; i--) {
@@ -511,6 +1004,37 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
         QList<double> altitudes;
         QueuedRequestInfo_t& requestInfo = _requestQueue[i];
 
+        if (requestInfo.queryMode == QueryMode::QueryModeCarpet) {
+            double minHeight, maxHeight;
+            QList<QList<double>> carpet;
+            if (_getCarpet(requestInfo, minHeight, maxHeight, carpet, error)) {
+                if (error) {
+                    qCWarning(TerrainQueryLog) << "_terrainDone(carpetQuery): signalling failure due to internal error";
+                    requestInfo.terrainQueryInterface->_signalCarpetHeights(false, qQNaN(), qQNaN(), QList<QList<double>>());
+                } else {
+                    qCDebug(TerrainQueryLog) << "_terrainDone(carpetQuery): All altitudes taken from cached data";
+                    requestInfo.terrainQueryInterface->_signalCarpetHeights(true, minHeight, maxHeight, carpet);
+                }
+                _requestQueue.removeAt(i);
+            }
+            continue;
+        }
+
+        if (requestInfo.queryMode == QueryMode::QueryModePolyPath) {
+            QList<TerrainTile> tiles;
+            if (_getPolyPathTiles(requestInfo, tiles, error)) {
+                if (error) {
+                    qCWarning(TerrainQueryLog) << "_terrainDone(polyPathQuery): signalling failure due to internal error";
+                    requestInfo.terrainQueryInterface->_signalPolyPathHeights(false, QList<TerrainQueryInterface::PathHeightInfo_t>());
+                } else {
+                    qCDebug(TerrainQueryLog) << "_terrainDone(polyPathQuery): All tiles taken from cached data";
+                    _samplePolyPath(requestInfo.terrainQueryInterface, tiles, requestInfo.coordinates);
+                }
+                _requestQueue.removeAt(i);
+            }
+            continue;
+        }
+
         if (_getAltitudesForCoordinates(requestInfo.coordinates, altitudes, error)) {
             if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
                 if (error) {
@@ -534,6 +1058,8 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
             _requestQueue.removeAt(i);
         }
     }
+
+    _startPrefetch();
 }
 
 QString TerrainTileManager::_getTileHash(const QGeoCoordinate& coordinate)
@@ -544,17 +1070,70 @@ QString TerrainTileManager::_getTileHash(const QGeoCoordinate& coordinate)
     return ret;
 }
 
+/// Coordinates are quantized to this many degrees (about 1m) for the height memo, well below the terrain sample spacing
+const double TerrainAtCoordinateBatchManager::_memoQuantization = 1e-5;
+const int TerrainAtCoordinateBatchManager::_memoMaxEntries = 10000;
+
 TerrainAtCoordinateBatchManager::TerrainAtCoordinateBatchManager(void)
+    : _memo(_memoMaxEntries)
 {
     _batchTimer.setSingleShot(true);
     _batchTimer.setInterval(_batchTimeout);
     connect(&_batchTimer, &QTimer::timeout, this, &TerrainAtCoordinateBatchManager::_sendNextBatch);
-    connect(&_terrainQuery, &TerrainQueryInterface::coordinateHeightsReceived, this, &TerrainAtCoordinateBatchManager::_coordinateHeights);
+    _terrainQuery = TerrainQueryInterface::create(this);
+    connect(_terrainQuery, &TerrainQueryInterface::coordinateHeightsReceived, this, &TerrainAtCoordinateBatchManager::_coordinateHeights);
+    connect(_terrainQuery, &TerrainQueryInterface::terrainDataChanged,        this, &TerrainAtCoordinateBatchManager::clearMemo);
+
+    // Remembered heights are stale once the terrain data comes from somewhere else
+    OfflineMapsSettings* offlineMapsSettings = qgcApp()->toolbox()->settingsManager()->offlineMapsSettings();
+    connect(offlineMapsSettings->terrainSource(),       &Fact::rawValueChanged, this, &TerrainAtCoordinateBatchManager::clearMemo);
+    connect(offlineMapsSettings->terrainDEMDirectory(), &Fact::rawValueChanged, this, &TerrainAtCoordinateBatchManager::clearMemo);
+}
+
+void TerrainAtCoordinateBatchManager::clearMemo(void)
+{
+    qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::clearMemo count" << _memo.count();
+    _memo.clear();
+}
+
+quint64 TerrainAtCoordinateBatchManager::_memoKey(const QGeoCoordinate& coordinate)
+{
+    quint64 latIndex = static_cast<quint64>(qRound64((coordinate.latitude() + 90.0) / _memoQuantization));
+    quint64 lonIndex = static_cast<quint64>(qRound64((coordinate.longitude() + 180.0) / _memoQuantization));
+    return (latIndex << 32) | lonIndex;
+}
+
+/// @return true: heights for all coordinates were remembered
+bool TerrainAtCoordinateBatchManager::_memoHeights(const QList<QGeoCoordinate>& coordinates, QList<double>& heights)
+{
+    heights.clear();
+    heights.reserve(coordinates.count());
+    for (const QGeoCoordinate& coordinate: coordinates) {
+        double* height = _memo.object(_memoKey(coordinate));
+        if (!height) {
+            heights.clear();
+            return false;
+        }
+        heights.append(*height);
+    }
+    return true;
 }
 
 void TerrainAtCoordinateBatchManager::addQuery(TerrainAtCoordinateQuery* terrainAtCoordinateQuery, const QList<QGeoCoordinate>& coordinates)
 {
     if (coordinates.length() > 0) {
+        QList<double> heights;
+        if (_memoHeights(coordinates, heights)) {
+            _memoRequestsSaved++;
+            _memoCoordinatesSaved += coordinates.count();
+            qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::addQuery answered from memo requestsSaved:coordinatesSaved:backendCoordinates" << _memoRequestsSaved << _memoCoordinatesSaved << _backendCoordinates;
+            // Callers expect the answer asynchronously, the query object is the context so nothing is delivered if it goes away
+            QTimer::singleShot(0, terrainAtCoordinateQuery, [terrainAtCoordinateQuery, heights]() mutable {
+                terrainAtCoordinateQuery->_signalTerrainData(true, heights);
+            });
+            return;
+        }
+
         connect(terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
         QueuedRequestInfo_t queuedRequestInfo = { terrainAtCoordinateQuery, coordinates };
         _requestQueue.append(queuedRequestInfo);
@@ -594,10 +1173,12 @@ void TerrainAtCoordinateBatchManager::_sendNextBatch(void)
         }
     }
     _requestQueue = _requestQueue.mid(requestQueueAdded);
+    _sentCoordinates = coords;
+    _backendCoordinates += coords.count();
     qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch requesting next batch _state:_requestQueue.count:_sentRequests.count" << _stateToString(_state) << _requestQueue.count() << _sentRequests.count();
 
     _state = State::Downloading;
-    _terrainQuery.requestCoordinateHeights(coords);
+    _terrainQuery->requestCoordinateHeights(coords);
 }
 
 void TerrainAtCoordinateBatchManager::_batchFailed(void)
@@ -662,6 +1243,12 @@ void TerrainAtCoordinateBatchManager::_coordinateHeights(bool success, QList<dou
         return;
     }
 
+    if (heights.count() == _sentCoordinates.count()) {
+        for (int i = 0; i < heights.count(); i++) {
+            _memo.insert(_memoKey(_sentCoordinates[i]), new double(heights[i]));
+        }
+    }
+
     int currentIndex = 0;
     for (const SentRequestInfo_t& sentRequestInfo: _sentRequests) {
         if (!sentRequestInfo.queryObjectDestroyed) {
@@ -669,8 +1256,9 @@ void TerrainAtCoordinateBatchManager::_coordinateHeights(bool success, QList<dou
             disconnect(sentRequestInfo.terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
             QList<double> requestAltitudes = heights.mid(currentIndex, sentRequestInfo.cCoord);
             sentRequestInfo.terrainAtCoordinateQuery->_signalTerrainData(true, requestAltitudes);
-            currentIndex += sentRequestInfo.cCoord;
         }
+        // Destroyed queries still occupy their slice of the heights
+        currentIndex += sentRequestInfo.cCoord;
     }
     _sentRequests.clear();
 
@@ -702,12 +1290,13 @@ TerrainPathQuery::TerrainPathQuery(QObject* parent)
     : QObject(parent)
 {
     qRegisterMetaType<PathHeightInfo_t>();
-    connect(&_terrainQuery, &TerrainQueryInterface::pathHeightsReceived, this, &TerrainPathQuery::_pathHeights);
+    _terrainQuery = TerrainQueryInterface::create(this);
+    connect(_terrainQuery, &TerrainQueryInterface::pathHeightsReceived, this, &TerrainPathQuery::_pathHeights);
 }
 
 void TerrainPathQuery::requestData(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
 {
-    _terrainQuery.requestPathHeights(fromCoord, toCoord);
+    _terrainQuery->requestPathHeights(fromCoord, toCoord);
 }
 
 void TerrainPathQuery::_pathHeights(bool success, double latStep, double lonStep, const QList<double>& heights)
@@ -720,10 +1309,11 @@ void TerrainPathQuery::_pathHeights(bool success, double latStep, double lonStep
 }
 
 TerrainPolyPathQuery::TerrainPolyPathQuery(QObject* parent)
-    : QObject   (parent)
-    , _curIndex (0)
+    : QObject(parent)
 {
-    connect(&_pathQuery, &TerrainPathQuery::terrainDataReceived, this, &TerrainPolyPathQuery::_terrainDataReceived);
+    qRegisterMetaType<TerrainPathQuery::PathHeightInfo_t>();
+    _terrainQuery = TerrainQueryInterface::create(this);
+    connect(_terrainQuery, &TerrainQueryInterface::polyPathHeightsReceived, this, &TerrainPolyPathQuery::terrainDataReceived);
 }
 
 void TerrainPolyPathQuery::requestData(const QVariantList& polyPath)
@@ -741,40 +1331,17 @@ void TerrainPolyPathQuery::requestData(const QList<QGeoCoordinate>& polyPath)
 {
     qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::requestData count" << polyPath.count();
 
-    // Kick off first request
-    _rgCoords = polyPath;
-    _curIndex = 0;
-    _pathQuery.requestData(_rgCoords[0], _rgCoords[1]);
-}
-
-void TerrainPolyPathQuery::_terrainDataReceived(bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
-{
-    qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_terrainDataReceived success:_curIndex" << success << _curIndex;
-
-    if (!success) {
-        _rgPathHeightInfo.clear();
-        emit terrainDataReceived(false /* success */, _rgPathHeightInfo);
-        return;
-    }
-
-    _rgPathHeightInfo.append(pathHeightInfo);
-
-    if (++_curIndex >= _rgCoords.count() - 1) {
-        // We've finished all requests
-        qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_terrainDataReceived complete";
-        emit terrainDataReceived(true /* success */, _rgPathHeightInfo);
-    } else {
-        _pathQuery.requestData(_rgCoords[_curIndex], _rgCoords[_curIndex+1]);
-    }
+    _terrainQuery->requestPolyPathHeights(polyPath);
 }
 
 TerrainCarpetQuery::TerrainCarpetQuery(QObject* parent)
     : QObject(parent)
 {
-    connect(&_terrainQuery, &TerrainQueryInterface::carpetHeightsReceived, this, &TerrainCarpetQuery::terrainDataReceived);
+    _terrainQuery = TerrainQueryInterface::create(this);
+    connect(_terrainQuery, &TerrainQueryInterface::carpetHeightsReceived, this, &TerrainCarpetQuery::terrainDataReceived);
 }
 
 void TerrainCarpetQuery::requestData(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
 {
-    _terrainQuery.requestCarpetHeights(swCoord, neCoord, statsOnly);
+    _terrainQuery->requestCarpetHeights(swCoord, neCoord, statsOnly);
 }
@@ -18,6 +18,10 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
+#include <QCache>
+#include <QHash>
+#include <QSet>
+#include <QPoint>
 #include <QtLocation/private/qgeotiledmapreply_p.h>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainQueryLog)
@@ -33,6 +37,12 @@ class TerrainQueryInterface : public QObject
 public:
     TerrainQueryInterface(QObject* parent) : QObject(parent) { }
 
+    typedef struct {
+        double          latStep;    ///< Amount of latitudinal distance between each returned height
+        double          lonStep;    ///< Amount of longitudinal distance between each returned height
+        QList<double>   heights;    ///< Terrain heights along path
+    } PathHeightInfo_t;
+
     /// Request terrain heights for specified coodinates.
     /// Signals: coordinateHeights when data is available
     virtual void requestCoordinateHeights(const QList<QGeoCoordinate>& coordinates) = 0;
@@ -42,6 +52,11 @@ public:
     ///     @param coordinates to query
     virtual void requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) = 0;
 
+    /// Requests terrain heights along every segment of the poly path in a single batch.
+    /// Signals: polyPathHeights, with one entry per segment
+    ///     @param polyPath Segment end points, at least two
+    virtual void requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath) = 0;
+
     /// Request terrain heights for the rectangular area specified.
     /// Signals: carpetHeights when data is available
     ///     @param swCoord South-West bound of rectangular area to query
@@ -49,10 +64,22 @@ public:
     ///     @param statsOnly true: Return only stats, no carpet data
     virtual void requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) = 0;
 
+    /// Returns the coordinates a path query is sampled at, spaced by TerrainTile::terrainAltitudeSpacing
+    ///     @param[out] latStep Latitude change between coordinates
+    ///     @param[out] lonStep Longitude change between coordinates
+    static QList<QGeoCoordinate> pathCoordinates(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double& latStep, double& lonStep);
+
+    /// Creates the query implementation selected in settings
+    static TerrainQueryInterface* create(QObject* parent);
+
 signals:
     void coordinateHeightsReceived(bool success, QList<double> heights);
     void pathHeightsReceived(bool success, double latStep, double lonStep, const QList<double>& heights);
+    void polyPathHeightsReceived(bool success, const QList<TerrainQueryInterface::PathHeightInfo_t>& rgPathHeightInfo);
     void carpetHeightsReceived(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet);
+
+    /// Signalled when the data backing earlier answers is gone or replaced, previously returned heights may be stale
+    void terrainDataChanged(void);
 };
 
 /// AirMap online implementation of terrain queries
@@ -65,6 +92,7 @@ public:
     // Overrides from TerrainQueryInterface
     void requestCoordinateHeights   (const QList<QGeoCoordinate>& coordinates) final;
     void requestPathHeights         (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) final;
+    void requestPolyPathHeights     (const QList<QGeoCoordinate>& polyPath) final;
     void requestCarpetHeights       (const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) final;
 
 private slots:
@@ -100,26 +128,63 @@ public:
     // Overrides from TerrainQueryInterface
     void requestCoordinateHeights(const QList<QGeoCoordinate>& coordinates) final;
     void requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) final;
+    void requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath) final;
     void requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) final;
 
     // Internal methods
     void _signalCoordinateHeights(bool success, QList<double> heights);
     void _signalPathHeights(bool success, double latStep, double lonStep, const QList<double>& heights);
+    void _signalPolyPathHeights(bool success, const QList<PathHeightInfo_t>& rgPathHeightInfo);
     void _signalCarpetHeights(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet);
+
+    /// Drops all decoded terrain tiles, must be called when the terrain tiles in the map cache are wiped
+    static void clearTileCache(void);
 };
 
 /// Used internally by TerrainOfflineAirMapQuery to manage terrain tiles
 class TerrainTileManager : public QObject {
     Q_OBJECT
 
+    friend class TerrainTileTest;
+
 public:
     TerrainTileManager(void);
 
     void addCoordinateQuery (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates);
     void addPathQuery       (TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& startPoint, const QGeoCoordinate& endPoint);
+    void addPolyPathQuery   (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& polyPath);
+    void addCarpetQuery     (TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly);
+
+    /// Computes carpet query results from the tiles covering the area
+    ///     @param tiles Tiles which together cover the whole area
+    ///     @param statsOnly true: only compute min/max, carpet is left empty
+    /// @return false: tiles do not cover the area
+    static bool carpetFromTiles(const QList<const TerrainTile*>& tiles, const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly, double& minHeight, double& maxHeight, QList<QList<double>>& carpet);
+
+    /// Computes poly path query results from the tiles covering all segments. Points are grouped
+    /// per tile so each tile is evaluated with a single batch call.
+    ///     @param tiles Tiles which together cover every segment
+    ///     @param[out] rgPathHeightInfo One entry per segment
+    /// @return false: tiles do not cover the path
+    static bool polyPathFromTiles(const QList<const TerrainTile*>& tiles, const QList<QGeoCoordinate>& polyPath, QList<TerrainQueryInterface::PathHeightInfo_t>& rgPathHeightInfo);
+
+    // Decoded tile cache statistics
+    quint64 cacheHits       (void) const { return _cacheHits; }
+    quint64 cacheMisses     (void) const { return _cacheMisses; }
+    quint64 cacheEvictions  (void) const { return _cacheEvictions; }
+    int     cacheSizeKB     (void) const { return _tiles.totalCost(); }
+
+    /// Drops all decoded tiles
+    void clearCache(void);
+
+signals:
+    /// Signalled when the decoded tile cache is cleared. Tiles evicted to stay within budget are not signalled, a
+    /// tile fetched again holds the same heights.
+    void tilesCleared(void);
 
 private slots:
     void _terrainDone       (QByteArray responseBytes, QNetworkReply::NetworkError error);
+    void _maxCacheChanged   (QVariant value);
 
 private:
     enum class State {
@@ -130,6 +195,7 @@ private:
     enum QueryMode {
         QueryModeCoordinates,
         QueryModePath,
+        QueryModePolyPath,
         QueryModeCarpet
     };
 
@@ -137,30 +203,63 @@ private:
         TerrainOfflineAirMapQuery*  terrainQueryInterface;
         QueryMode                   queryMode;
         double                      latStep, lonStep;
-        QList<QGeoCoordinate>       coordinates;
+        QList<QGeoCoordinate>       coordinates;        ///< Poly path: segment end points
+        QGeoCoordinate              swCoord, neCoord;   ///< Carpet area
+        bool                        statsOnly;          ///< Carpet stats only
+        QList<QPoint>               tiles;              ///< Poly path: unique tiles covering all segments
+        QHash<QString, TerrainTile> pinnedTiles;        ///< Carpet/poly path: tiles already found, kept until the request completes
     } QueuedRequestInfo_t;
 
     void    _tileFailed                         (void);
     bool    _getAltitudesForCoordinates         (const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error);
+    bool    _getCarpet                          (QueuedRequestInfo_t& requestInfo, double& minHeight, double& maxHeight, QList<QList<double>>& carpet, bool& error);
+    bool    _getPolyPathTiles                   (QueuedRequestInfo_t& requestInfo, QList<TerrainTile>& tiles, bool& error);
+    bool    _pinTile                            (QueuedRequestInfo_t& requestInfo, int tileX, int tileY);
+    void    _samplePolyPath                     (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<TerrainTile>& tiles, const QList<QGeoCoordinate>& polyPath);
     QString _getTileHash                        (const QGeoCoordinate& coordinate);
+    void    _requestTile                        (int tileX, int tileY);
+    void    _requestMissingTile                 (int tileX, int tileY);
+    void    _prefetchNeighbours                 (const QGeoCoordinate& coordinate);
+    void    _startPrefetch                      (void);
+    void    _insertTile                         (const QString& hash, TerrainTile* tile);
 
     QList<QueuedRequestInfo_t>  _requestQueue;
     State                       _state = State::Idle;
     QNetworkAccessManager       _networkManager;
 
     QMutex                      _tilesMutex;
-    QHash<QString, TerrainTile> _tiles;
+    QCache<QString, TerrainTile> _tiles;            ///< Decoded tiles, cost is in KB
+    QList<QPoint>               _prefetchCandidates;///< Neighbour tiles to prefetch once no request is waiting for a download
+    QString                     _prefetchHash;      ///< Hash of the neighbour tile being prefetched
+    QSet<QString>               _prefetchFailed;    ///< Neighbour tiles which failed to prefetch, not retried
+    quint64                     _cacheHits =        0;
+    quint64                     _cacheMisses =      0;
+    quint64                     _cacheEvictions =   0;
+
+    static const double         _prefetchEdgeMargin;
 };
 
-/// Used internally by TerrainAtCoordinateQuery to batch coordinate requests together
+/// Used internally by TerrainAtCoordinateQuery to batch coordinate requests together. Heights which were
+/// already returned are remembered so repeated queries for the same coordinates skip the backend.
 class TerrainAtCoordinateBatchManager : public QObject {
     Q_OBJECT
 
+    friend class TerrainTileTest;
+
 public:
     TerrainAtCoordinateBatchManager(void);
 
     void addQuery(TerrainAtCoordinateQuery* terrainAtCoordinateQuery, const QList<QGeoCoordinate>& coordinates);
 
+    // Height memo statistics
+    quint64 memoRequestsSaved       (void) const { return _memoRequestsSaved; }     ///< Queries answered without the backend
+    quint64 memoCoordinatesSaved    (void) const { return _memoCoordinatesSaved; }  ///< Coordinates answered without the backend
+    quint64 backendCoordinates      (void) const { return _backendCoordinates; }    ///< Coordinates sent to the backend
+
+public slots:
+    /// Forgets all remembered heights, must be called when the terrain data source or its data changes
+    void clearMemo(void);
+
 private slots:
     void _sendNextBatch         (void);
     void _queryObjectDestroyed  (QObject* elevationProvider);
@@ -184,15 +283,26 @@ private:
         Downloading,
     };
 
-    void _batchFailed(void);
-    QString _stateToString(State state);
+    void    _batchFailed    (void);
+    QString _stateToString  (State state);
+    bool    _memoHeights    (const QList<QGeoCoordinate>& coordinates, QList<double>& heights);
+    quint64 _memoKey        (const QGeoCoordinate& coordinate);
 
     QList<QueuedRequestInfo_t>  _requestQueue;
     QList<SentRequestInfo_t>    _sentRequests;
+    QList<QGeoCoordinate>       _sentCoordinates;
     State                       _state = State::Idle;
     const int                   _batchTimeout = 500;
     QTimer                      _batchTimer;
-    TerrainOfflineAirMapQuery   _terrainQuery;
+    TerrainQueryInterface*      _terrainQuery;
+
+    QCache<quint64, double>     _memo;                          ///< Heights keyed by quantized coordinate
+    quint64                     _memoRequestsSaved =    0;
+    quint64                     _memoCoordinatesSaved = 0;
+    quint64                     _backendCoordinates =   0;
+
+    static const double         _memoQuantization;
+    static const int            _memoMaxEntries;
 };
 
 /// NOTE: TerrainAtCoordinateQuery is not thread safe. All instances/calls to ElevationProvider must be on main thread.
@@ -226,11 +336,7 @@ public:
     ///     @param coordinates to query
     void requestData(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord);
 
-    typedef struct {
-        double          latStep;    ///< Amount of latitudinal distance between each returned height
-        double          lonStep;    ///< Amount of longitudinal distance between each returned height
-        QList<double>   heights;    ///< Terrain heights along path
-    } PathHeightInfo_t;
+    typedef TerrainQueryInterface::PathHeightInfo_t PathHeightInfo_t;
 
 signals:
     /// Signalled when terrain data comes back from server
@@ -240,7 +346,7 @@ private slots:
     void _pathHeights(bool success, double latStep, double lonStep, const QList<double>& heights);
 
 private:
-    TerrainOfflineAirMapQuery _terrainQuery;
+    TerrainQueryInterface* _terrainQuery;
 };
 
 Q_DECLARE_METATYPE(TerrainPathQuery::PathHeightInfo_t)
@@ -253,7 +359,7 @@ public:
     TerrainPolyPathQuery(QObject* parent = NULL);
 
     /// Async terrain query for terrain heights for the paths between each specified QGeoCoordinate.
-    /// When the query is done, the terrainData() signal is emitted.
+    /// All segments are queried as a single batch. When the query is done, the terrainData() signal is emitted.
     ///     @param polyPath List of QGeoCoordinate
     void requestData(const QVariantList& polyPath);
     void requestData(const QList<QGeoCoordinate>& polyPath);
@@ -262,14 +368,8 @@ signals:
     /// Signalled when terrain data comes back from server
     void terrainDataReceived(bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo);
 
-private slots:
-    void _terrainDataReceived(bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
-
 private:
-    int                                         _curIndex;
-    QList<QGeoCoordinate>                       _rgCoords;
-    QList<TerrainPathQuery::PathHeightInfo_t>   _rgPathHeightInfo;
-    TerrainPathQuery                            _pathQuery;
+    TerrainQueryInterface* _terrainQuery;
 };
 
 
@@ -292,6 +392,6 @@ signals:
     void terrainDataReceived(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet);
 
 private:
-    TerrainAirMapQuery _terrainQuery;
+    TerrainQueryInterface* _terrainQuery;
 };
 
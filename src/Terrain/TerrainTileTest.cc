@@ -0,0 +1,402 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+#include "TerrainTile.h"
+#include "TerrainQuery.h"
+#include "QGCMapEngine.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QVector>
+#include <QSignalSpy>
+
+const double TerrainTileTest::_swLat = 47.0;
+const double TerrainTileTest::_swLon = 8.0;
+const double TerrainTileTest::_neLat = 47.01;
+const double TerrainTileTest::_neLon = 8.01;
+
+TerrainTileTest::TerrainTileTest(void)
+{
+
+}
+
+QByteArray TerrainTileTest::_serialize(const QJsonArray& carpet, double swLat, double swLon, double neLat, double neLon)
+{
+    QJsonObject bounds;
+    bounds["sw"] = QJsonArray({ swLat, swLon });
+    bounds["ne"] = QJsonArray({ neLat, neLon });
+
+    QJsonObject stats;
+    stats["min"] = 0;
+    stats["max"] = 0;
+    stats["avg"] = 0;
+
+    QJsonObject data;
+    data["bounds"] = bounds;
+    data["stats"] =  stats;
+    data["carpet"] = carpet;
+
+    QJsonObject root;
+    root["status"] = "success";
+    root["data"] =   data;
+
+    return TerrainTile::serialize(QJsonDocument(root).toJson());
+}
+
+/// Builds a serialized tile whose elevation is a plane: 10 * latIndex + lonIndex
+QByteArray TerrainTileTest::_tileBytes(int gridSizeLat, int gridSizeLon)
+{
+    QJsonArray carpet;
+    for (int i = 0; i < gridSizeLat; i++) {
+        QJsonArray row;
+        for (int j = 0; j < gridSizeLon; j++) {
+            row.append(10 * i + j);
+        }
+        carpet.append(row);
+    }
+
+    return _serialize(carpet, _swLat, _swLon, _neLat, _neLon);
+}
+
+/// Synthetic terrain shared by neighbouring tiles: a plane rising to the north east
+double TerrainTileTest::_planeHeight(double latitude, double longitude)
+{
+    return qRound((latitude - _swLat) * 10000 + (longitude - _swLon) * 5000);
+}
+
+/// Tile number tileLat/tileLon (0.01 degrees each, counted from the south west test corner) of the plane
+QByteArray TerrainTileTest::_planeTileBytes(int tileLat, int tileLon)
+{
+    const int    gridSize = 11;
+    const double tileSize = 0.01;
+    const double swLat = _swLat + tileLat * tileSize;
+    const double swLon = _swLon + tileLon * tileSize;
+
+    QJsonArray carpet;
+    for (int i = 0; i < gridSize; i++) {
+        QJsonArray row;
+        for (int j = 0; j < gridSize; j++) {
+            row.append(_planeHeight(swLat + i * tileSize / (gridSize - 1), swLon + j * tileSize / (gridSize - 1)));
+        }
+        carpet.append(row);
+    }
+
+    return _serialize(carpet, swLat, swLon, swLat + tileSize, swLon + tileSize);
+}
+
+/// Terrain tile manager cache key of a tile built by _planeTileBytes
+QString TerrainTileTest::_planeTileHash(int tileLat, int tileLon)
+{
+    const double tileSize = 0.01;
+    const double centerLat = _swLat + (tileLat + 0.5) * tileSize;
+    const double centerLon = _swLon + (tileLon + 0.5) * tileSize;
+    return QGCMapEngine::getTileHash(UrlFactory::AirmapElevation, QGCMapEngine::long2elevationTileX(centerLon, 1), QGCMapEngine::lat2elevationTileY(centerLat, 1), 1);
+}
+
+void TerrainTileTest::_testInterpolation(void)
+{
+    TerrainTile tile(_tileBytes(3, 3));
+    QVERIFY(tile.isValid());
+
+    double latSpacing = (_neLat - _swLat) / 2;
+    double lonSpacing = (_neLon - _swLon) / 2;
+
+    // Grid points return the stored values
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat, _swLon)), 0.0);
+    QCOMPARE(tile.elevation(QGeoCoordinate(_neLat, _neLon)), 22.0);
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat + latSpacing, _swLon)), 10.0);
+
+    // A plane is reproduced exactly by bilinear interpolation
+    QGeoCoordinate coord(_swLat + latSpacing * 0.5, _swLon + lonSpacing * 1.25);
+    QVERIFY(qAbs(tile.elevation(coord) - (10 * 0.5 + 1.25)) < 1e-6);
+    coord = QGeoCoordinate(_swLat + latSpacing * 1.75, _swLon + lonSpacing * 0.5);
+    QVERIFY(qAbs(tile.elevation(coord) - (10 * 1.75 + 0.5)) < 1e-6);
+}
+
+void TerrainTileTest::_testOutsideTile(void)
+{
+    TerrainTile tile(_tileBytes(3, 3));
+    QVERIFY(tile.isValid());
+
+    QVERIFY(qIsNaN(tile.elevation(QGeoCoordinate(_swLat - 0.001, _swLon))));
+    QVERIFY(qIsNaN(tile.elevation(QGeoCoordinate(_neLat, _neLon + 0.001))));
+
+    double latitudes[]  = { _swLat, _swLat - 1, _neLat };
+    double longitudes[] = { _swLon, _swLon,     _neLon };
+    double heights[3];
+    QCOMPARE(tile.elevations(latitudes, longitudes, heights, 3), 2);
+    QCOMPARE(heights[0], 0.0);
+    QVERIFY(qIsNaN(heights[1]));
+    QCOMPARE(heights[2], 22.0);
+
+    // Truncated data must not produce a valid tile
+    QByteArray bytes = _tileBytes(3, 3);
+    bytes.chop(2);
+    QVERIFY(!TerrainTile(bytes).isValid());
+
+    // Nor must bounds without an area, the grid spacing would be a division by zero
+    QJsonArray carpet({ QJsonArray({ 1, 2 }), QJsonArray({ 3, 4 }) });
+    QVERIFY(!TerrainTile(_serialize(carpet, _swLat, _swLon, _swLat, _neLon)).isValid());
+    QVERIFY(!TerrainTile(_serialize(carpet, _swLat, _swLon, _neLat, _swLon)).isValid());
+}
+
+void TerrainTileTest::_testBatchMatchesSingle(void)
+{
+    TerrainTile tile(_tileBytes(151, 151));
+    QVERIFY(tile.isValid());
+
+    const int count = 1000;
+    QVector<double> latitudes(count);
+    QVector<double> longitudes(count);
+    QVector<double> heights(count);
+    for (int i = 0; i < count; i++) {
+        latitudes[i] =  _swLat + (_neLat - _swLat) * ((i * 7919) % count) / count;
+        longitudes[i] = _swLon + (_neLon - _swLon) * ((i * 104729) % count) / count;
+    }
+
+    QCOMPARE(tile.elevations(latitudes.constData(), longitudes.constData(), heights.data(), count), count);
+    for (int i = 0; i < count; i++) {
+        QCOMPARE(heights[i], tile.elevation(QGeoCoordinate(latitudes[i], longitudes[i])));
+    }
+}
+
+void TerrainTileTest::_benchmarkBatch(void)
+{
+    TerrainTile tile(_tileBytes(151, 151));
+    QVERIFY(tile.isValid());
+
+    const int count = 1000000;
+    QVector<double> latitudes(count);
+    QVector<double> longitudes(count);
+    QVector<double> heights(count);
+    for (int i = 0; i < count; i++) {
+        latitudes[i] =  _swLat + (_neLat - _swLat) * (i % 1000) / 1000.0;
+        longitudes[i] = _swLon + (_neLon - _swLon) * (i / 1000) / 1000.0;
+    }
+
+    int cInside = 0;
+    QBENCHMARK {
+        cInside = tile.elevations(latitudes.constData(), longitudes.constData(), heights.data(), count);
+    }
+    QCOMPARE(cInside, count);
+}
+
+void TerrainTileTest::_testStats(void)
+{
+    TerrainTile tile(_tileBytes(151, 151));
+    QVERIFY(tile.isValid());
+
+    double latSpacing = (_neLat - _swLat) / 150;
+    double lonSpacing = (_neLon - _swLon) / 150;
+
+    // Whole tile
+    TerrainMinMaxPyramid::Stats_t stats;
+    QVERIFY(tile.stats(QGeoCoordinate(_swLat, _swLon), QGeoCoordinate(_neLat, _neLon), stats));
+    QCOMPARE(stats.min, 0.0);
+    QCOMPARE(stats.max, 1650.0);
+    QCOMPARE(stats.count, static_cast<quint64>(151 * 151));
+
+    // Part of the tile, bounds between samples
+    QVERIFY(tile.stats(QGeoCoordinate(_swLat + latSpacing * 20.5, _swLon + lonSpacing * 3.2), QGeoCoordinate(_swLat + latSpacing * 97.7, _swLon + lonSpacing * 40.9), stats));
+    QCOMPARE(stats.min, 10.0 * 21 + 4);
+    QCOMPARE(stats.max, 10.0 * 97 + 40);
+    QCOMPARE(stats.count, static_cast<quint64>((97 - 21 + 1) * (40 - 4 + 1)));
+
+    // Area between samples
+    QVERIFY(!tile.stats(QGeoCoordinate(_swLat + latSpacing * 20.2, _swLon + lonSpacing * 3.2), QGeoCoordinate(_swLat + latSpacing * 20.8, _swLon + lonSpacing * 3.8), stats));
+
+    // Area outside of the tile
+    QVERIFY(!tile.stats(QGeoCoordinate(_neLat + 1, _neLon + 1), QGeoCoordinate(_neLat + 2, _neLon + 2), stats));
+}
+
+void TerrainTileTest::_testCarpetFromTiles(void)
+{
+    TerrainTile tile00(_planeTileBytes(0, 0));
+    TerrainTile tile01(_planeTileBytes(0, 1));
+    TerrainTile tile10(_planeTileBytes(1, 0));
+    TerrainTile tile11(_planeTileBytes(1, 1));
+    QList<const TerrainTile*> tiles = { &tile00, &tile01, &tile10, &tile11 };
+
+    // Area spanning all four tiles, the plane has its extremes at the corners
+    QGeoCoordinate swCoord(_swLat + 0.0035, _swLon + 0.0042);
+    QGeoCoordinate neCoord(_swLat + 0.0167, _swLon + 0.0151);
+    double expectedMin = (swCoord.latitude() - _swLat) * 10000 + (swCoord.longitude() - _swLon) * 5000;
+    double expectedMax = (neCoord.latitude() - _swLat) * 10000 + (neCoord.longitude() - _swLon) * 5000;
+
+    double minHeight, maxHeight;
+    QList<QList<double>> carpet;
+    QVERIFY(TerrainTileManager::carpetFromTiles(tiles, swCoord, neCoord, true /* statsOnly */, minHeight, maxHeight, carpet));
+    QVERIFY(qAbs(minHeight - expectedMin) < 1e-3);
+    QVERIFY(qAbs(maxHeight - expectedMax) < 1e-3);
+    QCOMPARE(carpet.count(), 0);
+
+    QVERIFY(TerrainTileManager::carpetFromTiles(tiles, swCoord, neCoord, false /* statsOnly */, minHeight, maxHeight, carpet));
+    QVERIFY(carpet.count() > 2);
+    QVERIFY(carpet[0].count() > 2);
+    QVERIFY(qAbs(carpet.first().first() - expectedMin) < 1e-3);
+    QVERIFY(qAbs(carpet.last().last() - expectedMax) < 1e-3);
+    for (int row = 1; row < carpet.count(); row++) {
+        QVERIFY(carpet[row][0] > carpet[row - 1][0]);
+    }
+
+    // Missing tile
+    tiles.removeLast();
+    QVERIFY(!TerrainTileManager::carpetFromTiles(tiles, swCoord, neCoord, true /* statsOnly */, minHeight, maxHeight, carpet));
+}
+
+void TerrainTileTest::_testPolyPathFromTiles(void)
+{
+    TerrainTile tile00(_planeTileBytes(0, 0));
+    TerrainTile tile01(_planeTileBytes(0, 1));
+    TerrainTile tile10(_planeTileBytes(1, 0));
+    TerrainTile tile11(_planeTileBytes(1, 1));
+    QList<const TerrainTile*> tiles = { &tile00, &tile01, &tile10, &tile11 };
+
+    // Transects zig-zagging across all four tiles
+    QList<QGeoCoordinate> polyPath = {
+        QGeoCoordinate(_swLat + 0.0021, _swLon + 0.0013),
+        QGeoCoordinate(_swLat + 0.0021, _swLon + 0.0187),
+        QGeoCoordinate(_swLat + 0.0102, _swLon + 0.0187),
+        QGeoCoordinate(_swLat + 0.0102, _swLon + 0.0013),
+        QGeoCoordinate(_swLat + 0.0176, _swLon + 0.0055),
+    };
+
+    QList<TerrainQueryInterface::PathHeightInfo_t> rgPathHeightInfo;
+    QVERIFY(TerrainTileManager::polyPathFromTiles(tiles, polyPath, rgPathHeightInfo));
+    QCOMPARE(rgPathHeightInfo.count(), polyPath.count() - 1);
+
+    for (int i = 0; i < rgPathHeightInfo.count(); i++) {
+        double latStep, lonStep;
+        QList<QGeoCoordinate> coordinates = TerrainQueryInterface::pathCoordinates(polyPath[i], polyPath[i + 1], latStep, lonStep);
+        const TerrainQueryInterface::PathHeightInfo_t& pathHeightInfo = rgPathHeightInfo[i];
+        QCOMPARE(pathHeightInfo.latStep, latStep);
+        QCOMPARE(pathHeightInfo.lonStep, lonStep);
+        QCOMPARE(pathHeightInfo.heights.count(), coordinates.count());
+        for (int j = 0; j < coordinates.count(); j++) {
+            double expected = (coordinates[j].latitude() - _swLat) * 10000 + (coordinates[j].longitude() - _swLon) * 5000;
+            QVERIFY(qAbs(pathHeightInfo.heights[j] - expected) < 1e-3);
+        }
+    }
+
+    // Missing tile
+    tiles.removeLast();
+    QVERIFY(!TerrainTileManager::polyPathFromTiles(tiles, polyPath, rgPathHeightInfo));
+    QCOMPARE(rgPathHeightInfo.count(), 0);
+}
+
+void TerrainTileTest::_testTileCache(void)
+{
+    TerrainTileManager manager;
+    manager._insertTile(_planeTileHash(0, 0), new TerrainTile(_planeTileBytes(0, 0)));
+
+    // Hit close to the east edge of the tile: the neighbour is remembered for prefetch, nothing is downloaded yet
+    QGeoCoordinate coord(_swLat + 0.005, _swLon + 0.0095);
+    bool error;
+    QList<double> altitudes;
+    QVERIFY(manager._getAltitudesForCoordinates({ coord }, altitudes, error));
+    QVERIFY(!error);
+    QCOMPARE(altitudes.count(), 1);
+    QVERIFY(qAbs(altitudes[0] - _planeHeight(coord.latitude(), coord.longitude())) < 1e-3);
+    QCOMPARE(manager.cacheHits(), 1ull);
+    QCOMPARE(manager.cacheMisses(), 0ull);
+    QVERIFY(manager._state == TerrainTileManager::State::Idle);
+    QCOMPARE(manager._prefetchCandidates.count(), 1);
+    QVERIFY(manager._prefetchHash.isEmpty());
+
+    // Miss, with a download already in progress so nothing goes to the network
+    manager._state = TerrainTileManager::State::Downloading;
+    altitudes.clear();
+    QVERIFY(!manager._getAltitudesForCoordinates({ QGeoCoordinate(_swLat + 0.005, _swLon + 0.015) }, altitudes, error));
+    QCOMPARE(manager.cacheHits(), 1ull);
+    QCOMPARE(manager.cacheMisses(), 1ull);
+
+    // A cache with room for a single tile evicts the least recently used one
+    manager._tiles.setMaxCost(1);
+    QCOMPARE(manager.cacheEvictions(), 0ull);
+    QSignalSpy tilesClearedSpy(&manager, &TerrainTileManager::tilesCleared);
+    manager._insertTile(_planeTileHash(0, 1), new TerrainTile(_planeTileBytes(0, 1)));
+    QCOMPARE(manager.cacheEvictions(), 1ull);
+    QCOMPARE(manager.cacheSizeKB(), 1);
+
+    // An evicted tile holds the same heights when fetched again, only clearing the cache signals a change
+    QCOMPARE(tilesClearedSpy.count(), 0);
+
+    altitudes.clear();
+    QVERIFY(manager._getAltitudesForCoordinates({ QGeoCoordinate(_swLat + 0.005, _swLon + 0.015) }, altitudes, error));
+    QCOMPARE(manager.cacheHits(), 2ull);
+    QVERIFY(!manager._getAltitudesForCoordinates({ coord }, altitudes, error));
+    QCOMPARE(manager.cacheMisses(), 2ull);
+
+    manager.clearCache();
+    QCOMPARE(tilesClearedSpy.count(), 1);
+    QCOMPARE(manager._tiles.count(), 0);
+}
+
+void TerrainTileTest::_testCarpetPinsTiles(void)
+{
+    TerrainTileManager manager;
+    // Room for a single tile, with a download in progress so misses do not go to the network
+    manager._tiles.setMaxCost(1);
+    manager._state = TerrainTileManager::State::Downloading;
+
+    // Area spanning two tiles
+    QGeoCoordinate swCoord(_swLat + 0.003, _swLon + 0.004);
+    QGeoCoordinate neCoord(_swLat + 0.007, _swLon + 0.016);
+    TerrainTileManager::QueuedRequestInfo_t requestInfo = { nullptr, TerrainTileManager::QueryModeCarpet, 0, 0, QList<QGeoCoordinate>(), swCoord, neCoord, true /* statsOnly */ };
+
+    bool error;
+    double minHeight, maxHeight;
+    QList<QList<double>> carpet;
+    manager._insertTile(_planeTileHash(0, 0), new TerrainTile(_planeTileBytes(0, 0)));
+    QVERIFY(!manager._getCarpet(requestInfo, minHeight, maxHeight, carpet, error));
+    QCOMPARE(requestInfo.pinnedTiles.count(), 1);
+
+    // Loading the second tile evicts the first one, the request still holds it
+    manager._insertTile(_planeTileHash(0, 1), new TerrainTile(_planeTileBytes(0, 1)));
+    QCOMPARE(manager.cacheEvictions(), 1ull);
+    QVERIFY(manager._getCarpet(requestInfo, minHeight, maxHeight, carpet, error));
+    QVERIFY(!error);
+    QVERIFY(qAbs(minHeight - ((swCoord.latitude() - _swLat) * 10000 + (swCoord.longitude() - _swLon) * 5000)) < 1e-3);
+    QVERIFY(qAbs(maxHeight - ((neCoord.latitude() - _swLat) * 10000 + (neCoord.longitude() - _swLon) * 5000)) < 1e-3);
+}
+
+void TerrainTileTest::_testHeightMemo(void)
+{
+    TerrainAtCoordinateBatchManager manager;
+    QList<QGeoCoordinate> coords = { QGeoCoordinate(_swLat + 0.001, _swLon + 0.001), QGeoCoordinate(_swLat + 0.002, _swLon + 0.002) };
+    QList<double> heights = { 10.0, 20.0 };
+
+    // Backend answer for a batch nobody is waiting on any more, heights are remembered
+    manager._sentCoordinates = coords;
+    manager._coordinateHeights(true, heights);
+    QCOMPARE(manager._memo.count(), 2);
+
+    // Same coordinates are answered from the memo, asynchronously
+    TerrainAtCoordinateQuery query;
+    QSignalSpy terrainDataSpy(&query, &TerrainAtCoordinateQuery::terrainDataReceived);
+    manager.addQuery(&query, coords);
+    QCOMPARE(manager.memoRequestsSaved(), 1ull);
+    QCOMPARE(manager.memoCoordinatesSaved(), 2ull);
+    QCOMPARE(manager._requestQueue.count(), 0);
+    QCOMPARE(terrainDataSpy.count(), 0);
+    QVERIFY(terrainDataSpy.wait(1000));
+    QCOMPARE(terrainDataSpy[0][0].toBool(), true);
+    QCOMPARE(terrainDataSpy[0][1].value<QList<double>>(), heights);
+
+    // Terrain data changing behind the backend forgets everything, the next query goes to the backend
+    emit manager._terrainQuery->terrainDataChanged();
+    QCOMPARE(manager._memo.count(), 0);
+    manager.addQuery(&query, coords);
+    manager._batchTimer.stop();
+    QCOMPARE(manager.memoRequestsSaved(), 1ull);
+    QCOMPARE(manager._requestQueue.count(), 1);
+    manager._requestQueue.clear();
+}
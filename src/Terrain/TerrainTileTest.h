@@ -0,0 +1,48 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QJsonArray>
+
+class TerrainTile;
+
+class TerrainTileTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TerrainTileTest(void);
+
+private slots:
+    void _testInterpolation(void);
+    void _testOutsideTile(void);
+    void _testBatchMatchesSingle(void);
+    void _benchmarkBatch(void);
+    void _testStats(void);
+    void _testCarpetFromTiles(void);
+    void _testPolyPathFromTiles(void);
+    void _testTileCache(void);
+    void _testCarpetPinsTiles(void);
+    void _testHeightMemo(void);
+
+private:
+    QByteArray _tileBytes       (int gridSizeLat, int gridSizeLon);
+    QByteArray _serialize       (const QJsonArray& carpet, double swLat, double swLon, double neLat, double neLon);
+    QByteArray _planeTileBytes  (int tileLat, int tileLon);
+    QString    _planeTileHash   (int tileLat, int tileLon);
+    double     _planeHeight     (double latitude, double longitude);
+
+    static const double _swLat;
+    static const double _swLon;
+    static const double _neLat;
+    static const double _neLon;
+};
@@ -7,6 +7,8 @@
 #include <QJsonArray>
 #include <QDataStream>
 
+#include <cmath>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "TerrainTileLog")
 
 const char*  TerrainTile::_jsonStatusKey        = "status";
@@ -24,7 +26,6 @@ TerrainTile::TerrainTile()
     : _minElevation(-1.0)
     , _maxElevation(-1.0)
     , _avgElevation(-1.0)
-    , _data(NULL)
     , _gridSizeLat(-1)
     , _gridSizeLon(-1)
     , _isValid(false)
@@ -34,13 +35,7 @@ TerrainTile::TerrainTile()
 
 TerrainTile::~TerrainTile()
 {
-    if (_data) {
-        for (int i = 0; i < _gridSizeLat; i++) {
-            delete _data[i];
-        }
-        delete _data;
-        _data = NULL;
-    }
+
 }
 
 
@@ -48,7 +43,6 @@ TerrainTile::TerrainTile(QByteArray byteArray)
     : _minElevation(-1.0)
     , _maxElevation(-1.0)
     , _avgElevation(-1.0)
-    , _data(NULL)
     , _gridSizeLat(-1)
     , _gridSizeLon(-1)
     , _isValid(false)
@@ -81,21 +75,25 @@ TerrainTile::TerrainTile(QByteArray byteArray)
         return;
     }
 
-    _data = new int16_t*[_gridSizeLat];
-    for (int k = 0; k < _gridSizeLat; k++) {
-        _data[k] = new int16_t[_gridSizeLon];
+    if (_gridSizeLat < 1 || _gridSizeLon < 1) {
+        qWarning() << "Terrain tile has an empty elevation grid";
+        return;
     }
 
-    int valueIndex = 0;
-    const int16_t* pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _gridSizeLat; i++) {
-        for (int j = 0; j < _gridSizeLon; j++) {
-            _data[i][j] = pTileData[valueIndex++];
-        }
+    // Grid spacing is derived from the bounds, so they must span an area (also rejects NaN)
+    if (!(_northEast.latitude() > _southWest.latitude()) || !(_northEast.longitude() > _southWest.longitude())) {
+        qWarning() << "Terrain tile has empty bounds";
+        return;
     }
 
+    // The elevation grid is used directly from the serialized bytes (implicitly shared, no copy)
+    _bytes = byteArray;
     _isValid = true;
 
+    const int16_t* data = _tileData();
+    const int gridSizeLon = _gridSizeLon;
+    _pyramid.build(_gridSizeLat, _gridSizeLon, [data, gridSizeLon](int row, int col) { return static_cast<double>(data[row * gridSizeLon + col]); });
+
     return;
 }
 
@@ -116,21 +114,76 @@ double TerrainTile::elevation(const QGeoCoordinate& coordinate) const
 {
     if (_isValid) {
         qCDebug(TerrainTileLog) << "elevation: " << coordinate << " , in sw " << _southWest << " , ne " << _northEast;
-        // Get the index at resolution of 1 arc second
-        int indexLat = _latToDataIndex(coordinate.latitude());
-        int indexLon = _lonToDataIndex(coordinate.longitude());
-        if (indexLat == -1 || indexLon == -1) {
-            qCWarning(TerrainTileLog) << "Internal error indexLat:indexLon == -1" << indexLat << indexLon;
-            return qQNaN();
-        }
-        qCDebug(TerrainTileLog) << "indexLat:indexLon" << indexLat << indexLon << "elevation" << _data[indexLat][indexLon];
-        return static_cast<double>(_data[indexLat][indexLon]);
+        double latitude = coordinate.latitude();
+        double longitude = coordinate.longitude();
+        double height;
+        elevations(&latitude, &longitude, &height, 1);
+        qCDebug(TerrainTileLog) << "elevation" << height;
+        return height;
     } else {
         qCWarning(TerrainTileLog) << "Asking for elevation, but no valid data.";
         return qQNaN();
     }
 }
 
+int TerrainTile::elevations(const double* latitudes, const double* longitudes, double* heights, int count) const
+{
+    if (!_isValid) {
+        qCWarning(TerrainTileLog) << "Asking for elevations, but no valid data.";
+        for (int i = 0; i < count; i++) {
+            heights[i] = qQNaN();
+        }
+        return 0;
+    }
+
+    const int16_t* data = _tileData();
+    const double swLat = _southWest.latitude();
+    const double swLon = _southWest.longitude();
+    const double neLat = _northEast.latitude();
+    const double neLon = _northEast.longitude();
+    const double latScale = (_gridSizeLat - 1) / (neLat - swLat);
+    const double lonScale = (_gridSizeLon - 1) / (neLon - swLon);
+
+    int cInside = 0;
+    for (int i = 0; i < count; i++) {
+        const double latitude = latitudes[i];
+        const double longitude = longitudes[i];
+        if (latitude < swLat || latitude > neLat || longitude < swLon || longitude > neLon) {
+            heights[i] = qQNaN();
+            continue;
+        }
+        heights[i] = _interpolate(data, (latitude - swLat) * latScale, (longitude - swLon) * lonScale);
+        cInside++;
+    }
+
+    return cInside;
+}
+
+bool TerrainTile::stats(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, TerrainMinMaxPyramid::Stats_t& stats) const
+{
+    if (!_isValid) {
+        qCWarning(TerrainTileLog) << "Asking for stats, but no valid data.";
+        return false;
+    }
+    if (neCoord.latitude() < swCoord.latitude() || neCoord.longitude() < swCoord.longitude()) {
+        qCWarning(TerrainTileLog) << "Asking for stats of an empty area" << swCoord << neCoord;
+        return false;
+    }
+
+    const double latScale = (_gridSizeLat - 1) / (_northEast.latitude() - _southWest.latitude());
+    const double lonScale = (_gridSizeLon - 1) / (_northEast.longitude() - _southWest.longitude());
+    // Small tolerance so samples exactly on the area boundary are included
+    const double epsilon = 1e-6;
+    int latIndex0 = static_cast<int>(ceil((swCoord.latitude() - _southWest.latitude()) * latScale - epsilon));
+    int latIndex1 = static_cast<int>(floor((neCoord.latitude() - _southWest.latitude()) * latScale + epsilon));
+    int lonIndex0 = static_cast<int>(ceil((swCoord.longitude() - _southWest.longitude()) * lonScale - epsilon));
+    int lonIndex1 = static_cast<int>(floor((neCoord.longitude() - _southWest.longitude()) * lonScale + epsilon));
+
+    const int16_t* data = _tileData();
+    const int gridSizeLon = _gridSizeLon;
+    return _pyramid.stats(latIndex0, lonIndex0, latIndex1, lonIndex1, [data, gridSizeLon](int row, int col) { return static_cast<double>(data[row * gridSizeLon + col]); }, stats);
+}
+
 QGeoCoordinate TerrainTile::centerCoordinate(void) const
 {
     return _southWest.atDistanceAndAzimuth(_southWest.distanceTo(_northEast) / 2.0, _southWest.azimuthTo(_northEast));
@@ -258,22 +311,29 @@ QByteArray TerrainTile::serialize(QByteArray input)
 }
 
 
-int TerrainTile::_latToDataIndex(double latitude) const
+const int16_t* TerrainTile::_tileData(void) const
 {
-    if (isValid() && _southWest.isValid() && _northEast.isValid()) {
-        return qRound((latitude - _southWest.latitude()) / (_northEast.latitude() - _southWest.latitude()) * (_gridSizeLat - 1));
-    } else {
-        qCWarning(TerrainTileLog) << "TerrainTile::_latToDataIndex internal error" << isValid() << _southWest.isValid() << _northEast.isValid();
-        return -1;
-    }
+    return reinterpret_cast<const int16_t*>(_bytes.constData() + sizeof(TileInfo_t));
 }
 
-int TerrainTile::_lonToDataIndex(double longitude) const
+/// Bilinear interpolation between the grid points surrounding the fractional indices
+double TerrainTile::_interpolate(const int16_t* data, double latIndex, double lonIndex) const
 {
-    if (isValid() && _southWest.isValid() && _northEast.isValid()) {
-        return qRound((longitude - _southWest.longitude()) / (_northEast.longitude() - _southWest.longitude()) * (_gridSizeLon - 1));
-    } else {
-        qCWarning(TerrainTileLog) << "TerrainTile::_lonToDataIndex internal error" << isValid() << _southWest.isValid() << _northEast.isValid();
-        return -1;
-    }
+    // Guard against rounding pushing an edge coordinate just outside the grid
+    latIndex = qBound(0.0, latIndex, static_cast<double>(_gridSizeLat - 1));
+    lonIndex = qBound(0.0, lonIndex, static_cast<double>(_gridSizeLon - 1));
+
+    const int latIndex0 = static_cast<int>(latIndex);
+    const int lonIndex0 = static_cast<int>(lonIndex);
+    const int latIndex1 = qMin(latIndex0 + 1, _gridSizeLat - 1);
+    const int lonIndex1 = qMin(lonIndex0 + 1, _gridSizeLon - 1);
+    const double latFraction = latIndex - latIndex0;
+    const double lonFraction = lonIndex - lonIndex0;
+
+    const int16_t* row0 = data + latIndex0 * _gridSizeLon;
+    const int16_t* row1 = data + latIndex1 * _gridSizeLon;
+    const double south = row0[lonIndex0] + (row0[lonIndex1] - row0[lonIndex0]) * lonFraction;
+    const double north = row1[lonIndex0] + (row1[lonIndex1] - row1[lonIndex0]) * lonFraction;
+
+    return south + (north - south) * latFraction;
 }
@@ -2,8 +2,10 @@
 #define TERRAINTILE_H
 
 #include "QGCLoggingCategory.h"
+#include "TerrainMinMaxPyramid.h"
 
 #include <QGeoCoordinate>
+#include <QByteArray>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileLog)
 
@@ -49,13 +51,37 @@ public:
     bool isValid(void) const { return _isValid; }
 
     /**
-    * Evaluates the elevation at the given coordinate
+    * Evaluates the elevation at the given coordinate. The value is bilinearly
+    * interpolated between the four surrounding grid points.
     *
     * @param coordinate
     * @return elevation
     */
     double elevation(const QGeoCoordinate& coordinate) const;
 
+    /**
+    * Evaluates the elevations for arrays of coordinates in one pass.
+    * Coordinates outside of the tile return NaN.
+    *
+    * @param latitudes array of count latitudes
+    * @param longitudes array of count longitudes
+    * @param[out] heights array of count elevations
+    * @param count number of coordinates
+    * @return number of coordinates which were inside the tile
+    */
+    int elevations(const double* latitudes, const double* longitudes, double* heights, int count) const;
+
+    /**
+    * Elevation statistics over the grid samples inside the specified area. Uses the
+    * tile's min/max pyramid so only samples along the edge of the area are read.
+    *
+    * @param swCoord south west corner of the area
+    * @param neCoord north east corner of the area
+    * @param[out] stats
+    * @return false: no samples of this tile are inside the area
+    */
+    bool stats(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, TerrainMinMaxPyramid::Stats_t& stats) const;
+
     /**
     * Accessor for the minimum elevation of the tile
     *
@@ -77,6 +103,13 @@ public:
     */
     double avgElevation(void) const { return _avgElevation; }
 
+    /**
+    * Memory held by the tile, including its min/max pyramid
+    *
+    * @return size in bytes
+    */
+    int byteSize(void) const { return _bytes.size() + _pyramid.byteSize(); }
+
     /**
     * Accessor for the center coordinate
     *
@@ -104,8 +137,8 @@ private:
         int16_t gridSizeLon;
     } TileInfo_t;
 
-    inline int _latToDataIndex(double latitude) const;
-    inline int _lonToDataIndex(double longitude) const;
+    inline const int16_t* _tileData(void) const;
+    inline double _interpolate(const int16_t* data, double latIndex, double lonIndex) const;
 
     QGeoCoordinate      _southWest;                                     /// South west corner of the tile
     QGeoCoordinate      _northEast;                                     /// North east corner of the tile
@@ -114,7 +147,8 @@ private:
     int16_t             _maxElevation;                                  /// Maximum elevation in tile
     double              _avgElevation;                                  /// Average elevation of the tile
 
-    int16_t**           _data;                                          /// 2D elevation data array
+    QByteArray          _bytes;                                         /// Serialized tile, elevation data is read in place
+    TerrainMinMaxPyramid _pyramid;                                      /// Min/max/avg per block of samples
     int16_t             _gridSizeLat;                                   /// data grid size in latitude direction
     int16_t             _gridSizeLon;                                   /// data grid size in longitude direction
     bool                _isValid;                                       /// data loaded is valid
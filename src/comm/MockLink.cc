@@ -12,13 +12,10 @@
 #include "QGCLoggingCategory.h"
 #include "QGCApplication.h"
 
-#ifdef UNITTEST_BUILD
-#include "UnitTest.h"
-#endif
-
 #include <QTimer>
 #include <QDebug>
 #include <QFile>
+#include <QTemporaryFile>
 
 #include <string.h>
 
@@ -78,8 +75,13 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     , _sendGPSPositionDelayCount            (100)   // No gps lock for 5 seconds
     , _currentParamRequestListComponentIndex(-1)
     , _currentParamRequestListParamIndex    (-1)
+    , _logDownloadFileSize                  (1000)
     , _logDownloadCurrentOffset             (0)
     , _logDownloadBytesRemaining            (0)
+    , _logDownloadBytesServed               (0)
+    , _logDownloadLossPercent               (0)
+    , _logDownloadPacketsPerTick            (1)
+    , _logDownloadLossSeed                  (1) // Fixed seed so lossy runs are repeatable
     , _adsbAngle                            (0)
 {
     MockConfiguration* mockConfig = qobject_cast<MockConfiguration*>(_config.data());
@@ -1281,9 +1283,17 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
     mavlink_msg_log_request_data_decode(&msg, &request);
 
     if (_logDownloadFilename.isEmpty()) {
-#ifdef UNITTEST_BUILD
-        _logDownloadFilename = UnitTest::createRandomFile(_logDownloadFileSize);
-#endif
+        // Written out so tests can compare the downloaded log against it
+        QTemporaryFile tempFile;
+        tempFile.setAutoRemove(false);
+        if (tempFile.open()) {
+            QByteArray contents(_logDownloadFileSize, Qt::Uninitialized);
+            _logDownloadContents(0, reinterpret_cast<uint8_t*>(contents.data()), _logDownloadFileSize);
+            tempFile.write(contents);
+            _logDownloadFilename = tempFile.fileName();
+        } else {
+            qWarning() << "MockLink::_handleLogRequestData open failed" << tempFile.errorString();
+        }
     }
 
     if (request.id != 0) {
@@ -1306,17 +1316,15 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
 
 void MockLink::_logDownloadWorker(void)
 {
-    if (_logDownloadBytesRemaining != 0) {
-        QFile file(_logDownloadFilename);
-        if (file.open(QIODevice::ReadOnly)) {
-            uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
+    for (int i=0; i<_logDownloadPacketsPerTick && _logDownloadBytesRemaining != 0; i++) {
+        uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
 
-            qint64 bytesToRead = qMin(_logDownloadBytesRemaining, (uint32_t)MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            Q_ASSERT(file.seek(_logDownloadCurrentOffset));
-            Q_ASSERT(file.read((char *)buffer, bytesToRead) == bytesToRead);
-
-            qDebug() << "MockLink::_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
+        uint32_t bytesToRead = qMin(_logDownloadBytesRemaining, (uint32_t)MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+        _logDownloadContents(_logDownloadCurrentOffset, buffer, bytesToRead);
 
+        if (_logDownloadDropPacket()) {
+            qCDebug(MockLinkLog) << "_logDownloadWorker dropping packet" << _logDownloadCurrentOffset;
+        } else {
             mavlink_message_t responseMsg;
             mavlink_msg_log_data_pack_chan(_vehicleSystemId,
                                            _vehicleComponentId,
@@ -1327,15 +1335,31 @@ void MockLink::_logDownloadWorker(void)
                                            bytesToRead,
                                            &buffer[0]);
             respondWithMavlinkMessage(responseMsg);
+        }
+
+        _logDownloadCurrentOffset += bytesToRead;
+        _logDownloadBytesRemaining -= bytesToRead;
+        _logDownloadBytesServed += bytesToRead;
+    }
+}
 
-            _logDownloadCurrentOffset += bytesToRead;
-            _logDownloadBytesRemaining -= bytesToRead;
+/// The log contents are a function of the offset only
+void MockLink::_logDownloadContents(uint32_t offset, uint8_t* buffer, uint32_t count)
+{
+    for (uint32_t i=0; i<count; i++) {
+        uint32_t position = offset + i;
+        buffer[i] = static_cast<uint8_t>((position * 2654435761u) >> 24);
+    }
+}
 
-            file.close();
-        } else {
-            qWarning() << "MockLink::_logDownloadWorker open failed" << file.errorString();
-        }
+bool MockLink::_logDownloadDropPacket(void)
+{
+    if (_logDownloadLossPercent <= 0) {
+        return false;
     }
+
+    _logDownloadLossSeed = _logDownloadLossSeed * 1103515245 + 12345;
+    return static_cast<int>((_logDownloadLossSeed >> 16) % 100) < _logDownloadLossPercent;
 }
 
 void MockLink::_sendADSBVehicles(void)
@@ -148,9 +148,33 @@ public:
     /// Reset the state of the MissionItemHandler to no items, no transactions in progress.
     void resetMissionItemHandler(void) { _missionItemHandler.reset(); }
 
+    /// Sets the number of mission items the vehicle accepts ahead of its request during a write
+    void setMissionTransferWindow(int transferWindow) { _missionItemHandler.setTransferWindow(transferWindow); }
+
+    /// Simulates link latency and loss for the mission protocol
+    void setMissionLinkConditions(int latencyMsecs, int lossPercent) { _missionItemHandler.setLinkConditions(latencyMsecs, lossPercent); }
+
+    /// @return Number of MISSION_REQUESTs sent during the last mission write
+    int missionWriteRequestCount(void) const { return _missionItemHandler.writeRequestCount(); }
+
+    /// @return Largest number of MISSION_REQUESTs outstanding during the last mission read
+    int missionMaxReadRequestsInFlight(void) const { return _missionItemHandler.maxReadRequestsInFlight(); }
+
     /// Returns the filename for the simulated log file. Only available after a download is requested.
     QString logDownloadFile(void) { return _logDownloadFilename; }
 
+    /// Sets the size of the simulated log file. The contents only depend on the offset, so a download can be resumed
+    /// against a new MockLink with the same size.
+    void setLogDownloadFileSize(uint32_t fileSize) { _logDownloadFileSize = fileSize; }
+
+    /// Simulates link rate and loss for log download
+    ///     @param lossPercent Percentage of LOG_DATA packets dropped
+    ///     @param packetsPerTick LOG_DATA packets sent every 2 msecs
+    void setLogDownloadLinkConditions(int lossPercent, int packetsPerTick) { _logDownloadLossPercent = lossPercent; _logDownloadPacketsPerTick = packetsPerTick; }
+
+    /// Returns the number of log bytes sent so far, including dropped packets
+    uint32_t logDownloadBytesServed(void) const { return _logDownloadBytesServed; }
+
     static MockLink* startPX4MockLink            (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startGenericMockLink        (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduCopterMockLink  (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
@@ -201,6 +225,8 @@ private:
     void _sendRCChannels(void);
     void _paramRequestListWorker(void);
     void _logDownloadWorker(void);
+    void _logDownloadContents(uint32_t offset, uint8_t* buffer, uint32_t count);
+    bool _logDownloadDropPacket(void);
     void _sendADSBVehicles(void);
     void _moveADSBVehicle(void);
 
@@ -245,11 +271,15 @@ private:
     int _currentParamRequestListParamIndex;     // Current parameter index for param request list workflow
 
     static const uint16_t _logDownloadLogId = 0;        ///< Id of siumulated log file
-    static const uint32_t _logDownloadFileSize = 1000;  ///< Size of simulated log file
 
     QString _logDownloadFilename;           ///< Filename for log download which is in progress
+    uint32_t    _logDownloadFileSize;       ///< Size of simulated log file
     uint32_t    _logDownloadCurrentOffset;  ///< Current offset we are sending from
     uint32_t    _logDownloadBytesRemaining; ///< Number of bytes still to send, 0 = send inactive
+    uint32_t    _logDownloadBytesServed;    ///< Number of bytes sent, including dropped packets
+    int         _logDownloadLossPercent;
+    int         _logDownloadPacketsPerTick;
+    quint32     _logDownloadLossSeed;
 
     QGeoCoordinate  _adsbVehicleCoordinate;
     double          _adsbAngle;
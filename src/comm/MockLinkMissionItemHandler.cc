@@ -24,6 +24,13 @@ MockLinkMissionItemHandler::MockLinkMissionItemHandler(MockLink* mockLink, MAVLi
     , _failReadRequestListFirstResponse(true)
     , _failReadRequest1FirstResponse(true)
     , _failWriteMissionCountFirstResponse(true)
+    , _transferWindow(1)
+    , _latencyMsecs(0)
+    , _lossPercent(0)
+    , _lossSeed(1)
+    , _writeRequestCount(0)
+    , _readItemsDelivered(0)
+    , _maxReadRequestsInFlight(0)
 {
     Q_ASSERT(mockLink);
 }
@@ -39,11 +46,83 @@ void MockLinkMissionItemHandler::_startMissionItemResponseTimer(void)
         _missionItemResponseTimer = new QTimer();
         connect(_missionItemResponseTimer, &QTimer::timeout, this, &MockLinkMissionItemHandler::_missionItemResponseTimeout);
     }
-    _missionItemResponseTimer->start(500);
+    _missionItemResponseTimer->start(500 + _latencyMsecs);
+}
+
+void MockLinkMissionItemHandler::_respondWithMavlinkMessage(const mavlink_message_t& msg)
+{
+    if (_dropMessage()) {
+        qCDebug(MockLinkMissionItemHandlerLog) << "_respondWithMavlinkMessage dropping outgoing message" << msg.msgid;
+        return;
+    }
+
+    if (_latencyMsecs > 0) {
+        QTimer::singleShot(_latencyMsecs, _mockLink, [this, msg]() { _deliverMavlinkMessage(msg); });
+    } else {
+        _deliverMavlinkMessage(msg);
+    }
+}
+
+void MockLinkMissionItemHandler::_deliverMavlinkMessage(const mavlink_message_t& msg)
+{
+    if (msg.msgid == MAVLINK_MSG_ID_MISSION_ITEM) {
+        _readItemsDelivered++;
+    }
+    _mockLink->respondWithMavlinkMessage(msg);
+}
+
+bool MockLinkMissionItemHandler::_dropMessage(void)
+{
+    if (_lossPercent <= 0) {
+        return false;
+    }
+
+    _lossSeed = _lossSeed * 1103515245 + 12345;
+    return static_cast<int>((_lossSeed >> 16) % 100) < _lossPercent;
+}
+
+MockLinkMissionItemHandler::MissionItemList_t& MockLinkMissionItemHandler::_itemListForType(MAV_MISSION_TYPE type)
+{
+    switch (type) {
+    case MAV_MISSION_TYPE_FENCE:
+        return _fenceItems;
+    case MAV_MISSION_TYPE_RALLY:
+        return _rallyItems;
+    default:
+        return _missionItems;
+    }
+}
+
+/// @return First sequence number of the current write which has not been received, -1 if all have been received
+int MockLinkMissionItemHandler::_firstMissingWriteSequence(void)
+{
+    const MissionItemList_t& items = _itemListForType(_requestType);
+
+    // Everything before the last requested item has been received already
+    for (int i=qMax(0, _writeSequenceIndex); i<_writeSequenceCount; i++) {
+        if (!items.contains(i)) {
+            return i;
+        }
+    }
+    return -1;
 }
 
 bool MockLinkMissionItemHandler::handleMessage(const mavlink_message_t& msg)
 {
+    switch (msg.msgid) {
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+        if (_dropMessage()) {
+            qCDebug(MockLinkMissionItemHandlerLog) << "handleMessage dropping incoming message" << msg.msgid;
+            return true;
+        }
+        break;
+    default:
+        break;
+    }
+
     switch (msg.msgid) {
     case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
         _handleMissionRequestList(msg);
@@ -119,6 +198,8 @@ void MockLinkMissionItemHandler::_handleMissionRequestList(const mavlink_message
     qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionRequestList read sequence";
     
     _failReadRequest1FirstResponse = true;
+    _readItemsDelivered = 0;
+    _maxReadRequestsInFlight = 0;
 
     if (_failureMode == FailReadRequestListNoResponse) {
         qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionRequestList not responding due to failure mode FailReadRequestListNoResponse";
@@ -163,7 +244,7 @@ void MockLinkMissionItemHandler::_handleMissionRequestList(const mavlink_message
                                             msg.compid,                 // Target is original sender
                                             itemCount,                  // Number of mission items
                                             _requestType);
-        _mockLink->respondWithMavlinkMessage(responseMsg);
+        _respondWithMavlinkMessage(responseMsg);
     }
 }
 
@@ -177,6 +258,9 @@ void MockLinkMissionItemHandler::_handleMissionRequest(const mavlink_message_t&
     
     Q_ASSERT(request.target_system == _mockLink->vehicleId());
 
+    // QGC can only have seen the items delivered so far, so everything from there up to this request is in flight
+    _maxReadRequestsInFlight = qMax(_maxReadRequestsInFlight, request.seq + 1 - _readItemsDelivered);
+
     if (_failureMode == FailReadRequest0NoResponse && request.seq == 0) {
         qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionRequest not responding due to failure mode FailReadRequest0NoResponse";
     } else if (_failureMode == FailReadRequest1NoResponse && request.seq == 1) {
@@ -237,7 +321,7 @@ void MockLinkMissionItemHandler::_handleMissionRequest(const mavlink_message_t&
                                                item.param1, item.param2, item.param3, item.param4,
                                                item.x, item.y, item.z,
                                                _requestType);
-            _mockLink->respondWithMavlinkMessage(responseMsg);
+            _respondWithMavlinkMessage(responseMsg);
         }
     }
 }
@@ -251,6 +335,7 @@ void MockLinkMissionItemHandler::_handleMissionCount(const mavlink_message_t& ms
     
     _requestType = (MAV_MISSION_TYPE)missionCount.mission_type;
     _writeSequenceCount = missionCount.count;
+    _writeRequestCount = 0;
     Q_ASSERT(_writeSequenceCount >= 0);
     
     qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionCount write sequence _writeSequenceCount:" << _writeSequenceCount;
@@ -317,7 +402,8 @@ void MockLinkMissionItemHandler::_requestNextMissionItem(int sequenceNumber)
                                                   _mavlinkProtocol->getComponentId(),
                                                   sequenceNumber,
                                                   _requestType);
-            _mockLink->respondWithMavlinkMessage(message);
+            _respondWithMavlinkMessage(message);
+            _writeRequestCount++;
 
             // If response with Mission Item doesn't come before timer fires it's an error
             _startMissionItemResponseTimer();
@@ -339,7 +425,7 @@ void MockLinkMissionItemHandler::_sendAck(MAV_MISSION_RESULT ackType)
                                       _mavlinkProtocol->getComponentId(),
                                       ackType,
                                       _requestType);
-    _mockLink->respondWithMavlinkMessage(message);
+    _respondWithMavlinkMessage(message);
 }
 
 void MockLinkMissionItemHandler::_handleMissionItem(const mavlink_message_t& msg)
@@ -366,28 +452,57 @@ void MockLinkMissionItemHandler::_handleMissionItem(const mavlink_message_t& msg
         break;
     }
 
-    _writeSequenceIndex++;
-    if (_writeSequenceIndex < _writeSequenceCount) {
-        if (_failureMode == FailWriteFinalAckMissingRequests && _writeSequenceIndex == 3) {
-            // Send MAV_MISSION_ACCPETED ack too early
-            _sendAck(MAV_MISSION_ACCEPTED);
-        } else {
-            _requestNextMissionItem(_writeSequenceIndex);
+    if (_windowedWrite()) {
+        // Items can arrive ahead of their request, so only request the next missing item once the whole window is in.
+        // _writeSequenceIndex is the last requested item in this mode.
+        int firstMissing = _firstMissingWriteSequence();
+        if (firstMissing != -1) {
+            if (firstMissing >= _writeSequenceIndex + _transferWindow) {
+                _writeSequenceIndex = firstMissing;
+                _requestNextMissionItem(_writeSequenceIndex);
+            } else {
+                _startMissionItemResponseTimer();
+            }
+            return;
         }
     } else {
-        if (_failureMode != FailWriteFinalAckNoResponse) {
-            MAV_MISSION_RESULT ack = MAV_MISSION_ACCEPTED;
-            
-            if (_failureMode ==  FailWriteFinalAckErrorAck) {
-                ack = MAV_MISSION_ERROR;
+        _writeSequenceIndex++;
+        if (_writeSequenceIndex < _writeSequenceCount) {
+            if (_failureMode == FailWriteFinalAckMissingRequests && _writeSequenceIndex == 3) {
+                // Send MAV_MISSION_ACCPETED ack too early
+                _sendAck(MAV_MISSION_ACCEPTED);
+            } else {
+                _requestNextMissionItem(_writeSequenceIndex);
             }
-            _sendAck(ack);
+            return;
+        }
+    }
+
+    if (_failureMode != FailWriteFinalAckNoResponse) {
+        MAV_MISSION_RESULT ack = MAV_MISSION_ACCEPTED;
+
+        if (_failureMode ==  FailWriteFinalAckErrorAck) {
+            ack = MAV_MISSION_ERROR;
         }
+        _sendAck(ack);
     }
 }
 
 void MockLinkMissionItemHandler::_missionItemResponseTimeout(void)
 {
+    if (_windowedWrite()) {
+        // An item or our request was lost, ask again for the first item which is still missing
+        int firstMissing = _firstMissingWriteSequence();
+        if (firstMissing == -1) {
+            _missionItemResponseTimer->stop();
+        } else {
+            qCDebug(MockLinkMissionItemHandlerLog) << "_missionItemResponseTimeout re-requesting sequenceNumber:" << firstMissing;
+            _writeSequenceIndex = firstMissing;
+            _requestNextMissionItem(_writeSequenceIndex);
+        }
+        return;
+    }
+
     qWarning() << "Timeout waiting for next MISSION_ITEM";
     Q_ASSERT(false);
 }
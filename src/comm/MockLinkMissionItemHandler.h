@@ -79,10 +79,28 @@ public:
 
     void setSendHomePositionOnEmptyList(bool sendHomePositionOnEmptyList) { _sendHomePositionOnEmptyList = sendHomePositionOnEmptyList; }
 
+    /// Sets the number of items the vehicle accepts ahead of its request during a write. With a window larger than 1
+    /// the vehicle waits for the whole window before requesting the next missing item.
+    void setTransferWindow(int transferWindow) { _transferWindow = transferWindow; }
+
+    /// Simulates a slow and lossy link for mission protocol messages
+    ///     @param latencyMsecs Round trip delay added to each message sent to QGC
+    ///     @param lossPercent Percentage of mission protocol messages dropped in each direction
+    void setLinkConditions(int latencyMsecs, int lossPercent) { _latencyMsecs = latencyMsecs; _lossPercent = lossPercent; }
+
+    /// @return Number of MISSION_REQUESTs sent to QGC during the last write, one per round trip
+    int writeRequestCount(void) const { return _writeRequestCount; }
+
+    /// @return Largest number of MISSION_REQUESTs QGC had outstanding during the last read. A request for item n
+    ///         is outstanding from the time it is sent until item n is delivered to QGC.
+    int maxReadRequestsInFlight(void) const { return _maxReadRequestsInFlight; }
+
 private slots:
     void _missionItemResponseTimeout(void);
 
 private:
+    typedef QMap<uint16_t, mavlink_mission_item_t>   MissionItemList_t;
+
     void _handleMissionRequestList(const mavlink_message_t& msg);
     void _handleMissionRequest(const mavlink_message_t& msg);
     void _handleMissionItem(const mavlink_message_t& msg);
@@ -91,6 +109,12 @@ private:
     void _requestNextMissionItem(int sequenceNumber);
     void _sendAck(MAV_MISSION_RESULT ackType);
     void _startMissionItemResponseTimer(void);
+    void _respondWithMavlinkMessage(const mavlink_message_t& msg);
+    void _deliverMavlinkMessage(const mavlink_message_t& msg);
+    bool _dropMessage(void);
+    bool _windowedWrite(void) const { return _transferWindow > 1 || _lossPercent > 0; }
+    int  _firstMissingWriteSequence(void);
+    MissionItemList_t& _itemListForType(MAV_MISSION_TYPE type);
 
 private:
     MockLink* _mockLink;
@@ -98,8 +122,6 @@ private:
     int _writeSequenceCount;    ///< Numbers of items about to be written
     int _writeSequenceIndex;    ///< Current index being reqested
     
-    typedef QMap<uint16_t, mavlink_mission_item_t>   MissionItemList_t;
-
     MAV_MISSION_TYPE    _requestType;
     MissionItemList_t   _missionItems;
     MissionItemList_t   _fenceItems;
@@ -112,5 +134,12 @@ private:
     bool                _failReadRequestListFirstResponse;
     bool                _failReadRequest1FirstResponse;
     bool                _failWriteMissionCountFirstResponse;
+    int                 _transferWindow;
+    int                 _latencyMsecs;
+    int                 _lossPercent;
+    quint32             _lossSeed;          ///< Fixed seed so lossy runs are repeatable
+    int                 _writeRequestCount;
+    int                 _readItemsDelivered;
+    int                 _maxReadRequestsInFlight;
 };
 
@@ -0,0 +1,216 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QmlObjectListModelTest.h"
+
+#include <QSignalSpy>
+
+QmlObjectListModelTest::QmlObjectListModelTest(void)
+    : _model(nullptr)
+{
+
+}
+
+void QmlObjectListModelTest::init(void)
+{
+    UnitTest::init();
+    _model = new QmlObjectListModel(this);
+}
+
+void QmlObjectListModelTest::cleanup(void)
+{
+    _model->deleteListAndContents();
+    _model = nullptr;
+    UnitTest::cleanup();
+}
+
+QObjectList QmlObjectListModelTest::_createItems(int count)
+{
+    QObjectList items;
+    for (int i=0; i<count; i++) {
+        QObject* item = new QmlObjectListModelTestItem(_model);
+        item->setObjectName(QString::number(i));
+        items.append(item);
+    }
+    return items;
+}
+
+void QmlObjectListModelTest::_testAppendList(void)
+{
+    _model->append(_createItems(2));
+    _model->setDirty(false);
+
+    QSignalSpy insertedSpy(_model, &QmlObjectListModel::rowsInserted);
+    QSignalSpy countSpy(_model, &QmlObjectListModel::countChanged);
+    QSignalSpy dirtySpy(_model, &QmlObjectListModel::dirtyChanged);
+
+    QObjectList items = _createItems(100);
+    _model->append(items);
+
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy[0][1].toInt(), 2);
+    QCOMPARE(insertedSpy[0][2].toInt(), 101);
+    QCOMPARE(countSpy.count(), 1);
+    QCOMPARE(dirtySpy.count(), 1);
+    QCOMPARE(_model->count(), 102);
+    QCOMPARE(_model->get(2), items.first());
+    QCOMPARE(_model->get(101), items.last());
+
+    // Child dirty changes must reach the list
+    _model->setDirty(false);
+    qobject_cast<QmlObjectListModelTestItem*>(items[50])->setDirty(true);
+    QVERIFY(_model->dirty());
+
+    // Empty list is a no-op
+    insertedSpy.clear();
+    _model->append(QObjectList());
+    QCOMPARE(insertedSpy.count(), 0);
+}
+
+void QmlObjectListModelTest::_testInsertList(void)
+{
+    _model->append(_createItems(4));
+
+    QSignalSpy insertedSpy(_model, &QmlObjectListModel::rowsInserted);
+    QObjectList items = _createItems(3);
+    _model->insert(2, items);
+
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(_model->count(), 7);
+    QStringList names;
+    for (int i=0; i<_model->count(); i++) {
+        names.append(_model->get(i)->objectName());
+    }
+    QCOMPARE(names, QStringList({ "0", "1", "0", "1", "2", "2", "3" }));
+    QCOMPARE(_model->get(2), items[0]);
+    QCOMPARE(_model->get(4), items[2]);
+}
+
+void QmlObjectListModelTest::_testRemoveRange(void)
+{
+    QObjectList items = _createItems(10);
+    _model->append(items);
+    _model->setDirty(false);
+
+    QSignalSpy removedSpy(_model, &QmlObjectListModel::rowsRemoved);
+    QSignalSpy countSpy(_model, &QmlObjectListModel::countChanged);
+
+    QObjectList removed = _model->removeRange(3, 4);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy[0][1].toInt(), 3);
+    QCOMPARE(removedSpy[0][2].toInt(), 6);
+    QCOMPARE(countSpy.count(), 1);
+    QCOMPARE(removed, items.mid(3, 4));
+    QCOMPARE(_model->count(), 6);
+    QCOMPARE(_model->get(3), items[7]);
+    QVERIFY(_model->dirty());
+
+    // Removed items no longer affect the list dirty state
+    _model->setDirty(false);
+    qobject_cast<QmlObjectListModelTestItem*>(removed[0])->setDirty(true);
+    QVERIFY(!_model->dirty());
+
+    // Invalid ranges do nothing
+    removedSpy.clear();
+    QVERIFY(_model->removeRange(4, 10).isEmpty());
+    QVERIFY(_model->removeRange(0, 0).isEmpty());
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(_model->count(), 6);
+}
+
+void QmlObjectListModelTest::_testClear(void)
+{
+    _model->append(_createItems(50));
+
+    QSignalSpy removedSpy(_model, &QmlObjectListModel::rowsRemoved);
+    QSignalSpy countSpy(_model, &QmlObjectListModel::countChanged);
+
+    _model->clear();
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(countSpy.count(), 1);
+    QCOMPARE(_model->count(), 0);
+
+    // Clearing an empty list does not signal
+    _model->clear();
+    QCOMPARE(removedSpy.count(), 1);
+}
+
+void QmlObjectListModelTest::_testResetObjectList(void)
+{
+    QObjectList oldItems = _createItems(5);
+    _model->append(oldItems);
+    _model->setDirty(false);
+
+    QSignalSpy resetSpy(_model, &QmlObjectListModel::modelReset);
+    QSignalSpy insertedSpy(_model, &QmlObjectListModel::rowsInserted);
+    QSignalSpy removedSpy(_model, &QmlObjectListModel::rowsRemoved);
+    QSignalSpy countSpy(_model, &QmlObjectListModel::countChanged);
+
+    QObjectList newItems = _createItems(20);
+    QCOMPARE(_model->resetObjectList(newItems), oldItems);
+
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(countSpy.count(), 1);
+    QCOMPARE(*_model->objectList(), newItems);
+    QVERIFY(_model->dirty());
+
+    // Dirty tracking moves from the old items to the new ones
+    _model->setDirty(false);
+    qobject_cast<QmlObjectListModelTestItem*>(oldItems[0])->setDirty(true);
+    QVERIFY(!_model->dirty());
+    qobject_cast<QmlObjectListModelTestItem*>(newItems[0])->setDirty(true);
+    QVERIFY(_model->dirty());
+
+    // clearAndDeleteContents uses a single reset as well
+    resetSpy.clear();
+    removedSpy.clear();
+    _model->clearAndDeleteContents();
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(_model->count(), 0);
+}
+
+void QmlObjectListModelTest::_benchmarkAppend_data(void)
+{
+    QTest::addColumn<int>("itemCount");
+    QTest::addColumn<bool>("bulk");
+
+    QTest::newRow("800 items, one at a time")   << 800 << false;
+    QTest::newRow("800 items, bulk")            << 800 << true;
+    QTest::newRow("5000 items, one at a time")  << 5000 << false;
+    QTest::newRow("5000 items, bulk")           << 5000 << true;
+}
+
+/// Compares building up a list the way mission load used to, one append per item, against a single bulk append.
+/// A view would re-layout for each row notification, so the notification count is reported as well.
+void QmlObjectListModelTest::_benchmarkAppend(void)
+{
+    QFETCH(int, itemCount);
+    QFETCH(bool, bulk);
+
+    QObjectList items = _createItems(itemCount);
+    int notificationCount = 0;
+    connect(_model, &QmlObjectListModel::rowsInserted, this, [&notificationCount]() { notificationCount++; });
+
+    QBENCHMARK {
+        notificationCount = 0;
+        _model->clear();
+        if (bulk) {
+            _model->append(items);
+        } else {
+            for (QObject* item: items) {
+                _model->append(item);
+            }
+        }
+    }
+    QCOMPARE(_model->count(), itemCount);
+    QCOMPARE(notificationCount, bulk ? 1 : itemCount);
+}
@@ -0,0 +1,60 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QmlObjectListModel.h"
+
+/// List item with a dirty property, as used by the dirty tracking in QmlObjectListModel
+class QmlObjectListModelTestItem : public QObject
+{
+    Q_OBJECT
+
+public:
+    QmlObjectListModelTestItem(QObject* parent = nullptr) : QObject(parent), _dirty(false) { }
+
+    Q_PROPERTY(bool dirty READ dirty WRITE setDirty NOTIFY dirtyChanged)
+
+    bool dirty      (void) const { return _dirty; }
+    void setDirty   (bool dirty) { _dirty = dirty; emit dirtyChanged(dirty); }
+
+signals:
+    void dirtyChanged(bool dirty);
+
+private:
+    bool _dirty;
+};
+
+/// Unit test for the bulk operations of QmlObjectListModel
+class QmlObjectListModelTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QmlObjectListModelTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _testAppendList(void);
+    void _testInsertList(void);
+    void _testRemoveRange(void);
+    void _testClear(void);
+    void _testResetObjectList(void);
+    void _benchmarkAppend_data(void);
+    void _benchmarkAppend(void);
+
+private:
+    QObjectList _createItems(int count);
+
+    QmlObjectListModel* _model;
+};
@@ -0,0 +1,378 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ShapeFileHelperTest.h"
+#include "ShapeFileHelper.h"
+#include "ShapeFileLoader.h"
+#include "KMLFileHelper.h"
+#include "QGCMapPolygon.h"
+
+#include "shapefil.h"
+
+#include <QSignalSpy>
+#include <QTextStream>
+
+#include <algorithm>
+
+ShapeFileHelperTest::ShapeFileHelperTest(void)
+    : _tempDir  (nullptr)
+    , _center   (47.633550, -122.089821)
+{
+
+}
+
+void ShapeFileHelperTest::init(void)
+{
+    UnitTest::init();
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+    qRegisterMetaType<QList<QGeoCoordinate>>("QList<QGeoCoordinate>");
+}
+
+void ShapeFileHelperTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = nullptr;
+    UnitTest::cleanup();
+}
+
+/// Clockwise circle of vertices about _center
+QList<QGeoCoordinate> ShapeFileHelperTest::_circle(int vertexCount, double radiusMeters) const
+{
+    QList<QGeoCoordinate> coords;
+    for (int i=0; i<vertexCount; i++) {
+        coords.append(_center.atDistanceAndAzimuth(radiusMeters, (360.0 * i) / vertexCount));
+    }
+    return coords;
+}
+
+QString ShapeFileHelperTest::_writeKML(const QString& name, const QList<QGeoCoordinate>& coords, bool polygon)
+{
+    QString filename = _tempDir->filePath(name);
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return QString();
+    }
+
+    QTextStream stream(&file);
+    stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+              "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+              "<Document>\n"
+              "<Placemark>\n";
+    if (polygon) {
+        stream << "<Polygon><outerBoundaryIs><LinearRing><coordinates>\n";
+    } else {
+        stream << "<LineString><coordinates>\n";
+    }
+
+    // Rings are closed by repeating the first vertex. Several tuples per line, like most exporters write them.
+    QList<QGeoCoordinate> fileCoords = coords;
+    if (polygon) {
+        fileCoords.append(coords.first());
+    }
+    for (int i=0; i<fileCoords.count(); i++) {
+        stream << QString::number(fileCoords[i].longitude(), 'f', 12) << "," << QString::number(fileCoords[i].latitude(), 'f', 12) << ",0";
+        stream << ((i % 8) == 7 ? "\n" : " ");
+    }
+
+    if (polygon) {
+        stream << "\n</coordinates></LinearRing></outerBoundaryIs></Polygon>\n";
+    } else {
+        stream << "\n</coordinates></LineString>\n";
+    }
+    stream << "</Placemark>\n"
+              "</Document>\n"
+              "</kml>\n";
+
+    return filename;
+}
+
+/// Writes a single part lat/lon polygon shape file along with the .shx index and .prj projection
+QString ShapeFileHelperTest::_writeSHP(const QString& name, const QList<QGeoCoordinate>& coords)
+{
+    QString filename = _tempDir->filePath(name + QStringLiteral(".shp"));
+
+    QFile prjFile(_tempDir->filePath(name + QStringLiteral(".prj")));
+    if (!prjFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return QString();
+    }
+    prjFile.write("GEOGCS[\"GCS_WGS_1984\",DATUM[\"D_WGS_1984\",SPHEROID[\"WGS_1984\",6378137.0,298.257223563]],PRIMEM[\"Greenwich\",0.0],UNIT[\"Degree\",0.0174532925199433]]\n");
+    prjFile.close();
+
+    // Closed ring
+    QVector<double> x, y;
+    for (const QGeoCoordinate& coord: coords) {
+        x.append(coord.longitude());
+        y.append(coord.latitude());
+    }
+    x.append(coords.first().longitude());
+    y.append(coords.first().latitude());
+
+    SHPHandle shpHandle = SHPCreate(filename.toUtf8(), SHPT_POLYGON);
+    if (!shpHandle) {
+        return QString();
+    }
+    SHPObject* shpObject = SHPCreateSimpleObject(SHPT_POLYGON, x.count(), x.data(), y.data(), nullptr);
+    SHPWriteObject(shpHandle, -1, shpObject);
+    SHPDestroyObject(shpObject);
+    SHPClose(shpHandle);
+
+    return filename;
+}
+
+void ShapeFileHelperTest::_testKMLPolygon(void)
+{
+    QList<QGeoCoordinate> clockwise = _circle(2000, 1000);
+    QList<QGeoCoordinate> counterClockwise = clockwise;
+    std::reverse(counterClockwise.begin(), counterClockwise.end());
+
+    QString clockwiseFile = _writeKML(QStringLiteral("cw.kml"), clockwise, true /* polygon */);
+    QString counterClockwiseFile = _writeKML(QStringLiteral("ccw.kml"), counterClockwise, true /* polygon */);
+    QVERIFY(!clockwiseFile.isEmpty());
+    QVERIFY(!counterClockwiseFile.isEmpty());
+
+    QString errorString;
+    QCOMPARE(ShapeFileHelper::determineShapeType(clockwiseFile, errorString), ShapeFileHelper::Polygon);
+    QVERIFY(errorString.isEmpty());
+
+    // Both windings must come back clockwise
+    for (const QString& filename: { clockwiseFile, counterClockwiseFile }) {
+        QList<double> progressValues;
+        QList<QGeoCoordinate> vertices;
+        QVERIFY(ShapeFileHelper::loadPolygonFromFile(filename, vertices, errorString, [&progressValues](double fraction) { progressValues.append(fraction); }));
+        QVERIFY(errorString.isEmpty());
+        QCOMPARE(vertices.count(), clockwise.count());
+        for (int i=0; i<vertices.count(); i++) {
+            QVERIFY(vertices[i].distanceTo(clockwise[i]) < 0.01);
+        }
+
+        QVERIFY(!progressValues.isEmpty());
+        QVERIFY(std::is_sorted(progressValues.begin(), progressValues.end()));
+        QCOMPARE(progressValues.last(), 1.0);
+    }
+}
+
+void ShapeFileHelperTest::_testKMLPolyline(void)
+{
+    QList<QGeoCoordinate> coords;
+    for (int i=0; i<1000; i++) {
+        coords.append(_center.atDistanceAndAzimuth(i * 10, 45));
+    }
+    QString filename = _writeKML(QStringLiteral("line.kml"), coords, false /* polygon */);
+    QVERIFY(!filename.isEmpty());
+
+    QString errorString;
+    QCOMPARE(ShapeFileHelper::determineShapeType(filename, errorString), ShapeFileHelper::Polyline);
+
+    QList<QGeoCoordinate> loadedCoords;
+    QVERIFY(ShapeFileHelper::loadPolylineFromFile(filename, loadedCoords, errorString));
+    QCOMPARE(loadedCoords.count(), coords.count());
+    QVERIFY(loadedCoords.first().distanceTo(coords.first()) < 0.01);
+    QVERIFY(loadedCoords.last().distanceTo(coords.last()) < 0.01);
+
+    // Polygon load from a file without a polygon fails cleanly
+    QList<QGeoCoordinate> vertices;
+    QVERIFY(!KMLFileHelper::loadPolygonFromFile(filename, vertices, errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void ShapeFileHelperTest::_testKMLBadCoordinates(void)
+{
+    QString filename = _tempDir->filePath(QStringLiteral("bad.kml"));
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<kml><Placemark><LineString><coordinates>\n"
+               "-122.1,47.6,0 -122.2;47.7,0 -122.3,47.8,0\n"
+               "</coordinates></LineString></Placemark></kml>\n");
+    file.close();
+
+    QString errorString;
+    QList<QGeoCoordinate> coords;
+    QVERIFY(!ShapeFileHelper::loadPolylineFromFile(filename, coords, errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void ShapeFileHelperTest::_testSHPPolygon(void)
+{
+    // 500 vertices on a 1km radius are ~12m apart, above the 5 meter vertex filter of the loader
+    QList<QGeoCoordinate> circle = _circle(500, 1000);
+    QString filename = _writeSHP(QStringLiteral("circle"), circle);
+    QVERIFY(!filename.isEmpty());
+
+    QString errorString;
+    QCOMPARE(ShapeFileHelper::determineShapeType(filename, errorString), ShapeFileHelper::Polygon);
+
+    QList<double> progressValues;
+    QList<QGeoCoordinate> vertices;
+    QVERIFY(ShapeFileHelper::loadPolygonFromFile(filename, vertices, errorString, [&progressValues](double fraction) { progressValues.append(fraction); }));
+    QVERIFY(errorString.isEmpty());
+    QCOMPARE(vertices.count(), circle.count());
+    for (int i=0; i<vertices.count(); i++) {
+        QVERIFY(vertices[i].distanceTo(circle[i]) < 0.01);
+    }
+    QVERIFY(!progressValues.isEmpty());
+    QCOMPARE(progressValues.last(), 1.0);
+}
+
+void ShapeFileHelperTest::_testSimplify(void)
+{
+    // Noisy straight line collapses to its end points
+    QList<QGeoCoordinate> line;
+    for (int i=0; i<=100; i++) {
+        QGeoCoordinate coord = _center.atDistanceAndAzimuth(i * 10, 90);
+        line.append(coord.atDistanceAndAzimuth((i % 2) ? 0.5 : -0.5, 0));
+    }
+    QList<QGeoCoordinate> simplified = line;
+    ShapeFileHelper::simplify(simplified, 2, false /* closed */);
+    QCOMPARE(simplified.count(), 2);
+    QCOMPARE(simplified.first(), line.first());
+    QCOMPARE(simplified.last(), line.last());
+
+    // Zero tolerance leaves everything alone
+    simplified = line;
+    ShapeFileHelper::simplify(simplified, 0, false /* closed */);
+    QCOMPARE(simplified, line);
+
+    // Densely sampled square ring collapses to its corners
+    QList<QGeoCoordinate> square;
+    QGeoCoordinate corner = _center;
+    for (int side=0; side<4; side++) {
+        for (int i=0; i<100; i++) {
+            square.append(corner.atDistanceAndAzimuth(i * 10, side * 90));
+        }
+        corner = corner.atDistanceAndAzimuth(1000, side * 90);
+    }
+    simplified = square;
+    ShapeFileHelper::simplify(simplified, 1, true /* closed */);
+    QCOMPARE(simplified.count(), 4);
+    QCOMPARE(simplified.first(), square[0]);
+    QVERIFY(simplified.contains(square[100]));
+    QVERIFY(simplified.contains(square[200]));
+    QVERIFY(simplified.contains(square[300]));
+
+    // A ring which would collapse below three vertices is left alone
+    QList<QGeoCoordinate> sliver;
+    for (int i=0; i<10; i++) {
+        sliver.append(_center.atDistanceAndAzimuth(i * 10, 0));
+    }
+    simplified = sliver;
+    ShapeFileHelper::simplify(simplified, 1, true /* closed */);
+    QCOMPARE(simplified, sliver);
+}
+
+void ShapeFileHelperTest::_testBackgroundLoad(void)
+{
+    QString smallFile = _writeKML(QStringLiteral("small.kml"), _circle(100, 1000), true /* polygon */);
+    QString largeFile = _writeKML(QStringLiteral("large.kml"), _circle(20000, 1000), true /* polygon */);
+
+    ShapeFileLoader loader;
+    QSignalSpy spyProgress(&loader, &ShapeFileLoader::progress);
+    QSignalSpy spyComplete(&loader, &ShapeFileLoader::loadComplete);
+
+    // Second load supersedes the first, only its result is signalled
+    loader.load(smallFile, ShapeFileHelper::Polygon, 0);
+    loader.load(largeFile, ShapeFileHelper::Polygon, 0);
+    QVERIFY(loader.loading());
+    QVERIFY(spyComplete.wait(10000));
+    QCOMPARE(spyComplete.count(), 1);
+    QVERIFY(!loader.loading());
+
+    QList<QVariant> arguments = spyComplete.takeFirst();
+    QVERIFY(arguments[0].toBool());
+    QCOMPARE(arguments[1].value<QList<QGeoCoordinate>>().count(), 20000);
+    QVERIFY(arguments[2].toString().isEmpty());
+    QVERIFY(spyProgress.count() > 0);
+
+    // Simplification runs on the worker as well. The circle sagitta at 20000 vertices is far below 1 meter.
+    loader.load(largeFile, ShapeFileHelper::Polygon, 1);
+    QVERIFY(spyComplete.wait(10000));
+    arguments = spyComplete.takeFirst();
+    QVERIFY(arguments[0].toBool());
+    int simplifiedCount = arguments[1].value<QList<QGeoCoordinate>>().count();
+    QVERIFY(simplifiedCount >= 3);
+    QVERIFY(simplifiedCount < 20000);
+
+    // Errors come back through the same signal
+    loader.load(_tempDir->filePath(QStringLiteral("missing.kml")), ShapeFileHelper::Polygon, 0);
+    QVERIFY(spyComplete.wait(10000));
+    arguments = spyComplete.takeFirst();
+    QVERIFY(!arguments[0].toBool());
+    QVERIFY(!arguments[2].toString().isEmpty());
+}
+
+void ShapeFileHelperTest::_testPolygonBackgroundLoad(void)
+{
+    QString file = _writeKML(QStringLiteral("polygon.kml"), _circle(5000, 1000), true /* polygon */);
+
+    QGCMapPolygon polygon;
+    QSignalSpy spyLoading(&polygon, &QGCMapPolygon::loadingChanged);
+    QSignalSpy spyProgress(&polygon, &QGCMapPolygon::loadProgressChanged);
+
+    polygon.loadKMLOrSHPFileInBackground(file);
+    QVERIFY(polygon.loading());
+    QCOMPARE(spyLoading.count(), 1);
+    QVERIFY(spyLoading.takeFirst()[0].toBool());
+
+    // The path is only replaced once loading signals completion
+    QVERIFY(spyLoading.wait(10000));
+    QVERIFY(!spyLoading.takeFirst()[0].toBool());
+    QVERIFY(!polygon.loading());
+    QVERIFY(polygon.count() >= 3);
+    QVERIFY(spyProgress.count() > 0);
+}
+
+void ShapeFileHelperTest::_benchmarkKMLLoad_data(void)
+{
+    QTest::addColumn<int>("vertexCount");
+
+    QTest::newRow("1000 vertices")      << 1000;
+    QTest::newRow("10000 vertices")     << 10000;
+    QTest::newRow("100000 vertices")    << 100000;
+}
+
+void ShapeFileHelperTest::_benchmarkKMLLoad(void)
+{
+    QFETCH(int, vertexCount);
+
+    QString filename = _writeKML(QStringLiteral("benchmark.kml"), _circle(vertexCount, 5000), true /* polygon */);
+    QVERIFY(!filename.isEmpty());
+
+    QString errorString;
+    QList<QGeoCoordinate> vertices;
+    QBENCHMARK {
+        QVERIFY(ShapeFileHelper::loadPolygonFromFile(filename, vertices, errorString));
+    }
+    QCOMPARE(vertices.count(), vertexCount);
+}
+
+void ShapeFileHelperTest::_benchmarkSHPLoad_data(void)
+{
+    QTest::addColumn<int>("vertexCount");
+
+    QTest::newRow("1000 vertices")      << 1000;
+    QTest::newRow("100000 vertices")    << 100000;
+}
+
+void ShapeFileHelperTest::_benchmarkSHPLoad(void)
+{
+    QFETCH(int, vertexCount);
+
+    // Radius keeps the vertex spacing above the 5 meter filter of the loader
+    QList<QGeoCoordinate> circle = _circle(vertexCount, vertexCount);
+    QString filename = _writeSHP(QStringLiteral("benchmark"), circle);
+    QVERIFY(!filename.isEmpty());
+
+    QString errorString;
+    QList<QGeoCoordinate> vertices;
+    QBENCHMARK {
+        QVERIFY(ShapeFileHelper::loadPolygonFromFile(filename, vertices, errorString));
+    }
+    QCOMPARE(vertices.count(), vertexCount);
+}
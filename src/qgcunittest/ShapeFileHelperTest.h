@@ -0,0 +1,49 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+#include <QGeoCoordinate>
+
+/// Unit test for streaming KML/SHP loading, simplification and background loading
+class ShapeFileHelperTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ShapeFileHelperTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _testKMLPolygon(void);
+    void _testKMLPolyline(void);
+    void _testKMLBadCoordinates(void);
+    void _testSHPPolygon(void);
+    void _testSimplify(void);
+    void _testBackgroundLoad(void);
+    void _testPolygonBackgroundLoad(void);
+    void _benchmarkKMLLoad_data(void);
+    void _benchmarkKMLLoad(void);
+    void _benchmarkSHPLoad_data(void);
+    void _benchmarkSHPLoad(void);
+
+private:
+    QList<QGeoCoordinate>   _circle     (int vertexCount, double radiusMeters) const;
+    QString                 _writeKML   (const QString& name, const QList<QGeoCoordinate>& coords, bool polygon);
+    QString                 _writeSHP   (const QString& name, const QList<QGeoCoordinate>& coords);
+
+    QTemporaryDir*  _tempDir;
+    QGeoCoordinate  _center;
+};
@@ -45,6 +45,16 @@
 #include "TransectStyleComplexItemTest.h"
 #include "CameraCalcTest.h"
 #include "FWLandingPatternTest.h"
+#include "TerrainTileTest.h"
+#include "TerrainDEMTest.h"
+#include "WaypointPathModelTest.h"
+#include "PolygonScanlineClipperTest.h"
+#include "ShapeFileHelperTest.h"
+#include "GeoFenceEvaluatorTest.h"
+#include "QmlObjectListModelTest.h"
+#include "ULogReaderTest.h"
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTilePrefetcherTest.h"
 
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
@@ -77,6 +87,16 @@ UT_REGISTER_TEST(TransectStyleComplexItemTest)
 UT_REGISTER_TEST(QGCMapPolylineTest)
 UT_REGISTER_TEST(CameraCalcTest)
 UT_REGISTER_TEST(FWLandingPatternTest)
+UT_REGISTER_TEST(TerrainTileTest)
+UT_REGISTER_TEST(TerrainDEMTest)
+UT_REGISTER_TEST(WaypointPathModelTest)
+UT_REGISTER_TEST(PolygonScanlineClipperTest)
+UT_REGISTER_TEST(ShapeFileHelperTest)
+UT_REGISTER_TEST(GeoFenceEvaluatorTest)
+UT_REGISTER_TEST(QmlObjectListModelTest)
+UT_REGISTER_TEST(ULogReaderTest)
+UT_REGISTER_TEST(QGCTileCacheWorkerTest)
+UT_REGISTER_TEST(QGCTilePrefetcherTest)
 
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
@@ -41,6 +41,9 @@ Rectangle {
     property Fact _mapProvider:                 QGroundControl.settingsManager.flightMapSettings.mapProvider
     property Fact _mapType:                     QGroundControl.settingsManager.flightMapSettings.mapType
     property Fact _followTarget:                QGroundControl.settingsManager.appSettings.followTarget
+    property Fact _terrainSource:               QGroundControl.settingsManager.offlineMapsSettings.terrainSource
+    property Fact _terrainDEMDirectory:         QGroundControl.settingsManager.offlineMapsSettings.terrainDEMDirectory
+    property Fact _prefetchTilesPerSecond:      QGroundControl.settingsManager.offlineMapsSettings.prefetchTilesPerSecond
     property real _panelWidth:                  _root.width * _internalWidthRatio
     property real _margins:                     ScreenTools.defaultFontPixelWidth
 
@@ -186,6 +189,54 @@ Rectangle {
                                 }
                             }
 
+                            QGCLabel {
+                                text:       qsTr("Terrain Source")
+                                visible:    _terrainSource.visible
+                            }
+                            FactComboBox {
+                                Layout.preferredWidth:  _comboFieldWidth
+                                fact:                   _terrainSource
+                                indexModel:             false
+                                visible:                _terrainSource.visible
+                            }
+
+                            QGCLabel {
+                                text:       qsTr("Terrain DEM Folder")
+                                visible:    _terrainDEMDirectory.visible && _terrainSource.rawValue === 1 && !ScreenTools.isMobile
+                            }
+                            RowLayout {
+                                Layout.preferredWidth:  _comboFieldWidth
+                                visible:                _terrainDEMDirectory.visible && _terrainSource.rawValue === 1 && !ScreenTools.isMobile
+
+                                QGCTextField {
+                                    Layout.fillWidth:   true
+                                    readOnly:           true
+                                    text:               _terrainDEMDirectory.rawValue === "" ? qsTr("<not set>") : _terrainDEMDirectory.value
+                                }
+                                QGCButton {
+                                    text:       qsTr("Browse")
+                                    onClicked:  terrainDEMBrowseDialog.openForLoad()
+                                    QGCFileDialog {
+                                        id:             terrainDEMBrowseDialog
+                                        title:          qsTr("Choose the folder containing DEM files")
+                                        folder:         _terrainDEMDirectory.rawValue
+                                        selectExisting: true
+                                        selectFolder:   true
+                                        onAcceptedForLoad: _terrainDEMDirectory.rawValue = file
+                                    }
+                                }
+                            }
+
+                            QGCLabel {
+                                text:       qsTr("Map Tile Prefetch (tiles/s)")
+                                visible:    _prefetchTilesPerSecond.visible
+                            }
+                            FactTextField {
+                                Layout.preferredWidth:  _valueFieldWidth
+                                fact:                   _prefetchTilesPerSecond
+                                visible:                _prefetchTilesPerSecond.visible
+                            }
+
                             QGCLabel {
                                 text:       qsTr("Stream GCS Position")
                                 visible:    _followTarget.visible
@@ -459,6 +510,12 @@ Rectangle {
                                 Layout.preferredWidth:  _valueFieldWidth
                                 fact:                   QGroundControl.settingsManager.flyViewSettings.guidedMaximumAltitude
                             }
+
+                            QGCLabel { text: qsTr("GeoFence Warning Distance") }
+                            FactTextField {
+                                Layout.preferredWidth:  _valueFieldWidth
+                                fact:                   QGroundControl.settingsManager.flyViewSettings.geoFenceWarningDistance
+                            }
                         }
                     }
                 }
@@ -494,6 +551,28 @@ Rectangle {
                                 fact:                   QGroundControl.settingsManager.appSettings.defaultMissionItemAltitude
                             }
                         }
+
+                        RowLayout {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.settingsManager.appSettings.shapeImportSimplifyTolerance.visible
+
+                            QGCLabel { text: qsTr("KML/SHP Simplify Tolerance") }
+                            FactTextField {
+                                Layout.preferredWidth:  _valueFieldWidth
+                                fact:                   QGroundControl.settingsManager.appSettings.shapeImportSimplifyTolerance
+                            }
+                        }
+
+                        RowLayout {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.settingsManager.appSettings.missionTransferWindow.visible
+
+                            QGCLabel { text: qsTr("Mission Transfer Window") }
+                            FactTextField {
+                                Layout.preferredWidth:  _valueFieldWidth
+                                fact:                   QGroundControl.settingsManager.appSettings.missionTransferWindow
+                            }
+                        }
                     }
                 }
 